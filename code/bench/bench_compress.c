@@ -0,0 +1,328 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "fossil/jellyfish/framework.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+
+int main(void) {
+    printf("bench_compress needs POSIX processes and sockets; skipped\n");
+    return 0;
+}
+
+#else
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Data-parallel training over loopback TCP: every worker process computes a minibatch
+// gradient on its shard and sends it compressed; the parent reduces, compresses the
+// average once more and broadcasts it, and every replica applies the same update.
+
+#define BENCH_INPUTS 32
+#define BENCH_CLASSES 4
+#define BENCH_TRAIN 8192
+#define BENCH_TEST 2048
+#define BENCH_BATCH 16
+#define BENCH_MAX_STEPS 2000
+#define BENCH_EVAL_EVERY 5
+#define BENCH_LEARNING_RATE 0.5
+#define BENCH_TARGET_ACCURACY 0.90
+
+typedef struct {
+    const char* name;
+    fossil_jellyfish_compression_t method;
+    double density;
+} bench_config_t;
+
+typedef struct {
+    int64_t steps;
+    double seconds;
+    int64_t bytes_up;
+    int64_t bytes_down;
+    double accuracy;
+} bench_result_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int send_all(int fd, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    while (size > 0) {
+        ssize_t sent = send(fd, bytes, size, 0);
+        if (sent <= 0) {
+            return -1;
+        }
+        bytes += sent;
+        size -= (size_t)sent;
+    }
+    return 0;
+}
+
+static int recv_all(int fd, void* data, size_t size) {
+    uint8_t* bytes = (uint8_t*)data;
+    while (size > 0) {
+        ssize_t received = recv(fd, bytes, size, 0);
+        if (received <= 0) {
+            return -1;
+        }
+        bytes += received;
+        size -= (size_t)received;
+    }
+    return 0;
+}
+
+static int send_message(int fd, int32_t stop, const uint8_t* message, int64_t size) {
+    if (send_all(fd, &stop, sizeof(stop)) != 0 || send_all(fd, &size, sizeof(size)) != 0) {
+        return -1;
+    }
+    return send_all(fd, message, (size_t)size);
+}
+
+static int64_t recv_message(int fd, int32_t* stop, uint8_t* message, int64_t capacity) {
+    int64_t size;
+    if (recv_all(fd, stop, sizeof(*stop)) != 0 || recv_all(fd, &size, sizeof(size)) != 0 || size < 0 || size > capacity) {
+        return -1;
+    }
+    return recv_all(fd, message, (size_t)size) == 0 ? size : -1;
+}
+
+// Gaussian clusters around fixed random centers, one per class
+static void make_dataset(double* inputs, double* targets, int64_t count, uint64_t seed) {
+    uint64_t state = seed;
+    for (int64_t i = 0; i < count; i++) {
+        int32_t label = (int32_t)(i % BENCH_CLASSES);
+        for (int32_t k = 0; k < BENCH_INPUTS; k++) {
+            double center = sin(12.9898 * (label + 1) + 78.233 * (k + 1)) > 0 ? 0.5 : -0.5;
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            double noise = ((double)(state >> 11) / 9007199254740992.0 - 0.5) * 2.0;
+            inputs[i * BENCH_INPUTS + k] = center + noise;
+        }
+        for (int32_t c = 0; c < BENCH_CLASSES; c++) {
+            targets[i * BENCH_CLASSES + c] = c == label;
+        }
+    }
+}
+
+static fossil_jellyfish_network_t* make_network(void) {
+    int32_t neurons[] = {BENCH_INPUTS, 64, 64, BENCH_CLASSES};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    return fossil_jellyfish_create_network(4, neurons, activations);
+}
+
+static void run_worker(int fd, int32_t rank, int32_t num_workers, const bench_config_t* config, const double* inputs, const double* targets) {
+    fossil_jellyfish_network_t* network = make_network();
+    int64_t num_parameters = fossil_jellyfish_num_parameters(network);
+    fossil_jellyfish_compressor_t* compressor = fossil_jellyfish_compressor_create(config->method, num_parameters, config->density);
+    int64_t capacity = fossil_jellyfish_compressed_bound(compressor);
+    uint8_t* message = (uint8_t*)malloc((size_t)capacity);
+    double* gradients = (double*)malloc((size_t)num_parameters * sizeof(double));
+    int64_t shard = BENCH_TRAIN / num_workers;
+    int64_t cursor = 0;
+
+    for (;;) {
+        memset(gradients, 0, (size_t)num_parameters * sizeof(double));
+        for (int32_t b = 0; b < BENCH_BATCH; b++) {
+            int64_t sample = rank * shard + cursor;
+            cursor = (cursor + 1) % shard;
+            fossil_jellyfish_forward(network, (double*)&inputs[sample * BENCH_INPUTS]);
+            fossil_jellyfish_accumulate_gradients(network, &targets[sample * BENCH_CLASSES], LOSS_BINARY_CROSS_ENTROPY, gradients);
+        }
+
+        int64_t size = fossil_jellyfish_compress(compressor, gradients, message, capacity);
+        int32_t stop = 0;
+        if (send_message(fd, 0, message, size) != 0) {
+            break;
+        }
+        size = recv_message(fd, &stop, message, capacity);
+        if (size < 0 || stop) {
+            break;
+        }
+
+        memset(gradients, 0, (size_t)num_parameters * sizeof(double));
+        fossil_jellyfish_decompress_add(message, size, gradients, num_parameters, 1.0);
+        fossil_jellyfish_apply_gradients(network, gradients, BENCH_LEARNING_RATE);
+    }
+
+    free(message);
+    free(gradients);
+    fossil_jellyfish_compressor_free(compressor);
+    fossil_jellyfish_free_network(network);
+}
+
+static int run_config(const bench_config_t* config, int32_t num_workers, const double* inputs, const double* targets, const fossil_jellyfish_dataset_t* test, bench_result_t* result) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (listener < 0 || bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, num_workers) != 0 ||
+        getsockname(listener, (struct sockaddr*)&address, &length) != 0) {
+        return -1;
+    }
+
+    // Pool threads do not survive fork, so children must start with a stopped pool;
+    // they inherit the dataset copy-on-write
+    fossil_jellyfish_shutdown_threads();
+    for (int32_t rank = 0; rank < num_workers; rank++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            return -1;
+        }
+        if (pid == 0) {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            int one = 1;
+            close(listener);
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            if (connect(fd, (struct sockaddr*)&address, sizeof(address)) == 0 && send_all(fd, &rank, sizeof(rank)) == 0) {
+                fossil_jellyfish_set_num_threads(1);
+                run_worker(fd, rank, num_workers, config, inputs, targets);
+            }
+            close(fd);
+            _exit(0);
+        }
+    }
+
+    int* workers = (int*)malloc((size_t)num_workers * sizeof(int));
+    for (int32_t i = 0; i < num_workers; i++) {
+        int fd = accept(listener, NULL, NULL);
+        int32_t rank = 0;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (fd < 0 || recv_all(fd, &rank, sizeof(rank)) != 0 || rank < 0 || rank >= num_workers) {
+            return -1;
+        }
+        workers[rank] = fd;
+    }
+    close(listener);
+
+    fossil_jellyfish_network_t* network = make_network();
+    int64_t num_parameters = fossil_jellyfish_num_parameters(network);
+    fossil_jellyfish_compressor_t* compressor = fossil_jellyfish_compressor_create(config->method, num_parameters, config->density);
+    int64_t capacity = fossil_jellyfish_compressed_bound(compressor);
+    uint8_t* message = (uint8_t*)malloc((size_t)capacity);
+    double* reduced = (double*)malloc((size_t)num_parameters * sizeof(double));
+    double* update = (double*)malloc((size_t)num_parameters * sizeof(double));
+    fossil_jellyfish_metrics_t metrics = {0};
+    metrics.flags = METRIC_ACCURACY;
+    metrics.loss = LOSS_BINARY_CROSS_ENTROPY;
+
+    memset(result, 0, sizeof(*result));
+    double start = now_seconds();
+    int32_t stop = 0;
+
+    while (!stop) {
+        // Reduce: average the decoded worker gradients
+        memset(reduced, 0, (size_t)num_parameters * sizeof(double));
+        for (int32_t i = 0; i < num_workers; i++) {
+            int32_t ignored;
+            int64_t size = recv_message(workers[i], &ignored, message, capacity);
+            if (size < 0 || fossil_jellyfish_decompress_add(message, size, reduced, num_parameters, 1.0 / (num_workers * BENCH_BATCH)) != 0) {
+                return -1;
+            }
+            result->bytes_up += size;
+        }
+        result->steps++;
+
+        if (result->steps % BENCH_EVAL_EVERY == 0) {
+            fossil_jellyfish_evaluate(network, test, &metrics);
+            result->accuracy = metrics.accuracy;
+            stop = metrics.accuracy >= BENCH_TARGET_ACCURACY || result->steps >= BENCH_MAX_STEPS;
+        }
+
+        // Broadcast the compressed average; every replica applies the same decoded update
+        int64_t size = fossil_jellyfish_compress(compressor, reduced, message, capacity);
+        for (int32_t i = 0; i < num_workers; i++) {
+            if (send_message(workers[i], stop, message, size) != 0) {
+                return -1;
+            }
+            result->bytes_down += size;
+        }
+        memset(update, 0, (size_t)num_parameters * sizeof(double));
+        fossil_jellyfish_decompress_add(message, size, update, num_parameters, 1.0);
+        fossil_jellyfish_apply_gradients(network, update, BENCH_LEARNING_RATE);
+    }
+    result->seconds = now_seconds() - start;
+
+    for (int32_t i = 0; i < num_workers; i++) {
+        close(workers[i]);
+    }
+    while (wait(NULL) > 0) {
+    }
+
+    free(workers);
+    free(message);
+    free(reduced);
+    free(update);
+    fossil_jellyfish_compressor_free(compressor);
+    fossil_jellyfish_free_network(network);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int32_t num_workers = argc > 1 ? atoi(argv[1]) : 4;
+    bench_config_t configs[] = {
+        {"dense", COMPRESSION_NONE, 1.0},
+        {"int8", COMPRESSION_INT8, 1.0},
+        {"top-10%", COMPRESSION_TOPK, 0.10},
+        {"top-1%", COMPRESSION_TOPK, 0.01},
+    };
+    double* inputs = (double*)malloc(BENCH_TRAIN * BENCH_INPUTS * sizeof(double));
+    double* targets = (double*)malloc(BENCH_TRAIN * BENCH_CLASSES * sizeof(double));
+    double* test_inputs = (double*)malloc(BENCH_TEST * BENCH_INPUTS * sizeof(double));
+    double* test_targets = (double*)malloc(BENCH_TEST * BENCH_CLASSES * sizeof(double));
+    fossil_jellyfish_dataset_t test = {test_inputs, test_targets, BENCH_TEST};
+
+    if (num_workers < 1 || num_workers > 64) {
+        fprintf(stderr, "usage: %s [workers 1..64]\n", argv[0]);
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    make_dataset(inputs, targets, BENCH_TRAIN, 1);
+    make_dataset(test_inputs, test_targets, BENCH_TEST, 2);
+
+    printf("%d workers, batch %d per worker, target accuracy %.2f\n", num_workers, BENCH_BATCH, BENCH_TARGET_ACCURACY);
+    printf("%-10s %8s %10s %14s %14s %10s %10s\n", "method", "steps", "seconds", "bytes up", "bytes down", "up/step", "accuracy");
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++) {
+        bench_result_t result;
+        if (run_config(&configs[c], num_workers, inputs, targets, &test, &result) != 0) {
+            fprintf(stderr, "%s: loopback run failed\n", configs[c].name);
+            return 1;
+        }
+        printf("%-10s %8lld %10.3f %14lld %14lld %10lld %10.4f\n", configs[c].name, (long long)result.steps, result.seconds,
+               (long long)result.bytes_up, (long long)result.bytes_down, (long long)(result.bytes_up / result.steps), result.accuracy);
+    }
+
+    free(inputs);
+    free(targets);
+    free(test_inputs);
+    free(test_targets);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,188 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifdef __linux__
+#define _GNU_SOURCE
+#else
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "fossil/jellyfish/framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Runs fossil_jellyfish_forward over a large parameter array with 4 KB pages and with
+// huge pages, counting dTLB load misses where perf events are allowed. The dense layer
+// streams its weights in order; the hashed layer gathers them at random, the access
+// pattern that misses the TLB the most.
+
+#define BENCH_INPUTS 2048
+#define BENCH_OUTPUTS 8
+#define BENCH_HASHED_NEURONS 512
+
+typedef struct {
+    double seconds;
+    double misses;     // dTLB load misses per pass, negative when not measured
+} bench_result_t;
+
+static double now_seconds(void) {
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+// Opens a dTLB read-miss counter for this thread, -1 when perf events are unavailable
+static int open_dtlb_counter(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+static void start_counter(int fd) {
+#ifdef __linux__
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#else
+    (void)fd;
+#endif
+}
+
+static double stop_counter(int fd) {
+#ifdef __linux__
+    long long count = 0;
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) == (ssize_t)sizeof(count)) {
+            return (double)count;
+        }
+    }
+#else
+    (void)fd;
+#endif
+    return -1;
+}
+
+// Kilobytes of this process backed by transparent huge pages, -1 when unknown
+static long anon_huge_kb(void) {
+    long total = -1;
+#ifdef __linux__
+    FILE* file = fopen("/proc/self/smaps_rollup", "r");
+    char line[256];
+    while (file && fgets(line, sizeof(line), file)) {
+        long kb;
+        if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1) {
+            total = kb;
+        }
+    }
+    if (file) {
+        fclose(file);
+    }
+#endif
+    return total;
+}
+
+static void run(fossil_jellyfish_network_t* network, double* inputs, int32_t passes, int counter, bench_result_t* result) {
+    // Warm up once so page faults and promotion stay out of the timing
+    fossil_jellyfish_forward(network, inputs);
+
+    start_counter(counter);
+    double start = now_seconds();
+    for (int32_t p = 0; p < passes; p++) {
+        fossil_jellyfish_forward(network, inputs);
+    }
+    result->seconds = (now_seconds() - start) / passes;
+    double misses = stop_counter(counter);
+    result->misses = misses >= 0 ? misses / passes : -1;
+}
+
+int main(int argc, char** argv) {
+    int32_t megabytes = argc > 1 ? atoi(argv[1]) : 512;
+    int32_t passes = argc > 2 ? atoi(argv[2]) : 5;
+    if (megabytes < 8 || passes < 1) {
+        fprintf(stderr, "usage: %s [weight megabytes >= 8] [passes]\n", argv[0]);
+        return 1;
+    }
+
+    int64_t num_params = ((int64_t)megabytes << 20) / (int64_t)sizeof(double);
+    int32_t hidden = (int32_t)(num_params / BENCH_INPUTS);
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_RELU, ACTIVATION_LINEAR};
+    double* inputs = (double*)malloc(BENCH_INPUTS * sizeof(double));
+    for (int32_t i = 0; i < BENCH_INPUTS; i++) {
+        inputs[i] = sin(0.01 * i);
+    }
+    int counter = open_dtlb_counter();
+
+    printf("%d MB of weights, %d passes, dTLB counter %s\n", megabytes, passes, counter >= 0 ? "on" : "unavailable");
+    printf("%-8s %-6s %12s %10s %16s %14s\n", "layer", "pages", "ms/pass", "GB/s", "dTLB misses", "THP MB");
+    for (int32_t hashed = 0; hashed <= 1; hashed++) {
+        for (int32_t huge = 0; huge <= 1; huge++) {
+            int32_t neurons[] = {BENCH_INPUTS, hashed ? BENCH_HASHED_NEURONS : hidden, BENCH_OUTPUTS};
+            fossil_jellyfish_set_huge_pages(huge);
+            fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+            if (!network || (hashed && fossil_jellyfish_hash_layer(network, 1, num_params, 1) != 0)) {
+                fprintf(stderr, "could not allocate the network\n");
+                return 1;
+            }
+            long backed = anon_huge_kb();
+
+            // Bytes touched per pass: the whole matrix, or one double per virtual weight
+            bench_result_t result;
+            run(network, inputs, passes, counter, &result);
+            double gigabytes = (double)neurons[1] * BENCH_INPUTS * sizeof(double) / 1e9;
+            char misses[32];
+            if (result.misses >= 0) {
+                snprintf(misses, sizeof(misses), "%.0f", result.misses);
+            } else {
+                snprintf(misses, sizeof(misses), "n/a");
+            }
+            printf("%-8s %-6s %12.2f %10.2f %16s %14ld\n", hashed ? "hashed" : "dense", huge ? "2 MB" : "4 KB", result.seconds * 1e3,
+                   gigabytes / result.seconds, misses, backed >= 0 ? backed / 1024 : -1);
+            fossil_jellyfish_free_network(network);
+        }
+    }
+    fossil_jellyfish_set_huge_pages(0);
+
+#ifdef __linux__
+    if (counter >= 0) {
+        close(counter);
+    }
+#endif
+    free(inputs);
+    return 0;
+}
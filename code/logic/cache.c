@@ -0,0 +1,245 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/cache.h"
+#include "internal.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define jellyfish_cpu_relax() YieldProcessor()
+#define jellyfish_thread_yield() ((void)SwitchToThread())
+#else
+#include <sched.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define jellyfish_cpu_relax() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define jellyfish_cpu_relax() __asm__ __volatile__("yield")
+#else
+#define jellyfish_cpu_relax() ((void)0)
+#endif
+#define jellyfish_thread_yield() ((void)sched_yield())
+#endif
+
+// Pauses between polls double up to this many, then a waiter yields its core instead
+#define JELLYFISH_SPIN_LIMIT 64
+
+_Static_assert(sizeof(fossil_jellyfish_cache_set_t) % FOSSIL_JELLYFISH_CACHE_LINE == 0, "cache sets must fill whole cache lines");
+
+// Critical sections are a few dozen instructions, so spinning beats sleeping. Waiters
+// back off with pause instructions, which frees the core for a hyperthreaded holder,
+// and yield once the holder looks descheduled.
+static void jellyfish_set_lock(fossil_jellyfish_cache_set_t* set) {
+    int32_t spins = 1;
+    while (!jellyfish_atomic_cas32(&set->lock, 0, 1)) {
+        while (jellyfish_atomic_load32(&set->lock)) {
+            if (spins > JELLYFISH_SPIN_LIMIT) {
+                jellyfish_thread_yield();
+                continue;
+            }
+            for (int32_t i = 0; i < spins; i++) {
+                jellyfish_cpu_relax();
+            }
+            spins *= 2;
+        }
+    }
+}
+
+static void jellyfish_set_unlock(fossil_jellyfish_cache_set_t* set) {
+    jellyfish_atomic_store32(&set->lock, 0);
+}
+
+#define JELLYFISH_CACHE_MULTIPLIER 0xff51afd7ed558ccdULL
+
+static inline uint64_t jellyfish_hash_word(uint64_t lane, const double* value) {
+    uint64_t bits;
+    memcpy(&bits, value, sizeof(bits));
+    lane = (lane ^ bits) * JELLYFISH_CACHE_MULTIPLIER;
+    return lane ^ (lane >> 29);
+}
+
+static inline uint64_t jellyfish_rotate64(uint64_t x, int32_t bits) {
+    return (x << bits) | (x >> (64 - bits));
+}
+
+// Four independent multiply lanes and a single finalizer keep hashing short on a hit
+static uint64_t jellyfish_hash_input(const double* input, int32_t width) {
+    uint64_t a = (uint64_t)width, b = JELLYFISH_GOLDEN_GAMMA, c = 2 * JELLYFISH_GOLDEN_GAMMA, d = 3 * JELLYFISH_GOLDEN_GAMMA;
+    int32_t k = 0;
+    for (; k + 4 <= width; k += 4) {
+        a = jellyfish_hash_word(a, &input[k]);
+        b = jellyfish_hash_word(b, &input[k + 1]);
+        c = jellyfish_hash_word(c, &input[k + 2]);
+        d = jellyfish_hash_word(d, &input[k + 3]);
+    }
+    for (; k < width; k++) {
+        a = jellyfish_hash_word(a, &input[k]);
+    }
+    return jellyfish_mix64(a ^ jellyfish_rotate64(b, 16) ^ jellyfish_rotate64(c, 32) ^ jellyfish_rotate64(d, 48));
+}
+
+static fossil_jellyfish_cache_set_t* jellyfish_cache_set(const fossil_jellyfish_cache_t* cache, uint64_t hash) {
+    return &cache->sets[((hash >> 32) * (uint64_t)cache->num_sets) >> 32];
+}
+
+static double* jellyfish_cache_entry(const fossil_jellyfish_cache_t* cache, const fossil_jellyfish_cache_set_t* set, int32_t way) {
+    size_t entry = (size_t)(set - cache->sets) * FOSSIL_JELLYFISH_CACHE_WAYS + (size_t)way;
+    return cache->values + entry * (size_t)(cache->input_width + cache->output_width);
+}
+
+// Way holding the input, or -1; the caller holds the set lock
+static int32_t jellyfish_cache_find(const fossil_jellyfish_cache_t* cache, const fossil_jellyfish_cache_set_t* set, const double* input, uint64_t hash) {
+    for (int32_t way = 0; way < FOSSIL_JELLYFISH_CACHE_WAYS; way++) {
+        if ((set->used >> way & 1) && set->hashes[way] == hash &&
+            memcmp(jellyfish_cache_entry(cache, set, way), input, (size_t)cache->input_width * sizeof(double)) == 0) {
+            return way;
+        }
+    }
+    return -1;
+}
+
+fossil_jellyfish_cache_t* fossil_jellyfish_cache_create(int64_t capacity, int32_t input_width, int32_t output_width) {
+    if (capacity <= 0 || input_width <= 0 || output_width <= 0) {
+        return NULL;
+    }
+    int64_t num_sets = (capacity + FOSSIL_JELLYFISH_CACHE_WAYS - 1) / FOSSIL_JELLYFISH_CACHE_WAYS;
+    if (num_sets > (int64_t)UINT32_MAX || (uint64_t)num_sets > (SIZE_MAX - FOSSIL_JELLYFISH_CACHE_LINE) / sizeof(fossil_jellyfish_cache_set_t)) {
+        return NULL;
+    }
+
+    fossil_jellyfish_cache_t* cache = (fossil_jellyfish_cache_t*)jellyfish_calloc(1, sizeof(fossil_jellyfish_cache_t));
+    if (!cache) {
+        return NULL;
+    }
+    cache->input_width = input_width;
+    cache->output_width = output_width;
+    cache->num_sets = num_sets;
+    // Over-allocated by a line so the sets can start on a line boundary
+    cache->set_block = jellyfish_calloc(1, (size_t)num_sets * sizeof(fossil_jellyfish_cache_set_t) + FOSSIL_JELLYFISH_CACHE_LINE);
+    if (cache->set_block) {
+        uintptr_t sets = ((uintptr_t)cache->set_block + FOSSIL_JELLYFISH_CACHE_LINE - 1) & ~(uintptr_t)(FOSSIL_JELLYFISH_CACHE_LINE - 1);
+        cache->sets = (fossil_jellyfish_cache_set_t*)sets;
+    }
+    cache->values = (double*)jellyfish_malloc((size_t)num_sets * FOSSIL_JELLYFISH_CACHE_WAYS * (size_t)(input_width + output_width) * sizeof(double));
+    if (!cache->sets || !cache->values) {
+        fossil_jellyfish_cache_free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void fossil_jellyfish_cache_free(fossil_jellyfish_cache_t* cache) {
+    if (!cache) {
+        return;
+    }
+    jellyfish_free(cache->set_block);
+    jellyfish_free(cache->values);
+    jellyfish_free(cache);
+}
+
+int32_t fossil_jellyfish_cache_lookup(fossil_jellyfish_cache_t* cache, const double* input, uint64_t version, double* output) {
+    uint64_t hash = jellyfish_hash_input(input, cache->input_width);
+    fossil_jellyfish_cache_set_t* set = jellyfish_cache_set(cache, hash);
+
+    jellyfish_set_lock(set);
+    int32_t way = jellyfish_cache_find(cache, set, input, hash);
+    int32_t hit = way >= 0 && set->versions[way] == version;
+    if (hit) {
+        memcpy(output, jellyfish_cache_entry(cache, set, way) + cache->input_width, (size_t)cache->output_width * sizeof(double));
+        set->referenced |= 1u << way;
+        set->hits++;
+    } else {
+        set->misses++;
+    }
+    jellyfish_set_unlock(set);
+    return hit;
+}
+
+void fossil_jellyfish_cache_insert(fossil_jellyfish_cache_t* cache, const double* input, uint64_t version, const double* output) {
+    uint64_t hash = jellyfish_hash_input(input, cache->input_width);
+    fossil_jellyfish_cache_set_t* set = jellyfish_cache_set(cache, hash);
+
+    jellyfish_set_lock(set);
+    int32_t way = jellyfish_cache_find(cache, set, input, hash);
+    if (way < 0 && set->used != (1u << FOSSIL_JELLYFISH_CACHE_WAYS) - 1) {
+        way = 0;
+        while (set->used >> way & 1) {
+            way++;
+        }
+    }
+    if (way < 0) {
+        // Second chance: referenced ways lose their bit and the hand moves on
+        while (set->referenced >> set->hand & 1) {
+            set->referenced &= ~(1u << set->hand);
+            set->hand = (set->hand + 1) % FOSSIL_JELLYFISH_CACHE_WAYS;
+        }
+        way = set->hand;
+        set->hand = (set->hand + 1) % FOSSIL_JELLYFISH_CACHE_WAYS;
+        set->evictions++;
+    }
+
+    double* entry = jellyfish_cache_entry(cache, set, way);
+    memcpy(entry, input, (size_t)cache->input_width * sizeof(double));
+    memcpy(entry + cache->input_width, output, (size_t)cache->output_width * sizeof(double));
+    set->hashes[way] = hash;
+    set->versions[way] = version;
+    set->used |= 1u << way;
+    set->referenced &= ~(1u << way);
+    set->insertions++;
+    jellyfish_set_unlock(set);
+}
+
+int32_t fossil_jellyfish_cached_forward(fossil_jellyfish_cache_t* cache, const fossil_jellyfish_network_t* network, uint64_t version, const double* input, double* output, double* scratch) {
+    if (fossil_jellyfish_cache_lookup(cache, input, version, output)) {
+        return 1;
+    }
+    jellyfish_forward_rows(network, input, network->layers[0]->num_neurons, 1, scratch, output);
+    fossil_jellyfish_cache_insert(cache, input, version, output);
+    return 0;
+}
+
+size_t fossil_jellyfish_cache_scratch_size(const fossil_jellyfish_network_t* network) {
+    return jellyfish_forward_scratch_size(network);
+}
+
+void fossil_jellyfish_cache_clear(fossil_jellyfish_cache_t* cache) {
+    for (int64_t s = 0; s < cache->num_sets; s++) {
+        fossil_jellyfish_cache_set_t* set = &cache->sets[s];
+        jellyfish_set_lock(set);
+        set->hand = 0;
+        set->used = set->referenced = 0;
+        set->hits = set->misses = set->insertions = set->evictions = 0;
+        jellyfish_set_unlock(set);
+    }
+}
+
+void fossil_jellyfish_cache_stats(fossil_jellyfish_cache_t* cache, fossil_jellyfish_cache_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (int64_t s = 0; s < cache->num_sets; s++) {
+        fossil_jellyfish_cache_set_t* set = &cache->sets[s];
+        jellyfish_set_lock(set);
+        stats->hits += set->hits;
+        stats->misses += set->misses;
+        stats->insertions += set->insertions;
+        stats->evictions += set->evictions;
+        for (int32_t way = 0; way < FOSSIL_JELLYFISH_CACHE_WAYS; way++) {
+            stats->entries += set->used >> way & 1;
+        }
+        jellyfish_set_unlock(set);
+    }
+    stats->capacity = cache->num_sets * FOSSIL_JELLYFISH_CACHE_WAYS;
+    stats->memory_bytes = sizeof(*cache) + (size_t)cache->num_sets * sizeof(fossil_jellyfish_cache_set_t) + FOSSIL_JELLYFISH_CACHE_LINE +
+                          (size_t)stats->capacity * (size_t)(cache->input_width + cache->output_width) * sizeof(double);
+    stats->hit_rate = stats->hits + stats->misses > 0 ? (double)stats->hits / (double)(stats->hits + stats->misses) : 0;
+}
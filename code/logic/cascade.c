@@ -0,0 +1,251 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/cascade.h"
+#include "fossil/jellyfish/factorize.h"
+#include "internal.h"
+#include <string.h>
+
+static int64_t jellyfish_layer_flops(const fossil_jellyfish_network_t* network, int32_t index) {
+    return (int64_t)network->layers[index]->num_neurons * network->layers[index - 1]->num_neurons;
+}
+
+fossil_jellyfish_cascade_t* fossil_jellyfish_cascade_create(fossil_jellyfish_network_t* network) {
+    if (!network || network->num_layers < 2) {
+        return NULL;
+    }
+    fossil_jellyfish_activation_t activation = network->layers[network->num_layers - 1]->activation;
+    if (activation != ACTIVATION_SIGMOID && activation != ACTIVATION_SOFTMAX) {
+        return NULL;
+    }
+
+    fossil_jellyfish_cascade_t* cascade = (fossil_jellyfish_cascade_t*)jellyfish_calloc(1, sizeof(fossil_jellyfish_cascade_t));
+    if (!cascade) {
+        return NULL;
+    }
+    cascade->network = network;
+    cascade->full_flops = fossil_jellyfish_forward_flops(network);
+    cascade->exit_counts = (int64_t*)jellyfish_calloc(1, sizeof(int64_t));
+    if (!cascade->exit_counts) {
+        jellyfish_free(cascade);
+        return NULL;
+    }
+    return cascade;
+}
+
+void fossil_jellyfish_cascade_free(fossil_jellyfish_cascade_t* cascade) {
+    if (!cascade) {
+        return;
+    }
+    for (int32_t e = 0; e < cascade->num_exits; e++) {
+        fossil_jellyfish_free_network(cascade->exits[e].head);
+    }
+    jellyfish_free(cascade->exits);
+    jellyfish_free(cascade->exit_counts);
+    jellyfish_free(cascade);
+}
+
+int32_t fossil_jellyfish_cascade_add_exit(fossil_jellyfish_cascade_t* cascade, const fossil_jellyfish_exit_config_t* config) {
+    if (!cascade || !config || config->layer < 1 || config->layer > cascade->network->num_layers - 2 || config->hidden < 0) {
+        return -1;
+    }
+
+    // Exits stay sorted by depth, one per layer
+    int32_t position = 0;
+    while (position < cascade->num_exits && cascade->exits[position].config.layer < config->layer) {
+        position++;
+    }
+    if (position < cascade->num_exits && cascade->exits[position].config.layer == config->layer) {
+        return -1;
+    }
+
+    const fossil_jellyfish_network_t* network = cascade->network;
+    const fossil_jellyfish_layer_t* output_layer = network->layers[network->num_layers - 1];
+    int32_t neurons[3] = {network->layers[config->layer]->num_neurons, config->hidden, output_layer->num_neurons};
+    fossil_jellyfish_activation_t activations[3] = {ACTIVATION_LINEAR, ACTIVATION_RELU, output_layer->activation};
+    if (config->hidden == 0) {
+        neurons[1] = neurons[2];
+        activations[1] = activations[2];
+    }
+    fossil_jellyfish_network_t* head = fossil_jellyfish_create_network(config->hidden > 0 ? 3 : 2, neurons, activations);
+
+    fossil_jellyfish_exit_t* exits = (fossil_jellyfish_exit_t*)jellyfish_realloc(cascade->exits, (size_t)cascade->num_exits * sizeof(fossil_jellyfish_exit_t),
+                                                                                (size_t)(cascade->num_exits + 1) * sizeof(fossil_jellyfish_exit_t));
+    if (exits) {
+        cascade->exits = exits;
+    }
+    int64_t* exit_counts = (int64_t*)jellyfish_realloc(cascade->exit_counts, (size_t)(cascade->num_exits + 1) * sizeof(int64_t), (size_t)(cascade->num_exits + 2) * sizeof(int64_t));
+    if (exit_counts) {
+        cascade->exit_counts = exit_counts;
+    }
+    if (!head || !exits || !exit_counts) {
+        fossil_jellyfish_free_network(head);
+        return -1;
+    }
+
+    memmove(&exits[position + 1], &exits[position], (size_t)(cascade->num_exits - position) * sizeof(fossil_jellyfish_exit_t));
+    exits[position].config = *config;
+    exits[position].head = head;
+    cascade->num_exits++;
+
+    // Stopping at an exit costs the backbone up to its layer plus every head evaluated so far
+    int64_t backbone = 0, heads = 0;
+    int32_t layer = 1;
+    for (int32_t e = 0; e < cascade->num_exits; e++) {
+        for (; layer <= exits[e].config.layer; layer++) {
+            backbone += jellyfish_layer_flops(network, layer);
+        }
+        heads += fossil_jellyfish_forward_flops(exits[e].head);
+        exits[e].flops = backbone + heads;
+    }
+
+    fossil_jellyfish_cascade_reset_stats(cascade);
+    return position;
+}
+
+int32_t fossil_jellyfish_cascade_train(fossil_jellyfish_cascade_t* cascade, const double* inputs, const double* targets, int64_t num_samples, int32_t num_epochs, double learning_rate, fossil_jellyfish_loss_t loss) {
+    if (!cascade || !inputs || !targets || num_samples < 0) {
+        return -1;
+    }
+
+    fossil_jellyfish_network_t* network = cascade->network;
+    int32_t input_width = network->layers[0]->num_neurons;
+    int32_t output_width = network->layers[network->num_layers - 1]->num_neurons;
+    int64_t backbone_parameters = fossil_jellyfish_num_parameters(network);
+    int64_t head_parameters = 0, error_count = 0;
+    for (int32_t e = 0; e < cascade->num_exits; e++) {
+        int64_t count = fossil_jellyfish_num_parameters(cascade->exits[e].head);
+        head_parameters = count > head_parameters ? count : head_parameters;
+        error_count += network->layers[cascade->exits[e].config.layer]->num_neurons;
+    }
+
+    jellyfish_scratch_mark_t mark = jellyfish_scratch_mark();
+    double* gradients = (double*)jellyfish_scratch_alloc((size_t)(backbone_parameters + head_parameters) * sizeof(double));
+    double* error_values = (double*)jellyfish_scratch_alloc((size_t)error_count * sizeof(double));
+    const double** errors = (const double**)jellyfish_scratch_alloc((size_t)network->num_layers * sizeof(double*));
+    if (!gradients || !error_values || !errors) {
+        jellyfish_scratch_reset(mark);
+        return -1;
+    }
+    memset((void*)errors, 0, (size_t)network->num_layers * sizeof(double*));
+    double* head_gradients = gradients + backbone_parameters;
+
+    int32_t status = 0;
+    for (int32_t epoch = 0; epoch < num_epochs && status == 0; epoch++) {
+        for (int64_t i = 0; i < num_samples && status == 0; i++) {
+            const double* target = targets + i * output_width;
+            fossil_jellyfish_forward(network, (double*)&inputs[i * input_width]);
+
+            // Each head learns from its layer's outputs and sends its input error back into that layer
+            double* error = error_values;
+            for (int32_t e = 0; e < cascade->num_exits; e++) {
+                const fossil_jellyfish_exit_t* exit = &cascade->exits[e];
+                const fossil_jellyfish_layer_t* source = network->layers[exit->config.layer];
+                const fossil_jellyfish_layer_t* first = exit->head->layers[1];
+                int32_t width = source->num_neurons;
+
+                fossil_jellyfish_forward(exit->head, source->outputs);
+                memset(head_gradients, 0, (size_t)head_parameters * sizeof(double));
+                jellyfish_accumulate_gradients(exit->head, target, loss, NULL, head_gradients);
+
+                for (int32_t k = 0; k < width; k++) {
+                    error[k] = 0;
+                }
+                for (int32_t j = 0; j < first->num_neurons; j++) {
+                    double delta = exit->config.loss_weight * first->deltas[j];
+                    for (int32_t k = 0; k < width; k++) {
+                        error[k] += first->weights[j * width + k] * delta;
+                    }
+                }
+                errors[exit->config.layer] = error;
+                error += width;
+
+                status |= fossil_jellyfish_apply_gradients(exit->head, head_gradients, learning_rate * exit->config.loss_weight);
+            }
+
+            memset(gradients, 0, (size_t)backbone_parameters * sizeof(double));
+            jellyfish_accumulate_gradients(network, target, loss, errors, gradients);
+            status |= fossil_jellyfish_apply_gradients(network, gradients, learning_rate);
+        }
+    }
+
+    jellyfish_scratch_reset(mark);
+    return status;
+}
+
+double fossil_jellyfish_confidence(const double* outputs, int32_t width, fossil_jellyfish_activation_t activation) {
+    double confidence = activation == ACTIVATION_SOFTMAX ? 0 : 1;
+    for (int32_t c = 0; c < width; c++) {
+        if (activation == ACTIVATION_SOFTMAX) {
+            confidence = outputs[c] > confidence ? outputs[c] : confidence;
+        } else {
+            double decided = outputs[c] > 0.5 ? outputs[c] : 1 - outputs[c];
+            confidence = decided < confidence ? decided : confidence;
+        }
+    }
+    return confidence;
+}
+
+int32_t fossil_jellyfish_cascade_predict(fossil_jellyfish_cascade_t* cascade, const double* input, double* output) {
+    fossil_jellyfish_network_t* network = cascade->network;
+    const fossil_jellyfish_layer_t* output_layer = network->layers[network->num_layers - 1];
+    int32_t width = output_layer->num_neurons;
+    int32_t computed = 1;
+    int64_t heads = 0;
+
+    jellyfish_load_inputs(network, input, network->layers[0]->num_neurons, 1, network->layers[0]->outputs);
+    for (int32_t e = 0; e < cascade->num_exits; e++) {
+        const fossil_jellyfish_exit_t* exit = &cascade->exits[e];
+        const fossil_jellyfish_layer_t* head_output = exit->head->layers[exit->head->num_layers - 1];
+
+        jellyfish_forward_layers(network, computed, exit->config.layer + 1);
+        computed = exit->config.layer + 1;
+        fossil_jellyfish_forward(exit->head, network->layers[exit->config.layer]->outputs);
+        heads += fossil_jellyfish_forward_flops(exit->head);
+
+        if (fossil_jellyfish_confidence(head_output->outputs, width, head_output->activation) >= exit->config.threshold) {
+            memcpy(output, head_output->outputs, (size_t)width * sizeof(double));
+            cascade->exit_counts[e]++;
+            cascade->num_requests++;
+            cascade->total_flops += exit->flops;
+            return e;
+        }
+    }
+
+    jellyfish_forward_layers(network, computed, network->num_layers);
+    memcpy(output, output_layer->outputs, (size_t)width * sizeof(double));
+    cascade->exit_counts[cascade->num_exits]++;
+    cascade->num_requests++;
+    cascade->total_flops += cascade->full_flops + heads;
+    return cascade->num_exits;
+}
+
+double fossil_jellyfish_cascade_exit_fraction(const fossil_jellyfish_cascade_t* cascade, int32_t exit_index) {
+    if (exit_index < 0 || exit_index > cascade->num_exits || cascade->num_requests == 0) {
+        return 0;
+    }
+    return (double)cascade->exit_counts[exit_index] / (double)cascade->num_requests;
+}
+
+double fossil_jellyfish_cascade_flops_saved(const fossil_jellyfish_cascade_t* cascade) {
+    if (cascade->num_requests == 0 || cascade->full_flops == 0) {
+        return 0;
+    }
+    return 1.0 - (double)cascade->total_flops / ((double)cascade->num_requests * (double)cascade->full_flops);
+}
+
+void fossil_jellyfish_cascade_reset_stats(fossil_jellyfish_cascade_t* cascade) {
+    memset(cascade->exit_counts, 0, (size_t)(cascade->num_exits + 1) * sizeof(int64_t));
+    cascade->num_requests = 0;
+    cascade->total_flops = 0;
+}
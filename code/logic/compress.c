@@ -0,0 +1,297 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/compress.h"
+#include "internal.h"
+#include <string.h>
+#include <math.h>
+
+#define JELLYFISH_COMPRESS_MAGIC 0x43474a46u  // "FJGC"
+
+// Message header; the payload layout depends on the method
+typedef struct {
+    uint32_t magic;
+    uint32_t method;
+    int64_t num_parameters;
+    int64_t count;           // Values in the payload
+} jellyfish_message_header_t;
+
+static int64_t jellyfish_num_chunks(int64_t num_parameters) {
+    return (num_parameters + FOSSIL_JELLYFISH_QUANT_CHUNK - 1) / FOSSIL_JELLYFISH_QUANT_CHUNK;
+}
+
+fossil_jellyfish_compressor_t* fossil_jellyfish_compressor_create(fossil_jellyfish_compression_t method, int64_t num_parameters, double density) {
+    if (num_parameters <= 0 || method < COMPRESSION_NONE || method > COMPRESSION_INT8) {
+        return NULL;
+    }
+    // Top-k indices are sent as 32-bit values
+    if (method == COMPRESSION_TOPK && (num_parameters > (int64_t)UINT32_MAX || !(density > 0 && density <= 1))) {
+        return NULL;
+    }
+
+    fossil_jellyfish_compressor_t* compressor = (fossil_jellyfish_compressor_t*)jellyfish_calloc(1, sizeof(fossil_jellyfish_compressor_t));
+    if (!compressor) {
+        return NULL;
+    }
+    compressor->method = method;
+    compressor->num_parameters = num_parameters;
+    compressor->k = num_parameters;
+
+    if (method != COMPRESSION_NONE) {
+        compressor->residual = (double*)jellyfish_calloc((size_t)num_parameters, sizeof(double));
+        if (!compressor->residual) {
+            fossil_jellyfish_compressor_free(compressor);
+            return NULL;
+        }
+    }
+    if (method == COMPRESSION_TOPK) {
+        compressor->k = (int64_t)ceil(density * (double)num_parameters);
+        compressor->magnitudes = (double*)jellyfish_malloc((size_t)num_parameters * sizeof(double));
+        if (!compressor->magnitudes) {
+            fossil_jellyfish_compressor_free(compressor);
+            return NULL;
+        }
+    }
+    return compressor;
+}
+
+void fossil_jellyfish_compressor_free(fossil_jellyfish_compressor_t* compressor) {
+    if (!compressor) {
+        return;
+    }
+    jellyfish_free(compressor->residual);
+    jellyfish_free(compressor->magnitudes);
+    jellyfish_free(compressor);
+}
+
+void fossil_jellyfish_compressor_reset(fossil_jellyfish_compressor_t* compressor) {
+    if (compressor->residual) {
+        memset(compressor->residual, 0, (size_t)compressor->num_parameters * sizeof(double));
+    }
+}
+
+int64_t fossil_jellyfish_compressed_bound(const fossil_jellyfish_compressor_t* compressor) {
+    int64_t n = compressor->num_parameters;
+    int64_t payload;
+
+    switch (compressor->method) {
+        case COMPRESSION_TOPK:
+            payload = compressor->k * (int64_t)(sizeof(uint32_t) + sizeof(float));
+            break;
+        case COMPRESSION_INT8:
+            payload = jellyfish_num_chunks(n) * (int64_t)sizeof(float) + n;
+            break;
+        default:
+            payload = n * (int64_t)sizeof(double);
+            break;
+    }
+    return (int64_t)sizeof(jellyfish_message_header_t) + payload;
+}
+
+// Returns the k-th largest value (k >= 1) of values, reordering them
+static double jellyfish_select_largest(double* values, int64_t count, int64_t k) {
+    int64_t low = 0, high = count - 1, target = k - 1;
+
+    while (low < high) {
+        // Median of three as pivot, partition into descending order
+        int64_t mid = low + (high - low) / 2;
+        double a = values[low], b = values[mid], c = values[high];
+        double pivot = (a > b) ? ((b > c) ? b : (a > c ? c : a)) : ((a > c) ? a : (b > c ? c : b));
+        int64_t i = low, j = high;
+
+        while (i <= j) {
+            while (values[i] > pivot) i++;
+            while (values[j] < pivot) j--;
+            if (i <= j) {
+                double swap = values[i];
+                values[i] = values[j];
+                values[j] = swap;
+                i++;
+                j--;
+            }
+        }
+        if (target <= j) {
+            high = j;
+        } else if (target >= i) {
+            low = i;
+        } else {
+            break;
+        }
+    }
+    return values[target];
+}
+
+static int64_t jellyfish_compress_topk(fossil_jellyfish_compressor_t* compressor, uint8_t* payload) {
+    int64_t n = compressor->num_parameters;
+    int64_t k = compressor->k;
+    double* restrict corrected = compressor->residual;
+    double* restrict magnitudes = compressor->magnitudes;
+    uint8_t* values = payload + (size_t)k * sizeof(uint32_t);
+    int64_t count = 0;
+
+    for (int64_t i = 0; i < n; i++) {
+        magnitudes[i] = fabs(corrected[i]);
+    }
+    double threshold = k < n ? jellyfish_select_largest(magnitudes, n, k) : 0;
+
+    // Everything above the threshold first, then ties until k values are taken
+    for (int32_t pass = 0; pass < 2 && count < k; pass++) {
+        for (int64_t i = 0; i < n && count < k; i++) {
+            double magnitude = fabs(corrected[i]);
+            if (magnitude == 0 || (pass == 0 ? !(magnitude > threshold) : magnitude != threshold)) {
+                continue;
+            }
+            uint32_t index = (uint32_t)i;
+            float sent = (float)corrected[i];
+            memcpy(payload + (size_t)count * sizeof(uint32_t), &index, sizeof(index));
+            memcpy(values + (size_t)count * sizeof(float), &sent, sizeof(sent));
+            corrected[i] -= (double)sent;
+            count++;
+        }
+    }
+
+    // Close the gap left when fewer than k values were non-zero
+    memmove(payload + (size_t)count * sizeof(uint32_t), values, (size_t)count * sizeof(float));
+    return count;
+}
+
+static void jellyfish_compress_int8(fossil_jellyfish_compressor_t* compressor, uint8_t* payload) {
+    int64_t n = compressor->num_parameters;
+    int64_t num_chunks = jellyfish_num_chunks(n);
+    double* restrict corrected = compressor->residual;
+    int8_t* restrict quantized = (int8_t*)(payload + (size_t)num_chunks * sizeof(float));
+
+    for (int64_t c = 0; c < num_chunks; c++) {
+        int64_t begin = c * FOSSIL_JELLYFISH_QUANT_CHUNK;
+        int64_t end = begin + FOSSIL_JELLYFISH_QUANT_CHUNK < n ? begin + FOSSIL_JELLYFISH_QUANT_CHUNK : n;
+        double largest = 0;
+        for (int64_t i = begin; i < end; i++) {
+            largest = fmax(largest, fabs(corrected[i]));
+        }
+
+        float scale = (float)(largest / 127.0);
+        double inverse = scale > 0 ? 1.0 / (double)scale : 0;
+        memcpy(payload + (size_t)c * sizeof(float), &scale, sizeof(float));
+
+        for (int64_t i = begin; i < end; i++) {
+            double level = nearbyint(corrected[i] * inverse);
+            level = level > 127 ? 127 : (level < -127 ? -127 : level);
+            quantized[i] = (int8_t)level;
+            corrected[i] -= level * (double)scale;
+        }
+    }
+}
+
+int64_t fossil_jellyfish_compress(fossil_jellyfish_compressor_t* compressor, const double* gradients, uint8_t* message, int64_t capacity) {
+    if (!compressor || !gradients || !message || capacity < fossil_jellyfish_compressed_bound(compressor)) {
+        return -1;
+    }
+
+    int64_t n = compressor->num_parameters;
+    uint8_t* payload = message + sizeof(jellyfish_message_header_t);
+    jellyfish_message_header_t header = {JELLYFISH_COMPRESS_MAGIC, (uint32_t)compressor->method, n, n};
+    int64_t payload_size;
+
+    if (compressor->method == COMPRESSION_NONE) {
+        memcpy(payload, gradients, (size_t)n * sizeof(double));
+        payload_size = n * (int64_t)sizeof(double);
+    } else {
+        // Error feedback: compress the gradient plus everything not yet sent
+        double* restrict corrected = compressor->residual;
+        for (int64_t i = 0; i < n; i++) {
+            corrected[i] += gradients[i];
+        }
+
+        if (compressor->method == COMPRESSION_TOPK) {
+            header.count = jellyfish_compress_topk(compressor, payload);
+            payload_size = header.count * (int64_t)(sizeof(uint32_t) + sizeof(float));
+        } else {
+            jellyfish_compress_int8(compressor, payload);
+            payload_size = jellyfish_num_chunks(n) * (int64_t)sizeof(float) + n;
+        }
+    }
+
+    memcpy(message, &header, sizeof(header));
+    return (int64_t)sizeof(header) + payload_size;
+}
+
+int32_t fossil_jellyfish_decompress_add(const uint8_t* message, int64_t size, double* gradients, int64_t num_parameters, double scale) {
+    jellyfish_message_header_t header;
+    if (!message || !gradients || size < (int64_t)sizeof(header)) {
+        return -1;
+    }
+    memcpy(&header, message, sizeof(header));
+    if (header.magic != JELLYFISH_COMPRESS_MAGIC || header.num_parameters != num_parameters || header.count < 0 || header.count > num_parameters) {
+        return -1;
+    }
+
+    const uint8_t* payload = message + sizeof(header);
+    int64_t payload_size = size - (int64_t)sizeof(header);
+    int64_t n = num_parameters;
+
+    switch ((fossil_jellyfish_compression_t)header.method) {
+        case COMPRESSION_NONE: {
+            if (header.count != n || payload_size != n * (int64_t)sizeof(double)) {
+                return -1;
+            }
+            for (int64_t i = 0; i < n; i++) {
+                double value;
+                memcpy(&value, payload + (size_t)i * sizeof(double), sizeof(double));
+                gradients[i] += scale * value;
+            }
+            return 0;
+        }
+        case COMPRESSION_TOPK: {
+            if (payload_size != header.count * (int64_t)(sizeof(uint32_t) + sizeof(float))) {
+                return -1;
+            }
+            // Every index is checked before any is applied, so a corrupt message changes nothing
+            for (int64_t j = 0; j < header.count; j++) {
+                uint32_t index;
+                memcpy(&index, payload + (size_t)j * sizeof(uint32_t), sizeof(index));
+                if ((int64_t)index >= n) {
+                    return -1;
+                }
+            }
+            const uint8_t* values = payload + (size_t)header.count * sizeof(uint32_t);
+            for (int64_t j = 0; j < header.count; j++) {
+                uint32_t index;
+                float value;
+                memcpy(&index, payload + (size_t)j * sizeof(uint32_t), sizeof(index));
+                memcpy(&value, values + (size_t)j * sizeof(float), sizeof(value));
+                gradients[index] += scale * (double)value;
+            }
+            return 0;
+        }
+        case COMPRESSION_INT8: {
+            int64_t num_chunks = jellyfish_num_chunks(n);
+            if (header.count != n || payload_size != num_chunks * (int64_t)sizeof(float) + n) {
+                return -1;
+            }
+            const int8_t* quantized = (const int8_t*)(payload + (size_t)num_chunks * sizeof(float));
+            for (int64_t c = 0; c < num_chunks; c++) {
+                int64_t begin = c * FOSSIL_JELLYFISH_QUANT_CHUNK;
+                int64_t end = begin + FOSSIL_JELLYFISH_QUANT_CHUNK < n ? begin + FOSSIL_JELLYFISH_QUANT_CHUNK : n;
+                float chunk_scale;
+                memcpy(&chunk_scale, payload + (size_t)c * sizeof(float), sizeof(float));
+                double step = scale * (double)chunk_scale;
+                for (int64_t i = begin; i < end; i++) {
+                    gradients[i] += step * (double)quantized[i];
+                }
+            }
+            return 0;
+        }
+        default:
+            return -1;
+    }
+}
@@ -0,0 +1,165 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/dataset.h"
+#include "internal.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+int32_t jellyfish_map_file(const char* file_path, void** mapping, size_t* size, void** handle) {
+    *mapping = NULL;
+    *size = 0;
+    *handle = NULL;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(file_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER length;
+    if (file == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+    if (GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+        HANDLE object = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (object) {
+            *mapping = MapViewOfFile(object, FILE_MAP_READ, 0, 0, 0);
+            if (*mapping) {
+                *handle = object;
+                *size = (size_t)length.QuadPart;
+            } else {
+                CloseHandle(object);
+            }
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = open(file_path, O_RDONLY);
+    struct stat info;
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* pointer = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (pointer != MAP_FAILED) {
+            *mapping = pointer;
+            *size = (size_t)info.st_size;
+        }
+    }
+    close(fd);
+#endif
+    return *mapping ? 0 : -1;
+}
+
+void jellyfish_unmap_file(void* mapping, size_t size, void* handle) {
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(mapping);
+    CloseHandle((HANDLE)handle);
+#else
+    (void)handle;
+    munmap(mapping, size);
+#endif
+}
+
+static int32_t jellyfish_dataset_valid(const fossil_jellyfish_dataset_header_t* header) {
+    return header->magic == FOSSIL_JELLYFISH_DATASET_MAGIC && header->version == FOSSIL_JELLYFISH_DATASET_VERSION &&
+           header->num_records >= -1 && header->input_width > 0 && header->target_width >= 0;
+}
+
+int32_t fossil_jellyfish_dataset_write_header(FILE* stream, int64_t num_records, int32_t input_width, int32_t target_width) {
+    fossil_jellyfish_dataset_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = FOSSIL_JELLYFISH_DATASET_MAGIC;
+    header.version = FOSSIL_JELLYFISH_DATASET_VERSION;
+    header.num_records = num_records;
+    header.input_width = input_width;
+    header.target_width = target_width;
+    if (!stream || !jellyfish_dataset_valid(&header)) {
+        return -1;
+    }
+    return fwrite(&header, sizeof(header), 1, stream) == 1 ? 0 : -1;
+}
+
+int32_t fossil_jellyfish_dataset_read_header(FILE* stream, fossil_jellyfish_dataset_header_t* header) {
+    if (!stream || !header || fread(header, sizeof(*header), 1, stream) != 1) {
+        return -1;
+    }
+    return jellyfish_dataset_valid(header) ? 0 : -1;
+}
+
+int32_t fossil_jellyfish_dataset_save(const char* file_path, const double* inputs, const double* targets, int64_t num_records, int32_t input_width, int32_t target_width) {
+    if (!file_path || !inputs || (target_width > 0 && !targets) || num_records < 0) {
+        return -1;
+    }
+    FILE* file = fopen(file_path, "wb");
+    if (!file) {
+        return -1;
+    }
+
+    int32_t status = fossil_jellyfish_dataset_write_header(file, num_records, input_width, target_width);
+    for (int64_t r = 0; r < num_records && status == 0; r++) {
+        if (fwrite(inputs + r * input_width, sizeof(double), (size_t)input_width, file) != (size_t)input_width ||
+            (target_width > 0 && fwrite(targets + r * target_width, sizeof(double), (size_t)target_width, file) != (size_t)target_width)) {
+            status = -1;
+        }
+    }
+    if (fclose(file) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        remove(file_path);
+    }
+    return status;
+}
+
+fossil_jellyfish_dataset_file_t* fossil_jellyfish_dataset_open(const char* file_path) {
+    fossil_jellyfish_dataset_file_t* dataset = (fossil_jellyfish_dataset_file_t*)jellyfish_calloc(1, sizeof(fossil_jellyfish_dataset_file_t));
+    if (!dataset) {
+        return NULL;
+    }
+    fossil_jellyfish_dataset_header_t header;
+    if (!file_path || jellyfish_map_file(file_path, &dataset->mapping, &dataset->mapping_size, &dataset->handle) != 0 ||
+        dataset->mapping_size < sizeof(header)) {
+        fossil_jellyfish_dataset_close(dataset);
+        return NULL;
+    }
+
+    // A mapped file must know its length, and hold every record it claims
+    memcpy(&header, dataset->mapping, sizeof(header));
+    size_t width = (size_t)header.input_width + (size_t)header.target_width;
+    if (!jellyfish_dataset_valid(&header) || header.num_records < 0 ||
+        (dataset->mapping_size - sizeof(header)) / sizeof(double) / width < (size_t)header.num_records) {
+        fossil_jellyfish_dataset_close(dataset);
+        return NULL;
+    }
+    dataset->records = (const double*)((const uint8_t*)dataset->mapping + sizeof(header));
+    dataset->num_records = header.num_records;
+    dataset->input_width = header.input_width;
+    dataset->target_width = header.target_width;
+    return dataset;
+}
+
+void fossil_jellyfish_dataset_close(fossil_jellyfish_dataset_file_t* dataset) {
+    if (!dataset) {
+        return;
+    }
+    if (dataset->mapping) {
+        jellyfish_unmap_file(dataset->mapping, dataset->mapping_size, dataset->handle);
+    }
+    jellyfish_free(dataset);
+}
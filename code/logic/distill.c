@@ -0,0 +1,210 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/distill.h"
+#include "internal.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define JELLYFISH_DISTILL_MAGIC 0x54534a46u  // "FJST"
+#define JELLYFISH_DISTILL_VERSION 1
+#define JELLYFISH_DISTILL_CHUNK 4096
+#define JELLYFISH_DISTILL_EPSILON 1e-12
+
+// Cache file header, padded so the targets that follow stay 64-byte aligned
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int64_t num_samples;
+    int32_t width;
+    int32_t reserved;
+    double temperature;
+    uint64_t inputs_hash;
+    uint8_t padding[24];
+} jellyfish_distill_header_t;
+
+static uint64_t jellyfish_hash_inputs(const double* inputs, int64_t count) {
+    uint64_t hash = (uint64_t)count;
+    for (int64_t i = 0; i < count; i++) {
+        uint64_t bits;
+        memcpy(&bits, &inputs[i], sizeof(bits));
+        hash = jellyfish_mix64(hash ^ bits) + JELLYFISH_GOLDEN_GAMMA;
+    }
+    return hash;
+}
+
+// Raises the entropy of the teacher outputs; T = 1 leaves them unchanged
+static void jellyfish_soften(double* rows, int64_t num_rows, int32_t width, fossil_jellyfish_activation_t activation, double temperature) {
+    double inverse = 1.0 / temperature;
+
+    if (activation == ACTIVATION_SIGMOID) {
+        for (int64_t i = 0; i < num_rows * width; i++) {
+            double p = fmin(fmax(rows[i], JELLYFISH_DISTILL_EPSILON), 1 - JELLYFISH_DISTILL_EPSILON);
+            rows[i] = 1.0 / (1.0 + exp(-log(p / (1 - p)) * inverse));
+        }
+    } else if (activation == ACTIVATION_SOFTMAX) {
+        for (int64_t r = 0; r < num_rows; r++) {
+            double* row = rows + r * width;
+            double largest = -INFINITY, sum = 0;
+            for (int32_t c = 0; c < width; c++) {
+                row[c] = log(fmax(row[c], JELLYFISH_DISTILL_EPSILON)) * inverse;
+                largest = fmax(largest, row[c]);
+            }
+            for (int32_t c = 0; c < width; c++) {
+                row[c] = exp(row[c] - largest);
+                sum += row[c];
+            }
+            for (int32_t c = 0; c < width; c++) {
+                row[c] /= sum;
+            }
+        }
+    }
+}
+
+int32_t fossil_jellyfish_distill_cache(const fossil_jellyfish_network_t* teacher, const double* inputs, int64_t num_samples, double temperature, const char* file_path) {
+    if (!teacher || !inputs || !file_path || num_samples <= 0 || !(temperature > 0)) {
+        return -1;
+    }
+
+    const fossil_jellyfish_layer_t* output_layer = teacher->layers[teacher->num_layers - 1];
+    int32_t input_width = teacher->layers[0]->num_neurons;
+    int32_t width = output_layer->num_neurons;
+    int64_t chunk = num_samples < JELLYFISH_DISTILL_CHUNK ? num_samples : JELLYFISH_DISTILL_CHUNK;
+    jellyfish_scratch_mark_t mark = jellyfish_scratch_mark();
+    double* outputs = (double*)jellyfish_scratch_alloc((size_t)chunk * (size_t)width * sizeof(double));
+    FILE* file = fopen(file_path, "wb");
+    if (!outputs || !file) {
+        jellyfish_scratch_reset(mark);
+        if (file) {
+            fclose(file);
+        }
+        return -1;
+    }
+
+    jellyfish_distill_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = JELLYFISH_DISTILL_MAGIC;
+    header.version = JELLYFISH_DISTILL_VERSION;
+    header.num_samples = num_samples;
+    header.width = width;
+    header.temperature = temperature;
+    header.inputs_hash = jellyfish_hash_inputs(inputs, num_samples * input_width);
+    int32_t status = fwrite(&header, sizeof(header), 1, file) == 1 ? 0 : -1;
+
+    // One pass of the teacher, a chunk at a time
+    for (int64_t begin = 0; begin < num_samples && status == 0; begin += chunk) {
+        int64_t rows = num_samples - begin < chunk ? num_samples - begin : chunk;
+        if (fossil_jellyfish_forward_batch(teacher, inputs + begin * input_width, rows, outputs) != 0) {
+            status = -1;
+            break;
+        }
+        jellyfish_soften(outputs, rows, width, output_layer->activation, temperature);
+        if (fwrite(outputs, sizeof(double) * (size_t)width, (size_t)rows, file) != (size_t)rows) {
+            status = -1;
+        }
+    }
+
+    jellyfish_scratch_reset(mark);
+    if (fclose(file) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        remove(file_path);
+    }
+    return status;
+}
+
+fossil_jellyfish_soft_targets_t* fossil_jellyfish_soft_targets_open(const char* file_path) {
+    fossil_jellyfish_soft_targets_t* soft_targets = (fossil_jellyfish_soft_targets_t*)jellyfish_calloc(1, sizeof(fossil_jellyfish_soft_targets_t));
+    if (!soft_targets) {
+        return NULL;
+    }
+
+    if (!file_path || jellyfish_map_file(file_path, &soft_targets->mapping, &soft_targets->mapping_size, &soft_targets->handle) != 0 ||
+        soft_targets->mapping_size < sizeof(jellyfish_distill_header_t)) {
+        fossil_jellyfish_soft_targets_close(soft_targets);
+        return NULL;
+    }
+
+    jellyfish_distill_header_t header;
+    memcpy(&header, soft_targets->mapping, sizeof(header));
+    if (header.magic != JELLYFISH_DISTILL_MAGIC || header.version != JELLYFISH_DISTILL_VERSION || header.num_samples <= 0 || header.width <= 0 ||
+        (soft_targets->mapping_size - sizeof(header)) / sizeof(double) / (size_t)header.width < (size_t)header.num_samples) {
+        fossil_jellyfish_soft_targets_close(soft_targets);
+        return NULL;
+    }
+    soft_targets->targets = (const double*)((const uint8_t*)soft_targets->mapping + sizeof(header));
+    soft_targets->num_samples = header.num_samples;
+    soft_targets->width = header.width;
+    soft_targets->temperature = header.temperature;
+    soft_targets->inputs_hash = header.inputs_hash;
+    return soft_targets;
+}
+
+void fossil_jellyfish_soft_targets_close(fossil_jellyfish_soft_targets_t* soft_targets) {
+    if (!soft_targets) {
+        return;
+    }
+    if (soft_targets->mapping) {
+        jellyfish_unmap_file(soft_targets->mapping, soft_targets->mapping_size, soft_targets->handle);
+    }
+    jellyfish_free(soft_targets);
+}
+
+int32_t fossil_jellyfish_distill(fossil_jellyfish_network_t* student, const fossil_jellyfish_soft_targets_t* soft_targets, const double* inputs, const double* hard_targets, const fossil_jellyfish_distill_config_t* config) {
+    if (!student || !soft_targets || !inputs || !config || config->batch_size <= 0) {
+        return -1;
+    }
+
+    int32_t input_width = student->layers[0]->num_neurons;
+    int32_t width = soft_targets->width;
+    int64_t num_samples = soft_targets->num_samples;
+    double alpha = hard_targets ? config->alpha : 1.0;
+
+    // The cache is only valid for the inputs it was built from
+    if (student->layers[student->num_layers - 1]->num_neurons != width ||
+        jellyfish_hash_inputs(inputs, num_samples * input_width) != soft_targets->inputs_hash) {
+        return -1;
+    }
+
+    int64_t num_parameters = fossil_jellyfish_num_parameters(student);
+    jellyfish_scratch_mark_t mark = jellyfish_scratch_mark();
+    double* gradients = (double*)jellyfish_scratch_alloc((size_t)num_parameters * sizeof(double));
+    double* target = (double*)jellyfish_scratch_alloc((size_t)width * sizeof(double));
+    if (!gradients || !target) {
+        jellyfish_scratch_reset(mark);
+        return -1;
+    }
+
+    int32_t status = 0;
+    for (int32_t epoch = 0; epoch < config->num_epochs && status == 0; epoch++) {
+        for (int64_t begin = 0; begin < num_samples && status == 0; begin += config->batch_size) {
+            int64_t end = begin + config->batch_size < num_samples ? begin + config->batch_size : num_samples;
+            memset(gradients, 0, (size_t)num_parameters * sizeof(double));
+
+            for (int64_t i = begin; i < end; i++) {
+                const double* soft = soft_targets->targets + i * width;
+                for (int32_t c = 0; c < width; c++) {
+                    target[c] = hard_targets ? alpha * soft[c] + (1 - alpha) * hard_targets[i * width + c] : soft[c];
+                }
+                fossil_jellyfish_forward(student, (double*)&inputs[i * input_width]);
+                fossil_jellyfish_accumulate_gradients(student, target, config->loss, gradients);
+            }
+            status = fossil_jellyfish_apply_gradients(student, gradients, config->learning_rate / (double)(end - begin));
+        }
+    }
+
+    jellyfish_scratch_reset(mark);
+    return status;
+}
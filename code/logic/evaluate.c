@@ -0,0 +1,175 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/evaluate.h"
+#include "fossil/jellyfish/parallel.h"
+#include "internal.h"
+#include <string.h>
+#include <math.h>
+
+#define JELLYFISH_EVALUATE_GRAIN (8 * JELLYFISH_FORWARD_BLOCK)
+
+// Per-thread partial sums, padded so neighbouring threads never share a cache line
+typedef struct {
+    double loss_sum;
+    double abs_sum;
+    double sq_sum;
+    double target_sum;
+    double target_sq_sum;
+    int64_t correct;
+    char padding[16];
+} jellyfish_partial_t;
+
+typedef struct {
+    const fossil_jellyfish_network_t* network;
+    const fossil_jellyfish_dataset_t* dataset;
+    const fossil_jellyfish_metrics_t* metrics;
+    int32_t in;
+    int32_t out;
+    size_t scratch_size;
+    double* scratch;              // Forward scratch plus one output block per thread
+    jellyfish_partial_t* partials;
+    int64_t* confusion;           // One matrix per thread
+} jellyfish_evaluate_t;
+
+static int32_t jellyfish_class_of(const double* row, int32_t width) {
+    if (width == 1) {
+        return row[0] >= 0.5;
+    }
+    int32_t best = 0;
+    for (int32_t i = 1; i < width; i++) {
+        if (row[i] > row[best]) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void jellyfish_evaluate_task(void* context, int64_t begin, int64_t end, int32_t thread_index) {
+    jellyfish_evaluate_t* eval = (jellyfish_evaluate_t*)context;
+    uint32_t flags = eval->metrics->flags;
+    int32_t classes = eval->out == 1 ? 2 : eval->out;
+    double* scratch = eval->scratch + (size_t)thread_index * eval->scratch_size;
+    double* outputs = scratch + jellyfish_forward_scratch_size(eval->network);
+    jellyfish_partial_t* partial = &eval->partials[thread_index];
+    int64_t* confusion = eval->confusion ? eval->confusion + (size_t)thread_index * (size_t)(classes * classes) : NULL;
+
+    for (int64_t row = begin; row < end; row += JELLYFISH_FORWARD_BLOCK) {
+        int64_t rows = end - row < JELLYFISH_FORWARD_BLOCK ? end - row : JELLYFISH_FORWARD_BLOCK;
+        const double* targets = eval->dataset->targets + row * eval->out;
+        int64_t n = rows * eval->out;
+
+        jellyfish_forward_rows(eval->network, eval->dataset->inputs + row * eval->in, eval->in, rows, scratch, outputs);
+
+        if (flags & METRIC_LOSS) {
+            partial->loss_sum += fossil_jellyfish_loss(eval->metrics->loss, outputs, targets, rows, eval->out) * (double)rows;
+        }
+
+        if (flags & (METRIC_ACCURACY | METRIC_CONFUSION)) {
+            for (int64_t r = 0; r < rows; r++) {
+                int32_t predicted = jellyfish_class_of(outputs + r * eval->out, eval->out);
+                int32_t expected = jellyfish_class_of(targets + r * eval->out, eval->out);
+                partial->correct += predicted == expected;
+                if (confusion) {
+                    confusion[expected * classes + predicted]++;
+                }
+            }
+        }
+
+        if (flags & METRIC_REGRESSION) {
+            double abs_sum = 0, sq_sum = 0, target_sum = 0, target_sq_sum = 0;
+            for (int64_t i = 0; i < n; i++) {
+                double d = outputs[i] - targets[i];
+                abs_sum += fabs(d);
+                sq_sum += d * d;
+                target_sum += targets[i];
+                target_sq_sum += targets[i] * targets[i];
+            }
+            partial->abs_sum += abs_sum;
+            partial->sq_sum += sq_sum;
+            partial->target_sum += target_sum;
+            partial->target_sq_sum += target_sq_sum;
+        }
+    }
+}
+
+int32_t fossil_jellyfish_evaluate(const fossil_jellyfish_network_t* network, const fossil_jellyfish_dataset_t* dataset, fossil_jellyfish_metrics_t* metrics) {
+    if (!network || !dataset || !metrics || network->num_layers < 1 || dataset->num_samples < 0) {
+        return -1;
+    }
+
+    jellyfish_evaluate_t eval;
+    int32_t threads = fossil_jellyfish_get_num_threads();
+    eval.network = network;
+    eval.dataset = dataset;
+    eval.metrics = metrics;
+    eval.in = network->layers[0]->num_neurons;
+    eval.out = network->layers[network->num_layers - 1]->num_neurons;
+    eval.scratch_size = jellyfish_forward_scratch_size(network) + (size_t)JELLYFISH_FORWARD_BLOCK * (size_t)eval.out;
+
+    int32_t classes = eval.out == 1 ? 2 : eval.out;
+    int32_t want_confusion = (metrics->flags & METRIC_CONFUSION) && metrics->confusion;
+
+    jellyfish_scratch_mark_t mark = jellyfish_scratch_mark();
+    size_t confusion_size = (size_t)threads * (size_t)(classes * classes) * sizeof(int64_t);
+    eval.scratch = (double*)jellyfish_scratch_alloc((size_t)threads * eval.scratch_size * sizeof(double));
+    eval.partials = (jellyfish_partial_t*)jellyfish_scratch_alloc((size_t)threads * sizeof(jellyfish_partial_t));
+    eval.confusion = want_confusion ? (int64_t*)jellyfish_scratch_alloc(confusion_size) : NULL;
+    if (!eval.scratch || !eval.partials || (want_confusion && !eval.confusion)) {
+        jellyfish_scratch_reset(mark);
+        return -1;
+    }
+    memset(eval.partials, 0, (size_t)threads * sizeof(jellyfish_partial_t));
+    if (want_confusion) {
+        memset(eval.confusion, 0, confusion_size);
+    }
+
+    fossil_jellyfish_parallel_for_bounded(dataset->num_samples, JELLYFISH_EVALUATE_GRAIN, threads, jellyfish_evaluate_task, &eval);
+
+    // Merge the per-thread partial results
+    jellyfish_partial_t total;
+    memset(&total, 0, sizeof(total));
+    for (int32_t t = 0; t < threads; t++) {
+        total.loss_sum += eval.partials[t].loss_sum;
+        total.abs_sum += eval.partials[t].abs_sum;
+        total.sq_sum += eval.partials[t].sq_sum;
+        total.target_sum += eval.partials[t].target_sum;
+        total.target_sq_sum += eval.partials[t].target_sq_sum;
+        total.correct += eval.partials[t].correct;
+    }
+    if (want_confusion) {
+        size_t cells = (size_t)(classes * classes);
+        memset(metrics->confusion, 0, cells * sizeof(int64_t));
+        for (int32_t t = 0; t < threads; t++) {
+            for (size_t c = 0; c < cells; c++) {
+                metrics->confusion[c] += eval.confusion[(size_t)t * cells + c];
+            }
+        }
+    }
+
+    double samples = dataset->num_samples > 0 ? (double)dataset->num_samples : 1.0;
+    double values = samples * (double)eval.out;
+    double total_variance = total.target_sq_sum - total.target_sum * total.target_sum / values;
+
+    metrics->num_samples = dataset->num_samples;
+    metrics->num_classes = classes;
+    metrics->loss_value = total.loss_sum / samples;
+    metrics->correct = total.correct;
+    metrics->accuracy = (double)total.correct / samples;
+    metrics->mse = total.sq_sum / values;
+    metrics->mae = total.abs_sum / values;
+    metrics->r2 = total_variance > 0 ? 1.0 - total.sq_sum / total_variance : 0.0;
+
+    jellyfish_scratch_reset(mark);
+    return 0;
+}
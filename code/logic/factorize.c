@@ -0,0 +1,280 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/factorize.h"
+#include "internal.h"
+#include <string.h>
+#include <math.h>
+
+#define JELLYFISH_SVD_MAX_SWEEPS 60
+#define JELLYFISH_SVD_TOLERANCE 1e-15
+
+// Thin SVD of a rows x cols matrix (cols <= rows) stored column by column
+typedef struct {
+    int64_t rows;
+    int64_t cols;
+    double* columns;    // In: the matrix; out: U S, columns sorted by singular value
+    double* right;      // cols x cols, column j is right singular vector j
+    double* values;     // cols singular values, descending
+} jellyfish_svd_t;
+
+static double jellyfish_dot(const double* restrict a, const double* restrict b, int64_t n) {
+    double sum = 0;
+    for (int64_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static void jellyfish_rotate(double* restrict a, double* restrict b, int64_t n, double c, double s) {
+    for (int64_t i = 0; i < n; i++) {
+        double x = a[i], y = b[i];
+        a[i] = c * x - s * y;
+        b[i] = s * x + c * y;
+    }
+}
+
+static void jellyfish_swap_columns(double* a, double* b, int64_t n) {
+    for (int64_t i = 0; i < n; i++) {
+        double swap = a[i];
+        a[i] = b[i];
+        b[i] = swap;
+    }
+}
+
+// One-sided Jacobi: rotate column pairs until they are mutually orthogonal
+static void jellyfish_svd(jellyfish_svd_t* svd) {
+    int64_t m = svd->rows, n = svd->cols;
+
+    memset(svd->right, 0, (size_t)(n * n) * sizeof(double));
+    for (int64_t j = 0; j < n; j++) {
+        svd->right[j * n + j] = 1;
+    }
+
+    for (int32_t sweep = 0; sweep < JELLYFISH_SVD_MAX_SWEEPS; sweep++) {
+        int32_t rotated = 0;
+        for (int64_t j = 0; j < n - 1; j++) {
+            for (int64_t k = j + 1; k < n; k++) {
+                double* x = svd->columns + j * m;
+                double* y = svd->columns + k * m;
+                double alpha = jellyfish_dot(x, x, m);
+                double beta = jellyfish_dot(y, y, m);
+                double gamma = jellyfish_dot(x, y, m);
+                if (fabs(gamma) <= JELLYFISH_SVD_TOLERANCE * sqrt(alpha * beta) || gamma == 0) {
+                    continue;
+                }
+                double zeta = (beta - alpha) / (2 * gamma);
+                double t = (zeta >= 0 ? 1.0 : -1.0) / (fabs(zeta) + sqrt(1 + zeta * zeta));
+                double c = 1 / sqrt(1 + t * t);
+                jellyfish_rotate(x, y, m, c, c * t);
+                jellyfish_rotate(svd->right + j * n, svd->right + k * n, n, c, c * t);
+                rotated = 1;
+            }
+        }
+        if (!rotated) {
+            break;
+        }
+    }
+
+    // Column norms are the singular values; selection sort keeps U, S and V aligned
+    for (int64_t j = 0; j < n; j++) {
+        svd->values[j] = sqrt(jellyfish_dot(svd->columns + j * m, svd->columns + j * m, m));
+    }
+    for (int64_t j = 0; j < n; j++) {
+        int64_t best = j;
+        for (int64_t k = j + 1; k < n; k++) {
+            best = svd->values[k] > svd->values[best] ? k : best;
+        }
+        if (best != j) {
+            double swap = svd->values[j];
+            svd->values[j] = svd->values[best];
+            svd->values[best] = swap;
+            jellyfish_swap_columns(svd->columns + j * m, svd->columns + best * m, m);
+            jellyfish_swap_columns(svd->right + j * n, svd->right + best * n, n);
+        }
+    }
+}
+
+int64_t fossil_jellyfish_forward_flops(const fossil_jellyfish_network_t* network) {
+    int64_t flops = 0;
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        flops += (int64_t)network->layers[i]->num_neurons * network->layers[i - 1]->num_neurons;
+    }
+    return flops;
+}
+
+static int32_t jellyfish_choose_rank(const double* values, int64_t count, const fossil_jellyfish_factorize_config_t* config, double* energy_kept) {
+    double total = 0, kept = 0;
+    int64_t rank = 0;
+
+    for (int64_t j = 0; j < count; j++) {
+        total += values[j] * values[j];
+    }
+    if (config->rank > 0) {
+        rank = config->rank < count ? config->rank : count;
+        for (int64_t j = 0; j < rank; j++) {
+            kept += values[j] * values[j];
+        }
+    } else {
+        while (rank < count && (rank == 0 || kept < config->energy * total)) {
+            kept += values[rank] * values[rank];
+            rank++;
+        }
+    }
+    *energy_kept = total > 0 ? kept / total : 1;
+    return (int32_t)rank;
+}
+
+static void jellyfish_validate(fossil_jellyfish_network_t* network, const fossil_jellyfish_factorize_config_t* config, double* loss, double* accuracy) {
+    fossil_jellyfish_metrics_t metrics = {0};
+    metrics.flags = METRIC_LOSS | METRIC_ACCURACY;
+    metrics.loss = config->loss;
+    if (config->validation && fossil_jellyfish_evaluate(network, config->validation, &metrics) == 0) {
+        *loss = metrics.loss_value;
+        *accuracy = metrics.accuracy;
+    }
+}
+
+// Inserts a linear layer of rank neurons before layer index, taking ownership of its weights
+static int32_t jellyfish_insert_layer(fossil_jellyfish_network_t* network, int32_t index, int32_t rank, double* weights) {
+    const fossil_jellyfish_allocator_t* allocator = &network->allocator;
+    size_t old_size = (size_t)network->num_layers * sizeof(fossil_jellyfish_layer_t*);
+    fossil_jellyfish_layer_t* layer = (fossil_jellyfish_layer_t*)jellyfish_calloc_with(allocator, 1, sizeof(fossil_jellyfish_layer_t));
+    fossil_jellyfish_layer_t** layers = (fossil_jellyfish_layer_t**)jellyfish_realloc_with(allocator, network->layers, old_size, old_size + sizeof(fossil_jellyfish_layer_t*));
+    if (layers) {
+        network->layers = layers;
+    }
+    if (!layer || !layers) {
+        jellyfish_free_with(allocator, layer);
+        return -1;
+    }
+
+    layer->num_neurons = rank;
+    layer->activation = ACTIVATION_LINEAR;
+    layer->biases = (double*)jellyfish_calloc_with(allocator, (size_t)rank, sizeof(double));
+    layer->outputs = (double*)jellyfish_calloc_with(allocator, (size_t)rank, sizeof(double));
+    layer->deltas = (double*)jellyfish_calloc_with(allocator, (size_t)rank, sizeof(double));
+    if (!layer->biases || !layer->outputs || !layer->deltas) {
+        jellyfish_free_with(allocator, layer->biases);
+        jellyfish_free_with(allocator, layer->outputs);
+        jellyfish_free_with(allocator, layer->deltas);
+        jellyfish_free_with(allocator, layer);
+        return -1;
+    }
+    layer->weights = weights;
+
+    memmove(&network->layers[index + 1], &network->layers[index], (size_t)(network->num_layers - index) * sizeof(fossil_jellyfish_layer_t*));
+    network->layers[index] = layer;
+    network->num_layers++;
+    return 0;
+}
+
+int32_t fossil_jellyfish_factorize_layer(fossil_jellyfish_network_t* network, const fossil_jellyfish_factorize_config_t* config, fossil_jellyfish_factorize_report_t* report) {
+    fossil_jellyfish_factorize_report_t local;
+    if (!report) {
+        report = &local;
+    }
+    memset(report, 0, sizeof(*report));
+    if (!network || !config || config->layer < 1 || config->layer >= network->num_layers || (config->rank <= 0 && !(config->energy > 0))) {
+        return -1;
+    }
+
+    fossil_jellyfish_layer_t* layer = network->layers[config->layer];
+    if (layer->kind != LAYER_DENSE) {
+        return -1;
+    }
+    int64_t fan_out = layer->num_neurons;
+    int64_t fan_in = network->layers[config->layer - 1]->num_neurons;
+    int32_t transposed = fan_out < fan_in;
+    int64_t rows = transposed ? fan_in : fan_out;
+    int64_t cols = transposed ? fan_out : fan_in;
+
+    report->flops_before = fossil_jellyfish_forward_flops(network);
+    jellyfish_validate(network, config, &report->loss_before, &report->accuracy_before);
+
+    // Column-major W is row-major W^T and vice versa, so the factored matrix is copied as is
+    jellyfish_scratch_mark_t mark = jellyfish_scratch_mark();
+    jellyfish_svd_t svd = {rows, cols, NULL, NULL, NULL};
+    svd.columns = (double*)jellyfish_scratch_alloc((size_t)(rows * cols) * sizeof(double));
+    svd.right = (double*)jellyfish_scratch_alloc((size_t)(cols * cols) * sizeof(double));
+    svd.values = (double*)jellyfish_scratch_alloc((size_t)cols * sizeof(double));
+    if (!svd.columns || !svd.right || !svd.values) {
+        jellyfish_scratch_reset(mark);
+        return -1;
+    }
+    if (transposed) {
+        memcpy(svd.columns, layer->weights, (size_t)(rows * cols) * sizeof(double));
+    } else {
+        for (int64_t j = 0; j < fan_out; j++) {
+            for (int64_t k = 0; k < fan_in; k++) {
+                svd.columns[k * fan_out + j] = layer->weights[j * fan_in + k];
+            }
+        }
+    }
+    jellyfish_svd(&svd);
+
+    int32_t rank = jellyfish_choose_rank(svd.values, cols, config, &report->energy_kept);
+    report->rank = rank;
+    report->flops_after = report->flops_before - fan_out * fan_in + (int64_t)rank * (fan_in + fan_out);
+    if (report->flops_after >= report->flops_before) {
+        report->flops_after = report->flops_before;
+        report->loss_factored = report->loss_tuned = report->loss_before;
+        report->accuracy_factored = report->accuracy_tuned = report->accuracy_before;
+        jellyfish_scratch_reset(mark);
+        return 1;
+    }
+
+    // W = U S V^T with U = columns / S. Untransposed: first = sqrt(S) V^T, second = U sqrt(S).
+    // Transposed, W^T = U S V^T, so the roles of U and V swap.
+    double* first = jellyfish_alloc_array(&network->allocator, (size_t)rank * (size_t)fan_in);
+    double* second = jellyfish_alloc_array(&network->allocator, (size_t)fan_out * (size_t)rank);
+    if (!first || !second) {
+        jellyfish_free_with(&network->allocator, first);
+        jellyfish_free_with(&network->allocator, second);
+        jellyfish_scratch_reset(mark);
+        return -1;
+    }
+    for (int64_t r = 0; r < rank; r++) {
+        double sigma = svd.values[r];
+        double left_scale = sigma > 0 ? 1.0 / sqrt(sigma) : 0;   // U sqrt(S) = columns / sqrt(S)
+        double right_scale = sqrt(sigma);                        // sqrt(S) V^T
+        const double* u = svd.columns + r * rows;
+        const double* v = svd.right + r * cols;
+        for (int64_t k = 0; k < fan_in; k++) {
+            first[r * fan_in + k] = transposed ? u[k] * left_scale : v[k] * right_scale;
+        }
+        for (int64_t j = 0; j < fan_out; j++) {
+            second[j * rank + r] = transposed ? v[j] * right_scale : u[j] * left_scale;
+        }
+    }
+    jellyfish_scratch_reset(mark);
+
+    if (jellyfish_layer_make_writable(network, config->layer, 1) != 0 || jellyfish_insert_layer(network, config->layer, rank, first) != 0) {
+        jellyfish_free_with(&network->allocator, first);
+        jellyfish_free_with(&network->allocator, second);
+        return -1;
+    }
+    jellyfish_free_with(&network->allocator, layer->weights);
+    layer->weights = second;
+
+    jellyfish_validate(network, config, &report->loss_factored, &report->accuracy_factored);
+    report->loss_tuned = report->loss_factored;
+    report->accuracy_tuned = report->accuracy_factored;
+
+    if (config->fine_tune && config->fine_tune_epochs > 0) {
+        fossil_jellyfish_train_with_loss(network, (double*)config->fine_tune->inputs, (double*)config->fine_tune->targets,
+                                         (int32_t)config->fine_tune->num_samples, config->fine_tune_epochs, config->learning_rate, config->loss);
+        jellyfish_validate(network, config, &report->loss_tuned, &report->accuracy_tuned);
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_CACHE_H
+#define FOSSIL_JELLYFISH_AI_CACHE_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Entries per set; an input can only live in the set its hash selects
+#define FOSSIL_JELLYFISH_CACHE_WAYS 8
+
+// Sets are padded to whole lines and start on a line boundary, so no two locks share one
+#define FOSSIL_JELLYFISH_CACHE_LINE 64
+
+// One set of the cache, guarded by its own spin lock
+typedef struct {
+    int32_t lock;
+    int32_t hand;                                      // CLOCK hand: next way considered for eviction
+    uint32_t used;                                     // Bit per way: holds an entry
+    uint32_t referenced;                               // Bit per way: hit since the hand last passed
+    uint64_t hashes[FOSSIL_JELLYFISH_CACHE_WAYS];
+    uint64_t versions[FOSSIL_JELLYFISH_CACHE_WAYS];    // Model version the output was computed with
+    int64_t hits;
+    int64_t misses;
+    int64_t insertions;
+    int64_t evictions;
+    int64_t reserved[2];                               // Pads the set to three cache lines
+} fossil_jellyfish_cache_set_t;
+
+// Set-associative CLOCK cache of forward results, keyed by the input bytes and a model version
+typedef struct {
+    int32_t input_width;
+    int32_t output_width;
+    int64_t num_sets;
+    fossil_jellyfish_cache_set_t* sets;    // Inside set_block, aligned to FOSSIL_JELLYFISH_CACHE_LINE
+    void* set_block;
+    double* values;                    // Per entry: the input row, then the output row
+} fossil_jellyfish_cache_t;
+
+// Cache counters, summed over the sets
+typedef struct {
+    int64_t hits;
+    int64_t misses;
+    int64_t insertions;
+    int64_t evictions;
+    int64_t entries;        // Occupied entries, current or stale
+    int64_t capacity;
+    size_t memory_bytes;    // Everything the cache allocated
+    double hit_rate;        // hits / (hits + misses), 0 before any lookup
+} fossil_jellyfish_cache_stats_t;
+
+// Function declarations
+
+/**
+ * @brief Creates a result cache for inputs and outputs of the given widths.
+ *
+ * @param capacity The number of entries, rounded up to a whole number of sets.
+ * @param input_width The number of input values.
+ * @param output_width The number of output values.
+ * @return A pointer to the cache, or NULL on error.
+ */
+fossil_jellyfish_cache_t* fossil_jellyfish_cache_create(int64_t capacity, int32_t input_width, int32_t output_width);
+
+/**
+ * @brief Frees the cache.
+ *
+ * @param cache A pointer to the cache.
+ */
+void fossil_jellyfish_cache_free(fossil_jellyfish_cache_t* cache);
+
+/**
+ * @brief Looks an input up; safe to call from any number of threads.
+ *
+ * Entries computed with another model version never match, so bumping the
+ * version invalidates the whole cache without touching it.
+ *
+ * @param cache A pointer to the cache.
+ * @param input The input vector, compared bit for bit.
+ * @param version The model version the caller is serving.
+ * @param output Receives the cached output on a hit.
+ * @return 1 on a hit, 0 on a miss.
+ */
+int32_t fossil_jellyfish_cache_lookup(fossil_jellyfish_cache_t* cache, const double* input, uint64_t version, double* output);
+
+/**
+ * @brief Stores the output of an input, evicting with CLOCK when its set is full.
+ *
+ * New entries start unreferenced, so inputs seen once leave before inputs that hit.
+ *
+ * @param cache A pointer to the cache.
+ * @param input The input vector.
+ * @param version The model version the output was computed with.
+ * @param output The output vector.
+ */
+void fossil_jellyfish_cache_insert(fossil_jellyfish_cache_t* cache, const double* input, uint64_t version, const double* output);
+
+/**
+ * @brief Serves a forward pass from the cache, computing and storing it on a miss.
+ *
+ * The miss path is thread-safe like fossil_jellyfish_forward_batch, so many threads may
+ * share the cache and the network.
+ *
+ * @param cache A pointer to the cache.
+ * @param network A pointer to the neural network whose outputs are cached under version.
+ * @param version The model version.
+ * @param input The input vector.
+ * @param output Receives the output vector.
+ * @param scratch At least fossil_jellyfish_cache_scratch_size(network) doubles, used on a miss.
+ * @return 1 on a hit, 0 on a miss.
+ */
+int32_t fossil_jellyfish_cached_forward(fossil_jellyfish_cache_t* cache, const fossil_jellyfish_network_t* network, uint64_t version, const double* input, double* output, double* scratch);
+
+/**
+ * @brief Returns the scratch doubles fossil_jellyfish_cached_forward needs.
+ *
+ * @param network A pointer to the neural network.
+ * @return The number of doubles.
+ */
+size_t fossil_jellyfish_cache_scratch_size(const fossil_jellyfish_network_t* network);
+
+/**
+ * @brief Drops every entry and clears the counters.
+ *
+ * @param cache A pointer to the cache.
+ */
+void fossil_jellyfish_cache_clear(fossil_jellyfish_cache_t* cache);
+
+/**
+ * @brief Collects the hit, miss and memory counters.
+ *
+ * @param cache A pointer to the cache.
+ * @param stats Receives the counters.
+ */
+void fossil_jellyfish_cache_stats(fossil_jellyfish_cache_t* cache, fossil_jellyfish_cache_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_CACHE_H */
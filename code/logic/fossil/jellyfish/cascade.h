@@ -0,0 +1,157 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_CASCADE_H
+#define FOSSIL_JELLYFISH_AI_CASCADE_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Auxiliary exit head settings
+typedef struct {
+    int32_t layer;        // Backbone layer the head reads, from 1 to num_layers - 2
+    int32_t hidden;       // Neurons of the head's ReLU hidden layer; 0 for a single output layer
+    double threshold;     // Confidence at or above which inference stops at this exit
+    double loss_weight;   // Weight of the head's loss in joint training
+} fossil_jellyfish_exit_config_t;
+
+// Exit head attached to an intermediate backbone layer
+typedef struct {
+    fossil_jellyfish_exit_config_t config;
+    fossil_jellyfish_network_t* head;   // Backbone layer width in, backbone output width out
+    int64_t flops;                      // Multiply-adds of an inference that stops here, heads included
+} fossil_jellyfish_exit_t;
+
+// Backbone network with early exits, ordered by depth
+typedef struct {
+    fossil_jellyfish_network_t* network;
+    fossil_jellyfish_exit_t* exits;
+    int32_t num_exits;
+    int64_t full_flops;       // Multiply-adds of the backbone alone
+
+    // Inference statistics; index num_exits counts requests that ran the whole backbone
+    int64_t* exit_counts;
+    int64_t num_requests;
+    int64_t total_flops;
+} fossil_jellyfish_cascade_t;
+
+// Function declarations
+
+/**
+ * @brief Creates a cascade around a backbone network, without exits.
+ *
+ * The output layer must be sigmoid or softmax so that outputs carry a confidence.
+ * The cascade borrows the network, which must outlive it.
+ *
+ * @param network A pointer to the backbone network.
+ * @return A pointer to the cascade, or NULL on error.
+ */
+fossil_jellyfish_cascade_t* fossil_jellyfish_cascade_create(fossil_jellyfish_network_t* network);
+
+/**
+ * @brief Frees the cascade and its exit heads, but not the backbone.
+ *
+ * @param cascade A pointer to the cascade.
+ */
+void fossil_jellyfish_cascade_free(fossil_jellyfish_cascade_t* cascade);
+
+/**
+ * @brief Attaches a freshly initialized exit head to a backbone layer.
+ *
+ * The head ends with the backbone's output activation, so its outputs read like
+ * the network's. Each layer takes at most one exit. Statistics are reset.
+ *
+ * @param cascade A pointer to the cascade.
+ * @param config The exit settings.
+ * @return The exit's index in depth order, or -1 on error.
+ */
+int32_t fossil_jellyfish_cascade_add_exit(fossil_jellyfish_cascade_t* cascade, const fossil_jellyfish_exit_config_t* config);
+
+/**
+ * @brief Trains the backbone and every exit head jointly with per-sample gradient descent.
+ *
+ * The objective is the backbone loss plus each head's loss times its loss_weight;
+ * head errors flow back into the backbone layers below their exits.
+ *
+ * @param cascade A pointer to the cascade.
+ * @param inputs Row-major input samples.
+ * @param targets Row-major expected outputs.
+ * @param num_samples The number of samples.
+ * @param num_epochs The number of passes over the samples.
+ * @param learning_rate The step size.
+ * @param loss The loss of the backbone and the heads.
+ * @return 0 on success, -1 on error.
+ */
+int32_t fossil_jellyfish_cascade_train(fossil_jellyfish_cascade_t* cascade, const double* inputs, const double* targets, int64_t num_samples, int32_t num_epochs, double learning_rate, fossil_jellyfish_loss_t loss);
+
+/**
+ * @brief Returns the confidence of an output vector.
+ *
+ * Softmax outputs score their largest probability; sigmoid outputs score the least
+ * decided output, min over c of max(p_c, 1 - p_c).
+ *
+ * @param outputs The output vector.
+ * @param width The number of outputs.
+ * @param activation The output activation.
+ * @return The confidence, between 0 and 1.
+ */
+double fossil_jellyfish_confidence(const double* outputs, int32_t width, fossil_jellyfish_activation_t activation);
+
+/**
+ * @brief Runs the backbone layer by layer, stopping at the first exit confident enough.
+ *
+ * Like fossil_jellyfish_forward this writes the layer output buffers, so one thread
+ * at a time. Every call is counted in the statistics.
+ *
+ * @param cascade A pointer to the cascade.
+ * @param input The input vector.
+ * @param output Receives the output of the exit taken.
+ * @return The exit index taken, num_exits for the full network.
+ */
+int32_t fossil_jellyfish_cascade_predict(fossil_jellyfish_cascade_t* cascade, const double* input, double* output);
+
+/**
+ * @brief Returns the fraction of counted requests that stopped at an exit.
+ *
+ * @param cascade A pointer to the cascade.
+ * @param exit_index The exit, or num_exits for requests that ran the whole backbone.
+ * @return The fraction, 0 before any request.
+ */
+double fossil_jellyfish_cascade_exit_fraction(const fossil_jellyfish_cascade_t* cascade, int32_t exit_index);
+
+/**
+ * @brief Returns the average fraction of the backbone's FLOPs saved per counted request.
+ *
+ * The cost of a request includes the heads it evaluated, so the figure goes
+ * negative when heads rarely fire.
+ *
+ * @param cascade A pointer to the cascade.
+ * @return 1 - average multiply-adds / backbone multiply-adds, 0 before any request.
+ */
+double fossil_jellyfish_cascade_flops_saved(const fossil_jellyfish_cascade_t* cascade);
+
+/**
+ * @brief Clears the inference statistics.
+ *
+ * @param cascade A pointer to the cascade.
+ */
+void fossil_jellyfish_cascade_reset_stats(fossil_jellyfish_cascade_t* cascade);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_CASCADE_H */
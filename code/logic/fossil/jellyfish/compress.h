@@ -0,0 +1,108 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_COMPRESS_H
+#define FOSSIL_JELLYFISH_AI_COMPRESS_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Values sharing one scale in 8-bit quantized messages
+#define FOSSIL_JELLYFISH_QUANT_CHUNK 256
+
+// Gradient encodings for data-parallel exchange
+typedef enum {
+    COMPRESSION_NONE,   // Dense doubles
+    COMPRESSION_TOPK,   // Largest magnitudes as float index/value pairs
+    COMPRESSION_INT8    // Signed bytes with one float scale per chunk
+} fossil_jellyfish_compression_t;
+
+// Per-worker compression state, sized for one flat gradient vector
+typedef struct {
+    fossil_jellyfish_compression_t method;
+    int64_t num_parameters;
+    int64_t k;                 // Top-k: values sent per message
+    double* residual;          // Error feedback: what earlier messages failed to send
+    double* magnitudes;        // Top-k: selection scratch
+} fossil_jellyfish_compressor_t;
+
+// Function declarations
+
+/**
+ * @brief Creates a compressor for gradients of num_parameters values.
+ *
+ * Both lossy methods keep the part of each gradient a message could not carry and add
+ * it to the next gradient, so no update is lost, only delayed.
+ *
+ * @param method The encoding.
+ * @param num_parameters The flat gradient length, see fossil_jellyfish_num_parameters.
+ * @param density Top-k: fraction of the values sent per message, in (0, 1].
+ * @return A pointer to the compressor, or NULL on error.
+ */
+fossil_jellyfish_compressor_t* fossil_jellyfish_compressor_create(fossil_jellyfish_compression_t method, int64_t num_parameters, double density);
+
+/**
+ * @brief Frees the compressor.
+ *
+ * @param compressor A pointer to the compressor.
+ */
+void fossil_jellyfish_compressor_free(fossil_jellyfish_compressor_t* compressor);
+
+/**
+ * @brief Clears the error feedback, e.g. after the model was reloaded.
+ *
+ * @param compressor A pointer to the compressor.
+ */
+void fossil_jellyfish_compressor_reset(fossil_jellyfish_compressor_t* compressor);
+
+/**
+ * @brief Returns the largest message fossil_jellyfish_compress can produce.
+ *
+ * @param compressor A pointer to the compressor.
+ * @return The size in bytes.
+ */
+int64_t fossil_jellyfish_compressed_bound(const fossil_jellyfish_compressor_t* compressor);
+
+/**
+ * @brief Encodes a gradient vector into a self-describing message in host byte order.
+ *
+ * @param compressor A pointer to the compressor.
+ * @param gradients The flat gradient vector.
+ * @param message Receives the message.
+ * @param capacity The size of message in bytes, at least fossil_jellyfish_compressed_bound.
+ * @return The message size in bytes, or -1 on error.
+ */
+int64_t fossil_jellyfish_compress(fossil_jellyfish_compressor_t* compressor, const double* gradients, uint8_t* message, int64_t capacity);
+
+/**
+ * @brief Decodes a message and adds scale times its values to a gradient vector.
+ *
+ * Decoding the messages of every worker into one zeroed vector performs the reduction.
+ *
+ * @param message The message.
+ * @param size The message size in bytes.
+ * @param gradients The flat gradient vector to add to.
+ * @param num_parameters The length of gradients; must match the message.
+ * @param scale Factor applied to the decoded values, e.g. 1 / number of workers.
+ * @return 0 on success, -1 if the message is malformed.
+ */
+int32_t fossil_jellyfish_decompress_add(const uint8_t* message, int64_t size, double* gradients, int64_t num_parameters, double scale);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_COMPRESS_H */
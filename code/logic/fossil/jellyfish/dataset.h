@@ -0,0 +1,104 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_DATASET_H
+#define FOSSIL_JELLYFISH_AI_DATASET_H
+
+#include "jellyfish.h"
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FOSSIL_JELLYFISH_DATASET_MAGIC 0x53444a46u  // "FJDS"
+#define FOSSIL_JELLYFISH_DATASET_VERSION 1
+
+// Dataset file header, padded so the records that follow stay 64-byte aligned. Each
+// record holds input_width inputs followed by target_width targets, as native doubles.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int64_t num_records;     // -1 in a stream whose length is not known up front
+    int32_t input_width;
+    int32_t target_width;
+    uint8_t padding[40];
+} fossil_jellyfish_dataset_header_t;
+
+// Dataset file mapped read-only into memory
+typedef struct {
+    const double* records;   // num_records records of input_width + target_width values
+    int64_t num_records;
+    int32_t input_width;
+    int32_t target_width;
+    void* mapping;           // Start of the mapped file
+    size_t mapping_size;
+    void* handle;            // Windows file mapping object, unused elsewhere
+} fossil_jellyfish_dataset_file_t;
+
+// Function declarations
+
+/**
+ * @brief Writes a dataset header to a stream.
+ *
+ * @param stream The stream, opened in binary mode.
+ * @param num_records The number of records that follow, or -1 if not known.
+ * @param input_width The number of inputs per record.
+ * @param target_width The number of targets per record, possibly 0.
+ * @return 0 on success, -1 on error.
+ */
+int32_t fossil_jellyfish_dataset_write_header(FILE* stream, int64_t num_records, int32_t input_width, int32_t target_width);
+
+/**
+ * @brief Reads and validates a dataset header from a stream; the records follow it.
+ *
+ * @param stream The stream, opened in binary mode.
+ * @param header Receives the header.
+ * @return 0 on success, -1 on a short read or an invalid header.
+ */
+int32_t fossil_jellyfish_dataset_read_header(FILE* stream, fossil_jellyfish_dataset_header_t* header);
+
+/**
+ * @brief Writes a dataset file from separate input and target arrays.
+ *
+ * @param file_path The file to write.
+ * @param inputs num_records rows of input_width values.
+ * @param targets num_records rows of target_width values; may be NULL when target_width is 0.
+ * @param num_records The number of records.
+ * @param input_width The number of inputs per record.
+ * @param target_width The number of targets per record.
+ * @return 0 on success, -1 on error.
+ */
+int32_t fossil_jellyfish_dataset_save(const char* file_path, const double* inputs, const double* targets, int64_t num_records, int32_t input_width, int32_t target_width);
+
+/**
+ * @brief Maps a dataset file; its records can be read in place, for example by
+ * fossil_jellyfish_forward_strided with a stride of input_width + target_width.
+ *
+ * @param file_path The dataset file.
+ * @return A pointer to the mapped dataset, or NULL if the file is missing, invalid or truncated.
+ */
+fossil_jellyfish_dataset_file_t* fossil_jellyfish_dataset_open(const char* file_path);
+
+/**
+ * @brief Unmaps the dataset.
+ *
+ * @param dataset A pointer to the mapped dataset; NULL is ignored.
+ */
+void fossil_jellyfish_dataset_close(fossil_jellyfish_dataset_file_t* dataset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_DATASET_H */
@@ -0,0 +1,97 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_DISTILL_H
+#define FOSSIL_JELLYFISH_AI_DISTILL_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Teacher outputs cached in a file and mapped read-only into memory
+typedef struct {
+    const double* targets;   // num_samples rows of width soft targets
+    int64_t num_samples;
+    int32_t width;
+    double temperature;
+    uint64_t inputs_hash;    // Fingerprint of the inputs the cache was built from
+    void* mapping;           // Start of the mapped file
+    size_t mapping_size;
+    void* handle;            // Windows file mapping object, unused elsewhere
+} fossil_jellyfish_soft_targets_t;
+
+// Distillation training settings
+typedef struct {
+    double alpha;                    // Weight of the soft targets; 1 - alpha goes to the hard labels
+    int32_t num_epochs;
+    int32_t batch_size;              // Samples per update
+    double learning_rate;
+    fossil_jellyfish_loss_t loss;
+} fossil_jellyfish_distill_config_t;
+
+// Function declarations
+
+/**
+ * @brief Runs the teacher over the inputs once and writes its softened outputs to a cache file.
+ *
+ * Sigmoid outputs are softened per value as sigmoid(logit(p) / T), softmax outputs per
+ * row as softmax(log(p) / T); other outputs are cached as they are. The teacher runs in
+ * batches on the thread pool and only one batch of outputs is held in memory.
+ *
+ * @param teacher A pointer to the teacher network.
+ * @param inputs num_samples rows of the teacher input width.
+ * @param num_samples The number of samples.
+ * @param temperature The softening temperature, 1 for the plain outputs.
+ * @param file_path The cache file to write.
+ * @return 0 on success, -1 on error.
+ */
+int32_t fossil_jellyfish_distill_cache(const fossil_jellyfish_network_t* teacher, const double* inputs, int64_t num_samples, double temperature, const char* file_path);
+
+/**
+ * @brief Maps a cache file written by fossil_jellyfish_distill_cache.
+ *
+ * @param file_path The cache file.
+ * @return A pointer to the mapped soft targets, or NULL if the file is missing or invalid.
+ */
+fossil_jellyfish_soft_targets_t* fossil_jellyfish_soft_targets_open(const char* file_path);
+
+/**
+ * @brief Unmaps the soft targets.
+ *
+ * @param soft_targets A pointer to the mapped soft targets.
+ */
+void fossil_jellyfish_soft_targets_close(fossil_jellyfish_soft_targets_t* soft_targets);
+
+/**
+ * @brief Trains a student against a blend of cached soft targets and hard labels.
+ *
+ * Each sample's target is alpha * soft + (1 - alpha) * hard. The gradients of MSE and
+ * the cross-entropy losses are linear in the target, so this equals weighting the
+ * soft and hard losses by alpha and 1 - alpha.
+ *
+ * @param student A pointer to the student network.
+ * @param soft_targets The mapped teacher outputs for the same inputs.
+ * @param inputs The inputs the cache was built from.
+ * @param hard_targets num_samples rows of labels, or NULL to train on soft targets only.
+ * @param config The training settings.
+ * @return 0 on success, -1 on error, including inputs that do not match the cache.
+ */
+int32_t fossil_jellyfish_distill(fossil_jellyfish_network_t* student, const fossil_jellyfish_soft_targets_t* soft_targets, const double* inputs, const double* hard_targets, const fossil_jellyfish_distill_config_t* config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_DISTILL_H */
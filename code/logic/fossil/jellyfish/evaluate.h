@@ -0,0 +1,75 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_EVALUATE_H
+#define FOSSIL_JELLYFISH_AI_EVALUATE_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Metrics computed by fossil_jellyfish_evaluate
+typedef enum {
+    METRIC_LOSS       = 1 << 0,  // Mean loss of the selected loss function
+    METRIC_ACCURACY   = 1 << 1,  // Argmax match, or 0.5 threshold for a single output
+    METRIC_CONFUSION  = 1 << 2,  // Counts into the caller-provided confusion matrix
+    METRIC_REGRESSION = 1 << 3   // MSE, MAE and R^2 over every output value
+} fossil_jellyfish_metric_t;
+
+// Read-only view of a labelled dataset stored as row-major arrays
+typedef struct {
+    const double* inputs;    // num_samples rows of the input layer width
+    const double* targets;   // num_samples rows of the output layer width
+    int64_t num_samples;
+} fossil_jellyfish_dataset_t;
+
+// Evaluation request and results
+typedef struct {
+    // Set by the caller
+    uint32_t flags;                  // Bitwise OR of fossil_jellyfish_metric_t values
+    fossil_jellyfish_loss_t loss;    // Loss used by METRIC_LOSS
+    int64_t* confusion;              // num_classes x num_classes, row = expected, column = predicted
+
+    // Filled in by fossil_jellyfish_evaluate
+    int64_t num_samples;
+    int32_t num_classes;             // Output width, or 2 for a single output
+    double loss_value;
+    int64_t correct;
+    double accuracy;
+    double mse;
+    double mae;
+    double r2;
+} fossil_jellyfish_metrics_t;
+
+// Function declarations
+
+/**
+ * @brief Evaluates the network over a dataset using the thread pool.
+ *
+ * Rows are pushed through the network in blocks, every thread keeps private partial
+ * sums and the partials are merged once at the end. The network is not modified.
+ *
+ * @param network A pointer to the neural network.
+ * @param dataset The samples and their expected outputs.
+ * @param metrics The requested metrics on input, the results on output.
+ * @return 0 on success, -1 on invalid arguments or allocation failure.
+ */
+int32_t fossil_jellyfish_evaluate(const fossil_jellyfish_network_t* network, const fossil_jellyfish_dataset_t* dataset, fossil_jellyfish_metrics_t* metrics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_EVALUATE_H */
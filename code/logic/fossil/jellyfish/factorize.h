@@ -0,0 +1,79 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_FACTORIZE_H
+#define FOSSIL_JELLYFISH_AI_FACTORIZE_H
+
+#include "jellyfish.h"
+#include "evaluate.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Low-rank factorization request
+typedef struct {
+    int32_t layer;                                  // Index of the layer to factor, at least 1
+    int32_t rank;                                   // Singular values kept; 0 selects by energy
+    double energy;                                  // Fraction of the squared singular values kept when rank is 0
+    const fossil_jellyfish_dataset_t* validation;   // Optional: measures the accuracy delta
+    const fossil_jellyfish_dataset_t* fine_tune;    // Optional: trains the factored network
+    int32_t fine_tune_epochs;
+    double learning_rate;
+    fossil_jellyfish_loss_t loss;                   // Used for validation and fine-tuning
+} fossil_jellyfish_factorize_config_t;
+
+// What the factorization changed
+typedef struct {
+    int32_t rank;
+    double energy_kept;          // Squared singular values kept over their total
+    int64_t flops_before;        // Multiply-adds of one forward pass over all layers
+    int64_t flops_after;
+    double loss_before;          // Validation results; zero without a validation set
+    double loss_factored;        // Right after factoring
+    double loss_tuned;           // After fine-tuning, or equal to loss_factored
+    double accuracy_before;
+    double accuracy_factored;
+    double accuracy_tuned;
+} fossil_jellyfish_factorize_report_t;
+
+// Function declarations
+
+/**
+ * @brief Returns the multiply-adds of one forward pass.
+ *
+ * @param network A pointer to the neural network.
+ * @return The number of multiply-adds.
+ */
+int64_t fossil_jellyfish_forward_flops(const fossil_jellyfish_network_t* network);
+
+/**
+ * @brief Replaces a dense layer with a thin pair of layers from its truncated SVD.
+ *
+ * The weight matrix W = U S V^T becomes a linear layer sqrt(S) V^T of rank neurons,
+ * followed by the original layer with weights U sqrt(S) and its own biases and
+ * activation, so the network gains one layer. Only dense layers can be factored.
+ *
+ * @param network A pointer to the neural network, modified in place.
+ * @param config The layer, rank selection and optional validation and fine-tuning.
+ * @param report Receives the chosen rank, FLOP counts and validation results; may be NULL.
+ * @return 0 when the layer was factored, 1 when the chosen rank would not reduce
+ *         the FLOPs and the network was left unchanged, -1 on error.
+ */
+int32_t fossil_jellyfish_factorize_layer(fossil_jellyfish_network_t* network, const fossil_jellyfish_factorize_config_t* config, fossil_jellyfish_factorize_report_t* report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_FACTORIZE_H */
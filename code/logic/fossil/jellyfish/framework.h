@@ -15,5 +15,23 @@
 #define FOSSIL_JELLYFISH_AI_FRAMEWORK_H
 
 #include "jellyfish.h"
+#include "loss.h"
+#include "parallel.h"
+#include "init.h"
+#include "evaluate.h"
+#include "graph.h"
+#include "online.h"
+#include "compress.h"
+#include "factorize.h"
+#include "distill.h"
+#include "hashed.h"
+#include "cascade.h"
+#include "cache.h"
+#include "normalize.h"
+#include "plan.h"
+#include "memory.h"
+#include "jit.h"
+#include "stream.h"
+#include "dataset.h"
 
 #endif /* FOSSIL_JELLYFISH_AI_FRAMEWORK_H */
@@ -0,0 +1,204 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_GRAPH_H
+#define FOSSIL_JELLYFISH_AI_GRAPH_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Kinds of graph nodes
+typedef enum {
+    NODE_INPUT,    // Slice of the graph input vector
+    NODE_DENSE,    // Fully connected layer over one producer
+    NODE_SUM,      // Element-wise sum of equally wide producers, then activation
+    NODE_CONCAT    // Producers laid end to end
+} fossil_jellyfish_node_kind_t;
+
+// Graph node; a node may only consume nodes created before it
+typedef struct {
+    fossil_jellyfish_node_kind_t kind;
+    int32_t width;                             // Number of output values
+    int32_t num_inputs;
+    int32_t* inputs;                           // Indices of the producer nodes
+    fossil_jellyfish_activation_t activation;  // Dense and sum nodes
+    double* weights;                           // Dense: width x producer width
+    double* biases;                            // Dense: width
+    int32_t owns_params;                       // Zero when the parameters belong to a chain network
+    int32_t layer;                             // Layer of the graph's network holding them, 0 when owned
+    int32_t offset;                            // Input nodes: position in the graph input vector
+    int32_t level;                             // Longest distance from an input, set by compile
+    int32_t last_use;                          // Last level reading this node, set by compile
+    int32_t buffer;                            // Inference buffer assigned by compile
+} fossil_jellyfish_node_t;
+
+// Directed acyclic network of nodes with its execution plan
+typedef struct {
+    int32_t num_nodes;
+    int32_t capacity;
+    fossil_jellyfish_node_t* nodes;
+    int32_t output;           // Node whose values are the graph output
+    int32_t input_width;      // Total width of all input nodes
+    fossil_jellyfish_network_t* network;  // Chain network the linked dense nodes read, NULL when none
+
+    // Execution plan built by fossil_jellyfish_graph_compile
+    int32_t compiled;
+    int32_t num_levels;
+    int32_t* level_order;     // Node indices grouped by level
+    int32_t* level_start;     // num_levels + 1 offsets into level_order
+    int32_t num_buffers;      // Reused inference buffers
+    int32_t buffer_width;
+    double* buffers;
+    double* activations;      // Training: every node keeps its values
+    double* gradients;        // Training: gradient with respect to every node's values
+    double** inference_values; // Per node: its inference buffer
+    double** training_values; // Per node: its slice of activations
+    double** node_gradients;  // Per node: its slice of gradients
+} fossil_jellyfish_graph_t;
+
+// Function declarations
+
+/**
+ * @brief Creates an empty graph.
+ *
+ * @return A pointer to the graph, or NULL if memory could not be allocated.
+ */
+fossil_jellyfish_graph_t* fossil_jellyfish_graph_create(void);
+
+/**
+ * @brief Frees the graph and the parameters it owns.
+ *
+ * @param graph A pointer to the graph.
+ */
+void fossil_jellyfish_graph_free(fossil_jellyfish_graph_t* graph);
+
+/**
+ * @brief Adds an input node reading the next width values of the graph input vector.
+ *
+ * @param graph A pointer to the graph.
+ * @param width The number of input values.
+ * @return The node index, or -1 on error.
+ */
+int32_t fossil_jellyfish_graph_add_input(fossil_jellyfish_graph_t* graph, int32_t width);
+
+/**
+ * @brief Adds a fully connected node, initialized like fossil_jellyfish_create_network.
+ *
+ * @param graph A pointer to the graph.
+ * @param input The producer node.
+ * @param width The number of neurons.
+ * @param activation The activation function.
+ * @return The node index, or -1 on error.
+ */
+int32_t fossil_jellyfish_graph_add_dense(fossil_jellyfish_graph_t* graph, int32_t input, int32_t width, fossil_jellyfish_activation_t activation);
+
+/**
+ * @brief Adds an element-wise sum node, e.g. to close a residual connection.
+ *
+ * @param graph A pointer to the graph.
+ * @param inputs The producer nodes, all of the same width.
+ * @param num_inputs The number of producers.
+ * @param activation The activation applied to the sum; ACTIVATION_LINEAR for none.
+ * @return The node index, or -1 on error.
+ */
+int32_t fossil_jellyfish_graph_add_sum(fossil_jellyfish_graph_t* graph, const int32_t* inputs, int32_t num_inputs, fossil_jellyfish_activation_t activation);
+
+/**
+ * @brief Adds a node concatenating its producers.
+ *
+ * @param graph A pointer to the graph.
+ * @param inputs The producer nodes.
+ * @param num_inputs The number of producers.
+ * @return The node index, or -1 on error.
+ */
+int32_t fossil_jellyfish_graph_add_concat(fossil_jellyfish_graph_t* graph, const int32_t* inputs, int32_t num_inputs);
+
+/**
+ * @brief Selects the node whose values form the graph output; defaults to the last node added.
+ *
+ * @param graph A pointer to the graph.
+ * @param node The output node.
+ */
+void fossil_jellyfish_graph_set_output(fossil_jellyfish_graph_t* graph, int32_t node);
+
+/**
+ * @brief Builds the execution plan: topological levels whose nodes run in parallel,
+ * and inference buffers reused once their last reader has run.
+ *
+ * Adding nodes invalidates the plan; forward and training compile on demand.
+ *
+ * @param graph A pointer to the graph.
+ * @return 0 on success, -1 if memory could not be allocated.
+ */
+int32_t fossil_jellyfish_graph_compile(fossil_jellyfish_graph_t* graph);
+
+/**
+ * @brief Runs inference level by level on the thread pool.
+ *
+ * @param graph A pointer to the graph.
+ * @param input The graph input vector, input nodes in creation order.
+ * @param output Receives the values of the output node.
+ * @return 0 on success, -1 on error.
+ */
+int32_t fossil_jellyfish_graph_forward(fossil_jellyfish_graph_t* graph, const double* input, double* output);
+
+/**
+ * @brief Performs one stochastic gradient descent step on a single sample.
+ *
+ * @param graph A pointer to the graph.
+ * @param input The graph input vector.
+ * @param expected_output The expected values of the output node.
+ * @param learning_rate The learning rate.
+ * @param loss The loss function to minimize.
+ * @return 0 on success, -1 on error.
+ */
+int32_t fossil_jellyfish_graph_train_step(fossil_jellyfish_graph_t* graph, const double* input, const double* expected_output, double learning_rate, fossil_jellyfish_loss_t loss);
+
+/**
+ * @brief Trains the graph like fossil_jellyfish_train_with_loss.
+ *
+ * @param graph A pointer to the graph.
+ * @param inputs An array of input vectors.
+ * @param expected_output An array of expected output vectors.
+ * @param num_samples The number of samples in the training data.
+ * @param num_epochs The number of epochs to train the graph.
+ * @param learning_rate The learning rate.
+ * @param loss The loss function to minimize.
+ * @return 0 on success, -1 on error.
+ */
+int32_t fossil_jellyfish_graph_train(fossil_jellyfish_graph_t* graph, const double* inputs, const double* expected_output, int32_t num_samples, int32_t num_epochs, double learning_rate, fossil_jellyfish_loss_t loss);
+
+/**
+ * @brief Builds the graph equivalent of a chain network.
+ *
+ * The dense nodes hold no parameters of their own: every forward pass and training step
+ * reads the network's current weight and bias arrays, so training either one trains both.
+ * A graph training step first gives each layer private arrays, as chain training does,
+ * so snapshots taken of the network are never written, and drops packed weights that
+ * would go stale. The network must outlive the graph. Hashed layers are not supported,
+ * nor is input normalization; fold it into the first layer beforehand. Once the network
+ * is reshaped, hashed or normalized, graph forward and training fail with -1.
+ *
+ * @param network A pointer to the neural network.
+ * @return A pointer to the graph, or NULL on error.
+ */
+fossil_jellyfish_graph_t* fossil_jellyfish_graph_from_network(fossil_jellyfish_network_t* network);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_GRAPH_H */
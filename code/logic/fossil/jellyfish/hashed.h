@@ -0,0 +1,56 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_HASHED_H
+#define FOSSIL_JELLYFISH_AI_HASHED_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Function declarations
+
+/**
+ * @brief Turns a dense layer into a hashed layer with num_params real weights.
+ *
+ * Virtual entry (j, k) of the weight matrix reads sign(j, k) * weights[slot(j, k)],
+ * both drawn from one hash of the entry index and the seed. Each real weight becomes
+ * the signed mean of the dense entries hashed onto it, the closest hashed matrix to
+ * the dense one; call fossil_jellyfish_init_layer afterwards to start from scratch.
+ *
+ * @param network A pointer to the neural network.
+ * @param layer_index The layer to convert, at least 1.
+ * @param num_params The number of real weights, at most 2^32 - 1.
+ * @param seed Selects the hash function.
+ * @return 0 on success, -1 on error.
+ */
+int32_t fossil_jellyfish_hash_layer(fossil_jellyfish_network_t* network, int32_t layer_index, int64_t num_params, uint64_t seed);
+
+/**
+ * @brief Returns one entry of a layer's virtual weight matrix, for dense and hashed layers alike.
+ *
+ * @param network A pointer to the neural network.
+ * @param layer_index The layer, at least 1.
+ * @param neuron The row: a neuron of the layer.
+ * @param input The column: a neuron of the previous layer.
+ * @return The weight.
+ */
+double fossil_jellyfish_layer_weight(const fossil_jellyfish_network_t* network, int32_t layer_index, int32_t neuron, int32_t input);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_HASHED_H */
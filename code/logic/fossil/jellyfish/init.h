@@ -0,0 +1,64 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_INIT_H
+#define FOSSIL_JELLYFISH_AI_INIT_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Weight initialization schemes
+typedef enum {
+    INIT_AUTO,            // He for ReLU-like layers, Xavier otherwise
+    INIT_XAVIER_UNIFORM,
+    INIT_XAVIER_NORMAL,
+    INIT_HE_UNIFORM,
+    INIT_HE_NORMAL,
+    INIT_ORTHOGONAL
+} fossil_jellyfish_init_t;
+
+// Seed used by fossil_jellyfish_create_network
+#define FOSSIL_JELLYFISH_DEFAULT_SEED 0x6a656c6c79666973ULL
+
+// Function declarations
+
+/**
+ * @brief Initializes the weights of one layer and zeroes its biases.
+ *
+ * Random values come from a counter-based generator, so the result depends only on
+ * the seed and the layer index, never on the number of threads used to fill it.
+ *
+ * @param network A pointer to the neural network.
+ * @param layer_index The index of the layer to initialize; the input layer is ignored.
+ * @param init The initialization scheme.
+ * @param seed The seed of the random generator.
+ */
+void fossil_jellyfish_init_layer(fossil_jellyfish_network_t* network, int32_t layer_index, fossil_jellyfish_init_t init, uint64_t seed);
+
+/**
+ * @brief Initializes the weights and biases of every layer in the network.
+ *
+ * @param network A pointer to the neural network.
+ * @param init The initialization scheme.
+ * @param seed The seed of the random generator.
+ */
+void fossil_jellyfish_init_network(fossil_jellyfish_network_t* network, fossil_jellyfish_init_t init, uint64_t seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_INIT_H */
@@ -18,10 +18,16 @@
 #include <stdint.h>
 #include <math.h>
 
+#include "loss.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Slope of ACTIVATION_LEAKY_RELU below zero and saturation value of ACTIVATION_ELU
+#define FOSSIL_JELLYFISH_LEAKY_SLOPE 0.01
+#define FOSSIL_JELLYFISH_ELU_ALPHA 1.0
+
 // Activation functions
 typedef enum {
     ACTIVATION_RELU,
@@ -29,9 +35,28 @@ typedef enum {
     ACTIVATION_TANH,
     ACTIVATION_LEAKY_RELU,
     ACTIVATION_SOFTMAX,
-    ACTIVATION_ELU
+    ACTIVATION_ELU,
+    ACTIVATION_LINEAR
 } fossil_jellyfish_activation_t;
 
+// Layer parameter layouts
+typedef enum {
+    LAYER_DENSE,   // Full num_neurons x fan-in weight matrix
+    LAYER_HASHED   // Virtual weight matrix hashed into num_params shared weights
+} fossil_jellyfish_layer_kind_t;
+
+// Memory hooks; alloc and free are required, aligned_alloc may be NULL, and a zeroed
+// allocator stands for the default one built on malloc and free
+typedef struct {
+    void* (*alloc)(void* context, size_t size);
+    void* (*aligned_alloc)(void* context, size_t alignment, size_t size);  // Alignment is a power of two
+    void (*free)(void* context, void* pointer);
+    void* context;
+} fossil_jellyfish_allocator_t;
+
+// Neurons per panel of packed weights, one register tile of the packed kernels
+#define FOSSIL_JELLYFISH_PANEL_WIDTH 4
+
 // Neural network layer structure
 typedef struct {
     int32_t num_neurons;
@@ -40,18 +65,29 @@ typedef struct {
     double* outputs;  // Output values after activation
     double* deltas;   // Deltas used in backpropagation
     fossil_jellyfish_activation_t activation;  // Activation function
+    void* shared;     // Copy-on-write parameter block shared with snapshots, NULL when owned
+    fossil_jellyfish_layer_kind_t kind;
+    int64_t num_params;   // Hashed: length of the weights array
+    uint64_t hash_seed;   // Hashed: selects the virtual-to-real weight mapping
+    double* packed;       // Optional panel-major copy of the weights for inference, NULL when absent
 } fossil_jellyfish_layer_t;
 
 // Neural network structure
 typedef struct {
     int32_t num_layers;
     fossil_jellyfish_layer_t** layers;
+    double* input_mean;    // Optional standardization fused into the input copy, NULL when off
+    double* input_scale;   // Reciprocal standard deviation per input feature
+    fossil_jellyfish_allocator_t allocator;  // Owns every array of the network
 } fossil_jellyfish_network_t;
 
 // Function declarations
 
 /**
  * @brief Creates a neural network with the specified number of layers and neurons per layer.
+ *
+ * Weights are initialized with INIT_AUTO and FOSSIL_JELLYFISH_DEFAULT_SEED and biases are zeroed;
+ * call fossil_jellyfish_init_network to pick another scheme or seed.
  * 
  * @param num_layers The number of layers in the network.
  * @param neurons_per_layer An array containing the number of neurons in each layer.
@@ -60,13 +96,87 @@ typedef struct {
  */
 fossil_jellyfish_network_t* fossil_jellyfish_create_network(int32_t num_layers, int32_t* neurons_per_layer, fossil_jellyfish_activation_t* activations);
 
+/**
+ * @brief Creates a neural network whose memory comes from the given allocator.
+ *
+ * The network, its layers and every array later attached to them (clones and snapshots
+ * included) are allocated and freed through the allocator, which must outlive them.
+ * fossil_jellyfish_create_network uses the global allocator of fossil_jellyfish_set_allocator.
+ *
+ * @param num_layers The number of layers in the network.
+ * @param neurons_per_layer An array containing the number of neurons in each layer.
+ * @param activations An array containing the activation functions for each layer.
+ * @param allocator The memory hooks, or NULL for the global allocator.
+ * @return A pointer to the created neural network, or NULL if memory could not be allocated.
+ */
+fossil_jellyfish_network_t* fossil_jellyfish_create_network_with_allocator(int32_t num_layers, int32_t* neurons_per_layer, fossil_jellyfish_activation_t* activations,
+                                                                           const fossil_jellyfish_allocator_t* allocator);
+
+/**
+ * @brief Clears a network struct the caller allocated, before filling it in by hand.
+ *
+ * The network and layer structs have grown fields since the first release (allocator,
+ * normalization, copy-on-write sharing, layer kinds, packed weights) that the library
+ * reads everywhere. Code that assembles a network with malloc must now call this and
+ * fossil_jellyfish_layer_init on every struct before setting num_layers, layers and the
+ * layer fields; a struct left uninitialized is undefined behaviour in any library call.
+ * Zeroing the structs with calloc is equivalent. Arrays assigned afterwards must come
+ * from malloc, since the cleared allocator frees with free().
+ *
+ * @param network A pointer to the network struct.
+ */
+void fossil_jellyfish_network_init(fossil_jellyfish_network_t* network);
+
+/**
+ * @brief Clears a layer struct the caller allocated to an empty dense layer.
+ *
+ * @param layer A pointer to the layer struct.
+ */
+void fossil_jellyfish_layer_init(fossil_jellyfish_layer_t* layer);
+
 /**
  * @brief Frees the memory allocated for the neural network.
- * 
+ *
+ * Every array reachable from the network is released through its allocator,
+ * layer outputs included.
+ *
  * @param network A pointer to the neural network to be freed.
  */
 void fossil_jellyfish_free_network(fossil_jellyfish_network_t* network);
 
+/**
+ * @brief Creates an independent deep copy of the neural network.
+ * 
+ * @param network A pointer to the neural network to copy.
+ * @return A pointer to the copy, or NULL if memory could not be allocated.
+ */
+fossil_jellyfish_network_t* fossil_jellyfish_clone(const fossil_jellyfish_network_t* network);
+
+/**
+ * @brief Creates a copy-on-write snapshot of the neural network.
+ *
+ * The snapshot shares weight and bias arrays with the original instead of copying them,
+ * so taking it costs a few small allocations per layer regardless of the model size.
+ * Whichever side is written first through a library call (training, initialization)
+ * copies that layer's parameters and stops sharing it. Both networks are freed with
+ * fossil_jellyfish_free_network, in any order and from any thread.
+ * 
+ * @param network A pointer to the neural network to snapshot.
+ * @return A pointer to the snapshot, or NULL if memory could not be allocated.
+ */
+fossil_jellyfish_network_t* fossil_jellyfish_snapshot(fossil_jellyfish_network_t* network);
+
+/**
+ * @brief Gives the network private copies of any parameters it still shares with a snapshot.
+ *
+ * Also drops packed weight copies, which would go stale. Library functions do this
+ * on their own; call it before writing to layer weights or biases directly.
+ * 
+ * @param network A pointer to the neural network.
+ * @return 0 on success, -1 if memory could not be allocated.
+ */
+int32_t fossil_jellyfish_make_writable(fossil_jellyfish_network_t* network);
+
 /**
  * @brief Performs a forward pass through the neural network with the given input.
  * 
@@ -75,6 +185,50 @@ void fossil_jellyfish_free_network(fossil_jellyfish_network_t* network);
  */
 void fossil_jellyfish_forward(fossil_jellyfish_network_t* network, double* input);
 
+/**
+ * @brief Performs a forward pass that reads the input in place and writes the output to the caller.
+ *
+ * Layer 1 reads the caller's row directly instead of a copy in the input layer, and the
+ * output layer writes straight into output. Hidden layer buffers are filled as by
+ * fossil_jellyfish_forward, but the input and output layer buffers are not, so use
+ * fossil_jellyfish_forward before backpropagation. With input normalization on, the
+ * standardized row still goes through the input layer's buffer.
+ *
+ * @param network A pointer to the neural network.
+ * @param input An array of input values.
+ * @param output Receives the output values; must not overlap the input.
+ */
+void fossil_jellyfish_forward_into(fossil_jellyfish_network_t* network, const double* input, double* output);
+
+/**
+ * @brief Runs the forward pass for a batch of samples on the thread pool.
+ *
+ * Unlike fossil_jellyfish_forward this leaves the layer output buffers untouched,
+ * so several threads may run it on the same network at once.
+ * 
+ * @param network A pointer to the neural network.
+ * @param inputs Row-major array of num_samples input rows.
+ * @param num_samples The number of samples in the batch.
+ * @param outputs Row-major array receiving num_samples output rows.
+ * @return 0 on success, -1 if scratch memory could not be allocated.
+ */
+int32_t fossil_jellyfish_forward_batch(const fossil_jellyfish_network_t* network, const double* inputs, int64_t num_samples, double* outputs);
+
+/**
+ * @brief Runs fossil_jellyfish_forward_batch on input rows embedded in larger records.
+ *
+ * Each row's features are read in place from the first input-width doubles of its record,
+ * so no packed copy of the batch is made.
+ *
+ * @param network A pointer to the neural network.
+ * @param inputs The first feature of the first record.
+ * @param input_stride Doubles between the starts of consecutive records, at least the input width.
+ * @param num_samples The number of records.
+ * @param outputs Row-major array receiving num_samples output rows.
+ * @return 0 on success, -1 on a short stride or if scratch memory could not be allocated.
+ */
+int32_t fossil_jellyfish_forward_strided(const fossil_jellyfish_network_t* network, const double* inputs, int64_t input_stride, int64_t num_samples, double* outputs);
+
 /**
  * @brief Performs backpropagation on the neural network with the given expected output and learning rate.
  * 
@@ -84,6 +238,50 @@ void fossil_jellyfish_forward(fossil_jellyfish_network_t* network, double* input
  */
 void fossil_jellyfish_backpropagate(fossil_jellyfish_network_t* network, double* expected_output, double learning_rate);
 
+/**
+ * @brief Performs backpropagation using the gradient of the given loss function at the output layer.
+ * 
+ * @param network A pointer to the neural network.
+ * @param expected_output An array of expected output values.
+ * @param learning_rate The learning rate for the backpropagation algorithm.
+ * @param loss The loss function whose gradient drives the update.
+ */
+void fossil_jellyfish_backpropagate_with_loss(fossil_jellyfish_network_t* network, double* expected_output, double learning_rate, fossil_jellyfish_loss_t loss);
+
+/**
+ * @brief Returns the number of trainable parameters, the length of a flat gradient vector.
+ *
+ * The flat layout visits the layers after the input layer in order, each with its
+ * row-major weight matrix followed by its biases.
+ * 
+ * @param network A pointer to the neural network.
+ * @return The number of weights and biases.
+ */
+int64_t fossil_jellyfish_num_parameters(const fossil_jellyfish_network_t* network);
+
+/**
+ * @brief Adds the loss gradient of the last forward pass to a flat gradient vector.
+ *
+ * The parameters are not modified, so gradients of several samples can be summed
+ * before a single fossil_jellyfish_apply_gradients call.
+ * 
+ * @param network A pointer to the neural network, after fossil_jellyfish_forward.
+ * @param expected_output An array of expected output values.
+ * @param loss The loss function to differentiate.
+ * @param gradients Flat vector of fossil_jellyfish_num_parameters values to add to.
+ */
+void fossil_jellyfish_accumulate_gradients(fossil_jellyfish_network_t* network, const double* expected_output, fossil_jellyfish_loss_t loss, double* gradients);
+
+/**
+ * @brief Moves every parameter against its gradient: parameter -= learning_rate * gradient.
+ * 
+ * @param network A pointer to the neural network.
+ * @param gradients Flat vector of fossil_jellyfish_num_parameters values.
+ * @param learning_rate The step size.
+ * @return 0 on success, -1 if shared parameters could not be copied.
+ */
+int32_t fossil_jellyfish_apply_gradients(fossil_jellyfish_network_t* network, const double* gradients, double learning_rate);
+
 /**
  * @brief Trains the neural network with the given inputs and expected outputs for a specified number of samples and epochs.
  * 
@@ -96,8 +294,24 @@ void fossil_jellyfish_backpropagate(fossil_jellyfish_network_t* network, double*
  */
 void fossil_jellyfish_train(fossil_jellyfish_network_t* network, double* inputs, double* expected_output, int32_t num_samples, int32_t num_epochs, double learning_rate);
 
+/**
+ * @brief Trains the neural network like fossil_jellyfish_train, minimizing the given loss function.
+ * 
+ * @param network A pointer to the neural network.
+ * @param inputs An array of input values.
+ * @param expected_output An array of expected output values.
+ * @param num_samples The number of samples in the training data.
+ * @param num_epochs The number of epochs to train the network.
+ * @param learning_rate The learning rate for the training algorithm.
+ * @param loss The loss function to minimize.
+ */
+void fossil_jellyfish_train_with_loss(fossil_jellyfish_network_t* network, double* inputs, double* expected_output, int32_t num_samples, int32_t num_epochs, double learning_rate, fossil_jellyfish_loss_t loss);
+
 /**
  * @brief Applies the specified activation function to the given value.
+ *
+ * Softmax normalizes a whole layer, so it returns the value unchanged here;
+ * use fossil_jellyfish_activate_vector for it.
  * 
  * @param value The input value.
  * @param activation The activation function to be applied.
@@ -106,17 +320,47 @@ void fossil_jellyfish_train(fossil_jellyfish_network_t* network, double* inputs,
 double fossil_jellyfish_activate(double value, fossil_jellyfish_activation_t activation);
 
 /**
- * @brief Computes the derivative of the specified activation function for the given value.
+ * @brief Computes the derivative of the specified activation function from its output.
+ *
+ * Every activation's derivative can be written in terms of its output, so no
+ * pre-activation values are kept. For softmax this is the diagonal of the Jacobian
+ * only; fossil_jellyfish_activation_backward applies the full Jacobian.
  * 
- * @param value The input value.
+ * @param value The activation output.
  * @param activation The activation function whose derivative is to be computed.
  * @return The derivative of the activation function.
  */
 double fossil_jellyfish_activate_derivative(double value, fossil_jellyfish_activation_t activation);
 
+/**
+ * @brief Applies an activation function to a whole layer in place.
+ *
+ * @param values The pre-activation values, replaced by the outputs.
+ * @param count The number of values.
+ * @param activation The activation function.
+ */
+void fossil_jellyfish_activate_vector(double* values, int32_t count, fossil_jellyfish_activation_t activation);
+
+/**
+ * @brief Turns gradients with respect to a layer's outputs into gradients with respect to its pre-activations.
+ *
+ * Multiplies by the transposed Jacobian of the activation, computed from the outputs alone:
+ * element-wise for every activation but softmax, whose gradient is y * (g - sum(g * y)).
+ *
+ * @param outputs The activation outputs.
+ * @param gradients The gradients, updated in place.
+ * @param count The number of values.
+ * @param activation The activation function.
+ */
+void fossil_jellyfish_activation_backward(const double* outputs, double* gradients, int32_t count, fossil_jellyfish_activation_t activation);
+
 /**
  * @brief Saves the current state of the fossil jellyfish network to a file.
  *
+ * The file is versioned: a header, one record per layer, then tagged sections
+ * that readers skip when they do not know them. Packed weight copies are saved
+ * in their own sections, so loading them costs no repacking.
+ *
  * @param network A pointer to the fossil jellyfish network to be saved.
  * @param file_path The path to the file where the network state will be saved.
  * @return An integer indicating the success or failure of the save operation.
@@ -126,6 +370,9 @@ int32_t fossil_jellyfish_save(fossil_jellyfish_network_t* network, const char* f
 /**
  * @brief Loads the fossil jellyfish network state from a file.
  *
+ * Reads both the versioned format and the older headerless one, and rejects
+ * files whose sizes do not match their contents.
+ *
  * @param file_path The path to the file from which the network state will be loaded.
  * @return A pointer to the loaded fossil jellyfish network.
  */
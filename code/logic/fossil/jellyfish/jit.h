@@ -0,0 +1,93 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_JIT_H
+#define FOSSIL_JELLYFISH_AI_JIT_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Forward pass of one network compiled to machine code
+typedef struct {
+    const fossil_jellyfish_network_t* network;
+    void* code;               // Executable mapping, NULL when the generic path runs instead
+    size_t code_size;         // Bytes of generated code
+    size_t mapping_size;
+    double* data;             // Normalization, weights and biases in the layout the code reads
+    void* data_block;         // Allocation behind data, which is 16-byte aligned
+    size_t data_size;         // Doubles of data
+    size_t workspace_size;    // Doubles of scratch one call needs
+    int32_t input_width;
+    int32_t output_width;
+    int32_t num_layers;
+    int32_t* layer_shape;     // Width and activation of every layer, as compiled
+    int32_t normalized;       // Whether the network standardized its inputs when compiled
+} fossil_jellyfish_jit_t;
+
+// Function declarations
+
+/**
+ * @brief Compiles the forward pass of a network to machine code.
+ *
+ * On x86-64 the generated SSE2 code has every layer width, loop trip count, buffer
+ * offset and weight address baked in, runs ReLU and linear layers inline and calls
+ * the library's kernels for the other activations. It sums in the same order as
+ * fossil_jellyfish_forward, so the outputs match it exactly. Weights are copied into
+ * panels of neurons interleaved by input; hashed layers are expanded to their virtual
+ * matrix. Other instruction sets, and systems that refuse executable mappings, get a
+ * JIT whose code is NULL and whose forward pass runs the generic path.
+ *
+ * @param network A pointer to the neural network, which must outlive the JIT.
+ * @return A pointer to the JIT, or NULL on allocation failure.
+ */
+fossil_jellyfish_jit_t* fossil_jellyfish_jit_compile(const fossil_jellyfish_network_t* network);
+
+/**
+ * @brief Frees the JIT and its executable mapping.
+ *
+ * @param jit A pointer to the JIT; NULL is ignored.
+ */
+void fossil_jellyfish_jit_free(fossil_jellyfish_jit_t* jit);
+
+/**
+ * @brief Copies the network's current weights, biases and normalization into the JIT.
+ *
+ * The generated code keeps reading the same addresses, so nothing is recompiled.
+ *
+ * @param jit A pointer to the JIT.
+ * @return 0 on success, -1 if the network's layer count, any layer width or activation,
+ *         or its normalization switch changed since compilation.
+ */
+int32_t fossil_jellyfish_jit_refresh(fossil_jellyfish_jit_t* jit);
+
+/**
+ * @brief Runs the compiled forward pass on one sample; several threads may share one JIT.
+ *
+ * The network's layer buffers are not touched; scratch comes from the calling
+ * thread's arena.
+ *
+ * @param jit A pointer to the JIT.
+ * @param input One row of raw inputs.
+ * @param output Receives one row of outputs; must not overlap the input.
+ * @return 0 on success, -1 if scratch memory could not be allocated.
+ */
+int32_t fossil_jellyfish_jit_forward(const fossil_jellyfish_jit_t* jit, const double* input, double* output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_JIT_H */
@@ -0,0 +1,77 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_LOSS_H
+#define FOSSIL_JELLYFISH_AI_LOSS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Loss functions
+typedef enum {
+    LOSS_MSE,
+    LOSS_MAE,
+    LOSS_HUBER,
+    LOSS_BINARY_CROSS_ENTROPY,
+    LOSS_CATEGORICAL_CROSS_ENTROPY
+} fossil_jellyfish_loss_t;
+
+// Transition point between the quadratic and linear regions of the Huber loss
+#define FOSSIL_JELLYFISH_HUBER_DELTA 1.0
+
+// Probabilities are clamped to [eps, 1 - eps] before taking logarithms
+#define FOSSIL_JELLYFISH_LOSS_EPSILON 1e-12
+
+// Function declarations
+
+/**
+ * @brief Computes the mean loss over a batch of predictions.
+ *
+ * Element-wise losses (MSE, MAE, Huber, binary cross-entropy) are averaged over
+ * every element of the batch. Categorical cross-entropy is summed across the
+ * classes of a row and averaged over the rows.
+ *
+ * @param loss The loss function to evaluate.
+ * @param predicted Row-major array of num_samples * width predicted values.
+ * @param expected Row-major array of num_samples * width expected values.
+ * @param num_samples The number of rows in the batch.
+ * @param width The number of values in each row.
+ * @return The mean loss, or 0 for an empty batch.
+ */
+double fossil_jellyfish_loss(fossil_jellyfish_loss_t loss, const double* predicted, const double* expected, int64_t num_samples, int32_t width);
+
+/**
+ * @brief Computes the gradient of the loss with respect to each prediction.
+ *
+ * The gradient is per element and is not divided by the batch size, so it can
+ * be fed straight into backpropagation. MSE follows the 1/2-scaled convention
+ * (predicted - expected) used by fossil_jellyfish_backpropagate.
+ *
+ * @param loss The loss function to differentiate.
+ * @param predicted Row-major array of num_samples * width predicted values.
+ * @param expected Row-major array of num_samples * width expected values.
+ * @param gradient Output array of num_samples * width values.
+ * @param num_samples The number of rows in the batch.
+ * @param width The number of values in each row.
+ */
+void fossil_jellyfish_loss_gradient(fossil_jellyfish_loss_t loss, const double* predicted, const double* expected, double* gradient, int64_t num_samples, int32_t width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_LOSS_H */
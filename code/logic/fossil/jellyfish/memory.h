@@ -0,0 +1,215 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_MEMORY_H
+#define FOSSIL_JELLYFISH_AI_MEMORY_H
+
+#include <stddef.h>
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Transparent huge page size on x86-64 and arm64 with 4 KB base pages
+#define FOSSIL_JELLYFISH_HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+// Alignment of the buffers the static constructors build in; a static array of double has it
+#define FOSSIL_JELLYFISH_STATIC_ALIGNMENT 8
+
+// Function declarations
+
+/**
+ * @brief Replaces the global allocator behind every allocation of the library.
+ *
+ * Networks capture the global allocator when they are created or loaded and keep it;
+ * everything else (datasets, plans, caches, scratch blocks) allocates through the one
+ * that is global at the time. Set it before creating any object, not while other
+ * threads use the library.
+ *
+ * @param allocator The memory hooks, copied; NULL restores malloc and free.
+ */
+void fossil_jellyfish_set_allocator(const fossil_jellyfish_allocator_t* allocator);
+
+/**
+ * @brief Returns the global allocator.
+ *
+ * @return A copy of the hooks, zeroed while the default allocator is in use.
+ */
+fossil_jellyfish_allocator_t fossil_jellyfish_get_allocator(void);
+
+/**
+ * @brief Grows the calling thread's scratch arena to at least size bytes in one block.
+ *
+ * Kernel temporaries (batch forward buffers, evaluation partials, gradient vectors of
+ * the training loops) are bump-allocated from a per-thread arena that is reset when
+ * the call returns, so after the first call of a given size no library hot path
+ * reaches the allocator. Reserving up front moves that first allocation out of the
+ * hot path as well.
+ *
+ * @param size The number of bytes.
+ * @return 0 on success, -1 if memory could not be allocated.
+ */
+int32_t fossil_jellyfish_scratch_reserve(size_t size);
+
+/**
+ * @brief Returns the calling thread's scratch arena to the allocator.
+ *
+ * Worker threads of the library release theirs when they exit and the thread that
+ * calls exit() has its arena released then; other threads that called into the
+ * library release theirs with this before exiting.
+ */
+void fossil_jellyfish_scratch_release(void);
+
+/**
+ * @brief Turns huge page backing of large parameter arrays on or off.
+ *
+ * While on, every parameter array of at least FOSSIL_JELLYFISH_HUGE_PAGE_SIZE that the
+ * library allocates (networks being created, cloned, loaded or copied on write) is
+ * aligned to a huge page and, on Linux, marked with madvise(MADV_HUGEPAGE), so one
+ * TLB entry covers 2 MB of weights instead of 4 KB. Smaller arrays, platforms without
+ * the call and allocators without aligned_alloc get ordinary allocations.
+ *
+ * @param enabled Nonzero to turn huge pages on. Off by default.
+ */
+void fossil_jellyfish_set_huge_pages(int32_t enabled);
+
+/**
+ * @brief Returns whether huge page backing is on.
+ *
+ * @return Nonzero when on.
+ */
+int32_t fossil_jellyfish_get_huge_pages(void);
+
+/**
+ * @brief Allocates a buffer the way large parameter arrays are allocated.
+ *
+ * Meant for large activation arenas such as batch inputs, outputs and plan scratch.
+ *
+ * @param size The number of bytes.
+ * @return The buffer, released with fossil_jellyfish_free_arena, or NULL on failure.
+ */
+void* fossil_jellyfish_alloc_arena(size_t size);
+
+/**
+ * @brief Releases a buffer from fossil_jellyfish_alloc_arena.
+ *
+ * @param arena The buffer; NULL is ignored.
+ */
+void fossil_jellyfish_free_arena(void* arena);
+
+/**
+ * @brief Moves a network's large parameter arrays into huge-page-backed memory.
+ *
+ * For networks created before huge pages were turned on. Arrays still shared with
+ * a snapshot are left where they are.
+ *
+ * @param network A pointer to the neural network.
+ * @return 0 on success, -1 if memory could not be allocated.
+ */
+int32_t fossil_jellyfish_use_huge_pages(fossil_jellyfish_network_t* network);
+
+/**
+ * @brief Returns the exact number of bytes fossil_jellyfish_create_network_in needs.
+ *
+ * Computed from the topology alone, so firmware can size its static buffer at
+ * compile time or check it at startup without touching the heap.
+ *
+ * @param num_layers The number of layers in the network.
+ * @param neurons_per_layer An array containing the number of neurons in each layer.
+ * @return The size in bytes, or 0 for an invalid topology.
+ */
+size_t fossil_jellyfish_network_size(int32_t num_layers, const int32_t* neurons_per_layer);
+
+/**
+ * @brief Creates a neural network inside a caller-supplied buffer, without allocating.
+ *
+ * Weights are initialized as fossil_jellyfish_create_network does, on the calling
+ * thread, so construction never starts the thread pool either. The network lives
+ * in the buffer until the caller reuses it; fossil_jellyfish_free_network releases
+ * nothing and may be skipped. Library calls that later attach memory to the network
+ * (snapshots, packed weights, factorization) draw on whatever the buffer has left
+ * and fail once it runs out. fossil_jellyfish_forward on the network never reaches
+ * the heap; batch entry points take their temporaries from the scratch arena.
+ *
+ * @param buffer The memory, aligned to FOSSIL_JELLYFISH_STATIC_ALIGNMENT.
+ * @param size The size of the buffer in bytes.
+ * @param num_layers The number of layers in the network.
+ * @param neurons_per_layer An array containing the number of neurons in each layer.
+ * @param activations An array containing the activation functions for each layer.
+ * @return A pointer to the network, which starts inside the buffer, or NULL when the
+ *         buffer is misaligned or smaller than fossil_jellyfish_network_size.
+ */
+fossil_jellyfish_network_t* fossil_jellyfish_create_network_in(void* buffer, size_t size, int32_t num_layers, int32_t* neurons_per_layer,
+                                                               fossil_jellyfish_activation_t* activations);
+
+/**
+ * @brief Returns the exact number of bytes fossil_jellyfish_load_into needs for a file.
+ *
+ * Loads the file once on the heap to measure it, so call it on the build host or
+ * at startup rather than on a target without a heap.
+ *
+ * @param file_path The path to a saved network.
+ * @return The size in bytes, or 0 if the file cannot be loaded.
+ */
+size_t fossil_jellyfish_load_size(const char* file_path);
+
+/**
+ * @brief Loads a saved network into a caller-supplied buffer, without allocating.
+ *
+ * Accepts every file fossil_jellyfish_load does, with the same buffer rules as
+ * fossil_jellyfish_create_network_in. The network itself takes nothing from the
+ * heap, but the file is read through stdio: fopen allocates its FILE and, on glibc
+ * and newlib, the stream buffer from the C library's heap until the call returns.
+ * Use fossil_jellyfish_load_into_from_memory where no heap exists at all.
+ *
+ * @param file_path The path to a saved network.
+ * @param buffer The memory, aligned to FOSSIL_JELLYFISH_STATIC_ALIGNMENT.
+ * @param size The size of the buffer in bytes.
+ * @return A pointer to the network, or NULL when the file cannot be loaded or the
+ *         buffer is misaligned or too small.
+ */
+fossil_jellyfish_network_t* fossil_jellyfish_load_into(const char* file_path, void* buffer, size_t size);
+
+/**
+ * @brief Returns the exact number of bytes fossil_jellyfish_load_into_from_memory needs.
+ *
+ * Measures without allocating, and without stdio.
+ *
+ * @param image The bytes of a saved network, as fossil_jellyfish_save writes them.
+ * @param image_size The number of bytes in image.
+ * @return The size in bytes, or 0 if the image cannot be loaded.
+ */
+size_t fossil_jellyfish_load_size_from_memory(const void* image, size_t image_size);
+
+/**
+ * @brief Loads a saved network from a byte range into a caller-supplied buffer.
+ *
+ * Parses the image directly, so nothing is allocated from any heap and stdio is
+ * not used; the image can sit in flash or be linked into the program. The image
+ * needs no particular alignment and is not referenced after the call returns.
+ *
+ * @param buffer The memory, aligned to FOSSIL_JELLYFISH_STATIC_ALIGNMENT.
+ * @param size The size of the buffer in bytes.
+ * @param image The bytes of a saved network, as fossil_jellyfish_save writes them.
+ * @param image_size The number of bytes in image.
+ * @return A pointer to the network, or NULL when the image cannot be loaded or the
+ *         buffer is misaligned or too small.
+ */
+fossil_jellyfish_network_t* fossil_jellyfish_load_into_from_memory(void* buffer, size_t size, const void* image, size_t image_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_MEMORY_H */
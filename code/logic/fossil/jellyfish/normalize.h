@@ -0,0 +1,64 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_NORMALIZE_H
+#define FOSSIL_JELLYFISH_AI_NORMALIZE_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Function declarations
+
+/**
+ * @brief Makes the network standardize raw inputs, (x - mean) / std, as it loads them.
+ *
+ * Every forward pass, batched or not, applies it in the copy into the input layer,
+ * and fossil_jellyfish_save stores it with the model. Features with a zero standard
+ * deviation are only centered.
+ *
+ * @param network A pointer to the neural network.
+ * @param mean Per-feature means, or NULL to turn normalization off.
+ * @param std Per-feature standard deviations, none negative.
+ * @return 0 on success, -1 on error.
+ */
+int32_t fossil_jellyfish_set_normalization(fossil_jellyfish_network_t* network, const double* mean, const double* std);
+
+/**
+ * @brief Sets the normalization to the per-feature mean and standard deviation of a dataset.
+ *
+ * @param network A pointer to the neural network.
+ * @param inputs Row-major raw input samples.
+ * @param num_samples The number of samples, at least 1.
+ * @return 0 on success, -1 on error.
+ */
+int32_t fossil_jellyfish_fit_normalization(fossil_jellyfish_network_t* network, const double* inputs, int64_t num_samples);
+
+/**
+ * @brief Folds the normalization into the first layer's weights and biases and turns it off.
+ *
+ * Outputs stay the same up to rounding, and the input copy becomes a plain memcpy again.
+ * The first layer must be dense.
+ *
+ * @param network A pointer to the neural network.
+ * @return 0 on success or when there is nothing to fold, -1 on error.
+ */
+int32_t fossil_jellyfish_fold_normalization(fossil_jellyfish_network_t* network);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_NORMALIZE_H */
@@ -0,0 +1,130 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_ONLINE_H
+#define FOSSIL_JELLYFISH_AI_ONLINE_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of weight versions rotated between the writer and the readers
+#define FOSSIL_JELLYFISH_ONLINE_VERSIONS 3
+
+// Online learning settings
+typedef struct {
+    int32_t batch_size;            // Samples accumulated before each update
+    double learning_rate;
+    fossil_jellyfish_loss_t loss;
+} fossil_jellyfish_online_config_t;
+
+// Learner fed one sample or micro-batch at a time by a single writer thread
+typedef struct {
+    fossil_jellyfish_network_t* network;   // Master weights, touched only by the writer
+    fossil_jellyfish_online_config_t config;
+    int64_t num_parameters;
+    double* gradients;                     // Gradient sum of the pending samples
+    int32_t pending;                       // Samples accumulated since the last update
+    int32_t publish_pending;               // An update is waiting for a free version
+    uint64_t updates;                      // Updates applied to the master weights
+
+    // Published weights served to readers
+    fossil_jellyfish_network_t* versions[FOSSIL_JELLYFISH_ONLINE_VERSIONS];
+    uint64_t version_ids[FOSSIL_JELLYFISH_ONLINE_VERSIONS];
+    int32_t readers[FOSSIL_JELLYFISH_ONLINE_VERSIONS];
+    int32_t published;                     // Version new readers start on
+} fossil_jellyfish_online_t;
+
+// Function declarations
+
+/**
+ * @brief Creates an online learner training the given network in place.
+ *
+ * Every buffer is allocated here, so pushing samples and predicting never allocate.
+ * The network belongs to the learner until fossil_jellyfish_online_free and must
+ * not be snapshotted or trained by other means meanwhile.
+ *
+ * @param network A pointer to the neural network to train.
+ * @param config The online learning settings.
+ * @return A pointer to the learner, or NULL on error.
+ */
+fossil_jellyfish_online_t* fossil_jellyfish_online_create(fossil_jellyfish_network_t* network, const fossil_jellyfish_online_config_t* config);
+
+/**
+ * @brief Frees the learner and its published versions, but not the trained network.
+ *
+ * @param online A pointer to the learner.
+ */
+void fossil_jellyfish_online_free(fossil_jellyfish_online_t* online);
+
+/**
+ * @brief Learns from one sample; applies and publishes an update every batch_size samples.
+ *
+ * The cost is one forward and backward pass, plus one weight update and one weight
+ * copy at the cadence. It never waits for readers: when every spare version is still
+ * being read, publishing is retried on the next call.
+ *
+ * @param online A pointer to the learner.
+ * @param input The input vector.
+ * @param expected_output The expected output vector.
+ * @return 1 if a new version was published, 0 otherwise, -1 on error.
+ */
+int32_t fossil_jellyfish_online_push(fossil_jellyfish_online_t* online, const double* input, const double* expected_output);
+
+/**
+ * @brief Learns from a micro-batch of samples as consecutive fossil_jellyfish_online_push calls.
+ *
+ * @param online A pointer to the learner.
+ * @param inputs num_samples input vectors.
+ * @param expected_output num_samples expected output vectors.
+ * @param num_samples The number of samples.
+ * @return The number of versions published, or -1 on error.
+ */
+int32_t fossil_jellyfish_online_push_batch(fossil_jellyfish_online_t* online, const double* inputs, const double* expected_output, int32_t num_samples);
+
+/**
+ * @brief Returns the number of doubles of scratch a reader passes to fossil_jellyfish_online_predict.
+ *
+ * @param online A pointer to the learner.
+ * @return The scratch size in doubles.
+ */
+size_t fossil_jellyfish_online_scratch_size(const fossil_jellyfish_online_t* online);
+
+/**
+ * @brief Runs inference on the latest published version; safe from any number of threads.
+ *
+ * The whole pass uses a single version, which is not overwritten while it is read.
+ *
+ * @param online A pointer to the learner.
+ * @param input The input vector.
+ * @param output Receives the output vector.
+ * @param scratch Caller-owned buffer of fossil_jellyfish_online_scratch_size doubles.
+ * @return The id of the version used; it counts published updates.
+ */
+uint64_t fossil_jellyfish_online_predict(fossil_jellyfish_online_t* online, const double* input, double* output, double* scratch);
+
+/**
+ * @brief Returns the id of the latest published version.
+ *
+ * @param online A pointer to the learner.
+ * @return The version id.
+ */
+uint64_t fossil_jellyfish_online_version(fossil_jellyfish_online_t* online);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_ONLINE_H */
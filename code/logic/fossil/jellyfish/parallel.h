@@ -0,0 +1,90 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_PARALLEL_H
+#define FOSSIL_JELLYFISH_AI_PARALLEL_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Work item run by the thread pool on the half-open index range [begin, end).
+ * thread_index is stable for the duration of one parallel_for call. It is smaller
+ * than the thread count the pool runs with, which another thread can change
+ * between the caller sizing per-thread results and the call starting; pass the
+ * count the results were sized for to fossil_jellyfish_parallel_for_bounded.
+ */
+typedef void (*fossil_jellyfish_task_t)(void* context, int64_t begin, int64_t end, int32_t thread_index);
+
+// Function declarations
+
+/**
+ * @brief Sets the number of threads used by the library thread pool.
+ *
+ * Safe to call while other threads run parallel work: it waits for the current
+ * call to finish, and later calls start the pool at the new size.
+ *
+ * @param num_threads The thread count including the calling thread; 0 selects the hardware concurrency.
+ */
+void fossil_jellyfish_set_num_threads(int32_t num_threads);
+
+/**
+ * @brief Returns the number of threads used by the library thread pool.
+ *
+ * @return The thread count including the calling thread.
+ */
+int32_t fossil_jellyfish_get_num_threads(void);
+
+/**
+ * @brief Splits [0, count) into chunks of grain indices and runs them on the thread pool.
+ *
+ * The calling thread takes part in the work and the call returns once every chunk is done.
+ * Work that fits into a single chunk, nested calls from inside a task and calls made while
+ * another thread owns the pool run inline on the calling thread as thread_index 0.
+ *
+ * @param count The number of indices to process.
+ * @param grain The minimum number of indices handed to a thread at once.
+ * @param task The function to run on each chunk.
+ * @param context Opaque pointer handed to every task invocation.
+ */
+void fossil_jellyfish_parallel_for(int64_t count, int64_t grain, fossil_jellyfish_task_t task, void* context);
+
+/**
+ * @brief fossil_jellyfish_parallel_for with every thread_index below max_threads.
+ *
+ * Read fossil_jellyfish_get_num_threads once, size per-thread results from it and
+ * pass the same value here. Workers at or above the bound skip the call, so a
+ * concurrent fossil_jellyfish_set_num_threads cannot index past the results.
+ *
+ * @param count The number of indices to process.
+ * @param grain The minimum number of indices handed to a thread at once.
+ * @param max_threads The number of per-thread slots the task may select from.
+ * @param task The function to run on each chunk.
+ * @param context Opaque pointer handed to every task invocation.
+ */
+void fossil_jellyfish_parallel_for_bounded(int64_t count, int64_t grain, int32_t max_threads, fossil_jellyfish_task_t task, void* context);
+
+/**
+ * @brief Stops and joins the worker threads; the pool restarts lazily on the next parallel call.
+ */
+void fossil_jellyfish_shutdown_threads(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_PARALLEL_H */
@@ -0,0 +1,194 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_PLAN_H
+#define FOSSIL_JELLYFISH_AI_PLAN_H
+
+#include <stdio.h>
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Weight kernels a plan step can run
+typedef enum {
+    KERNEL_DENSE,          // Row-major weights read in place
+    KERNEL_DENSE_PACKED,   // Panels of FOSSIL_JELLYFISH_PANEL_WIDTH neurons interleaved by input
+    KERNEL_SPARSE,         // Compressed sparse rows of the nonzero weights
+    KERNEL_HASHED          // Weights rehashed from a hashed layer's real weights
+} fossil_jellyfish_kernel_kind_t;
+
+// Compile settings
+typedef struct {
+    int32_t disable_packing;     // Keep every dense layer on KERNEL_DENSE
+    double sparse_threshold;     // Densities at or below this use KERNEL_SPARSE; 0 never does
+    FILE* log;                   // Receives the kernel choices when not NULL
+    int32_t autotune;            // Benchmark the candidate kernels of each dense layer instead of the two rules above
+    const char* tuning_cache;    // Per-host file of tuned winners, reused and extended when autotuning; may be NULL
+} fossil_jellyfish_compile_options_t;
+
+typedef struct fossil_jellyfish_plan_step fossil_jellyfish_plan_step_t;
+
+// Computes y = W x for rows of x, biases excluded
+typedef void (*fossil_jellyfish_matvec_kernel_t)(const fossil_jellyfish_plan_step_t* step, const double* inputs, int64_t rows, double* outputs);
+
+// Computes errors = W^T deltas for one row
+typedef void (*fossil_jellyfish_transpose_kernel_t)(const fossil_jellyfish_plan_step_t* step, const double* deltas, double* errors);
+
+// One layer of the plan
+struct fossil_jellyfish_plan_step {
+    int32_t layer;
+    int32_t fan_in;
+    int32_t fan_out;
+    fossil_jellyfish_kernel_kind_t kind;
+    fossil_jellyfish_matvec_kernel_t matvec;
+    fossil_jellyfish_transpose_kernel_t transpose;
+    void (*activate)(double* values, int32_t count);
+    void (*activate_backward)(const double* outputs, double* gradients, int32_t count);
+    const char* kernel_name;
+    const char* activation_name;
+    const char* selection;                    // How the kernel was picked: "fixed", "heuristic", "tuned" or "cached"
+    const fossil_jellyfish_layer_t* source;   // The network layer, for dense weights and biases
+    double* packed;                           // Packed panels or sparse values, owned
+    int32_t* indices;                         // Sparse: row starts, then input indices, owned
+    int64_t nonzeros;
+    int32_t buffer;                           // Forward scratch buffer written: 0 or 1, -1 for the output
+    size_t offset;                            // Where the step's outputs sit in the backward scratch
+    size_t gradient_offset;                   // Where the layer's weight gradients start in the flat layout
+};
+
+// Immutable execution plan of a network
+typedef struct {
+    const fossil_jellyfish_network_t* network;
+    fossil_jellyfish_allocator_t allocator;   // The network's; the steps' packed and sparse arrays come from it
+    fossil_jellyfish_compile_options_t options;
+    int32_t num_steps;
+    fossil_jellyfish_plan_step_t* steps;
+    int32_t input_width;
+    int32_t output_width;
+    size_t buffer_size;       // Doubles per forward buffer: one row block of the widest layer
+    size_t activation_size;   // Doubles of every layer's outputs for one sample
+} fossil_jellyfish_plan_t;
+
+// Function declarations
+
+/**
+ * @brief Returns the default compile settings: packing on, sparse at 30% density or less,
+ *        no log, no autotuning.
+ *
+ * @return The settings.
+ */
+fossil_jellyfish_compile_options_t fossil_jellyfish_compile_defaults(void);
+
+/**
+ * @brief Compiles a network into an execution plan.
+ *
+ * Each layer gets a weight kernel picked by kind, shape and measured sparsity, its
+ * activation kernel, prepacked weights where the kernel wants them, and a buffer.
+ *
+ * With autotune set, each dense layer instead times every candidate kernel on a block
+ * of rows and keeps the fastest. Winners are keyed by CPU model, layer shape, density
+ * and candidate set; with a tuning cache they are read from that file and new ones are
+ * appended to it, so each shape is timed once per host.
+ * The plan reads biases and unpacked weights from the network, which must outlive it;
+ * after the weights change, call fossil_jellyfish_plan_refresh. Packed and sparse
+ * copies of the weights come from the network's allocator, as its own packed weights
+ * do, so a network built in a fixed buffer needs room there for them.
+ *
+ * @param network A pointer to the neural network.
+ * @param options The settings, or NULL for fossil_jellyfish_compile_defaults.
+ * @return A pointer to the plan, or NULL on error.
+ */
+fossil_jellyfish_plan_t* fossil_jellyfish_compile(const fossil_jellyfish_network_t* network, const fossil_jellyfish_compile_options_t* options);
+
+/**
+ * @brief Frees the plan.
+ *
+ * @param plan A pointer to the plan.
+ */
+void fossil_jellyfish_plan_free(fossil_jellyfish_plan_t* plan);
+
+/**
+ * @brief Repacks the plan's weights from the network after training.
+ *
+ * Sparse layers are measured again, since training fills in zeros, and may move
+ * to a dense kernel; every other kernel choice is kept.
+ *
+ * @param plan A pointer to the plan.
+ * @return 0 on success, -1 if the network's shape changed or on allocation failure.
+ */
+int32_t fossil_jellyfish_plan_refresh(fossil_jellyfish_plan_t* plan);
+
+/**
+ * @brief Returns the scratch doubles fossil_jellyfish_plan_forward and
+ *        fossil_jellyfish_plan_accumulate_gradients need.
+ *
+ * @param plan A pointer to the plan.
+ * @return The number of doubles.
+ */
+size_t fossil_jellyfish_plan_scratch_size(const fossil_jellyfish_plan_t* plan);
+
+/**
+ * @brief Runs the plan on rows of raw inputs; several threads may share one plan.
+ *
+ * @param plan A pointer to the plan.
+ * @param inputs Row-major input rows.
+ * @param rows The number of rows.
+ * @param outputs Receives the output rows.
+ * @param scratch At least fossil_jellyfish_plan_scratch_size(plan) doubles.
+ */
+void fossil_jellyfish_plan_forward(const fossil_jellyfish_plan_t* plan, const double* inputs, int64_t rows, double* outputs, double* scratch);
+
+/**
+ * @brief Adds one sample's loss gradient to a flat gradient array, running the plan both ways.
+ *
+ * The layout matches fossil_jellyfish_accumulate_gradients, so the sum goes to
+ * fossil_jellyfish_apply_gradients. Several threads may share one plan.
+ *
+ * @param plan A pointer to the plan.
+ * @param input The raw input vector.
+ * @param expected_output The expected output vector.
+ * @param loss The loss function.
+ * @param gradients The flat gradient array to add to.
+ * @param scratch At least fossil_jellyfish_plan_scratch_size(plan) doubles.
+ */
+void fossil_jellyfish_plan_accumulate_gradients(const fossil_jellyfish_plan_t* plan, const double* input, const double* expected_output, fossil_jellyfish_loss_t loss, double* gradients, double* scratch);
+
+/**
+ * @brief Writes one line per step with its shape, kernels, density and buffer.
+ *
+ * @param plan A pointer to the plan.
+ * @param stream The stream to write to.
+ */
+void fossil_jellyfish_plan_describe(const fossil_jellyfish_plan_t* plan, FILE* stream);
+
+/**
+ * @brief Keeps a panel-major copy of every dense layer's weights next to the row-major one.
+ *
+ * Panels hold FOSSIL_JELLYFISH_PANEL_WIDTH neurons interleaved by input, the layout the
+ * packed kernels read, so fossil_jellyfish_forward, fossil_jellyfish_forward_batch and
+ * compiled plans run on them without packing per call. Layers narrower than a panel
+ * stay unpacked. Anything that writes the weights through the library, and
+ * fossil_jellyfish_make_writable, drops the copies; clones and snapshots start without them.
+ *
+ * @param network A pointer to the neural network.
+ * @return 0 on success, -1 if memory could not be allocated.
+ */
+int32_t fossil_jellyfish_pack_weights(fossil_jellyfish_network_t* network);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_PLAN_H */
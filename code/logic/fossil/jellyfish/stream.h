@@ -0,0 +1,96 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_STREAM_H
+#define FOSSIL_JELLYFISH_AI_STREAM_H
+
+#include "jellyfish.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sliding-window inference over a signal fed one sample at a time
+typedef struct {
+    fossil_jellyfish_network_t* network;
+    int32_t window;          // Samples per window
+    int32_t channels;        // Values per sample; the input layer holds window * channels
+    int64_t num_pushed;      // Samples pushed since creation or the last reset
+    int32_t tied;            // The first layer weights every position alike, so running sums suffice
+    double* pending;         // Ring of window rows of first-layer sums, one per window still filling
+    double* values;          // Untied: the newest sample at every position; tied: the last window
+    double* totals;          // Tied: per channel, the sum of the standardized window
+} fossil_jellyfish_stream_t;
+
+// Function declarations
+
+/**
+ * @brief Creates a stream whose windows are the network's inputs.
+ *
+ * Input feature p * channels + c is channel c of the sample at position p, the oldest
+ * sample at position 0.
+ *
+ * When the first layer is dense and gives channel c the same weight at every position,
+ * with the same standardization, as a temporal pooling layer does, the stream keeps one
+ * running sum per channel: the newest sample is added, the oldest subtracted, and the
+ * first layer costs width * channels per step instead of width * window * channels.
+ * The sums are recomputed from the window once per window to bound rounding drift, so
+ * outputs match fossil_jellyfish_forward to rounding rather than bit for bit.
+ *
+ * Any other first layer weights a sample differently at each position, so the oldest
+ * sample cannot be subtracted out. Each pushed sample then adds its products to the
+ * first-layer sums of every window it will belong to. That is the same arithmetic per
+ * step as running the first layer on every window; only the window copy and its
+ * standardization are saved. Layers after the first run in full on every window.
+ *
+ * @param network A pointer to the neural network, with at least one layer after the input.
+ * @param window The number of samples per window, dividing the input width.
+ * @return A pointer to the stream, or NULL on error.
+ */
+fossil_jellyfish_stream_t* fossil_jellyfish_stream_create(fossil_jellyfish_network_t* network, int32_t window);
+
+/**
+ * @brief Frees the stream; the network is left alone.
+ *
+ * @param stream A pointer to the stream; NULL is ignored.
+ */
+void fossil_jellyfish_stream_free(fossil_jellyfish_stream_t* stream);
+
+/**
+ * @brief Forgets every pushed sample, as when a new signal starts.
+ *
+ * @param stream A pointer to the stream.
+ */
+void fossil_jellyfish_stream_reset(fossil_jellyfish_stream_t* stream);
+
+/**
+ * @brief Pushes one sample and runs the window it completes.
+ *
+ * Without a tied first layer the outputs match fossil_jellyfish_forward on a copy of
+ * the window bit for bit. Hidden layer buffers are filled as by
+ * fossil_jellyfish_forward_into. Sums already pending keep the weights they were
+ * started with, and whether the first layer is tied is decided at creation and reset,
+ * so reset the stream after training the first layer or changing the normalization.
+ *
+ * @param stream A pointer to the stream.
+ * @param sample The channels values of the newest sample.
+ * @param output Receives the outputs of the window ending at this sample.
+ * @return 1 when output was written, 0 while the first window is still filling.
+ */
+int32_t fossil_jellyfish_stream_push(fossil_jellyfish_stream_t* stream, const double* sample, double* output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_JELLYFISH_AI_STREAM_H */
@@ -0,0 +1,518 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/graph.h"
+#include "fossil/jellyfish/parallel.h"
+#include "internal.h"
+#include <string.h>
+
+// Multiply-adds handed to one thread when a single dense node is split by neurons
+#define JELLYFISH_GRAPH_GRAIN_WORK ((int64_t)1 << 15)
+
+typedef struct {
+    fossil_jellyfish_graph_t* graph;
+    double** values;
+    const double* input;
+    int32_t node;       // Dense node split by neurons, or -1 to run whole nodes of a level
+    int32_t level;
+} jellyfish_graph_run_t;
+
+static void jellyfish_graph_free_plan(fossil_jellyfish_graph_t* graph) {
+    jellyfish_free(graph->level_order);
+    jellyfish_free(graph->level_start);
+    jellyfish_free(graph->buffers);
+    jellyfish_free(graph->activations);
+    jellyfish_free(graph->gradients);
+    jellyfish_free(graph->inference_values);
+    jellyfish_free(graph->training_values);
+    jellyfish_free(graph->node_gradients);
+    graph->level_order = NULL;
+    graph->level_start = NULL;
+    graph->buffers = NULL;
+    graph->activations = NULL;
+    graph->gradients = NULL;
+    graph->inference_values = NULL;
+    graph->training_values = NULL;
+    graph->node_gradients = NULL;
+    graph->num_levels = 0;
+    graph->num_buffers = 0;
+    graph->compiled = 0;
+}
+
+fossil_jellyfish_graph_t* fossil_jellyfish_graph_create(void) {
+    fossil_jellyfish_graph_t* graph = (fossil_jellyfish_graph_t*)jellyfish_calloc(1, sizeof(fossil_jellyfish_graph_t));
+    if (graph) {
+        graph->output = -1;
+    }
+    return graph;
+}
+
+void fossil_jellyfish_graph_free(fossil_jellyfish_graph_t* graph) {
+    if (!graph) {
+        return;
+    }
+    for (int32_t i = 0; i < graph->num_nodes; i++) {
+        fossil_jellyfish_node_t* node = &graph->nodes[i];
+        if (node->owns_params) {
+            jellyfish_free(node->weights);
+            jellyfish_free(node->biases);
+        }
+        jellyfish_free(node->inputs);
+    }
+    jellyfish_graph_free_plan(graph);
+    jellyfish_free(graph->nodes);
+    jellyfish_free(graph);
+}
+
+// Appends a node without parameters and returns its index
+static int32_t jellyfish_graph_push(fossil_jellyfish_graph_t* graph, fossil_jellyfish_node_kind_t kind, int32_t width, const int32_t* inputs, int32_t num_inputs, fossil_jellyfish_activation_t activation) {
+    if (width <= 0) {
+        return -1;
+    }
+    for (int32_t i = 0; i < num_inputs; i++) {
+        if (inputs[i] < 0 || inputs[i] >= graph->num_nodes) {
+            return -1;
+        }
+    }
+
+    if (graph->num_nodes == graph->capacity) {
+        int32_t capacity = graph->capacity ? 2 * graph->capacity : 16;
+        fossil_jellyfish_node_t* nodes = (fossil_jellyfish_node_t*)jellyfish_realloc(graph->nodes, (size_t)graph->capacity * sizeof(fossil_jellyfish_node_t),
+                                                                                 (size_t)capacity * sizeof(fossil_jellyfish_node_t));
+        if (!nodes) {
+            return -1;
+        }
+        graph->nodes = nodes;
+        graph->capacity = capacity;
+    }
+
+    fossil_jellyfish_node_t* node = &graph->nodes[graph->num_nodes];
+    memset(node, 0, sizeof(*node));
+    node->kind = kind;
+    node->width = width;
+    node->activation = activation;
+    node->num_inputs = num_inputs;
+    if (num_inputs > 0) {
+        node->inputs = (int32_t*)jellyfish_malloc((size_t)num_inputs * sizeof(int32_t));
+        if (!node->inputs) {
+            return -1;
+        }
+        memcpy(node->inputs, inputs, (size_t)num_inputs * sizeof(int32_t));
+    }
+
+    jellyfish_graph_free_plan(graph);
+    return graph->num_nodes++;
+}
+
+int32_t fossil_jellyfish_graph_add_input(fossil_jellyfish_graph_t* graph, int32_t width) {
+    int32_t index = jellyfish_graph_push(graph, NODE_INPUT, width, NULL, 0, ACTIVATION_LINEAR);
+    if (index >= 0) {
+        graph->nodes[index].offset = graph->input_width;
+        graph->input_width += width;
+    }
+    return index;
+}
+
+int32_t fossil_jellyfish_graph_add_dense(fossil_jellyfish_graph_t* graph, int32_t input, int32_t width, fossil_jellyfish_activation_t activation) {
+    int32_t index = jellyfish_graph_push(graph, NODE_DENSE, width, &input, 1, activation);
+    if (index < 0) {
+        return -1;
+    }
+
+    fossil_jellyfish_node_t* node = &graph->nodes[index];
+    int64_t fan_in = graph->nodes[input].width;
+    node->weights = (double*)jellyfish_malloc((size_t)(width * fan_in) * sizeof(double));
+    node->biases = (double*)jellyfish_calloc((size_t)width, sizeof(double));
+    node->owns_params = 1;
+    if (!node->weights || !node->biases) {
+        jellyfish_free(node->weights);
+        jellyfish_free(node->biases);
+        jellyfish_free(node->inputs);
+        graph->num_nodes--;
+        return -1;
+    }
+    jellyfish_init_weights(node->weights, width, fan_in, activation, INIT_AUTO,
+                           jellyfish_mix64(FOSSIL_JELLYFISH_DEFAULT_SEED + (uint64_t)index * JELLYFISH_GOLDEN_GAMMA));
+    return index;
+}
+
+int32_t fossil_jellyfish_graph_add_sum(fossil_jellyfish_graph_t* graph, const int32_t* inputs, int32_t num_inputs, fossil_jellyfish_activation_t activation) {
+    if (num_inputs < 1 || inputs[0] < 0 || inputs[0] >= graph->num_nodes) {
+        return -1;
+    }
+    int32_t width = graph->nodes[inputs[0]].width;
+    for (int32_t i = 1; i < num_inputs; i++) {
+        if (inputs[i] < 0 || inputs[i] >= graph->num_nodes || graph->nodes[inputs[i]].width != width) {
+            return -1;
+        }
+    }
+    return jellyfish_graph_push(graph, NODE_SUM, width, inputs, num_inputs, activation);
+}
+
+int32_t fossil_jellyfish_graph_add_concat(fossil_jellyfish_graph_t* graph, const int32_t* inputs, int32_t num_inputs) {
+    int32_t width = 0;
+    if (num_inputs < 1) {
+        return -1;
+    }
+    for (int32_t i = 0; i < num_inputs; i++) {
+        if (inputs[i] < 0 || inputs[i] >= graph->num_nodes) {
+            return -1;
+        }
+        width += graph->nodes[inputs[i]].width;
+    }
+    return jellyfish_graph_push(graph, NODE_CONCAT, width, inputs, num_inputs, ACTIVATION_LINEAR);
+}
+
+void fossil_jellyfish_graph_set_output(fossil_jellyfish_graph_t* graph, int32_t node) {
+    if (node >= 0 && node < graph->num_nodes) {
+        graph->output = node;
+        jellyfish_graph_free_plan(graph);
+    }
+}
+
+int32_t fossil_jellyfish_graph_compile(fossil_jellyfish_graph_t* graph) {
+    int32_t n = graph->num_nodes;
+    jellyfish_graph_free_plan(graph);
+    if (n == 0) {
+        return -1;
+    }
+    if (graph->output < 0) {
+        graph->output = n - 1;
+    }
+
+    // Levels: creation order is already topological, so one pass suffices
+    int32_t max_level = 0;
+    size_t total_values = 0;
+    graph->buffer_width = 0;
+    for (int32_t i = 0; i < n; i++) {
+        fossil_jellyfish_node_t* node = &graph->nodes[i];
+        node->level = 0;
+        for (int32_t k = 0; k < node->num_inputs; k++) {
+            int32_t level = graph->nodes[node->inputs[k]].level + 1;
+            node->level = level > node->level ? level : node->level;
+        }
+        node->last_use = node->level;
+        max_level = node->level > max_level ? node->level : max_level;
+        graph->buffer_width = node->width > graph->buffer_width ? node->width : graph->buffer_width;
+        total_values += (size_t)node->width;
+    }
+    for (int32_t i = 0; i < n; i++) {
+        fossil_jellyfish_node_t* node = &graph->nodes[i];
+        for (int32_t k = 0; k < node->num_inputs; k++) {
+            fossil_jellyfish_node_t* producer = &graph->nodes[node->inputs[k]];
+            producer->last_use = node->level > producer->last_use ? node->level : producer->last_use;
+        }
+    }
+    graph->nodes[graph->output].last_use = max_level + 1;
+
+    graph->num_levels = max_level + 1;
+    graph->level_order = (int32_t*)jellyfish_malloc((size_t)n * sizeof(int32_t));
+    graph->level_start = (int32_t*)jellyfish_calloc((size_t)graph->num_levels + 1, sizeof(int32_t));
+    int32_t* free_list = (int32_t*)jellyfish_malloc((size_t)n * sizeof(int32_t));
+    graph->inference_values = (double**)jellyfish_malloc((size_t)n * sizeof(double*));
+    graph->training_values = (double**)jellyfish_malloc((size_t)n * sizeof(double*));
+    graph->node_gradients = (double**)jellyfish_malloc((size_t)n * sizeof(double*));
+    graph->activations = (double*)jellyfish_calloc(total_values, sizeof(double));
+    graph->gradients = (double*)jellyfish_calloc(total_values, sizeof(double));
+    if (!graph->level_order || !graph->level_start || !free_list || !graph->inference_values ||
+        !graph->training_values || !graph->node_gradients || !graph->activations || !graph->gradients) {
+        jellyfish_free(free_list);
+        jellyfish_graph_free_plan(graph);
+        return -1;
+    }
+
+    // Group nodes by level with a counting sort
+    for (int32_t i = 0; i < n; i++) {
+        graph->level_start[graph->nodes[i].level + 1]++;
+    }
+    for (int32_t l = 0; l < graph->num_levels; l++) {
+        graph->level_start[l + 1] += graph->level_start[l];
+    }
+    int32_t* fill = free_list;
+    memcpy(fill, graph->level_start, (size_t)graph->num_levels * sizeof(int32_t));
+    for (int32_t i = 0; i < n; i++) {
+        graph->level_order[fill[graph->nodes[i].level]++] = i;
+    }
+
+    // Inference buffers: take a released buffer when one exists, release after the last reader's level
+    int32_t num_free = 0;
+    graph->num_buffers = 0;
+    for (int32_t l = 0; l < graph->num_levels; l++) {
+        for (int32_t p = graph->level_start[l]; p < graph->level_start[l + 1]; p++) {
+            fossil_jellyfish_node_t* node = &graph->nodes[graph->level_order[p]];
+            node->buffer = num_free > 0 ? free_list[--num_free] : graph->num_buffers++;
+        }
+        for (int32_t i = 0; i < n; i++) {
+            if (graph->nodes[i].last_use == l && graph->nodes[i].level <= l) {
+                free_list[num_free++] = graph->nodes[i].buffer;
+            }
+        }
+    }
+    jellyfish_free(free_list);
+
+    graph->buffers = (double*)jellyfish_calloc((size_t)graph->num_buffers * (size_t)graph->buffer_width, sizeof(double));
+    if (!graph->buffers) {
+        jellyfish_graph_free_plan(graph);
+        return -1;
+    }
+
+    size_t offset = 0;
+    for (int32_t i = 0; i < n; i++) {
+        graph->inference_values[i] = graph->buffers + (size_t)graph->nodes[i].buffer * (size_t)graph->buffer_width;
+        graph->training_values[i] = graph->activations + offset;
+        graph->node_gradients[i] = graph->gradients + offset;
+        offset += (size_t)graph->nodes[i].width;
+    }
+
+    graph->compiled = 1;
+    return 0;
+}
+
+// Pre-activations of neurons [begin, end); the caller activates the whole node once every range is done
+static void jellyfish_graph_dense(const fossil_jellyfish_node_t* node, const double* restrict x, int32_t fan_in, double* restrict y, int32_t begin, int32_t end) {
+    for (int32_t j = begin; j < end; j++) {
+        const double* restrict w = node->weights + (size_t)j * (size_t)fan_in;
+        double weighted_sum = 0;
+        for (int32_t k = 0; k < fan_in; k++) {
+            weighted_sum += x[k] * w[k];
+        }
+        y[j] = weighted_sum + node->biases[j];
+    }
+}
+
+static void jellyfish_graph_run_node(fossil_jellyfish_graph_t* graph, double** values, const double* input, int32_t index) {
+    const fossil_jellyfish_node_t* node = &graph->nodes[index];
+    double* y = values[index];
+
+    switch (node->kind) {
+        case NODE_INPUT:
+            memcpy(y, input + node->offset, (size_t)node->width * sizeof(double));
+            break;
+        case NODE_DENSE:
+            jellyfish_graph_dense(node, values[node->inputs[0]], graph->nodes[node->inputs[0]].width, y, 0, node->width);
+            fossil_jellyfish_activate_vector(y, node->width, node->activation);
+            break;
+        case NODE_SUM:
+            memcpy(y, values[node->inputs[0]], (size_t)node->width * sizeof(double));
+            for (int32_t k = 1; k < node->num_inputs; k++) {
+                const double* x = values[node->inputs[k]];
+                for (int32_t j = 0; j < node->width; j++) {
+                    y[j] += x[j];
+                }
+            }
+            fossil_jellyfish_activate_vector(y, node->width, node->activation);
+            break;
+        case NODE_CONCAT:
+            for (int32_t k = 0; k < node->num_inputs; k++) {
+                int32_t width = graph->nodes[node->inputs[k]].width;
+                memcpy(y, values[node->inputs[k]], (size_t)width * sizeof(double));
+                y += width;
+            }
+            break;
+    }
+}
+
+static void jellyfish_graph_task(void* context, int64_t begin, int64_t end, int32_t thread_index) {
+    jellyfish_graph_run_t* run = (jellyfish_graph_run_t*)context;
+    fossil_jellyfish_graph_t* graph = run->graph;
+    (void)thread_index;
+
+    if (run->node >= 0) {
+        const fossil_jellyfish_node_t* node = &graph->nodes[run->node];
+        int32_t producer = node->inputs[0];
+        jellyfish_graph_dense(node, run->values[producer], graph->nodes[producer].width, run->values[run->node], (int32_t)begin, (int32_t)end);
+        return;
+    }
+    for (int64_t p = begin; p < end; p++) {
+        jellyfish_graph_run_node(graph, run->values, run->input, graph->level_order[graph->level_start[run->level] + p]);
+    }
+}
+
+// Runs the levels in order; independent nodes of a level run side by side
+static void jellyfish_graph_execute(fossil_jellyfish_graph_t* graph, double** values, const double* input) {
+    jellyfish_graph_run_t run;
+    run.graph = graph;
+    run.values = values;
+    run.input = input;
+
+    for (int32_t l = 0; l < graph->num_levels; l++) {
+        int32_t count = graph->level_start[l + 1] - graph->level_start[l];
+        run.level = l;
+        run.node = -1;
+
+        if (count == 1) {
+            int32_t index = graph->level_order[graph->level_start[l]];
+            const fossil_jellyfish_node_t* node = &graph->nodes[index];
+            if (node->kind == NODE_DENSE) {
+                int64_t fan_in = graph->nodes[node->inputs[0]].width;
+                run.node = index;
+                fossil_jellyfish_parallel_for(node->width, JELLYFISH_GRAPH_GRAIN_WORK / (fan_in > 0 ? fan_in : 1), jellyfish_graph_task, &run);
+                fossil_jellyfish_activate_vector(values[index], node->width, node->activation);
+                continue;
+            }
+        }
+        fossil_jellyfish_parallel_for(count, 1, jellyfish_graph_task, &run);
+    }
+}
+
+// Points the linked dense nodes at their layers' current arrays, which training or a
+// snapshot may have replaced; writable first detaches them as chain training does
+static int32_t jellyfish_graph_bind(fossil_jellyfish_graph_t* graph, int32_t writable) {
+    fossil_jellyfish_network_t* network = graph->network;
+    if (!network) {
+        return 0;
+    }
+    if (network->input_mean) {
+        return -1;
+    }
+    for (int32_t i = 0; i < graph->num_nodes; i++) {
+        fossil_jellyfish_node_t* node = &graph->nodes[i];
+        if (node->layer <= 0) {
+            continue;
+        }
+        if (node->layer >= network->num_layers) {
+            return -1;
+        }
+        const fossil_jellyfish_layer_t* layer = network->layers[node->layer];
+        if (layer->kind != LAYER_DENSE || layer->num_neurons != node->width ||
+            network->layers[node->layer - 1]->num_neurons != graph->nodes[node->inputs[0]].width) {
+            return -1;
+        }
+        if (writable && jellyfish_layer_make_writable(network, node->layer, 1) != 0) {
+            return -1;
+        }
+        node->weights = layer->weights;
+        node->biases = layer->biases;
+    }
+    return 0;
+}
+
+int32_t fossil_jellyfish_graph_forward(fossil_jellyfish_graph_t* graph, const double* input, double* output) {
+    if (!graph->compiled && fossil_jellyfish_graph_compile(graph) != 0) {
+        return -1;
+    }
+    if (jellyfish_graph_bind(graph, 0) != 0) {
+        return -1;
+    }
+    jellyfish_graph_execute(graph, graph->inference_values, input);
+    memcpy(output, graph->inference_values[graph->output], (size_t)graph->nodes[graph->output].width * sizeof(double));
+    return 0;
+}
+
+int32_t fossil_jellyfish_graph_train_step(fossil_jellyfish_graph_t* graph, const double* input, const double* expected_output, double learning_rate, fossil_jellyfish_loss_t loss) {
+    if (!graph->compiled && fossil_jellyfish_graph_compile(graph) != 0) {
+        return -1;
+    }
+    if (jellyfish_graph_bind(graph, 1) != 0) {
+        return -1;
+    }
+    double** values = graph->training_values;
+    double** gradients = graph->node_gradients;
+    int32_t out = graph->output;
+
+    jellyfish_graph_execute(graph, values, input);
+
+    // Gradients with respect to node values, accumulated over every consumer
+    size_t total = (size_t)(gradients[graph->num_nodes - 1] - graph->gradients) + (size_t)graph->nodes[graph->num_nodes - 1].width;
+    memset(graph->gradients, 0, total * sizeof(double));
+    fossil_jellyfish_loss_gradient(loss, values[out], expected_output, gradients[out], 1, graph->nodes[out].width);
+
+    for (int32_t i = out; i >= 0; i--) {
+        fossil_jellyfish_node_t* node = &graph->nodes[i];
+        double* g = gradients[i];
+        const double* y = values[i];
+
+        if (node->kind == NODE_DENSE || node->kind == NODE_SUM) {
+            fossil_jellyfish_activation_backward(y, g, node->width, node->activation);
+        }
+
+        if (node->kind == NODE_DENSE) {
+            int32_t producer = node->inputs[0];
+            int32_t fan_in = graph->nodes[producer].width;
+            const double* x = values[producer];
+            double* gx = gradients[producer];
+            for (int32_t j = 0; j < node->width; j++) {
+                double* w = node->weights + (size_t)j * (size_t)fan_in;
+                double step = learning_rate * g[j];
+                for (int32_t k = 0; k < fan_in; k++) {
+                    gx[k] += w[k] * g[j];
+                    w[k] -= step * x[k];
+                }
+                node->biases[j] -= step;
+            }
+        } else if (node->kind == NODE_SUM) {
+            for (int32_t k = 0; k < node->num_inputs; k++) {
+                double* gx = gradients[node->inputs[k]];
+                for (int32_t j = 0; j < node->width; j++) {
+                    gx[j] += g[j];
+                }
+            }
+        } else if (node->kind == NODE_CONCAT) {
+            for (int32_t k = 0; k < node->num_inputs; k++) {
+                int32_t width = graph->nodes[node->inputs[k]].width;
+                double* gx = gradients[node->inputs[k]];
+                for (int32_t j = 0; j < width; j++) {
+                    gx[j] += g[j];
+                }
+                g += width;
+            }
+        }
+    }
+    return 0;
+}
+
+int32_t fossil_jellyfish_graph_train(fossil_jellyfish_graph_t* graph, const double* inputs, const double* expected_output, int32_t num_samples, int32_t num_epochs, double learning_rate, fossil_jellyfish_loss_t loss) {
+    if (!graph->compiled && fossil_jellyfish_graph_compile(graph) != 0) {
+        return -1;
+    }
+    int32_t out_width = graph->nodes[graph->output].width;
+    for (int32_t epoch = 0; epoch < num_epochs; epoch++) {
+        for (int32_t i = 0; i < num_samples; i++) {
+            if (fossil_jellyfish_graph_train_step(graph, &inputs[(size_t)i * (size_t)graph->input_width], &expected_output[(size_t)i * (size_t)out_width], learning_rate, loss) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+fossil_jellyfish_graph_t* fossil_jellyfish_graph_from_network(fossil_jellyfish_network_t* network) {
+    if (network->num_layers < 1 || network->input_mean) {
+        return NULL;
+    }
+    // Dense nodes index their weights as a full matrix
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        if (network->layers[i]->kind != LAYER_DENSE) {
+            return NULL;
+        }
+    }
+    fossil_jellyfish_graph_t* graph = fossil_jellyfish_graph_create();
+    if (!graph) {
+        return NULL;
+    }
+    graph->network = network;
+
+    int32_t previous = fossil_jellyfish_graph_add_input(graph, network->layers[0]->num_neurons);
+    for (int32_t i = 1; i < network->num_layers && previous >= 0; i++) {
+        fossil_jellyfish_layer_t* layer = network->layers[i];
+        previous = jellyfish_graph_push(graph, NODE_DENSE, layer->num_neurons, &previous, 1, layer->activation);
+        if (previous >= 0) {
+            graph->nodes[previous].layer = i;
+        }
+    }
+    if (previous < 0) {
+        fossil_jellyfish_graph_free(graph);
+        return NULL;
+    }
+    return graph;
+}
@@ -0,0 +1,121 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/hashed.h"
+#include "internal.h"
+#include <string.h>
+
+// The real weights are never materialized as a matrix: every kernel rehashes the
+// entry index, which is cheaper than streaming a table as large as the matrix
+
+void jellyfish_hashed_matvec_rows(const fossil_jellyfish_layer_t* layer, int32_t fan_in, const double* inputs, int64_t stride, int64_t rows, double* sums) {
+    const double* real = layer->weights;
+    double accumulators[JELLYFISH_FORWARD_BLOCK];
+
+    for (int32_t j = 0; j < layer->num_neurons; j++) {
+        uint64_t row_index = (uint64_t)j * (uint64_t)fan_in;
+        memset(accumulators, 0, sizeof(accumulators));
+
+        // Each virtual weight is hashed once and reused by every row of the block
+        for (int32_t k = 0; k < fan_in; k++) {
+            double sign;
+            double w = real[jellyfish_hash_slot(layer, row_index + (uint64_t)k, &sign)] * sign;
+            for (int64_t r = 0; r < rows; r++) {
+                accumulators[r] += inputs[r * stride + k] * w;
+            }
+        }
+        for (int64_t r = 0; r < rows; r++) {
+            sums[r * layer->num_neurons + j] = accumulators[r];
+        }
+    }
+}
+
+void jellyfish_hashed_transpose_matvec(const fossil_jellyfish_layer_t* layer, int32_t fan_in, const double* deltas, double* errors) {
+    const double* real = layer->weights;
+    memset(errors, 0, (size_t)fan_in * sizeof(double));
+
+    for (int32_t j = 0; j < layer->num_neurons; j++) {
+        uint64_t row_index = (uint64_t)j * (uint64_t)fan_in;
+        double delta = deltas[j];
+        for (int32_t k = 0; k < fan_in; k++) {
+            double sign;
+            errors[k] += real[jellyfish_hash_slot(layer, row_index + (uint64_t)k, &sign)] * sign * delta;
+        }
+    }
+}
+
+void jellyfish_hashed_accumulate(const fossil_jellyfish_layer_t* layer, int32_t fan_in, const double* inputs, const double* deltas, double scale, double* real_gradients) {
+    for (int32_t j = 0; j < layer->num_neurons; j++) {
+        uint64_t row_index = (uint64_t)j * (uint64_t)fan_in;
+        double delta = scale * deltas[j];
+        for (int32_t k = 0; k < fan_in; k++) {
+            double sign;
+            real_gradients[jellyfish_hash_slot(layer, row_index + (uint64_t)k, &sign)] += sign * delta * inputs[k];
+        }
+    }
+}
+
+int32_t fossil_jellyfish_hash_layer(fossil_jellyfish_network_t* network, int32_t layer_index, int64_t num_params, uint64_t seed) {
+    if (!network || layer_index <= 0 || layer_index >= network->num_layers || num_params <= 0 || num_params > (int64_t)UINT32_MAX) {
+        return -1;
+    }
+    fossil_jellyfish_layer_t* layer = network->layers[layer_index];
+    int32_t fan_in = network->layers[layer_index - 1]->num_neurons;
+    if (layer->kind != LAYER_DENSE || jellyfish_layer_make_writable(network, layer_index, 1) != 0) {
+        return -1;
+    }
+
+    jellyfish_scratch_mark_t mark = jellyfish_scratch_mark();
+    double* real = jellyfish_alloc_array(&network->allocator, (size_t)num_params);
+    int32_t* counts = (int32_t*)jellyfish_scratch_alloc((size_t)num_params * sizeof(int32_t));
+    if (!real || !counts) {
+        jellyfish_free_with(&network->allocator, real);
+        jellyfish_scratch_reset(mark);
+        return -1;
+    }
+    memset(real, 0, (size_t)num_params * sizeof(double));
+    memset(counts, 0, (size_t)num_params * sizeof(int32_t));
+
+    // Least-squares projection: the signed mean of the entries sharing a slot
+    layer->kind = LAYER_HASHED;
+    layer->num_params = num_params;
+    layer->hash_seed = seed;
+    for (int32_t j = 0; j < layer->num_neurons; j++) {
+        for (int32_t k = 0; k < fan_in; k++) {
+            uint64_t index = (uint64_t)j * (uint64_t)fan_in + (uint64_t)k;
+            double sign;
+            int64_t slot = jellyfish_hash_slot(layer, index, &sign);
+            real[slot] += sign * layer->weights[index];
+            counts[slot]++;
+        }
+    }
+    for (int64_t p = 0; p < num_params; p++) {
+        real[p] = counts[p] > 0 ? real[p] / counts[p] : 0;
+    }
+
+    jellyfish_scratch_reset(mark);
+    jellyfish_free_with(&network->allocator, layer->weights);
+    layer->weights = real;
+    return 0;
+}
+
+double fossil_jellyfish_layer_weight(const fossil_jellyfish_network_t* network, int32_t layer_index, int32_t neuron, int32_t input) {
+    const fossil_jellyfish_layer_t* layer = network->layers[layer_index];
+    uint64_t index = (uint64_t)neuron * (uint64_t)network->layers[layer_index - 1]->num_neurons + (uint64_t)input;
+    if (layer->kind == LAYER_HASHED) {
+        double sign;
+        int64_t slot = jellyfish_hash_slot(layer, index, &sign);
+        return sign * layer->weights[slot];
+    }
+    return layer->weights[index];
+}
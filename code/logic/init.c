@@ -0,0 +1,203 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/init.h"
+#include "fossil/jellyfish/parallel.h"
+#include "internal.h"
+#include <string.h>
+#include <math.h>
+
+#define JELLYFISH_INIT_GRAIN ((int64_t)1 << 15)
+#define JELLYFISH_TWO_PI 6.283185307179586476925286766559
+
+typedef struct {
+    double* values;
+    int64_t count;
+    uint64_t seed;
+    double scale;
+} jellyfish_fill_t;
+
+typedef struct {
+    double* rows;
+    int64_t row;
+    int64_t num_rows;
+    int64_t row_length;
+} jellyfish_orthogonalize_t;
+
+// Uniform double in (0, 1] for element i of the stream selected by seed
+static inline double jellyfish_unit(uint64_t seed, uint64_t i) {
+    uint64_t bits = jellyfish_mix64(seed + (i + 1) * JELLYFISH_GOLDEN_GAMMA);
+    return (double)((bits >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static void jellyfish_fill_uniform_task(void* context, int64_t begin, int64_t end, int32_t thread_index) {
+    jellyfish_fill_t* fill = (jellyfish_fill_t*)context;
+    double* restrict values = fill->values;
+    (void)thread_index;
+    for (int64_t i = begin; i < end; i++) {
+        values[i] = (2.0 * jellyfish_unit(fill->seed, (uint64_t)i) - 1.0) * fill->scale;
+    }
+}
+
+// Box-Muller on pairs of elements so every pair is independent of the chunking
+static void jellyfish_fill_normal_task(void* context, int64_t begin, int64_t end, int32_t thread_index) {
+    jellyfish_fill_t* fill = (jellyfish_fill_t*)context;
+    double* restrict values = fill->values;
+    (void)thread_index;
+    for (int64_t p = begin; p < end; p++) {
+        double radius = sqrt(-2.0 * log(jellyfish_unit(fill->seed, (uint64_t)(2 * p)))) * fill->scale;
+        double angle = JELLYFISH_TWO_PI * jellyfish_unit(fill->seed, (uint64_t)(2 * p + 1));
+        values[2 * p] = radius * cos(angle);
+        if (2 * p + 1 < fill->count) {
+            values[2 * p + 1] = radius * sin(angle);
+        }
+    }
+}
+
+static void jellyfish_fill_uniform(double* values, int64_t count, uint64_t seed, double limit) {
+    jellyfish_fill_t fill = {values, count, seed, limit};
+    fossil_jellyfish_parallel_for(count, JELLYFISH_INIT_GRAIN, jellyfish_fill_uniform_task, &fill);
+}
+
+static void jellyfish_fill_normal(double* values, int64_t count, uint64_t seed, double stddev) {
+    jellyfish_fill_t fill = {values, count, seed, stddev};
+    fossil_jellyfish_parallel_for((count + 1) / 2, JELLYFISH_INIT_GRAIN / 2, jellyfish_fill_normal_task, &fill);
+}
+
+static double jellyfish_dot(const double* restrict a, const double* restrict b, int64_t n) {
+    double sum = 0;
+    for (int64_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// Removes the component along the current row from every later row
+static void jellyfish_orthogonalize_task(void* context, int64_t begin, int64_t end, int32_t thread_index) {
+    jellyfish_orthogonalize_t* work = (jellyfish_orthogonalize_t*)context;
+    const double* restrict basis = work->rows + work->row * work->row_length;
+    (void)thread_index;
+    for (int64_t j = work->row + 1 + begin; j < work->row + 1 + end; j++) {
+        double* restrict row = work->rows + j * work->row_length;
+        double projection = jellyfish_dot(row, basis, work->row_length);
+        for (int64_t k = 0; k < work->row_length; k++) {
+            row[k] -= projection * basis[k];
+        }
+    }
+}
+
+// Modified Gram-Schmidt over the rows of a num_rows x row_length matrix (num_rows <= row_length)
+static void jellyfish_orthonormalize_rows(double* rows, int64_t num_rows, int64_t row_length) {
+    jellyfish_orthogonalize_t work = {rows, 0, num_rows, row_length};
+    int64_t grain = JELLYFISH_INIT_GRAIN / (row_length > 0 ? row_length : 1);
+
+    for (int64_t i = 0; i < num_rows; i++) {
+        double* row = rows + i * row_length;
+        double norm = sqrt(jellyfish_dot(row, row, row_length));
+        double inv = norm > 0 ? 1.0 / norm : 0;
+        for (int64_t k = 0; k < row_length; k++) {
+            row[k] *= inv;
+        }
+        work.row = i;
+        fossil_jellyfish_parallel_for(num_rows - i - 1, grain, jellyfish_orthogonalize_task, &work);
+    }
+}
+
+static void jellyfish_init_orthogonal(double* weights, int64_t fan_out, int64_t fan_in, uint64_t seed) {
+    if (fan_out <= fan_in) {
+        jellyfish_fill_normal(weights, fan_out * fan_in, seed, 1.0);
+        jellyfish_orthonormalize_rows(weights, fan_out, fan_in);
+        return;
+    }
+
+    // More neurons than inputs: build orthonormal columns through the transpose
+    jellyfish_scratch_mark_t mark = jellyfish_scratch_mark();
+    double* transposed = (double*)jellyfish_scratch_alloc((size_t)(fan_out * fan_in) * sizeof(double));
+    if (!transposed) {
+        jellyfish_fill_normal(weights, fan_out * fan_in, seed, 1.0 / sqrt((double)fan_in));
+        return;
+    }
+    jellyfish_fill_normal(transposed, fan_out * fan_in, seed, 1.0);
+    jellyfish_orthonormalize_rows(transposed, fan_in, fan_out);
+    for (int64_t j = 0; j < fan_out; j++) {
+        for (int64_t k = 0; k < fan_in; k++) {
+            weights[j * fan_in + k] = transposed[k * fan_out + j];
+        }
+    }
+    jellyfish_scratch_reset(mark);
+}
+
+static int32_t jellyfish_is_relu_like(fossil_jellyfish_activation_t activation) {
+    return activation == ACTIVATION_RELU || activation == ACTIVATION_LEAKY_RELU || activation == ACTIVATION_ELU;
+}
+
+void jellyfish_init_weights(double* weights, int64_t fan_out, int64_t fan_in, fossil_jellyfish_activation_t activation, fossil_jellyfish_init_t init, uint64_t seed) {
+    jellyfish_init_values(weights, fan_in * fan_out, fan_out, fan_in, activation, init, seed);
+}
+
+void jellyfish_init_values(double* weights, int64_t count, int64_t fan_out, int64_t fan_in, fossil_jellyfish_activation_t activation, fossil_jellyfish_init_t init, uint64_t seed) {
+    if (init == INIT_AUTO) {
+        init = jellyfish_is_relu_like(activation) ? INIT_HE_UNIFORM : INIT_XAVIER_UNIFORM;
+    }
+
+    switch (init) {
+        case INIT_XAVIER_UNIFORM:
+            jellyfish_fill_uniform(weights, count, seed, sqrt(6.0 / (double)(fan_in + fan_out)));
+            break;
+        case INIT_XAVIER_NORMAL:
+            jellyfish_fill_normal(weights, count, seed, sqrt(2.0 / (double)(fan_in + fan_out)));
+            break;
+        case INIT_HE_UNIFORM:
+            jellyfish_fill_uniform(weights, count, seed, sqrt(6.0 / (double)fan_in));
+            break;
+        case INIT_HE_NORMAL:
+            jellyfish_fill_normal(weights, count, seed, sqrt(2.0 / (double)fan_in));
+            break;
+        case INIT_ORTHOGONAL:
+            jellyfish_init_orthogonal(weights, fan_out, fan_in, seed);
+            break;
+        default:
+            memset(weights, 0, (size_t)count * sizeof(double));
+            break;
+    }
+}
+
+void fossil_jellyfish_init_layer(fossil_jellyfish_network_t* network, int32_t layer_index, fossil_jellyfish_init_t init, uint64_t seed) {
+    if (layer_index <= 0 || layer_index >= network->num_layers) {
+        return;
+    }
+    fossil_jellyfish_layer_t* layer = network->layers[layer_index];
+
+    // The previous values are overwritten, so a shared layer is detached without copying
+    if (jellyfish_layer_make_writable(network, layer_index, 0) != 0) {
+        return;
+    }
+
+    int64_t fan_in = network->layers[layer_index - 1]->num_neurons;
+    uint64_t layer_seed = jellyfish_mix64(seed + (uint64_t)layer_index * JELLYFISH_GOLDEN_GAMMA);
+    if (layer->kind == LAYER_HASHED) {
+        // Every virtual weight reads one real weight, so the real weights take the
+        // virtual matrix's distribution; orthogonality cannot survive the hashing
+        jellyfish_init_values(layer->weights, layer->num_params, layer->num_neurons, fan_in, layer->activation,
+                              init == INIT_ORTHOGONAL ? INIT_AUTO : init, layer_seed);
+    } else {
+        jellyfish_init_weights(layer->weights, layer->num_neurons, fan_in, layer->activation, init, layer_seed);
+    }
+    memset(layer->biases, 0, (size_t)layer->num_neurons * sizeof(double));
+}
+
+void fossil_jellyfish_init_network(fossil_jellyfish_network_t* network, fossil_jellyfish_init_t init, uint64_t seed) {
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        fossil_jellyfish_init_layer(network, i, init, seed);
+    }
+}
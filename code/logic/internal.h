@@ -0,0 +1,179 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_JELLYFISH_AI_INTERNAL_H
+#define FOSSIL_JELLYFISH_AI_INTERNAL_H
+
+// Private helpers shared by the library sources, never installed
+
+#include <stdint.h>
+
+#include "fossil/jellyfish/jellyfish.h"
+#include "fossil/jellyfish/init.h"
+#include <stddef.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define JELLYFISH_THREAD_LOCAL __declspec(thread)
+#define jellyfish_atomic_load64(p) _InterlockedCompareExchange64((volatile long long*)(p), 0, 0)
+#define jellyfish_atomic_store64(p, v) ((void)_InterlockedExchange64((volatile long long*)(p), (long long)(v)))
+#define jellyfish_atomic_add64(p, v) _InterlockedExchangeAdd64((volatile long long*)(p), (long long)(v))
+#define jellyfish_atomic_load32(p) _InterlockedCompareExchange((volatile long*)(p), 0, 0)
+#define jellyfish_atomic_store32(p, v) ((void)_InterlockedExchange((volatile long*)(p), (long)(v)))
+#define jellyfish_atomic_add32(p, v) _InterlockedExchangeAdd((volatile long*)(p), (long)(v))
+#define jellyfish_atomic_cas32(p, e, d) (_InterlockedCompareExchange((volatile long*)(p), (long)(d), (long)(e)) == (long)(e))
+#define jellyfish_atomic_fence() do { volatile long jellyfish_fence_ = 0; (void)_InterlockedOr(&jellyfish_fence_, 0); } while (0)
+#else
+#define JELLYFISH_THREAD_LOCAL _Thread_local
+#define jellyfish_atomic_load64(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define jellyfish_atomic_store64(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define jellyfish_atomic_add64(p, v) __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#define jellyfish_atomic_load32(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define jellyfish_atomic_store32(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define jellyfish_atomic_add32(p, v) __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#define jellyfish_atomic_cas32(p, e, d) __sync_bool_compare_and_swap((p), (e), (d))
+#define jellyfish_atomic_fence() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+// SplitMix64 finalizer, also used as a counter-based random generator
+static inline uint64_t jellyfish_mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+#define JELLYFISH_GOLDEN_GAMMA 0x9e3779b97f4a7c15ULL
+
+// Reference-counted parameter arrays of a layer shared between snapshots
+typedef struct {
+    int32_t refcount;
+    size_t weight_count;
+    size_t bias_count;
+    double* weights;
+    double* biases;
+    fossil_jellyfish_allocator_t allocator;   // Frees the block with the last reference
+} jellyfish_shared_params_t;
+
+// Gives layer index private parameter arrays; the old values are copied only when preserve is set
+int32_t jellyfish_layer_make_writable(fossil_jellyfish_network_t* network, int32_t index, int32_t preserve);
+
+// Fills a fan_out x fan_in weight matrix with the given scheme
+void jellyfish_init_weights(double* weights, int64_t fan_out, int64_t fan_in, fossil_jellyfish_activation_t activation, fossil_jellyfish_init_t init, uint64_t seed);
+
+// Fills count values with the distribution the scheme gives a fan_out x fan_in matrix; not orthogonal
+void jellyfish_init_values(double* values, int64_t count, int64_t fan_out, int64_t fan_in, fossil_jellyfish_activation_t activation, fossil_jellyfish_init_t init, uint64_t seed);
+
+// Rows pushed through each layer together by the batched forward pass
+#define JELLYFISH_FORWARD_BLOCK 32
+
+// Widest layer of the network, used to size forward scratch buffers
+int32_t jellyfish_max_width(const fossil_jellyfish_network_t* network);
+
+// Doubles of scratch needed by jellyfish_forward_rows for one block
+size_t jellyfish_forward_scratch_size(const fossil_jellyfish_network_t* network);
+
+// Thread-safe forward pass of up to JELLYFISH_FORWARD_BLOCK rows; never touches layer buffers.
+// Input rows start input_stride doubles apart and are read in place; outputs are packed.
+void jellyfish_forward_rows(const fossil_jellyfish_network_t* network, const double* inputs, int64_t input_stride, int64_t rows, double* scratch, double* outputs);
+
+// Length of a layer's weights array: the dense matrix or the hashed real weights
+size_t jellyfish_weight_count(const fossil_jellyfish_network_t* network, int32_t index);
+
+// Real weight slot of a hashed layer's virtual entry, with the sign it is read with
+static inline int64_t jellyfish_hash_slot(const fossil_jellyfish_layer_t* layer, uint64_t virtual_index, double* sign) {
+    uint64_t hash = jellyfish_mix64(layer->hash_seed + (virtual_index + 1) * JELLYFISH_GOLDEN_GAMMA);
+    *sign = (hash & 1) ? -1.0 : 1.0;
+    return (int64_t)(((hash >> 32) * (uint64_t)layer->num_params) >> 32);
+}
+
+// Layer-wide activation kernels; backward turns output gradients into pre-activation gradients
+typedef struct {
+    const char* name;
+    void (*forward)(double* values, int32_t count);
+    void (*backward)(const double* outputs, double* gradients, int32_t count);
+} jellyfish_activation_kernel_t;
+
+const jellyfish_activation_kernel_t* jellyfish_activation_kernel(fossil_jellyfish_activation_t activation);
+
+// Copies rows of raw inputs, stride doubles apart, packed into destination, standardized
+// when the network has input normalization
+void jellyfish_load_inputs(const fossil_jellyfish_network_t* network, const double* inputs, int64_t stride, int64_t rows, double* destination);
+
+// Allocation through the hooks: NULL selects the global allocator, a zeroed one the default
+void* jellyfish_alloc_with(const fossil_jellyfish_allocator_t* allocator, size_t size);
+void* jellyfish_calloc_with(const fossil_jellyfish_allocator_t* allocator, size_t count, size_t size);
+void* jellyfish_realloc_with(const fossil_jellyfish_allocator_t* allocator, void* pointer, size_t old_size, size_t new_size);
+void jellyfish_free_with(const fossil_jellyfish_allocator_t* allocator, void* pointer);
+
+#define jellyfish_malloc(size) jellyfish_alloc_with(NULL, (size))
+#define jellyfish_calloc(count, size) jellyfish_calloc_with(NULL, (count), (size))
+#define jellyfish_realloc(pointer, old_size, new_size) jellyfish_realloc_with(NULL, (pointer), (old_size), (new_size))
+#define jellyfish_free(pointer) jellyfish_free_with(NULL, (pointer))
+
+// Parameter array allocation, huge-page backed when that is on and the array is large
+double* jellyfish_alloc_array(const fossil_jellyfish_allocator_t* allocator, size_t count);
+
+// fossil_jellyfish_load with the network's memory drawn from allocator, NULL for the global one
+fossil_jellyfish_network_t* jellyfish_load_with(const char* file_path, const fossil_jellyfish_allocator_t* allocator);
+
+// The same, parsing a saved network's bytes in memory instead of a file
+fossil_jellyfish_network_t* jellyfish_load_image(const void* image, size_t image_size, const fossil_jellyfish_allocator_t* allocator);
+
+// Runs the calling thread's fossil_jellyfish_parallel_for calls inline, as nested calls
+// inside a task already are, so the pool is neither started nor allocated until the leave
+int32_t jellyfish_serial_enter(void);
+void jellyfish_serial_leave(int32_t previous);
+
+// Position in the calling thread's scratch arena
+typedef struct {
+    void* block;
+    size_t used;
+} jellyfish_scratch_mark_t;
+
+// Temporaries of one call: take a mark, bump-allocate, reset to the mark before returning.
+// Blocks are 64-byte aligned, uninitialized and kept across resets, so only growth allocates.
+jellyfish_scratch_mark_t jellyfish_scratch_mark(void);
+void* jellyfish_scratch_alloc(size_t size);
+void jellyfish_scratch_reset(jellyfish_scratch_mark_t mark);
+
+// Computes one layer's activated outputs from a row of the previous layer's outputs
+void jellyfish_forward_layer(const fossil_jellyfish_network_t* network, int32_t index, const double* inputs, double* outputs);
+
+// Runs layers [begin, end) of the forward pass from the outputs of layer begin - 1
+void jellyfish_forward_layers(fossil_jellyfish_network_t* network, int32_t begin, int32_t end);
+
+// fossil_jellyfish_accumulate_gradients with errors[i], when errors and errors[i] are not NULL,
+// added to -dL/d(outputs) of hidden layer i, so losses of side branches train the layers they read
+void jellyfish_accumulate_gradients(fossil_jellyfish_network_t* network, const double* expected_output, fossil_jellyfish_loss_t loss, const double* const* errors, double* gradients);
+
+// Hashed layer kernels: sums = W x for up to JELLYFISH_FORWARD_BLOCK rows stride doubles apart, errors = W^T deltas,
+// and real_gradients += scale * (deltas x^T) folded onto the real weights
+void jellyfish_hashed_matvec_rows(const fossil_jellyfish_layer_t* layer, int32_t fan_in, const double* inputs, int64_t stride, int64_t rows, double* sums);
+void jellyfish_hashed_transpose_matvec(const fossil_jellyfish_layer_t* layer, int32_t fan_in, const double* deltas, double* errors);
+void jellyfish_hashed_accumulate(const fossil_jellyfish_layer_t* layer, int32_t fan_in, const double* inputs, const double* deltas, double scale, double* real_gradients);
+
+// Packed dense kernels: panel p holds neurons [p * FOSSIL_JELLYFISH_PANEL_WIDTH, ...) with
+// packed[(p * fan_in + k) * FOSSIL_JELLYFISH_PANEL_WIDTH + l] = W[p * FOSSIL_JELLYFISH_PANEL_WIDTH + l][k],
+// and the last panel zero-padded; sums = W x for any number of rows stride doubles apart
+size_t jellyfish_packed_count(int32_t fan_in, int32_t fan_out);
+void jellyfish_pack_panels(const double* weights, int32_t fan_in, int32_t fan_out, double* packed);
+void jellyfish_packed_matvec_rows(const double* packed, int32_t fan_in, int32_t fan_out, const double* inputs, int64_t stride, int64_t rows, double* sums);
+
+// Maps a whole non-empty file read-only; handle is the Windows file mapping object
+int32_t jellyfish_map_file(const char* file_path, void** mapping, size_t* size, void** handle);
+void jellyfish_unmap_file(void* mapping, size_t size, void* handle);
+
+#endif /* FOSSIL_JELLYFISH_AI_INTERNAL_H */
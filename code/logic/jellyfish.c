@@ -12,6 +12,10 @@
  * -----------------------------------------------------------------------------
  */
 #include "fossil/jellyfish/jellyfish.h"
+#include "fossil/jellyfish/init.h"
+#include "fossil/jellyfish/parallel.h"
+#include "fossil/jellyfish/memory.h"
+#include "internal.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
@@ -25,125 +29,812 @@ double fossil_jellyfish_activate(double value, fossil_jellyfish_activation_t act
             return 1.0 / (1.0 + exp(-value));
         case ACTIVATION_TANH:
             return tanh(value);
+        case ACTIVATION_LEAKY_RELU:
+            return value > 0 ? value : FOSSIL_JELLYFISH_LEAKY_SLOPE * value;
+        case ACTIVATION_ELU:
+            return value > 0 ? value : FOSSIL_JELLYFISH_ELU_ALPHA * expm1(value);
         default:
             return value;
     }
 }
 
+// Derivatives in terms of the output y: every activation here is monotonic, so y determines the input's sign
 double fossil_jellyfish_activate_derivative(double value, fossil_jellyfish_activation_t activation) {
     switch (activation) {
         case ACTIVATION_RELU:
             return value > 0 ? 1 : 0;
         case ACTIVATION_SIGMOID:
-            return value * (1 - value);  // Sigmoid derivative
+        case ACTIVATION_SOFTMAX:
+            return value * (1 - value);  // Sigmoid derivative, and the softmax Jacobian diagonal
         case ACTIVATION_TANH:
             return 1 - value * value;  // Tanh derivative
+        case ACTIVATION_LEAKY_RELU:
+            return value > 0 ? 1 : FOSSIL_JELLYFISH_LEAKY_SLOPE;
+        case ACTIVATION_ELU:
+            return value > 0 ? 1 : value + FOSSIL_JELLYFISH_ELU_ALPHA;  // alpha * e^x = y + alpha
         default:
-            return value;
+            return 1;
+    }
+}
+
+// One specialized kernel pair per activation: plain loops the compiler can vectorize
+static void jellyfish_relu_forward(double* restrict values, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        values[i] = values[i] > 0 ? values[i] : 0;
+    }
+}
+
+static void jellyfish_relu_backward(const double* restrict outputs, double* restrict gradients, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        gradients[i] = outputs[i] > 0 ? gradients[i] : 0;
+    }
+}
+
+static void jellyfish_sigmoid_forward(double* restrict values, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        values[i] = 1.0 / (1.0 + exp(-values[i]));
+    }
+}
+
+static void jellyfish_sigmoid_backward(const double* restrict outputs, double* restrict gradients, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        gradients[i] *= outputs[i] * (1 - outputs[i]);
+    }
+}
+
+static void jellyfish_tanh_forward(double* restrict values, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        values[i] = tanh(values[i]);
+    }
+}
+
+static void jellyfish_tanh_backward(const double* restrict outputs, double* restrict gradients, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        gradients[i] *= 1 - outputs[i] * outputs[i];
+    }
+}
+
+static void jellyfish_leaky_relu_forward(double* restrict values, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        values[i] = values[i] > 0 ? values[i] : FOSSIL_JELLYFISH_LEAKY_SLOPE * values[i];
+    }
+}
+
+static void jellyfish_leaky_relu_backward(const double* restrict outputs, double* restrict gradients, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        gradients[i] *= outputs[i] > 0 ? 1 : FOSSIL_JELLYFISH_LEAKY_SLOPE;
+    }
+}
+
+static void jellyfish_softmax_forward(double* restrict values, int32_t count) {
+    // Shifting by the maximum keeps exp from overflowing
+    double largest = -INFINITY, sum = 0;
+    for (int32_t i = 0; i < count; i++) {
+        largest = values[i] > largest ? values[i] : largest;
+    }
+    for (int32_t i = 0; i < count; i++) {
+        values[i] = exp(values[i] - largest);
+        sum += values[i];
+    }
+    for (int32_t i = 0; i < count; i++) {
+        values[i] /= sum;
+    }
+}
+
+static void jellyfish_softmax_backward(const double* restrict outputs, double* restrict gradients, int32_t count) {
+    double dot = 0;
+    for (int32_t i = 0; i < count; i++) {
+        dot += gradients[i] * outputs[i];
+    }
+    for (int32_t i = 0; i < count; i++) {
+        gradients[i] = outputs[i] * (gradients[i] - dot);
+    }
+}
+
+static void jellyfish_elu_forward(double* restrict values, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        values[i] = values[i] > 0 ? values[i] : FOSSIL_JELLYFISH_ELU_ALPHA * expm1(values[i]);
+    }
+}
+
+static void jellyfish_elu_backward(const double* restrict outputs, double* restrict gradients, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        gradients[i] *= outputs[i] > 0 ? 1 : outputs[i] + FOSSIL_JELLYFISH_ELU_ALPHA;
     }
 }
 
+static void jellyfish_linear_forward(double* values, int32_t count) {
+    (void)values;
+    (void)count;
+}
+
+static void jellyfish_linear_backward(const double* outputs, double* gradients, int32_t count) {
+    (void)outputs;
+    (void)gradients;
+    (void)count;
+}
+
+// Indexed by fossil_jellyfish_activation_t
+static const jellyfish_activation_kernel_t jellyfish_activation_kernels[] = {
+    {"relu", jellyfish_relu_forward, jellyfish_relu_backward},
+    {"sigmoid", jellyfish_sigmoid_forward, jellyfish_sigmoid_backward},
+    {"tanh", jellyfish_tanh_forward, jellyfish_tanh_backward},
+    {"leaky_relu", jellyfish_leaky_relu_forward, jellyfish_leaky_relu_backward},
+    {"softmax", jellyfish_softmax_forward, jellyfish_softmax_backward},
+    {"elu", jellyfish_elu_forward, jellyfish_elu_backward},
+    {"linear", jellyfish_linear_forward, jellyfish_linear_backward}
+};
+
+const jellyfish_activation_kernel_t* jellyfish_activation_kernel(fossil_jellyfish_activation_t activation) {
+    size_t count = sizeof(jellyfish_activation_kernels) / sizeof(jellyfish_activation_kernels[0]);
+    return (size_t)activation < count ? &jellyfish_activation_kernels[activation] : &jellyfish_activation_kernels[ACTIVATION_LINEAR];
+}
+
+void fossil_jellyfish_activate_vector(double* values, int32_t count, fossil_jellyfish_activation_t activation) {
+    jellyfish_activation_kernel(activation)->forward(values, count);
+}
+
+void fossil_jellyfish_activation_backward(const double* outputs, double* gradients, int32_t count, fossil_jellyfish_activation_t activation) {
+    jellyfish_activation_kernel(activation)->backward(outputs, gradients, count);
+}
+
 // Creates a new neural network
 fossil_jellyfish_network_t* fossil_jellyfish_create_network(int32_t num_layers, int32_t* neurons_per_layer, fossil_jellyfish_activation_t* activations) {
-    fossil_jellyfish_network_t* network = (fossil_jellyfish_network_t*)malloc(sizeof(fossil_jellyfish_network_t));
-    network->num_layers = num_layers;
-    network->layers = (fossil_jellyfish_layer_t**)malloc(num_layers * sizeof(fossil_jellyfish_layer_t*));
+    return fossil_jellyfish_create_network_with_allocator(num_layers, neurons_per_layer, activations, NULL);
+}
+
+fossil_jellyfish_network_t* fossil_jellyfish_create_network_with_allocator(int32_t num_layers, int32_t* neurons_per_layer, fossil_jellyfish_activation_t* activations,
+                                                                           const fossil_jellyfish_allocator_t* allocator) {
+    fossil_jellyfish_allocator_t hooks = allocator ? *allocator : fossil_jellyfish_get_allocator();
+    fossil_jellyfish_network_t* network = (fossil_jellyfish_network_t*)jellyfish_calloc_with(&hooks, 1, sizeof(fossil_jellyfish_network_t));
+    if (!network) {
+        return NULL;
+    }
+    network->allocator = hooks;
+    network->layers = (fossil_jellyfish_layer_t**)jellyfish_calloc_with(&hooks, (size_t)num_layers, sizeof(fossil_jellyfish_layer_t*));
+    if (!network->layers) {
+        jellyfish_free_with(&hooks, network);
+        return NULL;
+    }
 
     for (int32_t i = 0; i < num_layers; i++) {
-        fossil_jellyfish_layer_t* layer = (fossil_jellyfish_layer_t*)malloc(sizeof(fossil_jellyfish_layer_t));
+        fossil_jellyfish_layer_t* layer = (fossil_jellyfish_layer_t*)jellyfish_calloc_with(&hooks, 1, sizeof(fossil_jellyfish_layer_t));
+        if (!layer) {
+            fossil_jellyfish_free_network(network);
+            return NULL;
+        }
+        network->layers[i] = layer;
+        network->num_layers++;
         layer->num_neurons = neurons_per_layer[i];
         layer->activation = activations[i];
+        layer->kind = LAYER_DENSE;
         if (i > 0) {  // Skip the input layer
-            layer->weights = (double*)malloc(neurons_per_layer[i] * neurons_per_layer[i-1] * sizeof(double));
-            layer->biases = (double*)malloc(neurons_per_layer[i] * sizeof(double));
-            layer->deltas = (double*)calloc(neurons_per_layer[i], sizeof(double));
-        } else {
-            layer->weights = NULL;
-            layer->biases = NULL;
-            layer->deltas = NULL;
+            layer->weights = jellyfish_alloc_array(&hooks, (size_t)neurons_per_layer[i] * (size_t)neurons_per_layer[i-1]);
+            layer->biases = (double*)jellyfish_alloc_with(&hooks, (size_t)neurons_per_layer[i] * sizeof(double));
+            layer->deltas = (double*)jellyfish_calloc_with(&hooks, (size_t)neurons_per_layer[i], sizeof(double));
+        }
+        layer->outputs = (double*)jellyfish_calloc_with(&hooks, (size_t)neurons_per_layer[i], sizeof(double));
+        if (!layer->outputs || (i > 0 && (!layer->weights || !layer->biases || !layer->deltas))) {
+            fossil_jellyfish_free_network(network);
+            return NULL;
         }
-        layer->outputs = (double*)calloc(neurons_per_layer[i], sizeof(double));
-
-        network->layers[i] = layer;
     }
 
+    // Start from a reproducible, activation-appropriate initialization
+    fossil_jellyfish_init_network(network, INIT_AUTO, FOSSIL_JELLYFISH_DEFAULT_SEED);
+
     return network;
 }
 
+// Drops one reference to a shared parameter block, freeing it with the last one
+static void jellyfish_shared_release(jellyfish_shared_params_t* shared) {
+    if (jellyfish_atomic_add32(&shared->refcount, -1) == 1) {
+        fossil_jellyfish_allocator_t allocator = shared->allocator;
+        jellyfish_free_with(&allocator, shared->weights);
+        jellyfish_free_with(&allocator, shared->biases);
+        jellyfish_free_with(&allocator, shared);
+    }
+}
+
+void fossil_jellyfish_network_init(fossil_jellyfish_network_t* network) {
+    memset(network, 0, sizeof(*network));
+}
+
+void fossil_jellyfish_layer_init(fossil_jellyfish_layer_t* layer) {
+    memset(layer, 0, sizeof(*layer));
+    layer->kind = LAYER_DENSE;
+}
+
 // Frees up memory allocated for the network
 void fossil_jellyfish_free_network(fossil_jellyfish_network_t* network) {
+    // The hooks live inside the network, so they are copied before it goes
+    fossil_jellyfish_allocator_t allocator = network->allocator;
     for (int i = 0; i < network->num_layers; i++) {
         fossil_jellyfish_layer_t* layer = network->layers[i];
-        free(layer->biases);
-        free(layer->weights);
-        free(layer->deltas);
-        free(layer);
+        if (layer->shared) {
+            jellyfish_shared_release((jellyfish_shared_params_t*)layer->shared);
+        } else {
+            jellyfish_free_with(&allocator, layer->biases);
+            jellyfish_free_with(&allocator, layer->weights);
+        }
+        jellyfish_free_with(&allocator, layer->packed);
+        jellyfish_free_with(&allocator, layer->deltas);
+        jellyfish_free_with(&allocator, layer->outputs);
+        jellyfish_free_with(&allocator, layer);
+    }
+    jellyfish_free_with(&allocator, network->layers);
+    jellyfish_free_with(&allocator, network->input_mean);
+    jellyfish_free_with(&allocator, network->input_scale);
+    jellyfish_free_with(&allocator, network);
+}
+
+size_t jellyfish_weight_count(const fossil_jellyfish_network_t* network, int32_t index) {
+    const fossil_jellyfish_layer_t* layer = network->layers[index];
+    if (index == 0) {
+        return 0;
+    }
+    if (layer->kind == LAYER_HASHED) {
+        return (size_t)layer->num_params;
     }
-    free(network->layers);
-    free(network);
+    return (size_t)layer->num_neurons * (size_t)network->layers[index - 1]->num_neurons;
+}
+
+static double* jellyfish_copy_array(const fossil_jellyfish_allocator_t* allocator, const double* source, size_t count) {
+    if (!source) {
+        return NULL;
+    }
+    double* copy = jellyfish_alloc_array(allocator, count);
+    if (copy) {
+        memcpy(copy, source, count * sizeof(double));
+    }
+    return copy;
+}
+
+// Shallow network skeleton: layer structs and private output/delta buffers, no parameters
+static fossil_jellyfish_network_t* jellyfish_network_skeleton(const fossil_jellyfish_network_t* network) {
+    const fossil_jellyfish_allocator_t* allocator = &network->allocator;
+    fossil_jellyfish_network_t* copy = (fossil_jellyfish_network_t*)jellyfish_alloc_with(allocator, sizeof(fossil_jellyfish_network_t));
+    if (!copy) {
+        return NULL;
+    }
+    copy->num_layers = 0;
+    copy->allocator = network->allocator;
+    copy->layers = (fossil_jellyfish_layer_t**)jellyfish_alloc_with(allocator, (size_t)network->num_layers * sizeof(fossil_jellyfish_layer_t*));
+    copy->input_mean = jellyfish_copy_array(allocator, network->input_mean, (size_t)network->layers[0]->num_neurons);
+    copy->input_scale = jellyfish_copy_array(allocator, network->input_scale, (size_t)network->layers[0]->num_neurons);
+    if (!copy->layers || (network->input_mean && (!copy->input_mean || !copy->input_scale))) {
+        jellyfish_free_with(allocator, copy->layers);
+        jellyfish_free_with(allocator, copy->input_mean);
+        jellyfish_free_with(allocator, copy->input_scale);
+        jellyfish_free_with(allocator, copy);
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < network->num_layers; i++) {
+        const fossil_jellyfish_layer_t* source = network->layers[i];
+        fossil_jellyfish_layer_t* layer = (fossil_jellyfish_layer_t*)jellyfish_alloc_with(allocator, sizeof(fossil_jellyfish_layer_t));
+        if (!layer) {
+            fossil_jellyfish_free_network(copy);
+            return NULL;
+        }
+        *layer = *source;
+        layer->weights = NULL;
+        layer->biases = NULL;
+        layer->shared = NULL;
+        layer->packed = NULL;
+        layer->outputs = jellyfish_copy_array(allocator, source->outputs, (size_t)source->num_neurons);
+        layer->deltas = jellyfish_copy_array(allocator, source->deltas, (size_t)source->num_neurons);
+        copy->layers[copy->num_layers++] = layer;
+        if ((source->outputs && !layer->outputs) || (source->deltas && !layer->deltas)) {
+            fossil_jellyfish_free_network(copy);
+            return NULL;
+        }
+    }
+    return copy;
+}
+
+fossil_jellyfish_network_t* fossil_jellyfish_clone(const fossil_jellyfish_network_t* network) {
+    fossil_jellyfish_network_t* copy = jellyfish_network_skeleton(network);
+    if (!copy) {
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < network->num_layers; i++) {
+        const fossil_jellyfish_layer_t* source = network->layers[i];
+        fossil_jellyfish_layer_t* layer = copy->layers[i];
+        layer->weights = jellyfish_copy_array(&copy->allocator, source->weights, jellyfish_weight_count(network, i));
+        layer->biases = jellyfish_copy_array(&copy->allocator, source->biases, (size_t)source->num_neurons);
+        if ((source->weights && !layer->weights) || (source->biases && !layer->biases)) {
+            fossil_jellyfish_free_network(copy);
+            return NULL;
+        }
+    }
+    return copy;
+}
+
+fossil_jellyfish_network_t* fossil_jellyfish_snapshot(fossil_jellyfish_network_t* network) {
+    // Wrap owned parameter arrays in a shared block first; only a small header is allocated
+    for (int32_t i = 0; i < network->num_layers; i++) {
+        fossil_jellyfish_layer_t* layer = network->layers[i];
+        if (!layer->shared) {
+            jellyfish_shared_params_t* shared = (jellyfish_shared_params_t*)jellyfish_alloc_with(&network->allocator, sizeof(jellyfish_shared_params_t));
+            if (!shared) {
+                return NULL;
+            }
+            shared->refcount = 1;
+            shared->allocator = network->allocator;
+            shared->weight_count = jellyfish_weight_count(network, i);
+            shared->bias_count = (size_t)layer->num_neurons;
+            shared->weights = layer->weights;
+            shared->biases = layer->biases;
+            layer->shared = shared;
+        }
+    }
+
+    fossil_jellyfish_network_t* copy = jellyfish_network_skeleton(network);
+    if (!copy) {
+        return NULL;
+    }
+    for (int32_t i = 0; i < network->num_layers; i++) {
+        jellyfish_shared_params_t* shared = (jellyfish_shared_params_t*)network->layers[i]->shared;
+        jellyfish_atomic_add32(&shared->refcount, 1);
+        copy->layers[i]->shared = shared;
+        copy->layers[i]->weights = shared->weights;
+        copy->layers[i]->biases = shared->biases;
+    }
+    return copy;
+}
+
+int32_t jellyfish_layer_make_writable(fossil_jellyfish_network_t* network, int32_t index, int32_t preserve) {
+    const fossil_jellyfish_allocator_t* allocator = &network->allocator;
+    fossil_jellyfish_layer_t* layer = network->layers[index];
+    jellyfish_shared_params_t* shared = (jellyfish_shared_params_t*)layer->shared;
+
+    // The packed copy would go stale once the weights are written
+    jellyfish_free_with(allocator, layer->packed);
+    layer->packed = NULL;
+    if (!shared) {
+        return 0;
+    }
+
+    // Sole owner: take the arrays back without copying
+    if (jellyfish_atomic_load32(&shared->refcount) == 1) {
+        layer->shared = NULL;
+        jellyfish_free_with(allocator, shared);
+        return 0;
+    }
+
+    double* weights = NULL;
+    double* biases = NULL;
+    if (shared->weights) {
+        weights = preserve ? jellyfish_copy_array(allocator, shared->weights, shared->weight_count)
+                           : jellyfish_alloc_array(allocator, shared->weight_count);
+    }
+    if (shared->biases) {
+        biases = preserve ? jellyfish_copy_array(allocator, shared->biases, shared->bias_count)
+                          : (double*)jellyfish_alloc_with(allocator, shared->bias_count * sizeof(double));
+    }
+    if ((shared->weights && !weights) || (shared->biases && !biases)) {
+        jellyfish_free_with(allocator, weights);
+        jellyfish_free_with(allocator, biases);
+        return -1;
+    }
+
+    layer->weights = weights;
+    layer->biases = biases;
+    layer->shared = NULL;
+    jellyfish_shared_release(shared);
+    return 0;
+}
+
+int32_t fossil_jellyfish_make_writable(fossil_jellyfish_network_t* network) {
+    for (int32_t i = 0; i < network->num_layers; i++) {
+        if (jellyfish_layer_make_writable(network, i, 1) != 0) {
+            return -1;
+        }
+    }
+    return 0;
 }
 
 // Forward pass through the network
 void fossil_jellyfish_forward(fossil_jellyfish_network_t* network, double* input) {
     // Load input into the first layer
-    memcpy(network->layers[0]->outputs, input, network->layers[0]->num_neurons * sizeof(double));
+    jellyfish_load_inputs(network, input, network->layers[0]->num_neurons, 1, network->layers[0]->outputs);
+    jellyfish_forward_layers(network, 1, network->num_layers);
+}
 
-    for (int32_t i = 1; i < network->num_layers; i++) {
-        fossil_jellyfish_layer_t* prev_layer = network->layers[i - 1];
-        fossil_jellyfish_layer_t* layer = network->layers[i];
+void fossil_jellyfish_forward_into(fossil_jellyfish_network_t* network, const double* input, double* output) {
+    int32_t last = network->num_layers - 1;
+    if (last == 0) {
+        jellyfish_load_inputs(network, input, network->layers[0]->num_neurons, 1, output);
+        return;
+    }
+
+    // Layer 1 reads the caller's row unless standardization needs a copy
+    const double* current = input;
+    if (network->input_mean) {
+        jellyfish_load_inputs(network, input, network->layers[0]->num_neurons, 1, network->layers[0]->outputs);
+        current = network->layers[0]->outputs;
+    }
+    for (int32_t i = 1; i <= last; i++) {
+        double* next = i == last ? output : network->layers[i]->outputs;
+        jellyfish_forward_layer(network, i, current, next);
+        current = next;
+    }
+}
+
+void jellyfish_load_inputs(const fossil_jellyfish_network_t* network, const double* inputs, int64_t stride, int64_t rows, double* destination) {
+    int32_t width = network->layers[0]->num_neurons;
+    if (!network->input_mean) {
+        if (stride == width) {
+            memcpy(destination, inputs, (size_t)rows * (size_t)width * sizeof(double));
+            return;
+        }
+        for (int64_t r = 0; r < rows; r++) {
+            memcpy(destination + r * width, inputs + r * stride, (size_t)width * sizeof(double));
+        }
+        return;
+    }
+    const double* restrict mean = network->input_mean;
+    const double* restrict scale = network->input_scale;
+    for (int64_t r = 0; r < rows; r++) {
+        const double* restrict x = inputs + r * stride;
+        double* restrict y = destination + r * width;
+        for (int32_t k = 0; k < width; k++) {
+            y[k] = (x[k] - mean[k]) * scale[k];
+        }
+    }
+}
 
+void jellyfish_forward_layer(const fossil_jellyfish_network_t* network, int32_t index, const double* inputs, double* outputs) {
+    const fossil_jellyfish_layer_t* layer = network->layers[index];
+    int32_t fan_in = network->layers[index - 1]->num_neurons;
+
+    if (layer->kind == LAYER_HASHED) {
+        jellyfish_hashed_matvec_rows(layer, fan_in, inputs, fan_in, 1, outputs);
+        for (int32_t j = 0; j < layer->num_neurons; j++) {
+            outputs[j] += layer->biases[j];
+        }
+    } else if (layer->packed) {
+        jellyfish_packed_matvec_rows(layer->packed, fan_in, layer->num_neurons, inputs, fan_in, 1, outputs);
+        for (int32_t j = 0; j < layer->num_neurons; j++) {
+            outputs[j] += layer->biases[j];
+        }
+    } else {
         for (int32_t j = 0; j < layer->num_neurons; j++) {
             double weighted_sum = 0;
-            for (int32_t k = 0; k < prev_layer->num_neurons; k++) {
-                weighted_sum += prev_layer->outputs[k] * layer->weights[j * prev_layer->num_neurons + k];
+            for (int32_t k = 0; k < fan_in; k++) {
+                weighted_sum += inputs[k] * layer->weights[j * fan_in + k];
+            }
+            outputs[j] = weighted_sum + layer->biases[j];
+        }
+    }
+    fossil_jellyfish_activate_vector(outputs, layer->num_neurons, layer->activation);
+}
+
+void jellyfish_forward_layers(fossil_jellyfish_network_t* network, int32_t begin, int32_t end) {
+    for (int32_t i = begin; i < end; i++) {
+        jellyfish_forward_layer(network, i, network->layers[i - 1]->outputs, network->layers[i]->outputs);
+    }
+}
+
+int32_t jellyfish_max_width(const fossil_jellyfish_network_t* network) {
+    int32_t width = 0;
+    for (int32_t i = 0; i < network->num_layers; i++) {
+        if (network->layers[i]->num_neurons > width) {
+            width = network->layers[i]->num_neurons;
+        }
+    }
+    return width;
+}
+
+size_t jellyfish_forward_scratch_size(const fossil_jellyfish_network_t* network) {
+    return 2 * (size_t)JELLYFISH_FORWARD_BLOCK * (size_t)jellyfish_max_width(network);
+}
+
+// Each weight row is reused across the whole block while it is hot in cache
+void jellyfish_forward_rows(const fossil_jellyfish_network_t* network, const double* inputs, int64_t input_stride, int64_t rows, double* scratch, double* outputs) {
+    size_t half = jellyfish_forward_scratch_size(network) / 2;
+    const double* current = inputs;
+    int64_t stride = input_stride;
+    double* buffers[2] = {scratch, scratch + half};
+
+    // Layer 1 writes the other buffer, so standardized inputs can sit in the first
+    if (network->input_mean) {
+        jellyfish_load_inputs(network, inputs, input_stride, rows, buffers[0]);
+        current = buffers[0];
+        stride = network->layers[0]->num_neurons;
+    }
+
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        const fossil_jellyfish_layer_t* layer = network->layers[i];
+        int32_t fan_in = network->layers[i - 1]->num_neurons;
+        int32_t fan_out = layer->num_neurons;
+        double* next = (i == network->num_layers - 1) ? outputs : buffers[i & 1];
+
+        if (layer->kind == LAYER_HASHED || layer->packed) {
+            if (layer->packed) {
+                jellyfish_packed_matvec_rows(layer->packed, fan_in, fan_out, current, stride, rows, next);
+            } else {
+                jellyfish_hashed_matvec_rows(layer, fan_in, current, stride, rows, next);
+            }
+            for (int64_t r = 0; r < rows; r++) {
+                for (int32_t j = 0; j < fan_out; j++) {
+                    next[r * fan_out + j] += layer->biases[j];
+                }
             }
-            weighted_sum += layer->biases[j];
-            layer->outputs[j] = fossil_jellyfish_activate(weighted_sum, layer->activation);
+        } else {
+            for (int32_t j = 0; j < fan_out; j++) {
+                const double* restrict w = layer->weights + (size_t)j * (size_t)fan_in;
+                for (int64_t r = 0; r < rows; r++) {
+                    const double* restrict x = current + r * stride;
+                    double weighted_sum = 0;
+                    for (int32_t k = 0; k < fan_in; k++) {
+                        weighted_sum += x[k] * w[k];
+                    }
+                    next[r * fan_out + j] = weighted_sum + layer->biases[j];
+                }
+            }
+        }
+        for (int64_t r = 0; r < rows; r++) {
+            fossil_jellyfish_activate_vector(next + r * fan_out, fan_out, layer->activation);
         }
+        current = next;
+        stride = fan_out;
+    }
+
+    if (network->num_layers == 1) {
+        jellyfish_load_inputs(network, inputs, input_stride, rows, outputs);
+    }
+}
+
+typedef struct {
+    const fossil_jellyfish_network_t* network;
+    const double* inputs;
+    int64_t input_stride;   // Doubles between the starts of consecutive input rows
+    double* outputs;
+    double* scratch;        // One forward scratch block per thread
+    size_t scratch_size;
+} jellyfish_forward_batch_t;
+
+static void jellyfish_forward_batch_task(void* context, int64_t begin, int64_t end, int32_t thread_index) {
+    jellyfish_forward_batch_t* batch = (jellyfish_forward_batch_t*)context;
+    int32_t out = batch->network->layers[batch->network->num_layers - 1]->num_neurons;
+    double* scratch = batch->scratch + (size_t)thread_index * batch->scratch_size;
+
+    for (int64_t row = begin; row < end; row += JELLYFISH_FORWARD_BLOCK) {
+        int64_t rows = end - row < JELLYFISH_FORWARD_BLOCK ? end - row : JELLYFISH_FORWARD_BLOCK;
+        jellyfish_forward_rows(batch->network, batch->inputs + row * batch->input_stride, batch->input_stride, rows, scratch, batch->outputs + row * out);
     }
 }
 
+int32_t fossil_jellyfish_forward_batch(const fossil_jellyfish_network_t* network, const double* inputs, int64_t num_samples, double* outputs) {
+    return fossil_jellyfish_forward_strided(network, inputs, network->layers[0]->num_neurons, num_samples, outputs);
+}
+
+int32_t fossil_jellyfish_forward_strided(const fossil_jellyfish_network_t* network, const double* inputs, int64_t input_stride, int64_t num_samples, double* outputs) {
+    if (input_stride < network->layers[0]->num_neurons) {
+        return -1;
+    }
+    jellyfish_forward_batch_t batch;
+    batch.network = network;
+    batch.inputs = inputs;
+    batch.input_stride = input_stride;
+    batch.outputs = outputs;
+    batch.scratch_size = jellyfish_forward_scratch_size(network);
+    int32_t threads = fossil_jellyfish_get_num_threads();
+    jellyfish_scratch_mark_t mark = jellyfish_scratch_mark();
+    batch.scratch = (double*)jellyfish_scratch_alloc((size_t)threads * batch.scratch_size * sizeof(double));
+    if (!batch.scratch) {
+        jellyfish_scratch_reset(mark);
+        return -1;
+    }
+
+    fossil_jellyfish_parallel_for_bounded(num_samples, 8 * JELLYFISH_FORWARD_BLOCK, threads, jellyfish_forward_batch_task, &batch);
+    jellyfish_scratch_reset(mark);
+    return 0;
+}
+
 // Backpropagation algorithm to adjust weights and biases
 void fossil_jellyfish_backpropagate(fossil_jellyfish_network_t* network, double* expected_output, double learning_rate) {
+    fossil_jellyfish_backpropagate_with_loss(network, expected_output, learning_rate, LOSS_MSE);
+}
+
+// Fills the deltas of every layer after the input layer from the output error,
+// plus the extra errors injected into hidden layer outputs when errors is not NULL
+static void jellyfish_compute_deltas(fossil_jellyfish_network_t* network, const double* expected_output, fossil_jellyfish_loss_t loss, const double* const* errors) {
     fossil_jellyfish_layer_t* output_layer = network->layers[network->num_layers - 1];
 
-    // Calculate deltas for the output layer
+    // Calculate deltas for the output layer (deltas point down the loss surface)
+    fossil_jellyfish_loss_gradient(loss, output_layer->outputs, expected_output, output_layer->deltas, 1, output_layer->num_neurons);
     for (int32_t i = 0; i < output_layer->num_neurons; i++) {
-        double error = expected_output[i] - output_layer->outputs[i];
-        output_layer->deltas[i] = error * fossil_jellyfish_activate_derivative(output_layer->outputs[i], output_layer->activation);
+        output_layer->deltas[i] = -output_layer->deltas[i];
     }
+    fossil_jellyfish_activation_backward(output_layer->outputs, output_layer->deltas, output_layer->num_neurons, output_layer->activation);
 
-    // Propagate the error backward
-    for (int32_t i = network->num_layers - 2; i >= 0; i--) {
+    // Propagate the error backward; the input layer has no weights, so it needs no deltas
+    for (int32_t i = network->num_layers - 2; i > 0; i--) {
         fossil_jellyfish_layer_t* layer = network->layers[i];
         fossil_jellyfish_layer_t* next_layer = network->layers[i + 1];
 
+        if (next_layer->kind == LAYER_HASHED) {
+            jellyfish_hashed_transpose_matvec(next_layer, layer->num_neurons, next_layer->deltas, layer->deltas);
+        } else {
+            for (int32_t j = 0; j < layer->num_neurons; j++) {
+                double error = 0;
+                for (int32_t k = 0; k < next_layer->num_neurons; k++) {
+                    error += next_layer->weights[k * layer->num_neurons + j] * next_layer->deltas[k];
+                }
+                layer->deltas[j] = error;
+            }
+        }
+        const double* extra = errors ? errors[i] : NULL;
+        for (int32_t j = 0; extra && j < layer->num_neurons; j++) {
+            layer->deltas[j] += extra[j];
+        }
+        fossil_jellyfish_activation_backward(layer->outputs, layer->deltas, layer->num_neurons, layer->activation);
+    }
+}
+
+void fossil_jellyfish_backpropagate_with_loss(fossil_jellyfish_network_t* network, double* expected_output, double learning_rate, fossil_jellyfish_loss_t loss) {
+    // Stop sharing parameters with snapshots before updating them
+    if (fossil_jellyfish_make_writable(network) != 0) {
+        return;
+    }
+
+    jellyfish_compute_deltas(network, expected_output, loss, NULL);
+
+    // Update weights and biases
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        fossil_jellyfish_layer_t* prev_layer = network->layers[i - 1];
+        fossil_jellyfish_layer_t* layer = network->layers[i];
+
+        if (layer->kind == LAYER_HASHED) {
+            jellyfish_hashed_accumulate(layer, prev_layer->num_neurons, prev_layer->outputs, layer->deltas, learning_rate, layer->weights);
+            for (int32_t j = 0; j < layer->num_neurons; j++) {
+                layer->biases[j] += learning_rate * layer->deltas[j];
+            }
+            continue;
+        }
+
         for (int32_t j = 0; j < layer->num_neurons; j++) {
-            double error = 0;
-            for (int32_t k = 0; k < next_layer->num_neurons; k++) {
-                error += next_layer->weights[k * layer->num_neurons + j] * next_layer->deltas[k];
+            for (int32_t k = 0; k < prev_layer->num_neurons; k++) {
+                layer->weights[j * prev_layer->num_neurons + k] += learning_rate * layer->deltas[j] * prev_layer->outputs[k];
             }
-            layer->deltas[j] = error * fossil_jellyfish_activate_derivative(layer->outputs[j], layer->activation);
+            layer->biases[j] += learning_rate * layer->deltas[j];
         }
+    }
+}
+
+int64_t fossil_jellyfish_num_parameters(const fossil_jellyfish_network_t* network) {
+    int64_t count = 0;
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        count += (int64_t)jellyfish_weight_count(network, i) + network->layers[i]->num_neurons;
+    }
+    return count;
+}
+
+void fossil_jellyfish_accumulate_gradients(fossil_jellyfish_network_t* network, const double* expected_output, fossil_jellyfish_loss_t loss, double* gradients) {
+    jellyfish_accumulate_gradients(network, expected_output, loss, NULL, gradients);
+}
 
-        // Update weights and biases
-        for (int32_t j = 0; j < next_layer->num_neurons; j++) {
-            for (int32_t k = 0; k < layer->num_neurons; k++) {
-                next_layer->weights[j * layer->num_neurons + k] += learning_rate * next_layer->deltas[j] * layer->outputs[k];
+void jellyfish_accumulate_gradients(fossil_jellyfish_network_t* network, const double* expected_output, fossil_jellyfish_loss_t loss, const double* const* errors, double* gradients) {
+    jellyfish_compute_deltas(network, expected_output, loss, errors);
+
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        const fossil_jellyfish_layer_t* prev_layer = network->layers[i - 1];
+        const fossil_jellyfish_layer_t* layer = network->layers[i];
+        const double* restrict x = prev_layer->outputs;
+        int32_t fan_in = prev_layer->num_neurons;
+
+        if (layer->kind == LAYER_HASHED) {
+            jellyfish_hashed_accumulate(layer, fan_in, x, layer->deltas, -1.0, gradients);
+        } else {
+            for (int32_t j = 0; j < layer->num_neurons; j++) {
+                double* restrict g = gradients + (size_t)j * (size_t)fan_in;
+                double delta = layer->deltas[j];
+                for (int32_t k = 0; k < fan_in; k++) {
+                    g[k] -= delta * x[k];
+                }
             }
-            next_layer->biases[j] += learning_rate * next_layer->deltas[j];
         }
+        gradients += jellyfish_weight_count(network, i);
+        for (int32_t j = 0; j < layer->num_neurons; j++) {
+            gradients[j] -= layer->deltas[j];
+        }
+        gradients += layer->num_neurons;
+    }
+}
+
+int32_t fossil_jellyfish_apply_gradients(fossil_jellyfish_network_t* network, const double* gradients, double learning_rate) {
+    if (fossil_jellyfish_make_writable(network) != 0) {
+        return -1;
+    }
+
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        fossil_jellyfish_layer_t* layer = network->layers[i];
+        size_t weight_count = jellyfish_weight_count(network, i);
+        double* restrict w = layer->weights;
+        double* restrict b = layer->biases;
+
+        for (size_t k = 0; k < weight_count; k++) {
+            w[k] -= learning_rate * gradients[k];
+        }
+        gradients += weight_count;
+        for (int32_t j = 0; j < layer->num_neurons; j++) {
+            b[j] -= learning_rate * gradients[j];
+        }
+        gradients += layer->num_neurons;
     }
+    return 0;
 }
 
 // Train the network with gradient descent
 void fossil_jellyfish_train(fossil_jellyfish_network_t* network, double* inputs, double* expected_output, int32_t num_samples, int32_t num_epochs, double learning_rate) {
+    fossil_jellyfish_train_with_loss(network, inputs, expected_output, num_samples, num_epochs, learning_rate, LOSS_MSE);
+}
+
+void fossil_jellyfish_train_with_loss(fossil_jellyfish_network_t* network, double* inputs, double* expected_output, int32_t num_samples, int32_t num_epochs, double learning_rate, fossil_jellyfish_loss_t loss) {
     for (int32_t epoch = 0; epoch < num_epochs; epoch++) {
         for (int32_t i = 0; i < num_samples; i++) {
             fossil_jellyfish_forward(network, &inputs[i * network->layers[0]->num_neurons]);
-            fossil_jellyfish_backpropagate(network, &expected_output[i * network->layers[network->num_layers - 1]->num_neurons], learning_rate);
+            fossil_jellyfish_backpropagate_with_loss(network, &expected_output[i * network->layers[network->num_layers - 1]->num_neurons], learning_rate, loss);
+        }
+    }
+}
+
+// Versioned model file: a header, one record per layer, then tagged sections up to an end tag.
+// Readers skip sections they do not know, so later additions stay readable by older code.
+#define JELLYFISH_FILE_MAGIC 0x48534a46  // "FJSH"
+#define JELLYFISH_FILE_VERSION 1
+#define JELLYFISH_SECTION_END 0
+#define JELLYFISH_SECTION_NORMALIZATION 1  // Input means, then reciprocal standard deviations
+#define JELLYFISH_SECTION_PACKED 2         // One layer's panel-major weights after a jellyfish_packed_section_t
+#define JELLYFISH_MAX_LAYERS (1 << 16)
+#define JELLYFISH_MAX_NEURONS (1 << 24)
+
+typedef struct {
+    int32_t magic;
+    int32_t version;
+    int32_t num_layers;
+    int32_t reserved;
+} jellyfish_file_header_t;
+
+typedef struct {
+    int32_t num_neurons;
+    int32_t activation;
+    int32_t kind;
+    int32_t reserved;
+    int64_t num_params;
+    uint64_t hash_seed;
+} jellyfish_layer_record_t;
+
+typedef struct {
+    uint32_t tag;
+    uint32_t reserved;
+    uint64_t size;
+} jellyfish_section_header_t;
+
+// Readers with another panel width skip the section and keep the layer unpacked
+typedef struct {
+    int32_t layer;
+    int32_t panel_width;
+} jellyfish_packed_section_t;
+
+// Writes count doubles, or zeros when the array does not exist
+static int32_t jellyfish_write_array(FILE* file, const double* values, size_t count) {
+    static const double zeros[64];
+    if (values) {
+        return fwrite(values, sizeof(double), count, file) == count ? 0 : -1;
+    }
+    while (count > 0) {
+        size_t chunk = count < 64 ? count : 64;
+        if (fwrite(zeros, sizeof(double), chunk, file) != chunk) {
+            return -1;
         }
+        count -= chunk;
     }
+    return 0;
 }
 
 int32_t fossil_jellyfish_save(fossil_jellyfish_network_t* network, const char* file_path) {
@@ -152,77 +843,332 @@ int32_t fossil_jellyfish_save(fossil_jellyfish_network_t* network, const char* f
         return -1;  // Error opening the file
     }
 
-    // Write the number of layers
-    fwrite(&network->num_layers, sizeof(int32_t), 1, file);
+    jellyfish_file_header_t header = {JELLYFISH_FILE_MAGIC, JELLYFISH_FILE_VERSION, network->num_layers, 0};
+    int32_t status = fwrite(&header, sizeof(header), 1, file) == 1 ? 0 : -1;
 
-    // Write each layer's data
-    for (int i = 0; i < network->num_layers; i++) {
+    // Write each layer's description and parameters
+    for (int32_t i = 0; i < network->num_layers && status == 0; i++) {
         fossil_jellyfish_layer_t* layer = network->layers[i];
+        jellyfish_layer_record_t record;
+        memset(&record, 0, sizeof(record));
+        record.num_neurons = layer->num_neurons;
+        record.activation = (int32_t)layer->activation;
+        record.kind = (int32_t)layer->kind;
+        record.num_params = layer->kind == LAYER_HASHED ? layer->num_params : 0;
+        record.hash_seed = layer->kind == LAYER_HASHED ? layer->hash_seed : 0;
 
-        // Write number of neurons
-        fwrite(&layer->num_neurons, sizeof(int32_t), 1, file);
+        if (fwrite(&record, sizeof(record), 1, file) != 1 ||
+            jellyfish_write_array(file, layer->biases, (size_t)layer->num_neurons) != 0 ||
+            jellyfish_write_array(file, layer->weights, jellyfish_weight_count(network, i)) != 0) {
+            status = -1;
+        }
+    }
 
-        // Write activation function
-        fwrite(&layer->activation, sizeof(fossil_jellyfish_activation_t), 1, file);
+    if (status == 0 && network->input_mean) {
+        size_t width = (size_t)network->layers[0]->num_neurons;
+        jellyfish_section_header_t section = {JELLYFISH_SECTION_NORMALIZATION, 0, 2 * width * sizeof(double)};
+        if (fwrite(&section, sizeof(section), 1, file) != 1 ||
+            jellyfish_write_array(file, network->input_mean, width) != 0 ||
+            jellyfish_write_array(file, network->input_scale, width) != 0) {
+            status = -1;
+        }
+    }
 
-        // Write biases (size is num_neurons)
-        fwrite(layer->biases, sizeof(double), layer->num_neurons, file);
+    for (int32_t i = 1; i < network->num_layers && status == 0; i++) {
+        const fossil_jellyfish_layer_t* layer = network->layers[i];
+        if (!layer->packed) {
+            continue;
+        }
+        size_t count = jellyfish_packed_count(network->layers[i - 1]->num_neurons, layer->num_neurons);
+        jellyfish_section_header_t section = {JELLYFISH_SECTION_PACKED, 0, sizeof(jellyfish_packed_section_t) + count * sizeof(double)};
+        jellyfish_packed_section_t packed = {i, FOSSIL_JELLYFISH_PANEL_WIDTH};
+        if (fwrite(&section, sizeof(section), 1, file) != 1 || fwrite(&packed, sizeof(packed), 1, file) != 1 ||
+            jellyfish_write_array(file, layer->packed, count) != 0) {
+            status = -1;
+        }
+    }
+
+    jellyfish_section_header_t end = {JELLYFISH_SECTION_END, 0, 0};
+    if (status == 0 && fwrite(&end, sizeof(end), 1, file) != 1) {
+        status = -1;
+    }
+    if (fclose(file) != 0) {
+        status = -1;
+    }
+    return status;
+}
 
-        // Write weights (size is num_neurons * number of neurons in previous layer)
-        int32_t prev_layer_neurons = (i == 0) ? 0 : network->layers[i - 1]->num_neurons;
-        fwrite(layer->weights, sizeof(double), layer->num_neurons * prev_layer_neurons, file);
+// Sequential source of a saved network: an open file, or a byte range in memory
+typedef struct {
+    FILE* file;
+    const unsigned char* bytes;
+    size_t size;
+    size_t position;
+} jellyfish_reader_t;
 
-        // Optionally save deltas (used in backpropagation)
-        fwrite(layer->deltas, sizeof(double), layer->num_neurons, file);
+// fread semantics over either source: returns the number of whole items copied
+static size_t jellyfish_read(jellyfish_reader_t* reader, void* destination, size_t size, size_t count) {
+    if (reader->file) {
+        return fread(destination, size, count, reader->file);
+    }
+    size_t available = (reader->size - reader->position) / size;
+    count = count < available ? count : available;
+    if (count > 0) {
+        memcpy(destination, reader->bytes + reader->position, count * size);
+        reader->position += count * size;
     }
+    return count;
+}
 
-    fclose(file);
-    return 0;  // Success
+static int32_t jellyfish_rewind(jellyfish_reader_t* reader) {
+    reader->position = 0;
+    return reader->file ? (fseek(reader->file, 0, SEEK_SET) == 0 ? 0 : -1) : 0;
 }
 
-fossil_jellyfish_network_t* fossil_jellyfish_load(const char* file_path) {
-    FILE *file = fopen(file_path, "rb");
-    if (!file) {
-        return NULL;  // Error opening the file
+static int32_t jellyfish_skip(jellyfish_reader_t* reader, uint64_t size) {
+    if (reader->file) {
+        return fseek(reader->file, (long)size, SEEK_CUR) == 0 ? 0 : -1;
+    }
+    if (size > (uint64_t)(reader->size - reader->position)) {
+        return -1;
     }
+    reader->position += (size_t)size;
+    return 0;
+}
 
-    // Read the number of layers
-    int32_t num_layers;
-    fread(&num_layers, sizeof(int32_t), 1, file);
+// Reads count doubles into a new array, refusing counts larger than the rest of the file
+static double* jellyfish_read_array(const fossil_jellyfish_allocator_t* allocator, jellyfish_reader_t* reader, size_t count, int64_t* remaining) {
+    if ((uint64_t)count > (uint64_t)*remaining / sizeof(double)) {
+        return NULL;
+    }
+    double* values = jellyfish_alloc_array(allocator, count);
+    if (values && jellyfish_read(reader, values, sizeof(double), count) != count) {
+        jellyfish_free_with(allocator, values);
+        return NULL;
+    }
+    *remaining -= (int64_t)(count * sizeof(double));
+    return values;
+}
 
-    // Allocate memory for the network
-    fossil_jellyfish_network_t* network = (fossil_jellyfish_network_t*)malloc(sizeof(fossil_jellyfish_network_t));
-    network->num_layers = num_layers;
-    network->layers = (fossil_jellyfish_layer_t**)malloc(num_layers * sizeof(fossil_jellyfish_layer_t*));
+static fossil_jellyfish_network_t* jellyfish_empty_network(int32_t num_layers, const fossil_jellyfish_allocator_t* hooks) {
+    fossil_jellyfish_allocator_t allocator = hooks ? *hooks : fossil_jellyfish_get_allocator();
+    fossil_jellyfish_network_t* network = (fossil_jellyfish_network_t*)jellyfish_calloc_with(&allocator, 1, sizeof(fossil_jellyfish_network_t));
+    if (!network) {
+        return NULL;
+    }
+    network->allocator = allocator;
+    network->layers = (fossil_jellyfish_layer_t**)jellyfish_calloc_with(&allocator, (size_t)num_layers, sizeof(fossil_jellyfish_layer_t*));
+    if (!network->layers) {
+        jellyfish_free_with(&allocator, network);
+        return NULL;
+    }
+    return network;
+}
 
-    // Read each layer's data
-    for (int i = 0; i < num_layers; i++) {
-        // Allocate memory for the layer
-        fossil_jellyfish_layer_t* layer = (fossil_jellyfish_layer_t*)malloc(sizeof(fossil_jellyfish_layer_t));
+// Adds a layer with zeroed buffers; the parameters are filled in by the reader
+static fossil_jellyfish_layer_t* jellyfish_append_layer(fossil_jellyfish_network_t* network, int32_t num_neurons, int32_t activation) {
+    fossil_jellyfish_layer_t* layer = (fossil_jellyfish_layer_t*)jellyfish_calloc_with(&network->allocator, 1, sizeof(fossil_jellyfish_layer_t));
+    if (!layer) {
+        return NULL;
+    }
+    network->layers[network->num_layers++] = layer;
+    layer->num_neurons = num_neurons;
+    layer->activation = (fossil_jellyfish_activation_t)activation;
+    layer->kind = LAYER_DENSE;
+    layer->outputs = (double*)jellyfish_calloc_with(&network->allocator, (size_t)num_neurons, sizeof(double));
+    if (network->num_layers > 1) {
+        layer->deltas = (double*)jellyfish_calloc_with(&network->allocator, (size_t)num_neurons, sizeof(double));
+    }
+    if (!layer->outputs || (network->num_layers > 1 && !layer->deltas)) {
+        return NULL;
+    }
+    return layer;
+}
 
-        // Read number of neurons
-        fread(&layer->num_neurons, sizeof(int32_t), 1, file);
+static int32_t jellyfish_valid_layer(int32_t num_neurons, int32_t activation) {
+    return num_neurons > 0 && num_neurons <= JELLYFISH_MAX_NEURONS && activation >= ACTIVATION_RELU && activation <= ACTIVATION_LINEAR;
+}
 
-        // Read activation function
-        fread(&layer->activation, sizeof(fossil_jellyfish_activation_t), 1, file);
+// Files written before the format was versioned start with the layer count and store
+// biases, weights and deltas for every layer, the input layer included
+static fossil_jellyfish_network_t* jellyfish_load_legacy(jellyfish_reader_t* reader, int32_t num_layers, int64_t remaining, const fossil_jellyfish_allocator_t* allocator) {
+    fossil_jellyfish_network_t* network = jellyfish_empty_network(num_layers, allocator);
+    if (!network) {
+        return NULL;
+    }
 
-        // Allocate and read biases
-        layer->biases = (double*)malloc(layer->num_neurons * sizeof(double));
-        fread(layer->biases, sizeof(double), layer->num_neurons, file);
+    for (int32_t i = 0; i < num_layers; i++) {
+        int32_t fields[2];
+        if (jellyfish_read(reader, fields, sizeof(int32_t), 2) != 2 || !jellyfish_valid_layer(fields[0], fields[1])) {
+            break;
+        }
+        remaining -= (int64_t)sizeof(fields);
+        fossil_jellyfish_layer_t* layer = jellyfish_append_layer(network, fields[0], fields[1]);
+        if (!layer) {
+            break;
+        }
 
-        // Allocate and read weights (size is num_neurons * number of neurons in previous layer)
-        int32_t prev_layer_neurons = (i == 0) ? 0 : network->layers[i - 1]->num_neurons;
-        layer->weights = (double*)malloc(layer->num_neurons * prev_layer_neurons * sizeof(double));
-        fread(layer->weights, sizeof(double), layer->num_neurons * prev_layer_neurons, file);
+        size_t fan_in = i > 0 ? (size_t)network->layers[i - 1]->num_neurons : 0;
+        double* biases = jellyfish_read_array(&network->allocator, reader, (size_t)fields[0], &remaining);
+        double* weights = jellyfish_read_array(&network->allocator, reader, (size_t)fields[0] * fan_in, &remaining);
+        double* deltas = jellyfish_read_array(&network->allocator, reader, (size_t)fields[0], &remaining);
+        jellyfish_free_with(&network->allocator, deltas);
+        if (i == 0) {
+            jellyfish_free_with(&network->allocator, biases);
+            jellyfish_free_with(&network->allocator, weights);
+            if (!biases || !weights || !deltas) {
+                break;
+            }
+            continue;
+        }
+        layer->biases = biases;
+        layer->weights = weights;
+        if (!biases || !weights || !deltas) {
+            break;
+        }
+    }
 
-        // Allocate and read deltas (if used)
-        layer->deltas = (double*)malloc(layer->num_neurons * sizeof(double));
-        fread(layer->deltas, sizeof(double), layer->num_neurons, file);
+    if (network->num_layers != num_layers || (num_layers > 1 && !network->layers[num_layers - 1]->weights)) {
+        fossil_jellyfish_free_network(network);
+        return NULL;
+    }
+    return network;
+}
 
-        // Assign the layer to the network
-        network->layers[i] = layer;
+static fossil_jellyfish_network_t* jellyfish_load_versioned(jellyfish_reader_t* reader, int64_t remaining, const fossil_jellyfish_allocator_t* allocator) {
+    jellyfish_file_header_t header;
+    if (jellyfish_read(reader, &header, sizeof(header), 1) != 1 || header.version < 1 || header.version > JELLYFISH_FILE_VERSION ||
+        header.num_layers < 1 || header.num_layers > JELLYFISH_MAX_LAYERS) {
+        return NULL;
+    }
+    remaining -= (int64_t)sizeof(header);
+
+    fossil_jellyfish_network_t* network = jellyfish_empty_network(header.num_layers, allocator);
+    if (!network) {
+        return NULL;
+    }
+
+    int32_t status = 0;
+    for (int32_t i = 0; i < header.num_layers && status == 0; i++) {
+        jellyfish_layer_record_t record;
+        fossil_jellyfish_layer_t* layer = NULL;
+        if (jellyfish_read(reader, &record, sizeof(record), 1) != 1 || !jellyfish_valid_layer(record.num_neurons, record.activation) ||
+            (record.kind != LAYER_DENSE && record.kind != LAYER_HASHED) ||
+            (record.kind == LAYER_HASHED && (i == 0 || record.num_params <= 0 || record.num_params > (int64_t)UINT32_MAX)) ||
+            !(layer = jellyfish_append_layer(network, record.num_neurons, record.activation))) {
+            status = -1;
+            break;
+        }
+        remaining -= (int64_t)sizeof(record);
+        layer->kind = (fossil_jellyfish_layer_kind_t)record.kind;
+        layer->num_params = record.kind == LAYER_HASHED ? record.num_params : 0;
+        layer->hash_seed = record.kind == LAYER_HASHED ? record.hash_seed : 0;
+
+        // The input layer has no parameters; its placeholder values are skipped
+        double* biases = jellyfish_read_array(&network->allocator, reader, (size_t)record.num_neurons, &remaining);
+        if (i == 0) {
+            jellyfish_free_with(&network->allocator, biases);
+            status = biases ? 0 : -1;
+            continue;
+        }
+        layer->biases = biases;
+        layer->weights = biases ? jellyfish_read_array(&network->allocator, reader, jellyfish_weight_count(network, i), &remaining) : NULL;
+        status = layer->weights ? 0 : -1;
+    }
+
+    // Read the sections this version knows and skip whatever a newer writer added
+    while (status == 0) {
+        jellyfish_section_header_t section;
+        if (jellyfish_read(reader, &section, sizeof(section), 1) != 1) {
+            status = -1;
+            break;
+        }
+        remaining -= (int64_t)sizeof(section);
+        if (section.tag == JELLYFISH_SECTION_END) {
+            break;
+        }
+        size_t width = (size_t)network->layers[0]->num_neurons;
+        if (section.tag == JELLYFISH_SECTION_NORMALIZATION && section.size == 2 * width * sizeof(double) && !network->input_mean) {
+            network->input_mean = jellyfish_read_array(&network->allocator, reader, width, &remaining);
+            network->input_scale = network->input_mean ? jellyfish_read_array(&network->allocator, reader, width, &remaining) : NULL;
+            status = network->input_scale ? 0 : -1;
+            continue;
+        }
+        if (section.tag == JELLYFISH_SECTION_PACKED && section.size >= sizeof(jellyfish_packed_section_t)) {
+            jellyfish_packed_section_t packed;
+            if (jellyfish_read(reader, &packed, sizeof(packed), 1) != 1) {
+                status = -1;
+                break;
+            }
+            remaining -= (int64_t)sizeof(packed);
+            section.size -= sizeof(packed);
+            fossil_jellyfish_layer_t* layer = packed.layer >= 1 && packed.layer < network->num_layers ? network->layers[packed.layer] : NULL;
+            if (layer && packed.panel_width == FOSSIL_JELLYFISH_PANEL_WIDTH && layer->kind == LAYER_DENSE && !layer->packed &&
+                layer->num_neurons >= FOSSIL_JELLYFISH_PANEL_WIDTH &&
+                section.size == jellyfish_packed_count(network->layers[packed.layer - 1]->num_neurons, layer->num_neurons) * sizeof(double)) {
+                layer->packed = jellyfish_read_array(&network->allocator, reader, (size_t)(section.size / sizeof(double)), &remaining);
+                status = layer->packed ? 0 : -1;
+                continue;
+            }
+        }
+        if (section.size > (uint64_t)remaining || jellyfish_skip(reader, section.size) != 0) {
+            status = -1;
+            break;
+        }
+        remaining -= (int64_t)section.size;
     }
 
+    if (status != 0) {
+        fossil_jellyfish_free_network(network);
+        return NULL;
+    }
+    return network;
+}
+
+fossil_jellyfish_network_t* fossil_jellyfish_load(const char* file_path) {
+    return jellyfish_load_with(file_path, NULL);
+}
+
+// Dispatches on the first word: the versioned format's magic or a legacy layer count
+static fossil_jellyfish_network_t* jellyfish_load_from(jellyfish_reader_t* reader, int64_t size, const fossil_jellyfish_allocator_t* allocator) {
+    int32_t first = 0;
+    if (size < (int64_t)sizeof(int32_t) || jellyfish_read(reader, &first, sizeof(int32_t), 1) != 1) {
+        return NULL;
+    }
+    if (first == JELLYFISH_FILE_MAGIC) {
+        // The header is read again in full
+        if (jellyfish_rewind(reader) != 0) {
+            return NULL;
+        }
+        return jellyfish_load_versioned(reader, size, allocator);
+    }
+    if (first >= 1 && first <= JELLYFISH_MAX_LAYERS) {
+        return jellyfish_load_legacy(reader, first, size - (int64_t)sizeof(int32_t), allocator);
+    }
+    return NULL;
+}
+
+fossil_jellyfish_network_t* jellyfish_load_with(const char* file_path, const fossil_jellyfish_allocator_t* allocator) {
+    FILE *file = fopen(file_path, "rb");
+    if (!file) {
+        return NULL;  // Error opening the file
+    }
+
+    // The file size bounds every count read from it
+    long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    fossil_jellyfish_network_t* network = NULL;
+    if (size >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        jellyfish_reader_t reader = {file, NULL, 0, 0};
+        network = jellyfish_load_from(&reader, (int64_t)size, allocator);
+    }
     fclose(file);
     return network;
 }
+
+fossil_jellyfish_network_t* jellyfish_load_image(const void* image, size_t image_size, const fossil_jellyfish_allocator_t* allocator) {
+    if (!image || image_size > (size_t)INT64_MAX) {
+        return NULL;
+    }
+    jellyfish_reader_t reader = {NULL, (const unsigned char*)image, image_size, 0};
+    return jellyfish_load_from(&reader, (int64_t)image_size, allocator);
+}
@@ -0,0 +1,522 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include "fossil/jellyfish/jit.h"
+#include "fossil/jellyfish/hashed.h"
+#include "internal.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JELLYFISH_JIT_X86_64
+#endif
+
+#if !defined(_WIN32) && !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+// Neuron pairs per register tile; each SSE2 accumulator holds two neurons
+#define JELLYFISH_JIT_TILE 4
+
+typedef void (*jellyfish_jit_function_t)(const double* input, double* output, double* workspace);
+
+static int32_t jellyfish_jit_pairs(int32_t neurons) {
+    return (neurons + 1) / 2;
+}
+
+static size_t jellyfish_jit_even(size_t count) {
+    return count + (count & 1);
+}
+
+// Data layout shared by the generator and refresh: the normalization mean and scale,
+// then per layer and per tile of up to four neuron pairs, fan_in rows of the tile's
+// weights followed by its biases. Padding neurons get zeros.
+static size_t jellyfish_jit_data_size(const fossil_jellyfish_network_t* network) {
+    size_t size = network->input_mean ? 2 * jellyfish_jit_even((size_t)network->layers[0]->num_neurons) : 0;
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        size += 2 * (size_t)jellyfish_jit_pairs(network->layers[i]->num_neurons) * ((size_t)network->layers[i - 1]->num_neurons + 1);
+    }
+    return size;
+}
+
+static void jellyfish_jit_fill(fossil_jellyfish_jit_t* jit) {
+    const fossil_jellyfish_network_t* network = jit->network;
+    double* data = jit->data;
+
+    if (network->input_mean) {
+        size_t width = (size_t)jit->input_width;
+        memcpy(data, network->input_mean, width * sizeof(double));
+        memcpy(data + jellyfish_jit_even(width), network->input_scale, width * sizeof(double));
+        data += 2 * jellyfish_jit_even(width);
+    }
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        const fossil_jellyfish_layer_t* layer = network->layers[i];
+        int32_t fan_in = network->layers[i - 1]->num_neurons;
+        int32_t pairs = jellyfish_jit_pairs(layer->num_neurons);
+        for (int32_t p0 = 0; p0 < pairs; p0 += JELLYFISH_JIT_TILE) {
+            int32_t lanes = 2 * (pairs - p0 < JELLYFISH_JIT_TILE ? pairs - p0 : JELLYFISH_JIT_TILE);
+            for (int32_t k = 0; k < fan_in; k++) {
+                for (int32_t l = 0; l < lanes; l++) {
+                    int32_t j = 2 * p0 + l;
+                    *data++ = j < layer->num_neurons ? fossil_jellyfish_layer_weight(network, i, j, k) : 0;
+                }
+            }
+            for (int32_t l = 0; l < lanes; l++) {
+                int32_t j = 2 * p0 + l;
+                *data++ = j < layer->num_neurons ? layer->biases[j] : 0;
+            }
+        }
+    }
+}
+
+#ifdef JELLYFISH_JIT_X86_64
+
+// x86-64 code generation
+
+enum {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15
+};
+
+#ifdef _WIN32
+#define JELLYFISH_ARG0 RCX
+#define JELLYFISH_ARG1 RDX
+#define JELLYFISH_ARG2 R8
+#define JELLYFISH_SHADOW_SPACE 32
+#else
+#define JELLYFISH_ARG0 RDI
+#define JELLYFISH_ARG1 RSI
+#define JELLYFISH_ARG2 RDX
+#define JELLYFISH_SHADOW_SPACE 0
+#endif
+
+// SSE2 opcodes after the 0x0F escape, with their mandatory prefixes
+#define SSE_PD 0x66
+#define SSE_SD 0xf2
+#define OP_MOVE_LOAD 0x10
+#define OP_MOVE_STORE 0x11
+#define OP_UNPCKLPD 0x14
+#define OP_MOVAPD 0x28
+#define OP_XORPD 0x57
+#define OP_ADD 0x58
+#define OP_MUL 0x59
+#define OP_SUB 0x5c
+#define OP_MAXPD 0x5f
+
+typedef struct {
+    uint8_t* bytes;
+    size_t size;
+    size_t capacity;
+    int32_t failed;
+} jellyfish_emitter_t;
+
+static void jellyfish_emit(jellyfish_emitter_t* e, uint8_t byte) {
+    if (e->size == e->capacity) {
+        size_t capacity = e->capacity ? 2 * e->capacity : 4096;
+        uint8_t* bytes = (uint8_t*)jellyfish_realloc(e->bytes, e->size, capacity);
+        if (!bytes) {
+            e->failed = 1;
+            return;
+        }
+        e->bytes = bytes;
+        e->capacity = capacity;
+    }
+    e->bytes[e->size++] = byte;
+}
+
+static void jellyfish_emit32(jellyfish_emitter_t* e, uint32_t value) {
+    for (int32_t b = 0; b < 4; b++) {
+        jellyfish_emit(e, (uint8_t)(value >> (8 * b)));
+    }
+}
+
+static void jellyfish_emit64(jellyfish_emitter_t* e, uint64_t value) {
+    jellyfish_emit32(e, (uint32_t)value);
+    jellyfish_emit32(e, (uint32_t)(value >> 32));
+}
+
+// REX prefix; emitted only when one of its bits is needed
+static void jellyfish_emit_rex(jellyfish_emitter_t* e, int32_t wide, int32_t reg, int32_t base) {
+    uint8_t rex = (uint8_t)(0x40 | (wide ? 8 : 0) | (reg & 8 ? 4 : 0) | (base & 8 ? 1 : 0));
+    if (rex != 0x40) {
+        jellyfish_emit(e, rex);
+    }
+}
+
+// [base + disp32]; rsp and r12 as a base need a SIB byte
+static void jellyfish_emit_mem(jellyfish_emitter_t* e, int32_t reg, int32_t base, int32_t disp) {
+    jellyfish_emit(e, (uint8_t)(0x80 | (reg & 7) << 3 | (base & 7)));
+    if ((base & 7) == RSP) {
+        jellyfish_emit(e, 0x24);
+    }
+    jellyfish_emit32(e, (uint32_t)disp);
+}
+
+static void jellyfish_emit_push(jellyfish_emitter_t* e, int32_t reg) {
+    jellyfish_emit_rex(e, 0, 0, reg);
+    jellyfish_emit(e, (uint8_t)(0x50 + (reg & 7)));
+}
+
+static void jellyfish_emit_pop(jellyfish_emitter_t* e, int32_t reg) {
+    jellyfish_emit_rex(e, 0, 0, reg);
+    jellyfish_emit(e, (uint8_t)(0x58 + (reg & 7)));
+}
+
+static void jellyfish_emit_mov(jellyfish_emitter_t* e, int32_t dst, int32_t src) {
+    jellyfish_emit_rex(e, 1, src, dst);
+    jellyfish_emit(e, 0x89);
+    jellyfish_emit(e, (uint8_t)(0xc0 | (src & 7) << 3 | (dst & 7)));
+}
+
+static void jellyfish_emit_mov64(jellyfish_emitter_t* e, int32_t dst, uint64_t value) {
+    jellyfish_emit_rex(e, 1, 0, dst);
+    jellyfish_emit(e, (uint8_t)(0xb8 + (dst & 7)));
+    jellyfish_emit64(e, value);
+}
+
+// Zero-extends into the full register
+static void jellyfish_emit_mov32(jellyfish_emitter_t* e, int32_t dst, uint32_t value) {
+    jellyfish_emit_rex(e, 0, 0, dst);
+    jellyfish_emit(e, (uint8_t)(0xb8 + (dst & 7)));
+    jellyfish_emit32(e, value);
+}
+
+static void jellyfish_emit_lea(jellyfish_emitter_t* e, int32_t dst, int32_t base, int32_t disp) {
+    jellyfish_emit_rex(e, 1, dst, base);
+    jellyfish_emit(e, 0x8d);
+    jellyfish_emit_mem(e, dst, base, disp);
+}
+
+// add (extension 0) or sub (extension 5) of a 32-bit immediate
+static void jellyfish_emit_arith(jellyfish_emitter_t* e, int32_t extension, int32_t dst, int32_t value) {
+    jellyfish_emit_rex(e, 1, 0, dst);
+    jellyfish_emit(e, 0x81);
+    jellyfish_emit(e, (uint8_t)(0xc0 | extension << 3 | (dst & 7)));
+    jellyfish_emit32(e, (uint32_t)value);
+}
+
+// dec dst; jnz target
+static void jellyfish_emit_loop(jellyfish_emitter_t* e, int32_t counter, size_t target) {
+    jellyfish_emit_rex(e, 1, 0, counter);
+    jellyfish_emit(e, 0xff);
+    jellyfish_emit(e, (uint8_t)(0xc8 | (counter & 7)));
+    jellyfish_emit(e, 0x0f);
+    jellyfish_emit(e, 0x85);
+    jellyfish_emit32(e, (uint32_t)(int32_t)((int64_t)target - (int64_t)(e->size + 4)));
+}
+
+static void jellyfish_emit_call(jellyfish_emitter_t* e, int32_t reg) {
+    jellyfish_emit_rex(e, 0, 0, reg);
+    jellyfish_emit(e, 0xff);
+    jellyfish_emit(e, (uint8_t)(0xd0 | (reg & 7)));
+}
+
+static void jellyfish_emit_sse(jellyfish_emitter_t* e, uint8_t prefix, uint8_t opcode, int32_t xmm, int32_t src) {
+    jellyfish_emit(e, prefix);
+    jellyfish_emit_rex(e, 0, xmm, src);
+    jellyfish_emit(e, 0x0f);
+    jellyfish_emit(e, opcode);
+    jellyfish_emit(e, (uint8_t)(0xc0 | (xmm & 7) << 3 | (src & 7)));
+}
+
+static void jellyfish_emit_sse_mem(jellyfish_emitter_t* e, uint8_t prefix, uint8_t opcode, int32_t xmm, int32_t base, int32_t disp) {
+    jellyfish_emit(e, prefix);
+    jellyfish_emit_rex(e, 0, xmm, base);
+    jellyfish_emit(e, 0x0f);
+    jellyfish_emit(e, opcode);
+    jellyfish_emit_mem(e, xmm, base, disp);
+}
+
+static uint64_t jellyfish_address(const void* pointer) {
+    return (uint64_t)(uintptr_t)pointer;
+}
+
+// Registers: r12 input, r13 output, r14 workspace, r15 the layer's inputs, rbx its outputs;
+// rax walks the tile data, r10 the inputs, rcx counts. xmm0-3 accumulate, xmm4-5 are temporaries.
+static void jellyfish_jit_generate(const fossil_jellyfish_jit_t* jit, jellyfish_emitter_t* e) {
+    const fossil_jellyfish_network_t* network = jit->network;
+    const double* data = jit->data;
+    size_t width = (size_t)jit->input_width;
+    int32_t hidden = (int32_t)jellyfish_jit_even((size_t)jellyfish_max_width(network));
+    int32_t buffers[2] = {(int32_t)jellyfish_jit_even(width), (int32_t)jellyfish_jit_even(width) + hidden};
+
+    jellyfish_emit_push(e, RBX);
+    jellyfish_emit_push(e, R12);
+    jellyfish_emit_push(e, R13);
+    jellyfish_emit_push(e, R14);
+    jellyfish_emit_push(e, R15);
+    if (JELLYFISH_SHADOW_SPACE > 0) {
+        jellyfish_emit_arith(e, 5, RSP, JELLYFISH_SHADOW_SPACE);
+    }
+    jellyfish_emit_mov(e, R12, JELLYFISH_ARG0);
+    jellyfish_emit_mov(e, R13, JELLYFISH_ARG1);
+    jellyfish_emit_mov(e, R14, JELLYFISH_ARG2);
+
+    // Standardized inputs go to the start of the workspace: (x - mean) * scale
+    if (network->input_mean) {
+        jellyfish_emit_mov(e, R10, R12);
+        jellyfish_emit_mov(e, R9, R14);
+        jellyfish_emit_mov64(e, RAX, jellyfish_address(data));
+        jellyfish_emit_mov64(e, R11, jellyfish_address(data + jellyfish_jit_even(width)));
+        jellyfish_emit_mov32(e, RCX, (uint32_t)width);
+        size_t loop = e->size;
+        jellyfish_emit_sse_mem(e, SSE_SD, OP_MOVE_LOAD, 0, R10, 0);
+        jellyfish_emit_sse_mem(e, SSE_SD, OP_SUB, 0, RAX, 0);
+        jellyfish_emit_sse_mem(e, SSE_SD, OP_MUL, 0, R11, 0);
+        jellyfish_emit_sse_mem(e, SSE_SD, OP_MOVE_STORE, 0, R9, 0);
+        jellyfish_emit_arith(e, 0, R10, 8);
+        jellyfish_emit_arith(e, 0, RAX, 8);
+        jellyfish_emit_arith(e, 0, R11, 8);
+        jellyfish_emit_arith(e, 0, R9, 8);
+        jellyfish_emit_loop(e, RCX, loop);
+        jellyfish_emit_mov(e, R15, R14);
+        data += 2 * jellyfish_jit_even(width);
+    } else {
+        jellyfish_emit_mov(e, R15, R12);
+    }
+
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        const fossil_jellyfish_layer_t* layer = network->layers[i];
+        int32_t fan_in = network->layers[i - 1]->num_neurons;
+        int32_t neurons = layer->num_neurons;
+        int32_t pairs = jellyfish_jit_pairs(neurons);
+        int32_t relu = layer->activation == ACTIVATION_RELU;
+
+        if (i == network->num_layers - 1) {
+            jellyfish_emit_mov(e, RBX, R13);
+        } else {
+            jellyfish_emit_lea(e, RBX, R14, buffers[i & 1] * (int32_t)sizeof(double));
+        }
+
+        for (int32_t p0 = 0; p0 < pairs; p0 += JELLYFISH_JIT_TILE) {
+            int32_t tile = pairs - p0 < JELLYFISH_JIT_TILE ? pairs - p0 : JELLYFISH_JIT_TILE;
+            jellyfish_emit_mov64(e, RAX, jellyfish_address(data));
+            jellyfish_emit_mov(e, R10, R15);
+            jellyfish_emit_mov32(e, RCX, (uint32_t)fan_in);
+            for (int32_t a = 0; a < tile; a++) {
+                jellyfish_emit_sse(e, SSE_PD, OP_XORPD, a, a);
+            }
+
+            // One input broadcast feeds every accumulator; sums run in input order
+            size_t loop = e->size;
+            jellyfish_emit_sse_mem(e, SSE_SD, OP_MOVE_LOAD, 4, R10, 0);
+            jellyfish_emit_sse(e, SSE_PD, OP_UNPCKLPD, 4, 4);
+            for (int32_t a = 0; a < tile; a++) {
+                jellyfish_emit_sse(e, SSE_PD, OP_MOVAPD, 5, 4);
+                jellyfish_emit_sse_mem(e, SSE_PD, OP_MUL, 5, RAX, 16 * a);
+                jellyfish_emit_sse(e, SSE_PD, OP_ADD, a, 5);
+            }
+            jellyfish_emit_arith(e, 0, R10, 8);
+            jellyfish_emit_arith(e, 0, RAX, 16 * tile);
+            jellyfish_emit_loop(e, RCX, loop);
+
+            // rax now points at the tile's biases
+            if (relu) {
+                jellyfish_emit_sse(e, SSE_PD, OP_XORPD, 5, 5);
+            }
+            for (int32_t a = 0; a < tile; a++) {
+                int32_t j = 2 * (p0 + a);
+                jellyfish_emit_sse_mem(e, SSE_PD, OP_ADD, a, RAX, 16 * a);
+                if (relu) {
+                    // maxpd returns its second operand for NaN and signed zeros, as v > 0 ? v : 0 does
+                    jellyfish_emit_sse(e, SSE_PD, OP_MAXPD, a, 5);
+                }
+                if (j + 1 < neurons) {
+                    jellyfish_emit_sse_mem(e, SSE_PD, OP_MOVE_STORE, a, RBX, j * (int32_t)sizeof(double));
+                } else {
+                    jellyfish_emit_sse_mem(e, SSE_SD, OP_MOVE_STORE, a, RBX, j * (int32_t)sizeof(double));
+                }
+            }
+            data += (size_t)(2 * tile) * ((size_t)fan_in + 1);
+        }
+
+        // Other activations call the library's kernel on the finished layer
+        if (layer->activation != ACTIVATION_RELU && layer->activation != ACTIVATION_LINEAR) {
+            void (*forward)(double*, int32_t) = jellyfish_activation_kernel(layer->activation)->forward;
+            uint64_t target = 0;
+            memcpy(&target, &forward, sizeof(forward) < sizeof(target) ? sizeof(forward) : sizeof(target));
+            jellyfish_emit_mov(e, JELLYFISH_ARG0, RBX);
+            jellyfish_emit_mov32(e, JELLYFISH_ARG1, (uint32_t)neurons);
+            jellyfish_emit_mov64(e, RAX, target);
+            jellyfish_emit_call(e, RAX);
+        }
+        jellyfish_emit_mov(e, R15, RBX);
+    }
+
+    if (JELLYFISH_SHADOW_SPACE > 0) {
+        jellyfish_emit_arith(e, 0, RSP, JELLYFISH_SHADOW_SPACE);
+    }
+    jellyfish_emit_pop(e, R15);
+    jellyfish_emit_pop(e, R14);
+    jellyfish_emit_pop(e, R13);
+    jellyfish_emit_pop(e, R12);
+    jellyfish_emit_pop(e, RBX);
+    jellyfish_emit(e, 0xc3);
+}
+
+// Copies the code into a fresh mapping and flips it from writable to executable
+static void* jellyfish_jit_map(const uint8_t* code, size_t size, size_t* mapping_size) {
+#ifdef _WIN32
+    void* mapping = VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    DWORD previous;
+    if (!mapping) {
+        return NULL;
+    }
+    memcpy(mapping, code, size);
+    if (!VirtualProtect(mapping, size, PAGE_EXECUTE_READ, &previous)) {
+        VirtualFree(mapping, 0, MEM_RELEASE);
+        return NULL;
+    }
+    FlushInstructionCache(GetCurrentProcess(), mapping, size);
+    *mapping_size = size;
+    return mapping;
+#else
+    long page = sysconf(_SC_PAGESIZE);
+    size_t rounded = page > 0 ? (size + (size_t)page - 1) / (size_t)page * (size_t)page : size;
+    void* mapping = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+    memcpy(mapping, code, size);
+    if (mprotect(mapping, rounded, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mapping, rounded);
+        return NULL;
+    }
+    *mapping_size = rounded;
+    return mapping;
+#endif
+}
+
+static void jellyfish_jit_unmap(void* mapping, size_t size) {
+#ifdef _WIN32
+    (void)size;
+    VirtualFree(mapping, 0, MEM_RELEASE);
+#else
+    munmap(mapping, size);
+#endif
+}
+
+#endif /* JELLYFISH_JIT_X86_64 */
+
+fossil_jellyfish_jit_t* fossil_jellyfish_jit_compile(const fossil_jellyfish_network_t* network) {
+    if (!network || network->num_layers < 1) {
+        return NULL;
+    }
+    fossil_jellyfish_jit_t* jit = (fossil_jellyfish_jit_t*)jellyfish_calloc(1, sizeof(fossil_jellyfish_jit_t));
+    if (!jit) {
+        return NULL;
+    }
+    jit->network = network;
+    jit->input_width = network->layers[0]->num_neurons;
+    jit->output_width = network->layers[network->num_layers - 1]->num_neurons;
+    jit->data_size = jellyfish_jit_data_size(network);
+    jit->workspace_size = jellyfish_forward_scratch_size(network);
+
+    // The code bakes in every layer's shape, so refresh must see the same one
+    jit->num_layers = network->num_layers;
+    jit->normalized = network->input_mean != NULL;
+    jit->layer_shape = (int32_t*)jellyfish_malloc(2 * (size_t)network->num_layers * sizeof(int32_t));
+    if (!jit->layer_shape) {
+        jellyfish_free(jit);
+        return NULL;
+    }
+    for (int32_t i = 0; i < network->num_layers; i++) {
+        jit->layer_shape[2 * i] = network->layers[i]->num_neurons;
+        jit->layer_shape[2 * i + 1] = (int32_t)network->layers[i]->activation;
+    }
+
+    // One spare pair of doubles lets the data start on a 16-byte boundary for mulpd
+    jit->data_block = jellyfish_malloc((jit->data_size + 2) * sizeof(double));
+    if (!jit->data_block) {
+        jellyfish_free(jit->layer_shape);
+        jellyfish_free(jit);
+        return NULL;
+    }
+    jit->data = (double*)(((uintptr_t)jit->data_block + 15) & ~(uintptr_t)15);
+    jellyfish_jit_fill(jit);
+
+#ifdef JELLYFISH_JIT_X86_64
+    // Single-layer networks only copy their inputs, which the generic path does as well
+    if (network->num_layers > 1) {
+        jellyfish_emitter_t emitter = {NULL, 0, 0, 0};
+        jellyfish_jit_generate(jit, &emitter);
+        if (!emitter.failed) {
+            jit->code = jellyfish_jit_map(emitter.bytes, emitter.size, &jit->mapping_size);
+            jit->code_size = jit->code ? emitter.size : 0;
+        }
+        jellyfish_free(emitter.bytes);
+    }
+    if (jit->code) {
+        size_t hidden = jellyfish_jit_even((size_t)jellyfish_max_width(network));
+        jit->workspace_size = jellyfish_jit_even((size_t)jit->input_width) + 2 * hidden;
+    }
+#endif
+    return jit;
+}
+
+void fossil_jellyfish_jit_free(fossil_jellyfish_jit_t* jit) {
+    if (!jit) {
+        return;
+    }
+#ifdef JELLYFISH_JIT_X86_64
+    if (jit->code) {
+        jellyfish_jit_unmap(jit->code, jit->mapping_size);
+    }
+#endif
+    jellyfish_free(jit->data_block);
+    jellyfish_free(jit->layer_shape);
+    jellyfish_free(jit);
+}
+
+int32_t fossil_jellyfish_jit_refresh(fossil_jellyfish_jit_t* jit) {
+    const fossil_jellyfish_network_t* network = jit->network;
+    if (network->num_layers != jit->num_layers || (network->input_mean != NULL) != jit->normalized) {
+        return -1;
+    }
+    for (int32_t i = 0; i < network->num_layers; i++) {
+        if (network->layers[i]->num_neurons != jit->layer_shape[2 * i] ||
+            (int32_t)network->layers[i]->activation != jit->layer_shape[2 * i + 1]) {
+            return -1;
+        }
+    }
+    jellyfish_jit_fill(jit);
+    return 0;
+}
+
+int32_t fossil_jellyfish_jit_forward(const fossil_jellyfish_jit_t* jit, const double* input, double* output) {
+    jellyfish_scratch_mark_t mark = jellyfish_scratch_mark();
+    double* workspace = (double*)jellyfish_scratch_alloc(jit->workspace_size * sizeof(double));
+    if (!workspace) {
+        jellyfish_scratch_reset(mark);
+        return -1;
+    }
+    if (jit->code) {
+        jellyfish_jit_function_t function;
+        memcpy(&function, &jit->code, sizeof(function));
+        function(input, output, workspace);
+    } else {
+        jellyfish_forward_rows(jit->network, input, jit->input_width, 1, workspace, output);
+    }
+    jellyfish_scratch_reset(mark);
+    return 0;
+}
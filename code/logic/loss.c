@@ -0,0 +1,180 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/loss.h"
+#include <math.h>
+
+// Independent accumulators per reduction so the compiler can keep them in vector lanes
+#define JELLYFISH_LOSS_LANES 8
+
+static double jellyfish_clamp_probability(double p) {
+    const double lo = FOSSIL_JELLYFISH_LOSS_EPSILON;
+    const double hi = 1.0 - FOSSIL_JELLYFISH_LOSS_EPSILON;
+    return p < lo ? lo : (p > hi ? hi : p);
+}
+
+static double jellyfish_sum_lanes(const double* lanes) {
+    double sum = 0;
+    for (int32_t l = 0; l < JELLYFISH_LOSS_LANES; l++) {
+        sum += lanes[l];
+    }
+    return sum;
+}
+
+// Element-wise reductions over a flat array of n values
+static double jellyfish_sum_squared_error(const double* restrict p, const double* restrict t, int64_t n) {
+    double lanes[JELLYFISH_LOSS_LANES] = {0};
+    int64_t i = 0;
+    for (; i + JELLYFISH_LOSS_LANES <= n; i += JELLYFISH_LOSS_LANES) {
+        for (int32_t l = 0; l < JELLYFISH_LOSS_LANES; l++) {
+            double d = p[i + l] - t[i + l];
+            lanes[l] += d * d;
+        }
+    }
+    for (; i < n; i++) {
+        double d = p[i] - t[i];
+        lanes[0] += d * d;
+    }
+    return jellyfish_sum_lanes(lanes);
+}
+
+static double jellyfish_sum_absolute_error(const double* restrict p, const double* restrict t, int64_t n) {
+    double lanes[JELLYFISH_LOSS_LANES] = {0};
+    int64_t i = 0;
+    for (; i + JELLYFISH_LOSS_LANES <= n; i += JELLYFISH_LOSS_LANES) {
+        for (int32_t l = 0; l < JELLYFISH_LOSS_LANES; l++) {
+            lanes[l] += fabs(p[i + l] - t[i + l]);
+        }
+    }
+    for (; i < n; i++) {
+        lanes[0] += fabs(p[i] - t[i]);
+    }
+    return jellyfish_sum_lanes(lanes);
+}
+
+static double jellyfish_huber_term(double d) {
+    const double delta = FOSSIL_JELLYFISH_HUBER_DELTA;
+    double a = fabs(d);
+    return a <= delta ? 0.5 * d * d : delta * (a - 0.5 * delta);
+}
+
+static double jellyfish_sum_huber(const double* restrict p, const double* restrict t, int64_t n) {
+    double lanes[JELLYFISH_LOSS_LANES] = {0};
+    int64_t i = 0;
+    for (; i + JELLYFISH_LOSS_LANES <= n; i += JELLYFISH_LOSS_LANES) {
+        for (int32_t l = 0; l < JELLYFISH_LOSS_LANES; l++) {
+            lanes[l] += jellyfish_huber_term(p[i + l] - t[i + l]);
+        }
+    }
+    for (; i < n; i++) {
+        lanes[0] += jellyfish_huber_term(p[i] - t[i]);
+    }
+    return jellyfish_sum_lanes(lanes);
+}
+
+static double jellyfish_binary_cross_entropy_term(double p, double t) {
+    p = jellyfish_clamp_probability(p);
+    return -(t * log(p) + (1.0 - t) * log(1.0 - p));
+}
+
+static double jellyfish_sum_binary_cross_entropy(const double* restrict p, const double* restrict t, int64_t n) {
+    double lanes[JELLYFISH_LOSS_LANES] = {0};
+    int64_t i = 0;
+    for (; i + JELLYFISH_LOSS_LANES <= n; i += JELLYFISH_LOSS_LANES) {
+        for (int32_t l = 0; l < JELLYFISH_LOSS_LANES; l++) {
+            lanes[l] += jellyfish_binary_cross_entropy_term(p[i + l], t[i + l]);
+        }
+    }
+    for (; i < n; i++) {
+        lanes[0] += jellyfish_binary_cross_entropy_term(p[i], t[i]);
+    }
+    return jellyfish_sum_lanes(lanes);
+}
+
+static double jellyfish_sum_categorical_cross_entropy(const double* restrict p, const double* restrict t, int64_t n) {
+    double lanes[JELLYFISH_LOSS_LANES] = {0};
+    int64_t i = 0;
+    for (; i + JELLYFISH_LOSS_LANES <= n; i += JELLYFISH_LOSS_LANES) {
+        for (int32_t l = 0; l < JELLYFISH_LOSS_LANES; l++) {
+            lanes[l] -= t[i + l] * log(jellyfish_clamp_probability(p[i + l]));
+        }
+    }
+    for (; i < n; i++) {
+        lanes[0] -= t[i] * log(jellyfish_clamp_probability(p[i]));
+    }
+    return jellyfish_sum_lanes(lanes);
+}
+
+double fossil_jellyfish_loss(fossil_jellyfish_loss_t loss, const double* predicted, const double* expected, int64_t num_samples, int32_t width) {
+    int64_t n = num_samples * (int64_t)width;
+    if (n <= 0) {
+        return 0;
+    }
+
+    switch (loss) {
+        case LOSS_MSE:
+            return jellyfish_sum_squared_error(predicted, expected, n) / (double)n;
+        case LOSS_MAE:
+            return jellyfish_sum_absolute_error(predicted, expected, n) / (double)n;
+        case LOSS_HUBER:
+            return jellyfish_sum_huber(predicted, expected, n) / (double)n;
+        case LOSS_BINARY_CROSS_ENTROPY:
+            return jellyfish_sum_binary_cross_entropy(predicted, expected, n) / (double)n;
+        case LOSS_CATEGORICAL_CROSS_ENTROPY:
+            // The per-row sum over classes is the same as one flat sum over the batch
+            return jellyfish_sum_categorical_cross_entropy(predicted, expected, n) / (double)num_samples;
+        default:
+            return 0;
+    }
+}
+
+void fossil_jellyfish_loss_gradient(fossil_jellyfish_loss_t loss, const double* restrict predicted, const double* restrict expected, double* restrict gradient, int64_t num_samples, int32_t width) {
+    const double delta = FOSSIL_JELLYFISH_HUBER_DELTA;
+    int64_t n = num_samples * (int64_t)width;
+
+    switch (loss) {
+        case LOSS_MSE:
+            for (int64_t i = 0; i < n; i++) {
+                gradient[i] = predicted[i] - expected[i];
+            }
+            break;
+        case LOSS_MAE:
+            for (int64_t i = 0; i < n; i++) {
+                double d = predicted[i] - expected[i];
+                gradient[i] = (double)(d > 0) - (double)(d < 0);
+            }
+            break;
+        case LOSS_HUBER:
+            for (int64_t i = 0; i < n; i++) {
+                double d = predicted[i] - expected[i];
+                gradient[i] = d < -delta ? -delta : (d > delta ? delta : d);
+            }
+            break;
+        case LOSS_BINARY_CROSS_ENTROPY:
+            for (int64_t i = 0; i < n; i++) {
+                double p = jellyfish_clamp_probability(predicted[i]);
+                gradient[i] = (p - expected[i]) / (p * (1.0 - p));
+            }
+            break;
+        case LOSS_CATEGORICAL_CROSS_ENTROPY:
+            for (int64_t i = 0; i < n; i++) {
+                gradient[i] = -expected[i] / jellyfish_clamp_probability(predicted[i]);
+            }
+            break;
+        default:
+            for (int64_t i = 0; i < n; i++) {
+                gradient[i] = 0;
+            }
+            break;
+    }
+}
@@ -0,0 +1,469 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifdef __linux__
+#define _GNU_SOURCE
+#else
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "fossil/jellyfish/memory.h"
+#include "internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+// Hugetlbfs and MAP_HUGETLB memory must be unmapped rather than freed, while every
+// parameter array goes back through the allocator's free, so huge pages come from
+// aligned blocks that the kernel promotes on its own
+static volatile int32_t jellyfish_huge_pages = 0;
+
+// Zeroed while the default allocator is in use
+static fossil_jellyfish_allocator_t jellyfish_global_allocator;
+
+#define JELLYFISH_SCRATCH_ALIGNMENT 64
+#define JELLYFISH_SCRATCH_MIN_BLOCK ((size_t)64 << 10)
+
+// Scratch blocks of a thread, oldest first; reset keeps them all for the next call
+typedef struct jellyfish_scratch_block {
+    struct jellyfish_scratch_block* next;
+    fossil_jellyfish_allocator_t allocator;   // The one that allocated the block
+    size_t size;
+    size_t used;
+    unsigned char* data;                      // JELLYFISH_SCRATCH_ALIGNMENT aligned
+} jellyfish_scratch_block_t;
+
+typedef struct {
+    jellyfish_scratch_block_t* first;
+    jellyfish_scratch_block_t* current;
+} jellyfish_scratch_t;
+
+static JELLYFISH_THREAD_LOCAL jellyfish_scratch_t jellyfish_scratch;
+static volatile int32_t jellyfish_scratch_atexit = 0;
+
+static void* jellyfish_default_alloc(void* context, size_t size) {
+    (void)context;
+    return malloc(size > 0 ? size : 1);
+}
+
+static void jellyfish_default_free(void* context, void* pointer) {
+    (void)context;
+    free(pointer);
+}
+
+#ifndef _WIN32
+static void* jellyfish_default_aligned_alloc(void* context, size_t alignment, size_t size) {
+    void* block = NULL;
+    (void)context;
+    alignment = alignment < sizeof(void*) ? sizeof(void*) : alignment;
+    return posix_memalign(&block, alignment, size > 0 ? size : 1) == 0 ? block : NULL;
+}
+#endif
+
+// Windows has no aligned block that free() accepts, so the default there has no aligned_alloc
+static const fossil_jellyfish_allocator_t jellyfish_default_allocator = {
+    jellyfish_default_alloc,
+#ifndef _WIN32
+    jellyfish_default_aligned_alloc,
+#else
+    NULL,
+#endif
+    jellyfish_default_free,
+    NULL
+};
+
+// NULL selects the global allocator and a zeroed one the default
+static const fossil_jellyfish_allocator_t* jellyfish_resolve(const fossil_jellyfish_allocator_t* allocator) {
+    if (!allocator) {
+        allocator = &jellyfish_global_allocator;
+    }
+    return allocator->alloc ? allocator : &jellyfish_default_allocator;
+}
+
+void fossil_jellyfish_set_allocator(const fossil_jellyfish_allocator_t* allocator) {
+    if (allocator && allocator->alloc && allocator->free) {
+        jellyfish_global_allocator = *allocator;
+    } else {
+        memset(&jellyfish_global_allocator, 0, sizeof(jellyfish_global_allocator));
+    }
+}
+
+fossil_jellyfish_allocator_t fossil_jellyfish_get_allocator(void) {
+    return jellyfish_global_allocator;
+}
+
+void* jellyfish_alloc_with(const fossil_jellyfish_allocator_t* allocator, size_t size) {
+    allocator = jellyfish_resolve(allocator);
+    return allocator->alloc(allocator->context, size > 0 ? size : 1);
+}
+
+void* jellyfish_calloc_with(const fossil_jellyfish_allocator_t* allocator, size_t count, size_t size) {
+    if (size > 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+    void* block = jellyfish_alloc_with(allocator, count * size);
+    if (block) {
+        memset(block, 0, count * size);
+    }
+    return block;
+}
+
+// The hooks have no realloc, so growing always moves the block
+void* jellyfish_realloc_with(const fossil_jellyfish_allocator_t* allocator, void* pointer, size_t old_size, size_t new_size) {
+    void* block = jellyfish_alloc_with(allocator, new_size);
+    if (block && pointer) {
+        memcpy(block, pointer, old_size < new_size ? old_size : new_size);
+        jellyfish_free_with(allocator, pointer);
+    }
+    return block;
+}
+
+void jellyfish_free_with(const fossil_jellyfish_allocator_t* allocator, void* pointer) {
+    if (pointer) {
+        allocator = jellyfish_resolve(allocator);
+        allocator->free(allocator->context, pointer);
+    }
+}
+
+void fossil_jellyfish_set_huge_pages(int32_t enabled) {
+    jellyfish_atomic_store32(&jellyfish_huge_pages, enabled ? 1 : 0);
+}
+
+int32_t fossil_jellyfish_get_huge_pages(void) {
+    return jellyfish_atomic_load32(&jellyfish_huge_pages);
+}
+
+static void* jellyfish_alloc_large(const fossil_jellyfish_allocator_t* allocator, size_t size) {
+    allocator = jellyfish_resolve(allocator);
+    size = size > 0 ? size : 1;
+    if (size >= FOSSIL_JELLYFISH_HUGE_PAGE_SIZE && allocator->aligned_alloc && jellyfish_atomic_load32(&jellyfish_huge_pages)) {
+        // Whole pages only, so the tail shares no huge page with unrelated data
+        size_t rounded = (size + FOSSIL_JELLYFISH_HUGE_PAGE_SIZE - 1) & ~(FOSSIL_JELLYFISH_HUGE_PAGE_SIZE - 1);
+        void* block = allocator->aligned_alloc(allocator->context, FOSSIL_JELLYFISH_HUGE_PAGE_SIZE, rounded);
+        if (block) {
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+            madvise(block, rounded, MADV_HUGEPAGE);
+#endif
+            return block;
+        }
+    }
+    return allocator->alloc(allocator->context, size);
+}
+
+void* fossil_jellyfish_alloc_arena(size_t size) {
+    return jellyfish_alloc_large(NULL, size);
+}
+
+void fossil_jellyfish_free_arena(void* arena) {
+    jellyfish_free_with(NULL, arena);
+}
+
+double* jellyfish_alloc_array(const fossil_jellyfish_allocator_t* allocator, size_t count) {
+    return (double*)jellyfish_alloc_large(allocator, count * sizeof(double));
+}
+
+static int32_t jellyfish_move_array(const fossil_jellyfish_allocator_t* allocator, double** array, size_t count) {
+    if (!*array || count * sizeof(double) < FOSSIL_JELLYFISH_HUGE_PAGE_SIZE) {
+        return 0;
+    }
+    double* moved = jellyfish_alloc_array(allocator, count);
+    if (!moved) {
+        return -1;
+    }
+    memcpy(moved, *array, count * sizeof(double));
+    jellyfish_free_with(allocator, *array);
+    *array = moved;
+    return 0;
+}
+
+int32_t fossil_jellyfish_use_huge_pages(fossil_jellyfish_network_t* network) {
+    if (!network || !fossil_jellyfish_get_huge_pages()) {
+        return network ? 0 : -1;
+    }
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        fossil_jellyfish_layer_t* layer = network->layers[i];
+        if (layer->shared) {
+            continue;
+        }
+        size_t weights = jellyfish_weight_count(network, i);
+        size_t packed = layer->packed ? jellyfish_packed_count(network->layers[i - 1]->num_neurons, layer->num_neurons) : 0;
+        if (jellyfish_move_array(&network->allocator, &layer->weights, weights) != 0 ||
+            jellyfish_move_array(&network->allocator, &layer->packed, packed) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Appends a block of at least size usable bytes to the thread's chain
+static jellyfish_scratch_block_t* jellyfish_scratch_grow(size_t size) {
+    jellyfish_scratch_t* scratch = &jellyfish_scratch;
+    jellyfish_scratch_block_t* last = scratch->current ? scratch->current : scratch->first;
+    while (last && last->next) {
+        last = last->next;
+    }
+    size_t capacity = last && last->size * 2 > size ? last->size * 2 : size;
+    capacity = capacity > JELLYFISH_SCRATCH_MIN_BLOCK ? capacity : JELLYFISH_SCRATCH_MIN_BLOCK;
+    if (capacity > SIZE_MAX - sizeof(jellyfish_scratch_block_t) - JELLYFISH_SCRATCH_ALIGNMENT) {
+        return NULL;
+    }
+
+    fossil_jellyfish_allocator_t allocator = *jellyfish_resolve(NULL);
+    jellyfish_scratch_block_t* block = (jellyfish_scratch_block_t*)allocator.alloc(allocator.context, sizeof(jellyfish_scratch_block_t) + JELLYFISH_SCRATCH_ALIGNMENT + capacity);
+    if (!block) {
+        return NULL;
+    }
+    uintptr_t data = ((uintptr_t)(block + 1) + JELLYFISH_SCRATCH_ALIGNMENT - 1) & ~(uintptr_t)(JELLYFISH_SCRATCH_ALIGNMENT - 1);
+    block->next = NULL;
+    block->allocator = allocator;
+    block->size = capacity;
+    block->used = 0;
+    block->data = (unsigned char*)data;
+    if (last) {
+        last->next = block;
+    } else {
+        scratch->first = block;
+        // Leak checkers do not see thread-local roots; the thread calling exit() releases its own arena
+        if (jellyfish_atomic_cas32(&jellyfish_scratch_atexit, 0, 1)) {
+            atexit(fossil_jellyfish_scratch_release);
+        }
+    }
+    return block;
+}
+
+jellyfish_scratch_mark_t jellyfish_scratch_mark(void) {
+    jellyfish_scratch_mark_t mark;
+    mark.block = jellyfish_scratch.current;
+    mark.used = mark.block ? jellyfish_scratch.current->used : 0;
+    return mark;
+}
+
+void* jellyfish_scratch_alloc(size_t size) {
+    jellyfish_scratch_t* scratch = &jellyfish_scratch;
+    jellyfish_scratch_block_t* block = scratch->current ? scratch->current : scratch->first;
+    size = (size + JELLYFISH_SCRATCH_ALIGNMENT - 1) & ~(size_t)(JELLYFISH_SCRATCH_ALIGNMENT - 1);
+    if (block && !scratch->current) {
+        block->used = 0;
+    }
+
+    // Later blocks are empty once the current one is passed
+    while (block && block->size - block->used < size) {
+        block = block->next;
+        if (block) {
+            block->used = 0;
+        }
+    }
+    if (!block) {
+        block = jellyfish_scratch_grow(size);
+        if (!block) {
+            return NULL;
+        }
+    }
+    scratch->current = block;
+    void* pointer = block->data + block->used;
+    block->used += size;
+    return pointer;
+}
+
+void jellyfish_scratch_reset(jellyfish_scratch_mark_t mark) {
+    jellyfish_scratch.current = (jellyfish_scratch_block_t*)mark.block;
+    if (mark.block) {
+        jellyfish_scratch.current->used = mark.used;
+    }
+}
+
+int32_t fossil_jellyfish_scratch_reserve(size_t size) {
+    jellyfish_scratch_t* scratch = &jellyfish_scratch;
+    for (jellyfish_scratch_block_t* block = scratch->first; block; block = block->next) {
+        if (block->size >= size) {
+            return 0;
+        }
+    }
+    // An idle chain is rebuilt as one block; a live one can only grow
+    if (!scratch->current || (scratch->current == scratch->first && scratch->current->used == 0)) {
+        fossil_jellyfish_scratch_release();
+    }
+    return jellyfish_scratch_grow(size) ? 0 : -1;
+}
+
+void fossil_jellyfish_scratch_release(void) {
+    jellyfish_scratch_t* scratch = &jellyfish_scratch;
+    jellyfish_scratch_block_t* block = scratch->first;
+    while (block) {
+        jellyfish_scratch_block_t* next = block->next;
+        fossil_jellyfish_allocator_t allocator = block->allocator;
+        allocator.free(allocator.context, block);
+        block = next;
+    }
+    scratch->first = NULL;
+    scratch->current = NULL;
+}
+
+// Bump allocation inside a caller's buffer; nothing is given back before the buffer goes
+typedef struct {
+    unsigned char* next;
+    unsigned char* end;
+} jellyfish_region_t;
+
+// Bytes a block takes in a region; 0 when the size cannot be represented
+static size_t jellyfish_region_round(size_t size) {
+    size = size > 0 ? size : 1;
+    if (size > SIZE_MAX - FOSSIL_JELLYFISH_STATIC_ALIGNMENT) {
+        return 0;
+    }
+    return (size + FOSSIL_JELLYFISH_STATIC_ALIGNMENT - 1) & ~(size_t)(FOSSIL_JELLYFISH_STATIC_ALIGNMENT - 1);
+}
+
+// Adds the region footprint of count items of size bytes; -1 once the total stops fitting in a size_t
+static int32_t jellyfish_region_add(size_t* total, size_t count, size_t size) {
+    size_t rounded = count <= (SIZE_MAX / 2) / (size > 0 ? size : 1) ? jellyfish_region_round(count * size) : 0;
+    if (rounded == 0 || *total > SIZE_MAX - rounded) {
+        return -1;
+    }
+    *total += rounded;
+    return 0;
+}
+
+static void* jellyfish_region_alloc(void* context, size_t size) {
+    jellyfish_region_t* region = (jellyfish_region_t*)context;
+    size_t rounded = jellyfish_region_round(size);
+    if (rounded == 0 || rounded > (size_t)(region->end - region->next)) {
+        return NULL;
+    }
+    void* block = region->next;
+    region->next += rounded;
+    return block;
+}
+
+static void jellyfish_region_free(void* context, void* pointer) {
+    (void)context;
+    (void)pointer;
+}
+
+// The region header sits at the start of the buffer, so the hooks stay valid as long as the network
+static int32_t jellyfish_region_open(void* buffer, size_t size, fossil_jellyfish_allocator_t* allocator) {
+    size_t header = jellyfish_region_round(sizeof(jellyfish_region_t));
+    if (!buffer || ((uintptr_t)buffer & (FOSSIL_JELLYFISH_STATIC_ALIGNMENT - 1)) != 0 || size < header) {
+        return -1;
+    }
+    jellyfish_region_t* region = (jellyfish_region_t*)buffer;
+    region->next = (unsigned char*)buffer + header;
+    region->end = (unsigned char*)buffer + size;
+    allocator->alloc = jellyfish_region_alloc;
+    allocator->aligned_alloc = NULL;
+    allocator->free = jellyfish_region_free;
+    allocator->context = region;
+    return 0;
+}
+
+// Sums the region footprint of everything allocated, freed or not, as a region would
+typedef struct {
+    size_t total;
+    int32_t overflow;
+} jellyfish_measure_t;
+
+static void* jellyfish_measure_alloc(void* context, size_t size) {
+    jellyfish_measure_t* measure = (jellyfish_measure_t*)context;
+    measure->overflow |= jellyfish_region_add(&measure->total, 1, size) != 0;
+    return jellyfish_malloc(size);
+}
+
+static void jellyfish_measure_free(void* context, void* pointer) {
+    (void)context;
+    jellyfish_free(pointer);
+}
+
+// Mirrors the allocations of fossil_jellyfish_create_network_with_allocator
+size_t fossil_jellyfish_network_size(int32_t num_layers, const int32_t* neurons_per_layer) {
+    size_t total = 0;
+    if (num_layers < 1 || !neurons_per_layer || jellyfish_region_add(&total, 1, sizeof(jellyfish_region_t)) != 0 ||
+        jellyfish_region_add(&total, 1, sizeof(fossil_jellyfish_network_t)) != 0 ||
+        jellyfish_region_add(&total, (size_t)num_layers, sizeof(fossil_jellyfish_layer_t*)) != 0) {
+        return 0;
+    }
+    for (int32_t i = 0; i < num_layers; i++) {
+        size_t neurons = (size_t)(neurons_per_layer[i] > 0 ? neurons_per_layer[i] : 0);
+        if (neurons == 0 || jellyfish_region_add(&total, 1, sizeof(fossil_jellyfish_layer_t)) != 0 ||
+            jellyfish_region_add(&total, neurons, sizeof(double)) != 0) {
+            return 0;
+        }
+        if (i == 0) {
+            continue;
+        }
+        // Weights, biases and deltas
+        size_t fan_in = (size_t)neurons_per_layer[i - 1];
+        if (neurons > SIZE_MAX / fan_in || jellyfish_region_add(&total, neurons * fan_in, sizeof(double)) != 0 ||
+            jellyfish_region_add(&total, neurons, sizeof(double)) != 0 || jellyfish_region_add(&total, neurons, sizeof(double)) != 0) {
+            return 0;
+        }
+    }
+    return total;
+}
+
+fossil_jellyfish_network_t* fossil_jellyfish_create_network_in(void* buffer, size_t size, int32_t num_layers, int32_t* neurons_per_layer,
+                                                               fossil_jellyfish_activation_t* activations) {
+    fossil_jellyfish_allocator_t allocator;
+    size_t needed = fossil_jellyfish_network_size(num_layers, neurons_per_layer);
+    if (needed == 0 || size < needed || jellyfish_region_open(buffer, size, &allocator) != 0) {
+        return NULL;
+    }
+    // Initialization would otherwise start the thread pool for large layers, which allocates
+    int32_t serial = jellyfish_serial_enter();
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network_with_allocator(num_layers, neurons_per_layer, activations, &allocator);
+    jellyfish_serial_leave(serial);
+    return network;
+}
+
+// Frees a network loaded through the measure allocator and returns the region it needs
+static size_t jellyfish_measured_size(fossil_jellyfish_network_t* network, const jellyfish_measure_t* measure) {
+    if (!network) {
+        return 0;
+    }
+    fossil_jellyfish_free_network(network);
+    size_t total = measure->total;
+    if (jellyfish_region_add(&total, 1, sizeof(jellyfish_region_t)) != 0 || measure->overflow) {
+        return 0;
+    }
+    return total;
+}
+
+size_t fossil_jellyfish_load_size(const char* file_path) {
+    jellyfish_measure_t measure = {0, 0};
+    fossil_jellyfish_allocator_t allocator = {jellyfish_measure_alloc, NULL, jellyfish_measure_free, &measure};
+    return jellyfish_measured_size(jellyfish_load_with(file_path, &allocator), &measure);
+}
+
+size_t fossil_jellyfish_load_size_from_memory(const void* image, size_t image_size) {
+    jellyfish_measure_t measure = {0, 0};
+    fossil_jellyfish_allocator_t allocator = {jellyfish_measure_alloc, NULL, jellyfish_measure_free, &measure};
+    return jellyfish_measured_size(jellyfish_load_image(image, image_size, &allocator), &measure);
+}
+
+fossil_jellyfish_network_t* fossil_jellyfish_load_into(const char* file_path, void* buffer, size_t size) {
+    fossil_jellyfish_allocator_t allocator;
+    if (jellyfish_region_open(buffer, size, &allocator) != 0) {
+        return NULL;
+    }
+    return jellyfish_load_with(file_path, &allocator);
+}
+
+fossil_jellyfish_network_t* fossil_jellyfish_load_into_from_memory(void* buffer, size_t size, const void* image, size_t image_size) {
+    fossil_jellyfish_allocator_t allocator;
+    if (jellyfish_region_open(buffer, size, &allocator) != 0) {
+        return NULL;
+    }
+    return jellyfish_load_image(image, image_size, &allocator);
+}
@@ -0,0 +1,115 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/normalize.h"
+#include "internal.h"
+#include <string.h>
+#include <math.h>
+
+int32_t fossil_jellyfish_set_normalization(fossil_jellyfish_network_t* network, const double* mean, const double* std) {
+    if (!network || (mean && !std)) {
+        return -1;
+    }
+    if (!mean) {
+        jellyfish_free_with(&network->allocator, network->input_mean);
+        jellyfish_free_with(&network->allocator, network->input_scale);
+        network->input_mean = NULL;
+        network->input_scale = NULL;
+        return 0;
+    }
+
+    int32_t width = network->layers[0]->num_neurons;
+    for (int32_t k = 0; k < width; k++) {
+        if (!(std[k] >= 0) || !isfinite(mean[k])) {
+            return -1;
+        }
+    }
+    double* input_mean = (double*)jellyfish_alloc_with(&network->allocator, (size_t)width * sizeof(double));
+    double* input_scale = (double*)jellyfish_alloc_with(&network->allocator, (size_t)width * sizeof(double));
+    if (!input_mean || !input_scale) {
+        jellyfish_free_with(&network->allocator, input_mean);
+        jellyfish_free_with(&network->allocator, input_scale);
+        return -1;
+    }
+
+    // Store the reciprocal so the input copy multiplies instead of dividing
+    for (int32_t k = 0; k < width; k++) {
+        input_mean[k] = mean[k];
+        input_scale[k] = std[k] > 0 ? 1.0 / std[k] : 1.0;
+    }
+    jellyfish_free_with(&network->allocator, network->input_mean);
+    jellyfish_free_with(&network->allocator, network->input_scale);
+    network->input_mean = input_mean;
+    network->input_scale = input_scale;
+    return 0;
+}
+
+int32_t fossil_jellyfish_fit_normalization(fossil_jellyfish_network_t* network, const double* inputs, int64_t num_samples) {
+    if (!network || !inputs || num_samples < 1) {
+        return -1;
+    }
+
+    int32_t width = network->layers[0]->num_neurons;
+    jellyfish_scratch_mark_t mark = jellyfish_scratch_mark();
+    double* mean = (double*)jellyfish_scratch_alloc((size_t)width * sizeof(double));
+    double* std = (double*)jellyfish_scratch_alloc((size_t)width * sizeof(double));
+    if (!mean || !std) {
+        jellyfish_scratch_reset(mark);
+        return -1;
+    }
+    memset(mean, 0, (size_t)width * sizeof(double));
+    memset(std, 0, (size_t)width * sizeof(double));
+
+    // Welford's update keeps the variance accurate when the mean is large
+    for (int64_t i = 0; i < num_samples; i++) {
+        const double* x = inputs + i * width;
+        for (int32_t k = 0; k < width; k++) {
+            double delta = x[k] - mean[k];
+            mean[k] += delta / (double)(i + 1);
+            std[k] += delta * (x[k] - mean[k]);
+        }
+    }
+    for (int32_t k = 0; k < width; k++) {
+        std[k] = sqrt(std[k] / (double)num_samples);
+    }
+
+    int32_t status = fossil_jellyfish_set_normalization(network, mean, std);
+    jellyfish_scratch_reset(mark);
+    return status;
+}
+
+int32_t fossil_jellyfish_fold_normalization(fossil_jellyfish_network_t* network) {
+    if (!network) {
+        return -1;
+    }
+    if (!network->input_mean) {
+        return 0;
+    }
+    if (network->num_layers < 2 || network->layers[1]->kind != LAYER_DENSE || jellyfish_layer_make_writable(network, 1, 1) != 0) {
+        return -1;
+    }
+
+    // W ((x - m) * s) + b = (W diag(s)) x + (b - W (m * s))
+    fossil_jellyfish_layer_t* layer = network->layers[1];
+    int32_t width = network->layers[0]->num_neurons;
+    for (int32_t j = 0; j < layer->num_neurons; j++) {
+        double* w = layer->weights + (size_t)j * (size_t)width;
+        double shift = 0;
+        for (int32_t k = 0; k < width; k++) {
+            w[k] *= network->input_scale[k];
+            shift += w[k] * network->input_mean[k];
+        }
+        layer->biases[j] -= shift;
+    }
+    return fossil_jellyfish_set_normalization(network, NULL, NULL);
+}
@@ -0,0 +1,163 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/online.h"
+#include "internal.h"
+#include <string.h>
+
+fossil_jellyfish_online_t* fossil_jellyfish_online_create(fossil_jellyfish_network_t* network, const fossil_jellyfish_online_config_t* config) {
+    if (!network || !config || config->batch_size <= 0 || network->num_layers < 2) {
+        return NULL;
+    }
+
+    // Detach from snapshots now so updates never copy parameters later
+    if (fossil_jellyfish_make_writable(network) != 0) {
+        return NULL;
+    }
+
+    fossil_jellyfish_online_t* online = (fossil_jellyfish_online_t*)jellyfish_calloc(1, sizeof(fossil_jellyfish_online_t));
+    if (!online) {
+        return NULL;
+    }
+    online->network = network;
+    online->config = *config;
+    online->num_parameters = fossil_jellyfish_num_parameters(network);
+    online->gradients = (double*)jellyfish_calloc((size_t)online->num_parameters, sizeof(double));
+    if (!online->gradients) {
+        fossil_jellyfish_online_free(online);
+        return NULL;
+    }
+
+    for (int32_t v = 0; v < FOSSIL_JELLYFISH_ONLINE_VERSIONS; v++) {
+        online->versions[v] = fossil_jellyfish_clone(network);
+        if (!online->versions[v]) {
+            fossil_jellyfish_online_free(online);
+            return NULL;
+        }
+    }
+    return online;
+}
+
+void fossil_jellyfish_online_free(fossil_jellyfish_online_t* online) {
+    if (!online) {
+        return;
+    }
+    for (int32_t v = 0; v < FOSSIL_JELLYFISH_ONLINE_VERSIONS; v++) {
+        if (online->versions[v]) {
+            fossil_jellyfish_free_network(online->versions[v]);
+        }
+    }
+    jellyfish_free(online->gradients);
+    jellyfish_free(online);
+}
+
+// Copies the master weights into a version no reader can reach, then makes it current
+static int32_t jellyfish_online_publish(fossil_jellyfish_online_t* online) {
+    int32_t current = online->published;
+
+    // Pairs with the fence in predict: a reader counted after this point sees the
+    // latest published index, so it never validates a version being rewritten
+    jellyfish_atomic_fence();
+
+    for (int32_t v = 0; v < FOSSIL_JELLYFISH_ONLINE_VERSIONS; v++) {
+        if (v == current || jellyfish_atomic_load32(&online->readers[v]) != 0) {
+            continue;
+        }
+
+        fossil_jellyfish_network_t* version = online->versions[v];
+        for (int32_t i = 1; i < online->network->num_layers; i++) {
+            const fossil_jellyfish_layer_t* layer = online->network->layers[i];
+            memcpy(version->layers[i]->weights, layer->weights, jellyfish_weight_count(online->network, i) * sizeof(double));
+            memcpy(version->layers[i]->biases, layer->biases, (size_t)layer->num_neurons * sizeof(double));
+        }
+        jellyfish_atomic_store64(&online->version_ids[v], online->updates);
+        jellyfish_atomic_store32(&online->published, v);
+        online->publish_pending = 0;
+        return 1;
+    }
+
+    // Every spare version is still being read; keep training and retry next time
+    online->publish_pending = 1;
+    return 0;
+}
+
+int32_t fossil_jellyfish_online_push(fossil_jellyfish_online_t* online, const double* input, const double* expected_output) {
+    if (!online || !input || !expected_output) {
+        return -1;
+    }
+
+    fossil_jellyfish_forward(online->network, (double*)input);
+    fossil_jellyfish_accumulate_gradients(online->network, expected_output, online->config.loss, online->gradients);
+    online->pending++;
+
+    if (online->pending >= online->config.batch_size) {
+        // Averaged over the batch so the cadence does not change the step size
+        if (fossil_jellyfish_apply_gradients(online->network, online->gradients, online->config.learning_rate / online->pending) != 0) {
+            return -1;
+        }
+        memset(online->gradients, 0, (size_t)online->num_parameters * sizeof(double));
+        online->pending = 0;
+        online->updates++;
+        online->publish_pending = 1;
+    }
+
+    return online->publish_pending ? jellyfish_online_publish(online) : 0;
+}
+
+int32_t fossil_jellyfish_online_push_batch(fossil_jellyfish_online_t* online, const double* inputs, const double* expected_output, int32_t num_samples) {
+    if (!online || num_samples < 0) {
+        return -1;
+    }
+
+    int32_t input_width = online->network->layers[0]->num_neurons;
+    int32_t output_width = online->network->layers[online->network->num_layers - 1]->num_neurons;
+    int32_t published = 0;
+
+    for (int32_t i = 0; i < num_samples; i++) {
+        int32_t result = fossil_jellyfish_online_push(online, &inputs[(size_t)i * (size_t)input_width], &expected_output[(size_t)i * (size_t)output_width]);
+        if (result < 0) {
+            return -1;
+        }
+        published += result;
+    }
+    return published;
+}
+
+size_t fossil_jellyfish_online_scratch_size(const fossil_jellyfish_online_t* online) {
+    return jellyfish_forward_scratch_size(online->network);
+}
+
+uint64_t fossil_jellyfish_online_predict(fossil_jellyfish_online_t* online, const double* input, double* output, double* scratch) {
+    int32_t v;
+
+    // Register as a reader, then confirm the version is still current so the writer
+    // cannot have picked it for rewriting before seeing the registration
+    for (;;) {
+        v = jellyfish_atomic_load32(&online->published);
+        jellyfish_atomic_add32(&online->readers[v], 1);
+        jellyfish_atomic_fence();
+        if (jellyfish_atomic_load32(&online->published) == v) {
+            break;
+        }
+        jellyfish_atomic_add32(&online->readers[v], -1);
+    }
+
+    uint64_t id = jellyfish_atomic_load64(&online->version_ids[v]);
+    jellyfish_forward_rows(online->versions[v], input, online->versions[v]->layers[0]->num_neurons, 1, scratch, output);
+    jellyfish_atomic_add32(&online->readers[v], -1);
+    return id;
+}
+
+uint64_t fossil_jellyfish_online_version(fossil_jellyfish_online_t* online) {
+    return jellyfish_atomic_load64(&online->version_ids[jellyfish_atomic_load32(&online->published)]);
+}
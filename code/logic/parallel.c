@@ -0,0 +1,324 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/parallel.h"
+#include "fossil/jellyfish/memory.h"
+#include "internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE jellyfish_thread_t;
+typedef CRITICAL_SECTION jellyfish_mutex_t;
+typedef CONDITION_VARIABLE jellyfish_cond_t;
+#define jellyfish_mutex_init(m) InitializeCriticalSection(m)
+#define jellyfish_mutex_destroy(m) DeleteCriticalSection(m)
+#define jellyfish_mutex_lock(m) EnterCriticalSection(m)
+#define jellyfish_mutex_trylock(m) (TryEnterCriticalSection(m) != 0)
+#define jellyfish_mutex_unlock(m) LeaveCriticalSection(m)
+#define jellyfish_cond_init(c) InitializeConditionVariable(c)
+#define jellyfish_cond_destroy(c) ((void)(c))
+#define jellyfish_cond_wait(c, m) SleepConditionVariableCS((c), (m), INFINITE)
+#define jellyfish_cond_signal(c) WakeConditionVariable(c)
+#define jellyfish_cond_broadcast(c) WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+#include <unistd.h>
+typedef pthread_t jellyfish_thread_t;
+typedef pthread_mutex_t jellyfish_mutex_t;
+typedef pthread_cond_t jellyfish_cond_t;
+#define jellyfish_mutex_init(m) pthread_mutex_init((m), NULL)
+#define jellyfish_mutex_destroy(m) pthread_mutex_destroy(m)
+#define jellyfish_mutex_lock(m) pthread_mutex_lock(m)
+#define jellyfish_mutex_trylock(m) (pthread_mutex_trylock(m) == 0)
+#define jellyfish_mutex_unlock(m) pthread_mutex_unlock(m)
+#define jellyfish_cond_init(c) pthread_cond_init((c), NULL)
+#define jellyfish_cond_destroy(c) pthread_cond_destroy(c)
+#define jellyfish_cond_wait(c, m) pthread_cond_wait((c), (m))
+#define jellyfish_cond_signal(c) pthread_cond_signal(c)
+#define jellyfish_cond_broadcast(c) pthread_cond_broadcast(c)
+#endif
+
+// Shared state of the persistent worker pool
+typedef struct {
+    jellyfish_mutex_t lock;     // Guards everything below except next
+    jellyfish_mutex_t submit;   // Held by the thread that owns the pool for one call
+    jellyfish_cond_t wake;
+    jellyfish_cond_t done;
+    jellyfish_thread_t* threads;
+    int32_t num_workers;
+    int32_t active;             // Workers that have not finished the current job
+    uint64_t generation;        // Bumped for every job, workers wait for a change
+    int32_t stop;
+
+    fossil_jellyfish_task_t task;
+    void* context;
+    int64_t count;
+    int64_t grain;
+    int32_t limit;              // Workers with this index or above sit the job out
+    int64_t next;               // Next unclaimed index, claimed atomically
+} jellyfish_pool_t;
+
+typedef struct {
+    int32_t index;
+    uint64_t generation;        // Generation at spawn time, so a job published before the thread runs is not missed
+} jellyfish_worker_t;
+
+static jellyfish_pool_t jellyfish_pool;
+static int32_t jellyfish_pool_initialized = 0;
+static int32_t jellyfish_requested_threads = 0;  // Read and written atomically
+static JELLYFISH_THREAD_LOCAL int32_t jellyfish_inside_task = 0;
+static jellyfish_worker_t* jellyfish_workers = NULL;
+
+#ifdef _WIN32
+static INIT_ONCE jellyfish_pool_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK jellyfish_pool_init_once(PINIT_ONCE once, PVOID param, PVOID* ctx) {
+    (void)once; (void)param; (void)ctx;
+    jellyfish_mutex_init(&jellyfish_pool.lock);
+    jellyfish_mutex_init(&jellyfish_pool.submit);
+    jellyfish_cond_init(&jellyfish_pool.wake);
+    jellyfish_cond_init(&jellyfish_pool.done);
+    jellyfish_pool_initialized = 1;
+    return TRUE;
+}
+
+static void jellyfish_pool_init(void) {
+    InitOnceExecuteOnce(&jellyfish_pool_once, jellyfish_pool_init_once, NULL, NULL);
+}
+#else
+static pthread_once_t jellyfish_pool_once = PTHREAD_ONCE_INIT;
+
+static void jellyfish_pool_init_once(void) {
+    jellyfish_mutex_init(&jellyfish_pool.lock);
+    jellyfish_mutex_init(&jellyfish_pool.submit);
+    jellyfish_cond_init(&jellyfish_pool.wake);
+    jellyfish_cond_init(&jellyfish_pool.done);
+    jellyfish_pool_initialized = 1;
+}
+
+static void jellyfish_pool_init(void) {
+    pthread_once(&jellyfish_pool_once, jellyfish_pool_init_once);
+}
+#endif
+
+static int32_t jellyfish_hardware_threads(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int32_t)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int32_t)n : 1;
+#endif
+}
+
+// Claims chunks of the current job until none are left
+static void jellyfish_run_chunks(int32_t thread_index) {
+    jellyfish_pool_t* pool = &jellyfish_pool;
+    jellyfish_inside_task = 1;
+    for (;;) {
+        int64_t begin = jellyfish_atomic_add64(&pool->next, pool->grain);
+        if (begin >= pool->count) {
+            break;
+        }
+        int64_t end = begin + pool->grain < pool->count ? begin + pool->grain : pool->count;
+        pool->task(pool->context, begin, end, thread_index);
+    }
+    jellyfish_inside_task = 0;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI jellyfish_worker_main(LPVOID arg) {
+#else
+static void* jellyfish_worker_main(void* arg) {
+#endif
+    jellyfish_pool_t* pool = &jellyfish_pool;
+    int32_t index = ((jellyfish_worker_t*)arg)->index;
+    uint64_t seen = ((jellyfish_worker_t*)arg)->generation;
+
+    jellyfish_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->generation == seen) {
+            jellyfish_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        seen = pool->generation;
+        int32_t joins = index < pool->limit;
+        jellyfish_mutex_unlock(&pool->lock);
+
+        if (joins) {
+            jellyfish_run_chunks(index);
+        }
+
+        jellyfish_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            jellyfish_cond_signal(&pool->done);
+        }
+    }
+    jellyfish_mutex_unlock(&pool->lock);
+    fossil_jellyfish_scratch_release();
+    return 0;
+}
+
+// Starts the workers; called with the submit lock held. The pool outlives any
+// allocator the application installs, so its bookkeeping stays on the C heap.
+static void jellyfish_pool_start(void) {
+    jellyfish_pool_t* pool = &jellyfish_pool;
+    int32_t total = fossil_jellyfish_get_num_threads();
+    int32_t started = 0;
+
+    pool->stop = 0;
+    pool->threads = (jellyfish_thread_t*)malloc((size_t)(total > 1 ? total - 1 : 1) * sizeof(jellyfish_thread_t));
+    jellyfish_workers = (jellyfish_worker_t*)malloc((size_t)(total > 1 ? total - 1 : 1) * sizeof(jellyfish_worker_t));
+    if (!pool->threads || !jellyfish_workers) {
+        free(pool->threads);
+        free(jellyfish_workers);
+        pool->threads = NULL;
+        jellyfish_workers = NULL;
+        pool->num_workers = 0;
+        return;
+    }
+
+    for (int32_t i = 0; i < total - 1; i++) {
+        jellyfish_workers[i].index = i + 1;
+        jellyfish_workers[i].generation = pool->generation;
+#ifdef _WIN32
+        pool->threads[i] = CreateThread(NULL, 0, jellyfish_worker_main, &jellyfish_workers[i], 0, NULL);
+        if (pool->threads[i] == NULL) {
+            break;
+        }
+#else
+        if (pthread_create(&pool->threads[i], NULL, jellyfish_worker_main, &jellyfish_workers[i]) != 0) {
+            break;
+        }
+#endif
+        started++;
+    }
+    pool->num_workers = started;
+}
+
+// Stops the workers; called with the submit lock held
+static void jellyfish_pool_stop(void) {
+    jellyfish_pool_t* pool = &jellyfish_pool;
+    if (!pool->threads) {
+        return;
+    }
+
+    jellyfish_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    jellyfish_cond_broadcast(&pool->wake);
+    jellyfish_mutex_unlock(&pool->lock);
+
+    for (int32_t i = 0; i < pool->num_workers; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+    free(pool->threads);
+    free(jellyfish_workers);
+    pool->threads = NULL;
+    jellyfish_workers = NULL;
+    pool->num_workers = 0;
+}
+
+void fossil_jellyfish_set_num_threads(int32_t num_threads) {
+    jellyfish_pool_init();
+    jellyfish_mutex_lock(&jellyfish_pool.submit);
+    jellyfish_pool_stop();
+    jellyfish_atomic_store32(&jellyfish_requested_threads, num_threads > 0 ? num_threads : 0);
+    jellyfish_mutex_unlock(&jellyfish_pool.submit);
+}
+
+int32_t fossil_jellyfish_get_num_threads(void) {
+    int32_t requested = (int32_t)jellyfish_atomic_load32(&jellyfish_requested_threads);
+    return requested > 0 ? requested : jellyfish_hardware_threads();
+}
+
+int32_t jellyfish_serial_enter(void) {
+    int32_t previous = jellyfish_inside_task;
+    jellyfish_inside_task = 1;
+    return previous;
+}
+
+void jellyfish_serial_leave(int32_t previous) {
+    jellyfish_inside_task = previous;
+}
+
+void fossil_jellyfish_parallel_for(int64_t count, int64_t grain, fossil_jellyfish_task_t task, void* context) {
+    fossil_jellyfish_parallel_for_bounded(count, grain, INT32_MAX, task, context);
+}
+
+void fossil_jellyfish_parallel_for_bounded(int64_t count, int64_t grain, int32_t max_threads, fossil_jellyfish_task_t task, void* context) {
+    jellyfish_pool_t* pool = &jellyfish_pool;
+    if (count <= 0) {
+        return;
+    }
+    if (grain < 1) {
+        grain = 1;
+    }
+
+    if (count <= grain || jellyfish_inside_task || max_threads <= 1 || fossil_jellyfish_get_num_threads() <= 1) {
+        task(context, 0, count, 0);
+        return;
+    }
+
+    jellyfish_pool_init();
+    if (!jellyfish_mutex_trylock(&pool->submit)) {
+        task(context, 0, count, 0);
+        return;
+    }
+    if (!pool->threads) {
+        jellyfish_pool_start();
+    }
+    if (pool->num_workers == 0) {
+        jellyfish_mutex_unlock(&pool->submit);
+        task(context, 0, count, 0);
+        return;
+    }
+
+    jellyfish_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->count = count;
+    pool->grain = grain;
+    pool->limit = max_threads;
+    jellyfish_atomic_store64(&pool->next, 0);
+    pool->active = pool->num_workers;
+    pool->generation++;
+    jellyfish_cond_broadcast(&pool->wake);
+    jellyfish_mutex_unlock(&pool->lock);
+
+    jellyfish_run_chunks(0);
+
+    jellyfish_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        jellyfish_cond_wait(&pool->done, &pool->lock);
+    }
+    jellyfish_mutex_unlock(&pool->lock);
+
+    jellyfish_mutex_unlock(&pool->submit);
+}
+
+void fossil_jellyfish_shutdown_threads(void) {
+    if (!jellyfish_pool_initialized) {
+        return;
+    }
+    jellyfish_mutex_lock(&jellyfish_pool.submit);
+    jellyfish_pool_stop();
+    jellyfish_mutex_unlock(&jellyfish_pool.submit);
+}
@@ -0,0 +1,740 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "fossil/jellyfish/plan.h"
+#include "internal.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+#define JELLYFISH_PANEL FOSSIL_JELLYFISH_PANEL_WIDTH
+
+size_t jellyfish_packed_count(int32_t fan_in, int32_t fan_out) {
+    size_t panels = (size_t)(fan_out + JELLYFISH_PANEL - 1) / JELLYFISH_PANEL;
+    return panels * JELLYFISH_PANEL * (size_t)fan_in;
+}
+
+void jellyfish_pack_panels(const double* weights, int32_t fan_in, int32_t fan_out, double* packed) {
+    for (int32_t j0 = 0; j0 < fan_out; j0 += JELLYFISH_PANEL) {
+        double* panel = packed + (size_t)j0 * (size_t)fan_in;
+        for (int32_t k = 0; k < fan_in; k++) {
+            for (int32_t l = 0; l < JELLYFISH_PANEL; l++) {
+                panel[k * JELLYFISH_PANEL + l] = j0 + l < fan_out ? weights[(size_t)(j0 + l) * (size_t)fan_in + (size_t)k] : 0;
+            }
+        }
+    }
+}
+
+// Register tile of two rows by one panel: every weight load feeds two rows and every
+// input load four neurons, through eight independent accumulators
+void jellyfish_packed_matvec_rows(const double* packed, int32_t fan_in, int32_t fan_out, const double* inputs, int64_t stride, int64_t rows, double* sums) {
+    int64_t r = 0;
+    for (; r + 1 < rows; r += 2) {
+        const double* restrict x0 = inputs + r * stride;
+        const double* restrict x1 = x0 + stride;
+        for (int32_t j0 = 0; j0 < fan_out; j0 += JELLYFISH_PANEL) {
+            const double* restrict panel = packed + (size_t)j0 * (size_t)fan_in;
+            double a0[JELLYFISH_PANEL] = {0}, a1[JELLYFISH_PANEL] = {0};
+            for (int32_t k = 0; k < fan_in; k++) {
+                for (int32_t l = 0; l < JELLYFISH_PANEL; l++) {
+                    a0[l] += x0[k] * panel[k * JELLYFISH_PANEL + l];
+                    a1[l] += x1[k] * panel[k * JELLYFISH_PANEL + l];
+                }
+            }
+            int32_t width = fan_out - j0 < JELLYFISH_PANEL ? fan_out - j0 : JELLYFISH_PANEL;
+            for (int32_t l = 0; l < width; l++) {
+                sums[r * fan_out + j0 + l] = a0[l];
+                sums[(r + 1) * fan_out + j0 + l] = a1[l];
+            }
+        }
+    }
+    for (; r < rows; r++) {
+        const double* restrict x = inputs + r * stride;
+        for (int32_t j0 = 0; j0 < fan_out; j0 += JELLYFISH_PANEL) {
+            const double* restrict panel = packed + (size_t)j0 * (size_t)fan_in;
+            double acc[JELLYFISH_PANEL] = {0};
+            for (int32_t k = 0; k < fan_in; k++) {
+                for (int32_t l = 0; l < JELLYFISH_PANEL; l++) {
+                    acc[l] += x[k] * panel[k * JELLYFISH_PANEL + l];
+                }
+            }
+            int32_t width = fan_out - j0 < JELLYFISH_PANEL ? fan_out - j0 : JELLYFISH_PANEL;
+            for (int32_t l = 0; l < width; l++) {
+                sums[r * fan_out + j0 + l] = acc[l];
+            }
+        }
+    }
+}
+
+int32_t fossil_jellyfish_pack_weights(fossil_jellyfish_network_t* network) {
+    if (!network) {
+        return -1;
+    }
+    for (int32_t i = 1; i < network->num_layers; i++) {
+        fossil_jellyfish_layer_t* layer = network->layers[i];
+        int32_t fan_in = network->layers[i - 1]->num_neurons;
+        if (layer->kind != LAYER_DENSE || layer->num_neurons < JELLYFISH_PANEL) {
+            continue;
+        }
+        if (!layer->packed) {
+            layer->packed = jellyfish_alloc_array(&network->allocator, jellyfish_packed_count(fan_in, layer->num_neurons));
+            if (!layer->packed) {
+                return -1;
+            }
+        }
+        jellyfish_pack_panels(layer->weights, fan_in, layer->num_neurons, layer->packed);
+    }
+    return 0;
+}
+
+// Weight kernels
+
+static void jellyfish_dense_matvec(const fossil_jellyfish_plan_step_t* step, const double* inputs, int64_t rows, double* outputs) {
+    int32_t fan_in = step->fan_in, fan_out = step->fan_out;
+    for (int32_t j = 0; j < fan_out; j++) {
+        const double* restrict w = step->source->weights + (size_t)j * (size_t)fan_in;
+        for (int64_t r = 0; r < rows; r++) {
+            const double* restrict x = inputs + r * fan_in;
+            double sum = 0;
+            for (int32_t k = 0; k < fan_in; k++) {
+                sum += x[k] * w[k];
+            }
+            outputs[r * fan_out + j] = sum;
+        }
+    }
+}
+
+static void jellyfish_dense_transpose(const fossil_jellyfish_plan_step_t* step, const double* deltas, double* errors) {
+    int32_t fan_in = step->fan_in;
+    memset(errors, 0, (size_t)fan_in * sizeof(double));
+    for (int32_t j = 0; j < step->fan_out; j++) {
+        const double* restrict w = step->source->weights + (size_t)j * (size_t)fan_in;
+        double delta = deltas[j];
+        for (int32_t k = 0; k < fan_in; k++) {
+            errors[k] += w[k] * delta;
+        }
+    }
+}
+
+static void jellyfish_packed_matvec(const fossil_jellyfish_plan_step_t* step, const double* inputs, int64_t rows, double* outputs) {
+    jellyfish_packed_matvec_rows(step->packed, step->fan_in, step->fan_out, inputs, step->fan_in, rows, outputs);
+}
+
+static void jellyfish_packed_transpose(const fossil_jellyfish_plan_step_t* step, const double* deltas, double* errors) {
+    int32_t fan_in = step->fan_in, fan_out = step->fan_out;
+    memset(errors, 0, (size_t)fan_in * sizeof(double));
+    for (int32_t j0 = 0; j0 < fan_out; j0 += JELLYFISH_PANEL) {
+        const double* restrict panel = step->packed + (size_t)j0 * (size_t)fan_in;
+        double d[JELLYFISH_PANEL] = {0};
+        for (int32_t l = 0; l < JELLYFISH_PANEL && j0 + l < fan_out; l++) {
+            d[l] = deltas[j0 + l];
+        }
+        for (int32_t k = 0; k < fan_in; k++) {
+            double sum = 0;
+            for (int32_t l = 0; l < JELLYFISH_PANEL; l++) {
+                sum += panel[k * JELLYFISH_PANEL + l] * d[l];
+            }
+            errors[k] += sum;
+        }
+    }
+}
+
+static void jellyfish_sparse_matvec(const fossil_jellyfish_plan_step_t* step, const double* inputs, int64_t rows, double* outputs) {
+    const int32_t* starts = step->indices;
+    const int32_t* columns = step->indices + step->fan_out + 1;
+    for (int64_t r = 0; r < rows; r++) {
+        const double* x = inputs + r * step->fan_in;
+        for (int32_t j = 0; j < step->fan_out; j++) {
+            double sum = 0;
+            for (int32_t n = starts[j]; n < starts[j + 1]; n++) {
+                sum += step->packed[n] * x[columns[n]];
+            }
+            outputs[r * step->fan_out + j] = sum;
+        }
+    }
+}
+
+static void jellyfish_sparse_transpose(const fossil_jellyfish_plan_step_t* step, const double* deltas, double* errors) {
+    const int32_t* starts = step->indices;
+    const int32_t* columns = step->indices + step->fan_out + 1;
+    memset(errors, 0, (size_t)step->fan_in * sizeof(double));
+    for (int32_t j = 0; j < step->fan_out; j++) {
+        for (int32_t n = starts[j]; n < starts[j + 1]; n++) {
+            errors[columns[n]] += step->packed[n] * deltas[j];
+        }
+    }
+}
+
+static void jellyfish_hashed_matvec(const fossil_jellyfish_plan_step_t* step, const double* inputs, int64_t rows, double* outputs) {
+    jellyfish_hashed_matvec_rows(step->source, step->fan_in, inputs, step->fan_in, rows, outputs);
+}
+
+static void jellyfish_hashed_transpose(const fossil_jellyfish_plan_step_t* step, const double* deltas, double* errors) {
+    jellyfish_hashed_transpose_matvec(step->source, step->fan_in, deltas, errors);
+}
+
+// Fills packed panels or sparse values from the layer's current weights
+static void jellyfish_plan_pack(fossil_jellyfish_plan_step_t* step) {
+    const double* weights = step->source->weights;
+    int32_t fan_in = step->fan_in, fan_out = step->fan_out;
+
+    // A layer packed ahead of time already holds the panels
+    if (step->kind == KERNEL_DENSE_PACKED && step->source->packed) {
+        memcpy(step->packed, step->source->packed, jellyfish_packed_count(fan_in, fan_out) * sizeof(double));
+    } else if (step->kind == KERNEL_DENSE_PACKED) {
+        jellyfish_pack_panels(weights, fan_in, fan_out, step->packed);
+    } else if (step->kind == KERNEL_SPARSE) {
+        const int32_t* starts = step->indices;
+        const int32_t* columns = step->indices + fan_out + 1;
+        for (int32_t j = 0; j < fan_out; j++) {
+            for (int32_t n = starts[j]; n < starts[j + 1]; n++) {
+                step->packed[n] = weights[(size_t)j * (size_t)fan_in + (size_t)columns[n]];
+            }
+        }
+    }
+}
+
+static const char* const jellyfish_kernel_names[] = {"dense", "dense_packed", "sparse", "hashed"};
+
+// Sets up a dense-family step for the given kernel, packing its weights
+static int32_t jellyfish_plan_step_build(fossil_jellyfish_plan_step_t* step, const fossil_jellyfish_allocator_t* allocator, fossil_jellyfish_kernel_kind_t kind, int64_t nonzeros) {
+    const double* weights = step->source->weights;
+    step->kind = kind;
+    step->kernel_name = jellyfish_kernel_names[kind];
+    step->nonzeros = kind == KERNEL_SPARSE ? nonzeros : (int64_t)step->fan_in * step->fan_out;
+
+    switch (kind) {
+        case KERNEL_HASHED:
+            step->matvec = jellyfish_hashed_matvec;
+            step->transpose = jellyfish_hashed_transpose;
+            return 0;
+        case KERNEL_DENSE:
+            step->matvec = jellyfish_dense_matvec;
+            step->transpose = jellyfish_dense_transpose;
+            return 0;
+        case KERNEL_DENSE_PACKED:
+            step->matvec = jellyfish_packed_matvec;
+            step->transpose = jellyfish_packed_transpose;
+            step->packed = jellyfish_alloc_array(allocator, jellyfish_packed_count(step->fan_in, step->fan_out));
+            break;
+        case KERNEL_SPARSE: {
+            step->matvec = jellyfish_sparse_matvec;
+            step->transpose = jellyfish_sparse_transpose;
+            step->packed = (double*)jellyfish_alloc_with(allocator, (size_t)(nonzeros > 0 ? nonzeros : 1) * sizeof(double));
+            step->indices = (int32_t*)jellyfish_alloc_with(allocator, (size_t)(step->fan_out + 1 + nonzeros) * sizeof(int32_t));
+            if (!step->indices) {
+                return -1;
+            }
+            int32_t* columns = step->indices + step->fan_out + 1;
+            int32_t n = 0;
+            for (int32_t j = 0; j < step->fan_out; j++) {
+                step->indices[j] = n;
+                for (int32_t k = 0; k < step->fan_in; k++) {
+                    if (weights[(size_t)j * (size_t)step->fan_in + (size_t)k] != 0) {
+                        columns[n++] = k;
+                    }
+                }
+            }
+            step->indices[step->fan_out] = n;
+            break;
+        }
+    }
+    if (!step->packed) {
+        return -1;
+    }
+    jellyfish_plan_pack(step);
+    return 0;
+}
+
+static void jellyfish_plan_step_release(fossil_jellyfish_plan_step_t* step, const fossil_jellyfish_allocator_t* allocator) {
+    jellyfish_free_with(allocator, step->packed);
+    jellyfish_free_with(allocator, step->indices);
+    step->packed = NULL;
+    step->indices = NULL;
+}
+
+// Autotuning
+
+#define JELLYFISH_TUNE_SAMPLES 3
+#define JELLYFISH_TUNE_WORK (1 << 21)   // Multiply-adds per timed sample
+#define JELLYFISH_CPU_MODEL_SIZE 128
+
+// The winning kernel for one layer shape on this host
+typedef struct {
+    int32_t fan_in;
+    int32_t fan_out;
+    int32_t permille;      // Nonzero weights per thousand
+    int32_t candidates;    // Bit mask of the kernels that were allowed to compete
+    fossil_jellyfish_kernel_kind_t kind;
+} jellyfish_tuning_entry_t;
+
+typedef struct {
+    char cpu[JELLYFISH_CPU_MODEL_SIZE];
+    const char* path;
+    jellyfish_tuning_entry_t* entries;
+    int32_t count;
+    int32_t capacity;
+} jellyfish_tuning_t;
+
+static double jellyfish_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+// The processor brand string on x86, the kernel's description elsewhere
+static void jellyfish_cpu_model(char* model, size_t size) {
+    snprintf(model, size, "unknown");
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    uint32_t brand[12];
+    for (uint32_t leaf = 0; leaf < 3; leaf++) {
+#ifdef _MSC_VER
+        int registers[4];
+        __cpuid(registers, (int)(0x80000002u + leaf));
+        memcpy(&brand[leaf * 4], registers, sizeof(registers));
+#else
+        __get_cpuid(0x80000002u + leaf, &brand[leaf * 4], &brand[leaf * 4 + 1], &brand[leaf * 4 + 2], &brand[leaf * 4 + 3]);
+#endif
+    }
+    char text[sizeof(brand) + 1];
+    memcpy(text, brand, sizeof(brand));
+    text[sizeof(brand)] = '\0';
+    if (text[0]) {
+        snprintf(model, size, "%s", text);
+    }
+#elif defined(__linux__)
+    FILE* cpuinfo = fopen("/proc/cpuinfo", "r");
+    char line[256];
+    while (cpuinfo && fgets(line, sizeof(line), cpuinfo)) {
+        char* colon = strchr(line, ':');
+        if (colon && (strncmp(line, "model name", 10) == 0 || strncmp(line, "Hardware", 8) == 0 || strncmp(line, "CPU part", 8) == 0)) {
+            snprintf(model, size, "%s", colon + 1 + (colon[1] == ' '));
+            break;
+        }
+    }
+    if (cpuinfo) {
+        fclose(cpuinfo);
+    }
+#endif
+    // The model ends the cache line, so it must not hold line breaks; spaces are trimmed
+    for (char* c = model; *c; c++) {
+        if (*c == '\n' || *c == '\r' || *c == '\t') {
+            *c = ' ';
+        }
+    }
+    size_t length = strlen(model);
+    while (length > 0 && model[length - 1] == ' ') {
+        model[--length] = '\0';
+    }
+    char* begin = model;
+    while (*begin == ' ') {
+        begin++;
+    }
+    memmove(model, begin, strlen(begin) + 1);
+}
+
+static int32_t jellyfish_tuning_add(jellyfish_tuning_t* tuning, const jellyfish_tuning_entry_t* entry) {
+    if (tuning->count == tuning->capacity) {
+        int32_t capacity = tuning->capacity > 0 ? 2 * tuning->capacity : 16;
+        jellyfish_tuning_entry_t* entries = (jellyfish_tuning_entry_t*)jellyfish_realloc(tuning->entries, (size_t)tuning->capacity * sizeof(jellyfish_tuning_entry_t),
+                                                                                        (size_t)capacity * sizeof(jellyfish_tuning_entry_t));
+        if (!entries) {
+            return -1;
+        }
+        tuning->entries = entries;
+        tuning->capacity = capacity;
+    }
+    tuning->entries[tuning->count++] = *entry;
+    return 0;
+}
+
+// Cache lines: fan_in fan_out permille candidates kernel nanoseconds_per_row cpu_model
+static void jellyfish_tuning_open(jellyfish_tuning_t* tuning, const char* path) {
+    memset(tuning, 0, sizeof(*tuning));
+    jellyfish_cpu_model(tuning->cpu, sizeof(tuning->cpu));
+    tuning->path = path;
+
+    FILE* file = path ? fopen(path, "r") : NULL;
+    char line[512];
+    while (file && fgets(line, sizeof(line), file)) {
+        jellyfish_tuning_entry_t entry;
+        char kernel[32], cpu[JELLYFISH_CPU_MODEL_SIZE];
+        double nanoseconds;
+        if (line[0] == '#' || sscanf(line, "%d %d %d %d %31s %lf %127[^\n]", &entry.fan_in, &entry.fan_out, &entry.permille,
+                                     &entry.candidates, kernel, &nanoseconds, cpu) != 7 || strcmp(cpu, tuning->cpu) != 0) {
+            continue;
+        }
+        for (int32_t kind = KERNEL_DENSE; kind <= KERNEL_SPARSE; kind++) {
+            if (strcmp(kernel, jellyfish_kernel_names[kind]) == 0 && (entry.candidates & (1 << kind))) {
+                entry.kind = (fossil_jellyfish_kernel_kind_t)kind;
+                jellyfish_tuning_add(tuning, &entry);
+            }
+        }
+    }
+    if (file) {
+        fclose(file);
+    }
+}
+
+// Later lines win, so a retuned shape overrides older results
+static const jellyfish_tuning_entry_t* jellyfish_tuning_find(const jellyfish_tuning_t* tuning, const jellyfish_tuning_entry_t* key) {
+    for (int32_t i = tuning->count - 1; i >= 0; i--) {
+        const jellyfish_tuning_entry_t* entry = &tuning->entries[i];
+        if (entry->fan_in == key->fan_in && entry->fan_out == key->fan_out && entry->permille == key->permille && entry->candidates == key->candidates) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void jellyfish_tuning_record(jellyfish_tuning_t* tuning, const jellyfish_tuning_entry_t* entry, double nanoseconds) {
+    jellyfish_tuning_add(tuning, entry);
+    FILE* file = tuning->path ? fopen(tuning->path, "a") : NULL;
+    if (!file) {
+        return;
+    }
+    if (fseek(file, 0, SEEK_END) == 0 && ftell(file) == 0) {
+        fprintf(file, "# fossil jellyfish tuning cache: fan_in fan_out permille candidates kernel ns_per_row cpu\n");
+    }
+    fprintf(file, "%d %d %d %d %s %.1f %s\n", entry->fan_in, entry->fan_out, entry->permille, entry->candidates,
+            jellyfish_kernel_names[entry->kind], nanoseconds, tuning->cpu);
+    fclose(file);
+}
+
+// Best of a few samples of a full row block, in seconds per row
+static double jellyfish_time_step(const fossil_jellyfish_plan_step_t* step, const double* inputs, double* outputs) {
+    int64_t work = (int64_t)JELLYFISH_FORWARD_BLOCK * step->fan_in * step->fan_out;
+    int64_t repeats = work < JELLYFISH_TUNE_WORK ? JELLYFISH_TUNE_WORK / work : 1;
+    double best = 0;
+
+    step->matvec(step, inputs, JELLYFISH_FORWARD_BLOCK, outputs);
+    for (int32_t sample = 0; sample < JELLYFISH_TUNE_SAMPLES; sample++) {
+        double start = jellyfish_seconds();
+        for (int64_t i = 0; i < repeats; i++) {
+            step->matvec(step, inputs, JELLYFISH_FORWARD_BLOCK, outputs);
+        }
+        double elapsed = (jellyfish_seconds() - start) / (double)(repeats * JELLYFISH_FORWARD_BLOCK);
+        best = sample == 0 || elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+// Times every candidate on the layer's own weights; -1 when scratch memory runs out
+static int32_t jellyfish_tune_step(const fossil_jellyfish_plan_step_t* step, const fossil_jellyfish_allocator_t* allocator, int64_t nonzeros, int32_t candidates, double* nanoseconds) {
+    jellyfish_scratch_mark_t mark = jellyfish_scratch_mark();
+    double* inputs = (double*)jellyfish_scratch_alloc((size_t)JELLYFISH_FORWARD_BLOCK * (size_t)step->fan_in * sizeof(double));
+    double* outputs = (double*)jellyfish_scratch_alloc((size_t)JELLYFISH_FORWARD_BLOCK * (size_t)step->fan_out * sizeof(double));
+    int32_t winner = -1;
+    double best = 0;
+
+    for (int64_t i = 0; inputs && i < (int64_t)JELLYFISH_FORWARD_BLOCK * step->fan_in; i++) {
+        inputs[i] = (double)(jellyfish_mix64((uint64_t)i) >> 11) * 0x1.0p-52 - 1.0;
+    }
+    for (int32_t kind = KERNEL_DENSE; inputs && outputs && kind <= KERNEL_SPARSE; kind++) {
+        fossil_jellyfish_plan_step_t candidate = *step;
+        candidate.packed = NULL;
+        candidate.indices = NULL;
+        if (!(candidates & (1 << kind)) || jellyfish_plan_step_build(&candidate, allocator, (fossil_jellyfish_kernel_kind_t)kind, nonzeros) != 0) {
+            jellyfish_plan_step_release(&candidate, allocator);
+            continue;
+        }
+        double elapsed = jellyfish_time_step(&candidate, inputs, outputs);
+        if (winner < 0 || elapsed < best) {
+            winner = kind;
+            best = elapsed;
+        }
+        jellyfish_plan_step_release(&candidate, allocator);
+    }
+    jellyfish_scratch_reset(mark);
+    *nanoseconds = best * 1e9;
+    return winner;
+}
+
+static int32_t jellyfish_plan_step_init(fossil_jellyfish_plan_step_t* step, const fossil_jellyfish_allocator_t* allocator, const fossil_jellyfish_compile_options_t* options,
+                                        jellyfish_tuning_t* tuning) {
+    const fossil_jellyfish_layer_t* layer = step->source;
+    int64_t count = (int64_t)step->fan_in * step->fan_out;
+    const jellyfish_activation_kernel_t* activation = jellyfish_activation_kernel(layer->activation);
+
+    step->activate = activation->forward;
+    step->activate_backward = activation->backward;
+    step->activation_name = activation->name;
+
+    if (layer->kind == LAYER_HASHED) {
+        step->selection = "fixed";
+        return jellyfish_plan_step_build(step, allocator, KERNEL_HASHED, count);
+    }
+
+    int64_t nonzeros = 0;
+    for (int64_t i = 0; i < count; i++) {
+        nonzeros += layer->weights[i] != 0;
+    }
+    int32_t sparse_allowed = nonzeros <= INT32_MAX;
+    int32_t packing_allowed = !options->disable_packing && step->fan_out >= JELLYFISH_PANEL;
+    fossil_jellyfish_kernel_kind_t kind = KERNEL_DENSE;
+    if (sparse_allowed && options->sparse_threshold > 0 && (double)nonzeros <= options->sparse_threshold * (double)count) {
+        kind = KERNEL_SPARSE;
+    } else if (packing_allowed) {
+        kind = KERNEL_DENSE_PACKED;
+    }
+    step->selection = "heuristic";
+
+    // CSR only competes when some weights are zero
+    jellyfish_tuning_entry_t key;
+    key.fan_in = step->fan_in;
+    key.fan_out = step->fan_out;
+    key.permille = (int32_t)((nonzeros * 1000 + count / 2) / count);
+    key.candidates = (1 << KERNEL_DENSE) | (packing_allowed ? 1 << KERNEL_DENSE_PACKED : 0) | (sparse_allowed && nonzeros < count ? 1 << KERNEL_SPARSE : 0);
+    if (tuning && key.candidates != (1 << KERNEL_DENSE)) {
+        const jellyfish_tuning_entry_t* cached = jellyfish_tuning_find(tuning, &key);
+        double nanoseconds;
+        int32_t winner;
+        if (cached) {
+            kind = cached->kind;
+            step->selection = "cached";
+        } else if ((winner = jellyfish_tune_step(step, allocator, nonzeros, key.candidates, &nanoseconds)) >= 0) {
+            kind = (fossil_jellyfish_kernel_kind_t)winner;
+            key.kind = kind;
+            jellyfish_tuning_record(tuning, &key, nanoseconds);
+            step->selection = "tuned";
+        }
+    }
+    return jellyfish_plan_step_build(step, allocator, kind, nonzeros);
+}
+
+fossil_jellyfish_compile_options_t fossil_jellyfish_compile_defaults(void) {
+    fossil_jellyfish_compile_options_t options;
+    options.disable_packing = 0;
+    options.sparse_threshold = 0.3;
+    options.log = NULL;
+    options.autotune = 0;
+    options.tuning_cache = NULL;
+    return options;
+}
+
+fossil_jellyfish_plan_t* fossil_jellyfish_compile(const fossil_jellyfish_network_t* network, const fossil_jellyfish_compile_options_t* options) {
+    if (!network || network->num_layers < 2) {
+        return NULL;
+    }
+    fossil_jellyfish_plan_t* plan = (fossil_jellyfish_plan_t*)jellyfish_calloc(1, sizeof(fossil_jellyfish_plan_t));
+    if (!plan) {
+        return NULL;
+    }
+    plan->network = network;
+    plan->allocator = network->allocator;
+    plan->options = options ? *options : fossil_jellyfish_compile_defaults();
+    plan->num_steps = network->num_layers - 1;
+    plan->input_width = network->layers[0]->num_neurons;
+    plan->output_width = network->layers[network->num_layers - 1]->num_neurons;
+    plan->buffer_size = (size_t)JELLYFISH_FORWARD_BLOCK * (size_t)jellyfish_max_width(network);
+    plan->activation_size = (size_t)plan->input_width;
+    plan->steps = (fossil_jellyfish_plan_step_t*)jellyfish_calloc((size_t)plan->num_steps, sizeof(fossil_jellyfish_plan_step_t));
+    if (!plan->steps) {
+        jellyfish_free(plan);
+        return NULL;
+    }
+
+    jellyfish_tuning_t tuning;
+    if (plan->options.autotune) {
+        jellyfish_tuning_open(&tuning, plan->options.tuning_cache);
+    }
+
+    // Steps ping-pong between two buffers; the first writes buffer 1 so normalized inputs can sit in buffer 0
+    size_t gradient_offset = 0;
+    for (int32_t s = 0; s < plan->num_steps; s++) {
+        fossil_jellyfish_plan_step_t* step = &plan->steps[s];
+        step->layer = s + 1;
+        step->source = network->layers[s + 1];
+        step->fan_in = network->layers[s]->num_neurons;
+        step->fan_out = step->source->num_neurons;
+        step->buffer = s == plan->num_steps - 1 ? -1 : (s + 1) & 1;
+        step->offset = plan->activation_size;
+        step->gradient_offset = gradient_offset;
+        plan->activation_size += (size_t)step->fan_out;
+        gradient_offset += jellyfish_weight_count(network, s + 1) + (size_t)step->fan_out;
+        if (jellyfish_plan_step_init(step, &plan->allocator, &plan->options, plan->options.autotune ? &tuning : NULL) != 0) {
+            if (plan->options.autotune) {
+                jellyfish_free(tuning.entries);
+            }
+            fossil_jellyfish_plan_free(plan);
+            return NULL;
+        }
+    }
+    if (plan->options.autotune) {
+        jellyfish_free(tuning.entries);
+    }
+
+    if (plan->options.log) {
+        fossil_jellyfish_plan_describe(plan, plan->options.log);
+    }
+    return plan;
+}
+
+void fossil_jellyfish_plan_free(fossil_jellyfish_plan_t* plan) {
+    if (!plan) {
+        return;
+    }
+    for (int32_t s = 0; s < plan->num_steps; s++) {
+        jellyfish_plan_step_release(&plan->steps[s], &plan->allocator);
+    }
+    jellyfish_free(plan->steps);
+    jellyfish_free(plan);
+}
+
+int32_t fossil_jellyfish_plan_refresh(fossil_jellyfish_plan_t* plan) {
+    const fossil_jellyfish_network_t* network = plan->network;
+    if (network->num_layers != plan->num_steps + 1) {
+        return -1;
+    }
+    for (int32_t s = 0; s < plan->num_steps; s++) {
+        const fossil_jellyfish_plan_step_t* step = &plan->steps[s];
+        const fossil_jellyfish_layer_t* layer = network->layers[s + 1];
+        if (layer != step->source || layer->num_neurons != step->fan_out || network->layers[s]->num_neurons != step->fan_in ||
+            (layer->kind == LAYER_HASHED) != (step->kind == KERNEL_HASHED)) {
+            return -1;
+        }
+    }
+
+    // Training fills in zeros, so sparse patterns are measured again rather than kept
+    jellyfish_tuning_t tuning;
+    int32_t status = 0;
+    if (plan->options.autotune) {
+        jellyfish_tuning_open(&tuning, plan->options.tuning_cache);
+    }
+    for (int32_t s = 0; s < plan->num_steps && status == 0; s++) {
+        fossil_jellyfish_plan_step_t* step = &plan->steps[s];
+        if (step->kind == KERNEL_SPARSE) {
+            jellyfish_plan_step_release(step, &plan->allocator);
+            status = jellyfish_plan_step_init(step, &plan->allocator, &plan->options, plan->options.autotune ? &tuning : NULL);
+        } else {
+            jellyfish_plan_pack(step);
+        }
+    }
+    if (plan->options.autotune) {
+        jellyfish_free(tuning.entries);
+    }
+    return status;
+}
+
+size_t fossil_jellyfish_plan_scratch_size(const fossil_jellyfish_plan_t* plan) {
+    size_t forward = 2 * plan->buffer_size;
+    size_t backward = plan->activation_size + 2 * (plan->buffer_size / JELLYFISH_FORWARD_BLOCK);
+    return forward > backward ? forward : backward;
+}
+
+static void jellyfish_plan_layer(const fossil_jellyfish_plan_step_t* step, const double* inputs, int64_t rows, double* outputs) {
+    const double* restrict biases = step->source->biases;
+    step->matvec(step, inputs, rows, outputs);
+    for (int64_t r = 0; r < rows; r++) {
+        double* restrict y = outputs + r * step->fan_out;
+        for (int32_t j = 0; j < step->fan_out; j++) {
+            y[j] += biases[j];
+        }
+        step->activate(y, step->fan_out);
+    }
+}
+
+void fossil_jellyfish_plan_forward(const fossil_jellyfish_plan_t* plan, const double* inputs, int64_t rows, double* outputs, double* scratch) {
+    double* buffers[2] = {scratch, scratch + plan->buffer_size};
+
+    for (int64_t row = 0; row < rows; row += JELLYFISH_FORWARD_BLOCK) {
+        int64_t block = rows - row < JELLYFISH_FORWARD_BLOCK ? rows - row : JELLYFISH_FORWARD_BLOCK;
+        const double* current = inputs + row * plan->input_width;
+        if (plan->network->input_mean) {
+            jellyfish_load_inputs(plan->network, current, plan->input_width, block, buffers[0]);
+            current = buffers[0];
+        }
+        for (int32_t s = 0; s < plan->num_steps; s++) {
+            const fossil_jellyfish_plan_step_t* step = &plan->steps[s];
+            double* next = step->buffer < 0 ? outputs + row * plan->output_width : buffers[step->buffer];
+            jellyfish_plan_layer(step, current, block, next);
+            current = next;
+        }
+    }
+}
+
+void fossil_jellyfish_plan_accumulate_gradients(const fossil_jellyfish_plan_t* plan, const double* input, const double* expected_output, fossil_jellyfish_loss_t loss, double* gradients, double* scratch) {
+    double* values = scratch;
+    double* delta = scratch + plan->activation_size;
+    double* error = delta + plan->buffer_size / JELLYFISH_FORWARD_BLOCK;
+
+    // Forward, keeping every layer's outputs
+    jellyfish_load_inputs(plan->network, input, plan->input_width, 1, values);
+    for (int32_t s = 0; s < plan->num_steps; s++) {
+        const fossil_jellyfish_plan_step_t* step = &plan->steps[s];
+        const double* x = s == 0 ? values : values + plan->steps[s - 1].offset;
+        jellyfish_plan_layer(step, x, 1, values + step->offset);
+    }
+
+    // Backward: delta holds dL/dz of the current step
+    const fossil_jellyfish_plan_step_t* last = &plan->steps[plan->num_steps - 1];
+    fossil_jellyfish_loss_gradient(loss, values + last->offset, expected_output, delta, 1, plan->output_width);
+    last->activate_backward(values + last->offset, delta, plan->output_width);
+
+    for (int32_t s = plan->num_steps - 1; s >= 0; s--) {
+        const fossil_jellyfish_plan_step_t* step = &plan->steps[s];
+        const double* restrict x = s == 0 ? values : values + plan->steps[s - 1].offset;
+        double* restrict g = gradients + step->gradient_offset;
+
+        if (step->kind == KERNEL_HASHED) {
+            jellyfish_hashed_accumulate(step->source, step->fan_in, x, delta, 1.0, g);
+        } else {
+            for (int32_t j = 0; j < step->fan_out; j++) {
+                double* restrict row = g + (size_t)j * (size_t)step->fan_in;
+                for (int32_t k = 0; k < step->fan_in; k++) {
+                    row[k] += delta[j] * x[k];
+                }
+            }
+        }
+        g += jellyfish_weight_count(plan->network, step->layer);
+        for (int32_t j = 0; j < step->fan_out; j++) {
+            g[j] += delta[j];
+        }
+
+        if (s > 0) {
+            step->transpose(step, delta, error);
+            plan->steps[s - 1].activate_backward(x, error, step->fan_in);
+            double* swap = delta;
+            delta = error;
+            error = swap;
+        }
+    }
+}
+
+void fossil_jellyfish_plan_describe(const fossil_jellyfish_plan_t* plan, FILE* stream) {
+    fprintf(stream, "plan: %d steps, f64, portable C kernels, input normalization %s, %s\n", plan->num_steps,
+            plan->network->input_mean ? "on" : "off", plan->options.autotune ? "autotuned" : "heuristic selection");
+    for (int32_t s = 0; s < plan->num_steps; s++) {
+        const fossil_jellyfish_plan_step_t* step = &plan->steps[s];
+        double density = step->kind == KERNEL_SPARSE ? (double)step->nonzeros / ((double)step->fan_in * (double)step->fan_out) : 1.0;
+        const char* buffer = step->buffer < 0 ? "output" : step->buffer == 0 ? "buffer 0" : "buffer 1";
+        fprintf(stream, "  layer %d: %d -> %d, %s (%s), %s, density %.2f, %s\n", step->layer, step->fan_in, step->fan_out,
+                step->kernel_name, step->selection, step->activation_name, density, buffer);
+    }
+}
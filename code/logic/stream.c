@@ -0,0 +1,176 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/jellyfish/stream.h"
+#include "fossil/jellyfish/hashed.h"
+#include "internal.h"
+#include <string.h>
+
+// Whether every window position sees the same first-layer weights and standardization
+static int32_t jellyfish_stream_tied(const fossil_jellyfish_stream_t* stream) {
+    const fossil_jellyfish_network_t* network = stream->network;
+    const fossil_jellyfish_layer_t* first = network->layers[1];
+    int32_t channels = stream->channels, fan_in = stream->window * channels;
+    if (first->kind != LAYER_DENSE) {
+        return 0;
+    }
+    for (int32_t k = channels; k < fan_in; k++) {
+        int32_t c = k % channels;
+        if (network->input_mean && (network->input_mean[k] != network->input_mean[c] || network->input_scale[k] != network->input_scale[c])) {
+            return 0;
+        }
+        for (int32_t j = 0; j < first->num_neurons; j++) {
+            if (first->weights[(size_t)j * (size_t)fan_in + (size_t)k] != first->weights[(size_t)j * (size_t)fan_in + (size_t)c]) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+fossil_jellyfish_stream_t* fossil_jellyfish_stream_create(fossil_jellyfish_network_t* network, int32_t window) {
+    if (!network || network->num_layers < 2 || window <= 0 || network->layers[0]->num_neurons % window != 0) {
+        return NULL;
+    }
+    fossil_jellyfish_stream_t* stream = (fossil_jellyfish_stream_t*)jellyfish_calloc(1, sizeof(fossil_jellyfish_stream_t));
+    if (!stream) {
+        return NULL;
+    }
+    stream->network = network;
+    stream->window = window;
+    stream->channels = network->layers[0]->num_neurons / window;
+    stream->pending = (double*)jellyfish_calloc((size_t)window * (size_t)network->layers[1]->num_neurons, sizeof(double));
+    stream->values = (double*)jellyfish_malloc((size_t)network->layers[0]->num_neurons * sizeof(double));
+    stream->totals = (double*)jellyfish_calloc((size_t)stream->channels, sizeof(double));
+    if (!stream->pending || !stream->values || !stream->totals) {
+        fossil_jellyfish_stream_free(stream);
+        return NULL;
+    }
+    stream->tied = jellyfish_stream_tied(stream);
+    return stream;
+}
+
+void fossil_jellyfish_stream_free(fossil_jellyfish_stream_t* stream) {
+    if (!stream) {
+        return;
+    }
+    jellyfish_free(stream->pending);
+    jellyfish_free(stream->values);
+    jellyfish_free(stream->totals);
+    jellyfish_free(stream);
+}
+
+void fossil_jellyfish_stream_reset(fossil_jellyfish_stream_t* stream) {
+    memset(stream->pending, 0, (size_t)stream->window * (size_t)stream->network->layers[1]->num_neurons * sizeof(double));
+    memset(stream->totals, 0, (size_t)stream->channels * sizeof(double));
+    stream->num_pushed = 0;
+    stream->tied = jellyfish_stream_tied(stream);
+}
+
+// Tied first layer: running per-channel sums over the ring of standardized samples in
+// values, so a step costs channels for the sums plus width * channels for the layer
+static int32_t jellyfish_stream_push_tied(fossil_jellyfish_stream_t* stream, const double* sample, int64_t step, double* next) {
+    const fossil_jellyfish_network_t* network = stream->network;
+    const fossil_jellyfish_layer_t* first = network->layers[1];
+    int32_t window = stream->window, channels = stream->channels;
+    size_t fan_in = (size_t)window * (size_t)channels;
+    double* slot = stream->values + (step % window) * channels;
+
+    for (int32_t c = 0; c < channels; c++) {
+        double value = network->input_mean ? (sample[c] - network->input_mean[c]) * network->input_scale[c] : sample[c];
+        stream->totals[c] += value - (step >= window ? slot[c] : 0);
+        slot[c] = value;
+    }
+
+    // Adding and subtracting accumulates rounding; summing the ring afresh once per window bounds it
+    if (step % window == window - 1) {
+        for (int32_t c = 0; c < channels; c++) {
+            double total = 0;
+            for (int32_t p = 0; p < window; p++) {
+                total += stream->values[p * channels + c];
+            }
+            stream->totals[c] = total;
+        }
+    }
+    if (step < window - 1) {
+        return 0;
+    }
+    for (int32_t j = 0; j < first->num_neurons; j++) {
+        const double* w = first->weights + (size_t)j * fan_in;
+        double weighted_sum = 0;
+        for (int32_t c = 0; c < channels; c++) {
+            weighted_sum += stream->totals[c] * w[c];
+        }
+        next[j] = weighted_sum + first->biases[j];
+    }
+    return 1;
+}
+
+// Any first layer: every pushed sample adds its products to the sums of each window it
+// belongs to, which is as much arithmetic as running the first layer on every window
+static int32_t jellyfish_stream_push_pending(fossil_jellyfish_stream_t* stream, const double* sample, int64_t step, double* next) {
+    fossil_jellyfish_network_t* network = stream->network;
+    const fossil_jellyfish_layer_t* first = network->layers[1];
+    int32_t window = stream->window, channels = stream->channels;
+    int32_t fan_in = window * channels, width = first->num_neurons;
+
+    // Standardization depends on the position the sample takes in each window
+    for (int32_t p = 0; p < window; p++) {
+        for (int32_t c = 0; c < channels; c++) {
+            int32_t k = p * channels + c;
+            stream->values[k] = network->input_mean ? (sample[c] - network->input_mean[k]) * network->input_scale[k] : sample[c];
+        }
+    }
+
+    // The window ending at step + window - 1 - p sees this sample at position p. Each window
+    // receives its positions in order, so its sums run in the same order as the forward pass.
+    for (int32_t j = 0; j < width; j++) {
+        for (int32_t p = 0; p < window; p++) {
+            double* sum = stream->pending + ((step + window - 1 - p) % window) * width + j;
+            for (int32_t c = 0; c < channels; c++) {
+                int32_t k = p * channels + c;
+                double w = first->kind == LAYER_HASHED ? fossil_jellyfish_layer_weight(network, 1, j, k) : first->weights[(size_t)j * (size_t)fan_in + (size_t)k];
+                *sum += stream->values[k] * w;
+            }
+        }
+    }
+
+    // The row of the window ending now is complete; it then starts the window ending at step + window
+    double* sums = stream->pending + (step % window) * width;
+    int32_t ready = step >= window - 1;
+    for (int32_t j = 0; ready && j < width; j++) {
+        next[j] = sums[j] + first->biases[j];
+    }
+    memset(sums, 0, (size_t)width * sizeof(double));
+    return ready;
+}
+
+int32_t fossil_jellyfish_stream_push(fossil_jellyfish_stream_t* stream, const double* sample, double* output) {
+    fossil_jellyfish_network_t* network = stream->network;
+    const fossil_jellyfish_layer_t* first = network->layers[1];
+    int32_t last = network->num_layers - 1;
+    int64_t step = stream->num_pushed++;
+    double* next = last == 1 ? output : first->outputs;
+
+    int32_t ready = stream->tied ? jellyfish_stream_push_tied(stream, sample, step, next)
+                                 : jellyfish_stream_push_pending(stream, sample, step, next);
+    if (ready) {
+        fossil_jellyfish_activate_vector(next, first->num_neurons, first->activation);
+        for (int32_t i = 2; i <= last; i++) {
+            double* current = next;
+            next = i == last ? output : network->layers[i]->outputs;
+            jellyfish_forward_layer(network, i, current, next);
+        }
+    }
+    return ready;
+}
@@ -0,0 +1,133 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+
+typedef struct {
+    fossil_jellyfish_cache_t* cache;
+    const fossil_jellyfish_network_t* network;
+    const double* inputs;       // 64 distinct rows, requested in a repeating pattern
+    double* outputs;
+    double* scratch;
+    size_t scratch_size;
+} cache_requests_t;
+
+static void serve_requests(void* context, int64_t begin, int64_t end, int32_t thread_index) {
+    cache_requests_t* requests = (cache_requests_t*)context;
+    double* scratch = requests->scratch + (size_t)thread_index * requests->scratch_size;
+    for (int64_t i = begin; i < end; i++) {
+        int64_t row = (i * 37) % 64;
+        fossil_jellyfish_cached_forward(requests->cache, requests->network, 1, &requests->inputs[row * 3], &requests->outputs[i * 2], scratch);
+    }
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for hits, version invalidation and CLOCK eviction within one set
+FOSSIL_TEST(test_cache_lookup_and_eviction) {
+    fossil_jellyfish_cache_t* cache = fossil_jellyfish_cache_create(FOSSIL_JELLYFISH_CACHE_WAYS, 2, 1);
+    fossil_jellyfish_cache_stats_t stats;
+    double input[2], output;
+    ASSUME_NOT_CNULL(cache);
+
+    input[1] = 0.5;
+    for (int32_t i = 0; i < FOSSIL_JELLYFISH_CACHE_WAYS; i++) {
+        input[0] = i;
+        ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_cache_lookup(cache, input, 1, &output));
+        output = 10.0 * i;
+        fossil_jellyfish_cache_insert(cache, input, 1, &output);
+    }
+    input[0] = 3;
+    ASSUME_ITS_EQUAL_I32(1, fossil_jellyfish_cache_lookup(cache, input, 1, &output));
+    ASSUME_ITS_TRUE(output == 30.0);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_cache_lookup(cache, input, 2, &output));
+
+    // Entries 0-2 were hit, so the hand passes them and evicts entry 4
+    for (int32_t i = 0; i < 3; i++) {
+        input[0] = i;
+        ASSUME_ITS_EQUAL_I32(1, fossil_jellyfish_cache_lookup(cache, input, 1, &output));
+    }
+    input[0] = 100;
+    fossil_jellyfish_cache_insert(cache, input, 1, &output);
+    for (int32_t i = 0; i < FOSSIL_JELLYFISH_CACHE_WAYS; i++) {
+        input[0] = i;
+        ASSUME_ITS_EQUAL_I32(i != 4, fossil_jellyfish_cache_lookup(cache, input, 1, &output));
+    }
+
+    fossil_jellyfish_cache_stats(cache, &stats);
+    ASSUME_ITS_TRUE(stats.insertions == FOSSIL_JELLYFISH_CACHE_WAYS + 1);
+    ASSUME_ITS_TRUE(stats.evictions == 1);
+    ASSUME_ITS_TRUE(stats.entries == FOSSIL_JELLYFISH_CACHE_WAYS);
+    ASSUME_ITS_TRUE(stats.hits == 1 + 3 + FOSSIL_JELLYFISH_CACHE_WAYS - 1);
+    ASSUME_ITS_TRUE(stats.memory_bytes > (size_t)FOSSIL_JELLYFISH_CACHE_WAYS * 3 * sizeof(double));
+    ASSUME_ITS_TRUE((uintptr_t)cache->sets % FOSSIL_JELLYFISH_CACHE_LINE == 0);
+
+    fossil_jellyfish_cache_clear(cache);
+    fossil_jellyfish_cache_stats(cache, &stats);
+    ASSUME_ITS_TRUE(stats.entries == 0 && stats.hits == 0 && stats.hit_rate == 0);
+
+    fossil_jellyfish_cache_free(cache);
+}
+
+// Test case for many threads sharing the cache in front of one network
+FOSSIL_TEST(test_cache_concurrent_forward) {
+    int32_t neurons[] = {3, 16, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_SOFTMAX};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    double inputs[64 * 3], expected[64 * 2];
+    for (int32_t i = 0; i < 64 * 3; i++) {
+        inputs[i] = sin(0.31 * i);
+    }
+    fossil_jellyfish_forward_batch(network, inputs, 64, expected);
+
+    cache_requests_t requests;
+    requests.cache = fossil_jellyfish_cache_create(256, 3, 2);
+    requests.network = network;
+    requests.inputs = inputs;
+    requests.outputs = (double*)malloc(4096 * 2 * sizeof(double));
+    requests.scratch_size = fossil_jellyfish_cache_scratch_size(network);
+    requests.scratch = (double*)malloc((size_t)fossil_jellyfish_get_num_threads() * requests.scratch_size * sizeof(double));
+    fossil_jellyfish_parallel_for(4096, 64, serve_requests, &requests);
+
+    int32_t mismatches = 0;
+    for (int64_t i = 0; i < 4096; i++) {
+        int64_t row = (i * 37) % 64;
+        mismatches += requests.outputs[i * 2] != expected[row * 2] || requests.outputs[i * 2 + 1] != expected[row * 2 + 1];
+    }
+    ASSUME_ITS_EQUAL_I32(0, mismatches);
+
+    fossil_jellyfish_cache_stats_t stats;
+    fossil_jellyfish_cache_stats(requests.cache, &stats);
+    ASSUME_ITS_TRUE(stats.hits + stats.misses == 4096);
+    ASSUME_ITS_TRUE(stats.misses >= 64);
+    ASSUME_ITS_TRUE(stats.hit_rate > 0.9);
+
+    free(requests.outputs);
+    free(requests.scratch);
+    fossil_jellyfish_cache_free(requests.cache);
+    fossil_jellyfish_free_network(network);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(cache_tests) {
+    ADD_TEST(test_cache_lookup_and_eviction);
+    ADD_TEST(test_cache_concurrent_forward);
+}
@@ -0,0 +1,136 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+#include <string.h>
+
+// Two classes split by a line; points far from it are easy
+static void make_samples(double* inputs, double* targets, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        for (int32_t k = 0; k < 4; k++) {
+            inputs[i * 4 + k] = sin(0.9 * i + 1.7 * k);
+        }
+        targets[i] = inputs[i * 4] + inputs[i * 4 + 1] > 0;
+    }
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for joint training with no exits matching plain training
+FOSSIL_TEST(test_cascade_train_without_exits) {
+    int32_t neurons[] = {4, 8, 6, 1};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_RELU, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(4, neurons, activations);
+    fossil_jellyfish_network_t* reference = fossil_jellyfish_clone(network);
+    double inputs[32 * 4], targets[32];
+    make_samples(inputs, targets, 32);
+
+    fossil_jellyfish_cascade_t* cascade = fossil_jellyfish_cascade_create(network);
+    ASSUME_NOT_CNULL(cascade);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_cascade_train(cascade, inputs, targets, 32, 5, 0.1, LOSS_BINARY_CROSS_ENTROPY));
+    fossil_jellyfish_train_with_loss(reference, inputs, targets, 32, 5, 0.1, LOSS_BINARY_CROSS_ENTROPY);
+
+    for (int32_t i = 1; i < 4; i++) {
+        for (int32_t j = 0; j < neurons[i] * neurons[i - 1]; j++) {
+            ASSUME_ITS_TRUE(fabs(network->layers[i]->weights[j] - reference->layers[i]->weights[j]) < 1e-9);
+        }
+    }
+
+    // Confidence needs probabilities at the output
+    activations[3] = ACTIVATION_LINEAR;
+    fossil_jellyfish_network_t* linear = fossil_jellyfish_create_network(4, neurons, activations);
+    ASSUME_ITS_CNULL(fossil_jellyfish_cascade_create(linear));
+
+    fossil_jellyfish_free_network(linear);
+    fossil_jellyfish_cascade_free(cascade);
+    fossil_jellyfish_free_network(reference);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for easy inputs leaving at the exit and the statistics they produce
+FOSSIL_TEST(test_cascade_early_exit) {
+    int32_t neurons[] = {4, 16, 16, 16, 1};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_TANH, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(5, neurons, activations);
+    double inputs[256 * 4], targets[256], output;
+    make_samples(inputs, targets, 256);
+
+    fossil_jellyfish_cascade_t* cascade = fossil_jellyfish_cascade_create(network);
+    fossil_jellyfish_exit_config_t config = {1, 0, 0.9, 0.5};
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_cascade_add_exit(cascade, &config));
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_cascade_add_exit(cascade, &config));
+    config.layer = 4;
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_cascade_add_exit(cascade, &config));
+    ASSUME_ITS_TRUE(cascade->exits[0].flops == 4 * 16 + 16);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_cascade_train(cascade, inputs, targets, 256, 100, 0.05, LOSS_BINARY_CROSS_ENTROPY));
+
+    int32_t correct = 0;
+    for (int32_t i = 0; i < 256; i++) {
+        fossil_jellyfish_cascade_predict(cascade, &inputs[i * 4], &output);
+        correct += (output > 0.5) == (targets[i] > 0.5);
+    }
+
+    double early = fossil_jellyfish_cascade_exit_fraction(cascade, 0);
+    ASSUME_ITS_TRUE(cascade->num_requests == 256);
+    ASSUME_ITS_TRUE(early > 0.5);
+    ASSUME_ITS_TRUE(fabs(early + fossil_jellyfish_cascade_exit_fraction(cascade, 1) - 1) < 1e-12);
+    ASSUME_ITS_TRUE(fossil_jellyfish_cascade_flops_saved(cascade) > 0.3);
+    ASSUME_ITS_TRUE(correct >= 240);
+
+    fossil_jellyfish_cascade_free(cascade);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for thresholds that always or never exit
+FOSSIL_TEST(test_cascade_thresholds) {
+    int32_t neurons[] = {4, 8, 8, 3};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_RELU, ACTIVATION_RELU, ACTIVATION_SOFTMAX};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(4, neurons, activations);
+    fossil_jellyfish_cascade_t* cascade = fossil_jellyfish_cascade_create(network);
+    fossil_jellyfish_exit_config_t never = {2, 4, 1.5, 1};
+    fossil_jellyfish_exit_config_t always = {1, 0, 0, 1};
+    double input[4] = {0.3, -0.1, 0.8, 0.5}, output[3], expected[3];
+
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_cascade_add_exit(cascade, &never));
+    ASSUME_ITS_EQUAL_I32(1, fossil_jellyfish_cascade_predict(cascade, input, output));
+    fossil_jellyfish_forward(network, input);
+    memcpy(expected, network->layers[3]->outputs, sizeof(expected));
+    ASSUME_ITS_TRUE(memcmp(output, expected, sizeof(expected)) == 0);
+    ASSUME_ITS_TRUE(fossil_jellyfish_cascade_flops_saved(cascade) < 0);
+
+    // The shallower exit sorts first and catches everything
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_cascade_add_exit(cascade, &always));
+    ASSUME_ITS_TRUE(cascade->num_requests == 0);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_cascade_predict(cascade, input, output));
+    ASSUME_ITS_TRUE(memcmp(output, cascade->exits[0].head->layers[1]->outputs, sizeof(output)) == 0);
+    ASSUME_ITS_TRUE(fossil_jellyfish_cascade_exit_fraction(cascade, 0) == 1);
+    ASSUME_ITS_TRUE(fossil_jellyfish_cascade_flops_saved(cascade) > 0);
+
+    fossil_jellyfish_cascade_free(cascade);
+    fossil_jellyfish_free_network(network);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(cascade_tests) {
+    ADD_TEST(test_cascade_train_without_exits);
+    ADD_TEST(test_cascade_early_exit);
+    ADD_TEST(test_cascade_thresholds);
+}
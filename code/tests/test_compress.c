@@ -0,0 +1,158 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+#include <string.h>
+
+#define COMPRESS_PARAMS 1000
+#define COMPRESS_ROUNDS 20
+
+static void fill_gradient(double* gradient, int32_t round) {
+    for (int32_t i = 0; i < COMPRESS_PARAMS; i++) {
+        gradient[i] = sin(0.37 * i + 1.7 * round) * (1 + i % 7);
+    }
+}
+
+// Sends COMPRESS_ROUNDS gradients and checks that decoded plus residual equals their sum
+static double conservation_error(fossil_jellyfish_compressor_t* compressor, int64_t* largest_message) {
+    double gradient[COMPRESS_PARAMS], sent[COMPRESS_PARAMS] = {0}, total[COMPRESS_PARAMS] = {0};
+    int64_t capacity = fossil_jellyfish_compressed_bound(compressor);
+    uint8_t* message = (uint8_t*)malloc((size_t)capacity);
+    double worst = 0;
+
+    *largest_message = 0;
+    for (int32_t round = 0; round < COMPRESS_ROUNDS; round++) {
+        fill_gradient(gradient, round);
+        for (int32_t i = 0; i < COMPRESS_PARAMS; i++) {
+            total[i] += gradient[i];
+        }
+        int64_t size = fossil_jellyfish_compress(compressor, gradient, message, capacity);
+        if (size < 0 || fossil_jellyfish_decompress_add(message, size, sent, COMPRESS_PARAMS, 1.0) != 0) {
+            free(message);
+            return INFINITY;
+        }
+        *largest_message = size > *largest_message ? size : *largest_message;
+    }
+    for (int32_t i = 0; i < COMPRESS_PARAMS; i++) {
+        worst = fmax(worst, fabs(sent[i] + compressor->residual[i] - total[i]));
+    }
+    free(message);
+    return worst;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for the dense encoding and the reduction of several messages
+FOSSIL_TEST(test_compress_dense_reduce) {
+    fossil_jellyfish_compressor_t* compressor = fossil_jellyfish_compressor_create(COMPRESSION_NONE, COMPRESS_PARAMS, 1.0);
+    double gradient[COMPRESS_PARAMS], reduced[COMPRESS_PARAMS] = {0};
+    int64_t capacity = fossil_jellyfish_compressed_bound(compressor);
+    uint8_t* message = (uint8_t*)malloc((size_t)capacity);
+    fill_gradient(gradient, 0);
+
+    int64_t size = fossil_jellyfish_compress(compressor, gradient, message, capacity);
+    ASSUME_ITS_TRUE(size == capacity);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_decompress_add(message, size, reduced, COMPRESS_PARAMS, 0.5));
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_decompress_add(message, size, reduced, COMPRESS_PARAMS, 0.5));
+    for (int32_t i = 0; i < COMPRESS_PARAMS; i++) {
+        ASSUME_ITS_TRUE(reduced[i] == gradient[i]);
+    }
+
+    // Truncated, mismatched and corrupted messages are rejected
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_decompress_add(message, size - 1, reduced, COMPRESS_PARAMS, 1.0));
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_decompress_add(message, size, reduced, COMPRESS_PARAMS - 1, 1.0));
+    message[0] ^= 0xff;
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_decompress_add(message, size, reduced, COMPRESS_PARAMS, 1.0));
+
+    free(message);
+    fossil_jellyfish_compressor_free(compressor);
+}
+
+// Test case for top-k selection and its error feedback
+FOSSIL_TEST(test_compress_topk) {
+    fossil_jellyfish_compressor_t* compressor = fossil_jellyfish_compressor_create(COMPRESSION_TOPK, COMPRESS_PARAMS, 0.05);
+    double gradient[COMPRESS_PARAMS], decoded[COMPRESS_PARAMS] = {0};
+    int64_t capacity = fossil_jellyfish_compressed_bound(compressor);
+    uint8_t* message = (uint8_t*)malloc((size_t)capacity);
+    ASSUME_ITS_TRUE(compressor->k == 50);
+
+    // The first message carries exactly the 50 largest magnitudes
+    fill_gradient(gradient, 0);
+    int64_t size = fossil_jellyfish_compress(compressor, gradient, message, capacity);
+    ASSUME_ITS_TRUE(size == capacity);
+    fossil_jellyfish_decompress_add(message, size, decoded, COMPRESS_PARAMS, 1.0);
+    double smallest_sent = INFINITY, largest_kept = 0;
+    for (int32_t i = 0; i < COMPRESS_PARAMS; i++) {
+        if (decoded[i] != 0) {
+            smallest_sent = fmin(smallest_sent, fabs(gradient[i]));
+        } else {
+            largest_kept = fmax(largest_kept, fabs(gradient[i]));
+        }
+    }
+    ASSUME_ITS_TRUE(smallest_sent >= largest_kept);
+
+    // An out-of-range index anywhere in the message leaves the gradients untouched
+    double untouched[COMPRESS_PARAMS];
+    uint32_t bad_index = COMPRESS_PARAMS;
+    memcpy(untouched, decoded, sizeof(decoded));
+    memcpy(message + size - 50 * (sizeof(uint32_t) + sizeof(float)) + 49 * sizeof(uint32_t), &bad_index, sizeof(bad_index));
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_decompress_add(message, size, decoded, COMPRESS_PARAMS, 1.0));
+    ASSUME_ITS_TRUE(memcmp(untouched, decoded, sizeof(decoded)) == 0);
+    free(message);
+
+    fossil_jellyfish_compressor_reset(compressor);
+    int64_t largest_message;
+    ASSUME_ITS_TRUE(conservation_error(compressor, &largest_message) < 1e-9);
+    ASSUME_ITS_TRUE(largest_message <= capacity);
+
+    fossil_jellyfish_compressor_free(compressor);
+}
+
+// Test case for 8-bit quantization and its error feedback
+FOSSIL_TEST(test_compress_int8) {
+    fossil_jellyfish_compressor_t* compressor = fossil_jellyfish_compressor_create(COMPRESSION_INT8, COMPRESS_PARAMS, 1.0);
+    double gradient[COMPRESS_PARAMS], decoded[COMPRESS_PARAMS] = {0};
+    int64_t capacity = fossil_jellyfish_compressed_bound(compressor);
+    uint8_t* message = (uint8_t*)malloc((size_t)capacity);
+
+    // One byte per value plus a scale per chunk, with error below half a step of 7/127
+    fill_gradient(gradient, 0);
+    int64_t size = fossil_jellyfish_compress(compressor, gradient, message, capacity);
+    ASSUME_ITS_TRUE(size < COMPRESS_PARAMS * 2);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_decompress_add(message, size, decoded, COMPRESS_PARAMS, 1.0));
+    for (int32_t i = 0; i < COMPRESS_PARAMS; i++) {
+        ASSUME_ITS_TRUE(fabs(decoded[i] - gradient[i]) <= 0.5 * 7.0 / 127.0 + 1e-6);
+    }
+    free(message);
+
+    fossil_jellyfish_compressor_reset(compressor);
+    int64_t largest_message;
+    ASSUME_ITS_TRUE(conservation_error(compressor, &largest_message) < 1e-9);
+
+    fossil_jellyfish_compressor_free(compressor);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(compress_tests) {
+    ADD_TEST(test_compress_dense_reduce);
+    ADD_TEST(test_compress_topk);
+    ADD_TEST(test_compress_int8);
+}
@@ -0,0 +1,94 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_DATASET_FILE "test_dataset_records.dat"
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for saving a dataset, mapping it and scoring its records in place
+FOSSIL_TEST(test_dataset_save_and_open) {
+    int32_t neurons[] = {3, 4, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_LINEAR};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    double inputs[7 * 3], targets[7 * 2], expected[7 * 2], outputs[7 * 2];
+    for (int32_t i = 0; i < 7 * 3; i++) {
+        inputs[i] = cos(0.5 * i);
+    }
+    for (int32_t i = 0; i < 7 * 2; i++) {
+        targets[i] = i;
+    }
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_dataset_save(TEST_DATASET_FILE, inputs, targets, 7, 3, 2));
+
+    fossil_jellyfish_dataset_file_t* dataset = fossil_jellyfish_dataset_open(TEST_DATASET_FILE);
+    ASSUME_NOT_CNULL(dataset);
+    ASSUME_ITS_TRUE(dataset->num_records == 7);
+    ASSUME_ITS_EQUAL_I32(3, dataset->input_width);
+    ASSUME_ITS_EQUAL_I32(2, dataset->target_width);
+    ASSUME_ITS_TRUE(((uintptr_t)dataset->records & 63) == 0);
+    ASSUME_ITS_TRUE(memcmp(&dataset->records[5 * 5], &inputs[5 * 3], 3 * sizeof(double)) == 0);
+    ASSUME_ITS_TRUE(memcmp(&dataset->records[5 * 5 + 3], &targets[5 * 2], 2 * sizeof(double)) == 0);
+
+    fossil_jellyfish_forward_batch(network, inputs, 7, expected);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_forward_strided(network, dataset->records, 5, 7, outputs));
+    ASSUME_ITS_TRUE(memcmp(outputs, expected, sizeof(expected)) == 0);
+
+    fossil_jellyfish_dataset_close(dataset);
+    fossil_jellyfish_free_network(network);
+    remove(TEST_DATASET_FILE);
+}
+
+// Test case for stream headers and truncated files
+FOSSIL_TEST(test_dataset_stream_header) {
+    fossil_jellyfish_dataset_header_t header;
+    double record[4] = {1, 2, 3, 4};
+    FILE* file = fopen(TEST_DATASET_FILE, "wb");
+    ASSUME_NOT_CNULL(file);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_dataset_write_header(file, -1, 4, 0));
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_dataset_write_header(file, -1, 0, 4));
+    fwrite(record, sizeof(record), 1, file);
+    fclose(file);
+
+    file = fopen(TEST_DATASET_FILE, "rb");
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_dataset_read_header(file, &header));
+    ASSUME_ITS_TRUE(header.num_records == -1);
+    ASSUME_ITS_EQUAL_I32(4, header.input_width);
+    ASSUME_ITS_EQUAL_I32(0, header.target_width);
+    fclose(file);
+
+    // Only a file that states its length can be mapped
+    ASSUME_ITS_CNULL(fossil_jellyfish_dataset_open(TEST_DATASET_FILE));
+    file = fopen(TEST_DATASET_FILE, "wb");
+    fossil_jellyfish_dataset_write_header(file, 2, 4, 0);
+    fwrite(record, sizeof(record), 1, file);
+    fclose(file);
+    ASSUME_ITS_CNULL(fossil_jellyfish_dataset_open(TEST_DATASET_FILE));
+    remove(TEST_DATASET_FILE);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(dataset_tests) {
+    ADD_TEST(test_dataset_save_and_open);
+    ADD_TEST(test_dataset_stream_header);
+}
@@ -0,0 +1,110 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+#include <stdio.h>
+
+#define DISTILL_SAMPLES 256
+#define DISTILL_CACHE "test_distill_cache.bin"
+
+static void fill_samples(double* inputs, double* targets) {
+    for (int32_t i = 0; i < DISTILL_SAMPLES; i++) {
+        inputs[i * 2] = sin(0.61 * i);
+        inputs[i * 2 + 1] = cos(1.37 * i);
+        targets[i * 2] = inputs[i * 2] * inputs[i * 2 + 1] > 0;
+        targets[i * 2 + 1] = 1 - targets[i * 2];
+    }
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for the soft target cache file
+FOSSIL_TEST(test_distill_cache_roundtrip) {
+    int32_t neurons[] = {2, 8, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* teacher = fossil_jellyfish_create_network(3, neurons, activations);
+    double inputs[DISTILL_SAMPLES * 2], targets[DISTILL_SAMPLES * 2];
+    fill_samples(inputs, targets);
+
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_distill_cache(teacher, inputs, DISTILL_SAMPLES, 2.0, DISTILL_CACHE));
+    fossil_jellyfish_soft_targets_t* soft = fossil_jellyfish_soft_targets_open(DISTILL_CACHE);
+    ASSUME_NOT_CNULL(soft);
+    ASSUME_ITS_TRUE(soft->num_samples == DISTILL_SAMPLES);
+    ASSUME_ITS_EQUAL_I32(2, soft->width);
+
+    // sigmoid(logit(p) / 2) for every cached value
+    double worst = 0;
+    for (int32_t i = 0; i < DISTILL_SAMPLES; i++) {
+        fossil_jellyfish_forward(teacher, &inputs[i * 2]);
+        for (int32_t c = 0; c < 2; c++) {
+            double p = teacher->layers[2]->outputs[c];
+            worst = fmax(worst, fabs(soft->targets[i * 2 + c] - 1.0 / (1.0 + exp(-0.5 * log(p / (1 - p))))));
+        }
+    }
+    ASSUME_ITS_TRUE(worst < 1e-9);
+
+    // A cache built from other inputs is refused
+    fossil_jellyfish_distill_config_t config = {0.5, 1, 16, 0.1, LOSS_BINARY_CROSS_ENTROPY};
+    inputs[0] += 1;
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_distill(teacher, soft, inputs, targets, &config));
+
+    fossil_jellyfish_soft_targets_close(soft);
+    remove(DISTILL_CACHE);
+    ASSUME_ITS_CNULL(fossil_jellyfish_soft_targets_open(DISTILL_CACHE));
+    fossil_jellyfish_free_network(teacher);
+}
+
+// Test case for a small student learning from a trained teacher
+FOSSIL_TEST(test_distill_student) {
+    int32_t teacher_neurons[] = {2, 32, 32, 2};
+    fossil_jellyfish_activation_t teacher_activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    int32_t student_neurons[] = {2, 8, 2};
+    fossil_jellyfish_activation_t student_activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* teacher = fossil_jellyfish_create_network(4, teacher_neurons, teacher_activations);
+    fossil_jellyfish_network_t* student = fossil_jellyfish_create_network(3, student_neurons, student_activations);
+    double inputs[DISTILL_SAMPLES * 2], targets[DISTILL_SAMPLES * 2];
+    fill_samples(inputs, targets);
+    fossil_jellyfish_train_with_loss(teacher, inputs, targets, DISTILL_SAMPLES, 300, 0.1, LOSS_BINARY_CROSS_ENTROPY);
+
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_distill_cache(teacher, inputs, DISTILL_SAMPLES, 1.5, DISTILL_CACHE));
+    fossil_jellyfish_soft_targets_t* soft = fossil_jellyfish_soft_targets_open(DISTILL_CACHE);
+    fossil_jellyfish_distill_config_t config = {0.7, 400, 8, 0.5, LOSS_BINARY_CROSS_ENTROPY};
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_distill(student, soft, inputs, targets, &config));
+
+    fossil_jellyfish_dataset_t data = {inputs, targets, DISTILL_SAMPLES};
+    fossil_jellyfish_metrics_t teacher_metrics = {0}, student_metrics = {0};
+    teacher_metrics.flags = student_metrics.flags = METRIC_ACCURACY;
+    fossil_jellyfish_evaluate(teacher, &data, &teacher_metrics);
+    fossil_jellyfish_evaluate(student, &data, &student_metrics);
+    ASSUME_ITS_TRUE(teacher_metrics.accuracy > 0.9);
+    ASSUME_ITS_TRUE(student_metrics.accuracy > 0.85);
+
+    fossil_jellyfish_soft_targets_close(soft);
+    remove(DISTILL_CACHE);
+    fossil_jellyfish_free_network(teacher);
+    fossil_jellyfish_free_network(student);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(distill_tests) {
+    ADD_TEST(test_distill_cache_roundtrip);
+    ADD_TEST(test_distill_student);
+}
@@ -0,0 +1,156 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+
+#define EVAL_SAMPLES 1000
+#define EVAL_INPUTS 4
+#define EVAL_CLASSES 3
+
+static void fill_samples(double* inputs, double* targets) {
+    for (int32_t i = 0; i < EVAL_SAMPLES; i++) {
+        for (int32_t k = 0; k < EVAL_INPUTS; k++) {
+            inputs[i * EVAL_INPUTS + k] = sin(0.37 * i + 1.3 * k);
+        }
+        for (int32_t c = 0; c < EVAL_CLASSES; c++) {
+            targets[i * EVAL_CLASSES + c] = (i % EVAL_CLASSES) == c;
+        }
+    }
+}
+
+// Records which thread ran each index; chunks are disjoint, so no two writes collide
+static void bounded_task(void* context, int64_t begin, int64_t end, int32_t thread_index) {
+    int32_t* owners = (int32_t*)context;
+    for (int64_t i = begin; i < end; i++) {
+        owners[i] = thread_index;
+    }
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case comparing the batched forward pass with the per-sample one
+FOSSIL_TEST(test_forward_batch_matches_forward) {
+    int32_t neurons[] = {EVAL_INPUTS, 16, EVAL_CLASSES};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_RELU, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    double* inputs = (double*)malloc(EVAL_SAMPLES * EVAL_INPUTS * sizeof(double));
+    double* targets = (double*)malloc(EVAL_SAMPLES * EVAL_CLASSES * sizeof(double));
+    double* outputs = (double*)malloc(EVAL_SAMPLES * EVAL_CLASSES * sizeof(double));
+    fill_samples(inputs, targets);
+
+    fossil_jellyfish_set_num_threads(3);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_forward_batch(network, inputs, EVAL_SAMPLES, outputs));
+
+    double worst = 0;
+    for (int32_t i = 0; i < EVAL_SAMPLES; i++) {
+        fossil_jellyfish_forward(network, &inputs[i * EVAL_INPUTS]);
+        for (int32_t c = 0; c < EVAL_CLASSES; c++) {
+            worst = fmax(worst, fabs(outputs[i * EVAL_CLASSES + c] - network->layers[2]->outputs[c]));
+        }
+    }
+    ASSUME_ITS_TRUE(worst < 1e-12);
+    fossil_jellyfish_set_num_threads(0);
+
+    free(inputs);
+    free(targets);
+    free(outputs);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case comparing parallel metrics with a serial reference
+FOSSIL_TEST(test_evaluate_metrics) {
+    int32_t neurons[] = {EVAL_INPUTS, 8, EVAL_CLASSES};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_RELU, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    double* inputs = (double*)malloc(EVAL_SAMPLES * EVAL_INPUTS * sizeof(double));
+    double* targets = (double*)malloc(EVAL_SAMPLES * EVAL_CLASSES * sizeof(double));
+    fill_samples(inputs, targets);
+
+    // Serial reference
+    int64_t correct = 0;
+    double sq_sum = 0;
+    for (int32_t i = 0; i < EVAL_SAMPLES; i++) {
+        fossil_jellyfish_forward(network, &inputs[i * EVAL_INPUTS]);
+        double* out = network->layers[2]->outputs;
+        int32_t best = 0;
+        for (int32_t c = 0; c < EVAL_CLASSES; c++) {
+            best = out[c] > out[best] ? c : best;
+            double d = out[c] - targets[i * EVAL_CLASSES + c];
+            sq_sum += d * d;
+        }
+        correct += best == i % EVAL_CLASSES;
+    }
+
+    int64_t confusion[EVAL_CLASSES * EVAL_CLASSES];
+    fossil_jellyfish_dataset_t dataset = {inputs, targets, EVAL_SAMPLES};
+    fossil_jellyfish_metrics_t metrics = {0};
+    metrics.flags = METRIC_LOSS | METRIC_ACCURACY | METRIC_CONFUSION | METRIC_REGRESSION;
+    metrics.loss = LOSS_MSE;
+    metrics.confusion = confusion;
+
+    fossil_jellyfish_set_num_threads(4);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_evaluate(network, &dataset, &metrics));
+    fossil_jellyfish_set_num_threads(0);
+
+    ASSUME_ITS_TRUE(metrics.correct == correct);
+    ASSUME_ITS_EQUAL_I32(EVAL_CLASSES, metrics.num_classes);
+    ASSUME_ITS_TRUE(fabs(metrics.mse - sq_sum / (EVAL_SAMPLES * EVAL_CLASSES)) < 1e-9);
+    ASSUME_ITS_TRUE(fabs(metrics.loss_value - metrics.mse) < 1e-9);
+
+    int64_t diagonal = 0, total = 0;
+    for (int32_t a = 0; a < EVAL_CLASSES; a++) {
+        for (int32_t b = 0; b < EVAL_CLASSES; b++) {
+            total += confusion[a * EVAL_CLASSES + b];
+            diagonal += a == b ? confusion[a * EVAL_CLASSES + b] : 0;
+        }
+    }
+    ASSUME_ITS_TRUE(total == EVAL_SAMPLES);
+    ASSUME_ITS_TRUE(diagonal == correct);
+
+    free(inputs);
+    free(targets);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for a pool larger than the per-thread slots its caller sized
+FOSSIL_TEST(test_parallel_for_bounded) {
+    int32_t owners[EVAL_SAMPLES];
+    for (int32_t i = 0; i < EVAL_SAMPLES; i++) {
+        owners[i] = -1;
+    }
+    fossil_jellyfish_set_num_threads(2);
+    int32_t slots = fossil_jellyfish_get_num_threads();
+    fossil_jellyfish_set_num_threads(6);
+    fossil_jellyfish_parallel_for_bounded(EVAL_SAMPLES, 1, slots, bounded_task, owners);
+    fossil_jellyfish_set_num_threads(0);
+
+    // Every index ran, and only on threads the caller had a slot for
+    for (int32_t i = 0; i < EVAL_SAMPLES; i++) {
+        ASSUME_ITS_TRUE(owners[i] >= 0 && owners[i] < slots);
+    }
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(evaluate_tests) {
+    ADD_TEST(test_forward_batch_matches_forward);
+    ADD_TEST(test_evaluate_metrics);
+    ADD_TEST(test_parallel_for_bounded);
+}
@@ -0,0 +1,133 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+
+// Gives the layer a rank-2 weight matrix
+static void make_rank_two(fossil_jellyfish_layer_t* layer, int32_t fan_in) {
+    for (int32_t j = 0; j < layer->num_neurons; j++) {
+        for (int32_t k = 0; k < fan_in; k++) {
+            layer->weights[j * fan_in + k] = sin(0.3 * j + 1) * cos(0.7 * k) + 0.5 * cos(1.1 * j) * sin(0.2 * k + 2);
+        }
+    }
+}
+
+// Largest output difference of the two networks over a few inputs
+static double max_difference(fossil_jellyfish_network_t* a, fossil_jellyfish_network_t* b) {
+    int32_t inputs = a->layers[0]->num_neurons;
+    int32_t outputs = a->layers[a->num_layers - 1]->num_neurons;
+    double input[64], worst = 0;
+
+    for (int32_t s = 0; s < 8; s++) {
+        for (int32_t k = 0; k < inputs; k++) {
+            input[k] = sin(1.3 * s + 0.4 * k);
+        }
+        fossil_jellyfish_forward(a, input);
+        fossil_jellyfish_forward(b, input);
+        for (int32_t c = 0; c < outputs; c++) {
+            worst = fmax(worst, fabs(a->layers[a->num_layers - 1]->outputs[c] - b->layers[b->num_layers - 1]->outputs[c]));
+        }
+    }
+    return worst;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for exact factorization of low-rank layers, wide and tall
+FOSSIL_TEST(test_factorize_low_rank_exact) {
+    int32_t neurons[] = {24, 40, 16, 3};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_RELU, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(4, neurons, activations);
+    make_rank_two(network->layers[1], 24);
+    make_rank_two(network->layers[2], 40);
+    fossil_jellyfish_network_t* reference = fossil_jellyfish_clone(network);
+
+    fossil_jellyfish_factorize_config_t config = {0};
+    fossil_jellyfish_factorize_report_t report;
+    config.energy = 0.999999;
+
+    // 40 x 24 (tall) then 16 x 40 (wide), which moved to index 3
+    config.layer = 1;
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_factorize_layer(network, &config, &report));
+    ASSUME_ITS_EQUAL_I32(2, report.rank);
+    ASSUME_ITS_TRUE(report.flops_after == report.flops_before - 40 * 24 + 2 * (40 + 24));
+    config.layer = 3;
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_factorize_layer(network, &config, &report));
+    ASSUME_ITS_EQUAL_I32(2, report.rank);
+
+    ASSUME_ITS_EQUAL_I32(6, network->num_layers);
+    ASSUME_ITS_EQUAL_I32(2, network->layers[1]->num_neurons);
+    ASSUME_ITS_TRUE(network->layers[1]->activation == ACTIVATION_LINEAR);
+    ASSUME_ITS_TRUE(network->layers[2]->activation == ACTIVATION_TANH);
+    ASSUME_ITS_TRUE(max_difference(network, reference) < 1e-9);
+    ASSUME_ITS_TRUE(fossil_jellyfish_forward_flops(network) == report.flops_after);
+
+    fossil_jellyfish_free_network(reference);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for the report with validation, fine-tuning and an unprofitable rank
+FOSSIL_TEST(test_factorize_report) {
+    int32_t neurons[] = {4, 32, 1};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    double inputs[64 * 4], targets[64];
+    for (int32_t i = 0; i < 64; i++) {
+        for (int32_t k = 0; k < 4; k++) {
+            inputs[i * 4 + k] = sin(0.9 * i + 1.7 * k);
+        }
+        targets[i] = inputs[i * 4] + inputs[i * 4 + 1] > 0;
+    }
+    fossil_jellyfish_dataset_t data = {inputs, targets, 64};
+    fossil_jellyfish_train_with_loss(network, inputs, targets, 64, 200, 0.5, LOSS_BINARY_CROSS_ENTROPY);
+
+    fossil_jellyfish_factorize_config_t config = {0};
+    fossil_jellyfish_factorize_report_t report;
+    config.layer = 1;
+    config.rank = 4;
+    config.validation = &data;
+    config.loss = LOSS_BINARY_CROSS_ENTROPY;
+
+    // 32 x 4 at rank 4 costs more than the dense layer
+    ASSUME_ITS_EQUAL_I32(1, fossil_jellyfish_factorize_layer(network, &config, &report));
+    ASSUME_ITS_EQUAL_I32(3, network->num_layers);
+    ASSUME_ITS_TRUE(report.flops_after == report.flops_before);
+
+    // A rank-1 hidden layer loses a little accuracy that fine-tuning wins back
+    config.rank = 1;
+    config.fine_tune = &data;
+    config.fine_tune_epochs = 100;
+    config.learning_rate = 0.1;
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_factorize_layer(network, &config, &report));
+    ASSUME_ITS_EQUAL_I32(4, network->num_layers);
+    ASSUME_ITS_TRUE(report.energy_kept < 1);
+    ASSUME_ITS_TRUE(report.flops_after < report.flops_before);
+    ASSUME_ITS_TRUE(report.accuracy_before > 0.9);
+    ASSUME_ITS_TRUE(report.loss_tuned <= report.loss_factored);
+
+    fossil_jellyfish_free_network(network);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(factorize_tests) {
+    ADD_TEST(test_factorize_low_rank_exact);
+    ADD_TEST(test_factorize_report);
+}
@@ -0,0 +1,162 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for the chain network as a special case of the graph
+FOSSIL_TEST(test_graph_from_network) {
+    int32_t neurons[] = {4, 6, 5, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_RELU, ACTIVATION_RELU, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(4, neurons, activations);
+    fossil_jellyfish_graph_t* graph = fossil_jellyfish_graph_from_network(network);
+    double input[4] = {0.1, -0.4, 0.8, 0.3};
+    double output[2];
+    ASSUME_NOT_CNULL(graph);
+
+    fossil_jellyfish_forward(network, input);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_graph_forward(graph, input, output));
+    ASSUME_ITS_TRUE(fabs(output[0] - network->layers[3]->outputs[0]) < 1e-12);
+    ASSUME_ITS_TRUE(fabs(output[1] - network->layers[3]->outputs[1]) < 1e-12);
+
+    // A chain never needs more than two live buffers
+    ASSUME_ITS_TRUE(graph->num_buffers <= 2);
+
+    fossil_jellyfish_graph_free(graph);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for graph training through a network with snapshots and packed weights
+FOSSIL_TEST(test_graph_trains_network) {
+    int32_t neurons[] = {3, 8, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    fossil_jellyfish_graph_t* graph = fossil_jellyfish_graph_from_network(network);
+    double input[3] = {0.4, -0.2, 0.9};
+    double target[2] = {1.0, 0.0};
+    double output[2];
+    ASSUME_NOT_CNULL(graph);
+
+    // The snapshot keeps its weights while the graph trains the network
+    fossil_jellyfish_network_t* snapshot = fossil_jellyfish_snapshot(network);
+    double* frozen = snapshot->layers[1]->weights;
+    double before = frozen[0];
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_graph_train_step(graph, input, target, 0.5, LOSS_MSE));
+    ASSUME_ITS_TRUE(snapshot->layers[1]->weights == frozen && frozen[0] == before);
+    ASSUME_ITS_TRUE(network->layers[1]->weights != frozen && network->layers[1]->weights[0] != before);
+
+    // Packing after the conversion never serves weights the graph has since changed
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_pack_weights(network));
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_graph_train_step(graph, input, target, 0.5, LOSS_MSE));
+    ASSUME_ITS_TRUE(network->layers[1]->packed == NULL);
+    fossil_jellyfish_forward(network, input);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_graph_forward(graph, input, output));
+    ASSUME_ITS_TRUE(fabs(output[0] - network->layers[2]->outputs[0]) < 1e-12);
+    ASSUME_ITS_TRUE(fabs(output[1] - network->layers[2]->outputs[1]) < 1e-12);
+
+    fossil_jellyfish_graph_free(graph);
+    fossil_jellyfish_free_network(snapshot);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for parallel branches merged by sum and concat nodes
+FOSSIL_TEST(test_graph_branches) {
+    fossil_jellyfish_graph_t* graph = fossil_jellyfish_graph_create();
+    int32_t in = fossil_jellyfish_graph_add_input(graph, 3);
+    int32_t a = fossil_jellyfish_graph_add_dense(graph, in, 4, ACTIVATION_TANH);
+    int32_t b = fossil_jellyfish_graph_add_dense(graph, in, 4, ACTIVATION_RELU);
+    int32_t branches[] = {a, b};
+    int32_t sum = fossil_jellyfish_graph_add_sum(graph, branches, 2, ACTIVATION_LINEAR);
+    int32_t parts[] = {sum, in};
+    int32_t concat = fossil_jellyfish_graph_add_concat(graph, parts, 2);
+    int32_t out = fossil_jellyfish_graph_add_dense(graph, concat, 1, ACTIVATION_LINEAR);
+    double input[3] = {0.5, -1.0, 0.25};
+    double output;
+
+    ASSUME_ITS_EQUAL_I32(7, graph->nodes[concat].width);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_graph_compile(graph));
+    ASSUME_ITS_EQUAL_I32(graph->nodes[a].level, graph->nodes[b].level);
+    ASSUME_ITS_TRUE(fossil_jellyfish_graph_add_sum(graph, parts, 2, ACTIVATION_LINEAR) < 0);
+
+    // Reference computed by hand from the node parameters
+    double ya[4], yb[4], merged[7], expected = graph->nodes[out].biases[0];
+    for (int32_t j = 0; j < 4; j++) {
+        double za = graph->nodes[a].biases[j], zb = graph->nodes[b].biases[j];
+        for (int32_t k = 0; k < 3; k++) {
+            za += graph->nodes[a].weights[j * 3 + k] * input[k];
+            zb += graph->nodes[b].weights[j * 3 + k] * input[k];
+        }
+        ya[j] = tanh(za);
+        yb[j] = zb > 0 ? zb : 0;
+        merged[j] = ya[j] + yb[j];
+    }
+    merged[4] = input[0];
+    merged[5] = input[1];
+    merged[6] = input[2];
+    for (int32_t k = 0; k < 7; k++) {
+        expected += graph->nodes[out].weights[k] * merged[k];
+    }
+
+    fossil_jellyfish_set_num_threads(2);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_graph_forward(graph, input, &output));
+    fossil_jellyfish_set_num_threads(0);
+    ASSUME_ITS_TRUE(fabs(output - expected) < 1e-12);
+
+    fossil_jellyfish_graph_free(graph);
+}
+
+// Test case for training a residual graph
+FOSSIL_TEST(test_graph_train_residual) {
+    fossil_jellyfish_graph_t* graph = fossil_jellyfish_graph_create();
+    int32_t in = fossil_jellyfish_graph_add_input(graph, 2);
+    int32_t hidden = fossil_jellyfish_graph_add_dense(graph, in, 8, ACTIVATION_TANH);
+    int32_t inner = fossil_jellyfish_graph_add_dense(graph, hidden, 8, ACTIVATION_TANH);
+    int32_t skip[] = {hidden, inner};
+    int32_t residual = fossil_jellyfish_graph_add_sum(graph, skip, 2, ACTIVATION_LINEAR);
+    fossil_jellyfish_graph_add_dense(graph, residual, 1, ACTIVATION_SIGMOID);
+
+    double inputs[] = {0, 0, 0, 1, 1, 0, 1, 1};
+    double targets[] = {0, 1, 1, 0};
+    double before = 0, after = 0, output;
+
+    for (int32_t i = 0; i < 4; i++) {
+        fossil_jellyfish_graph_forward(graph, &inputs[i * 2], &output);
+        before += (output - targets[i]) * (output - targets[i]);
+    }
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_graph_train(graph, inputs, targets, 4, 2000, 0.5, LOSS_MSE));
+    for (int32_t i = 0; i < 4; i++) {
+        fossil_jellyfish_graph_forward(graph, &inputs[i * 2], &output);
+        after += (output - targets[i]) * (output - targets[i]);
+    }
+    ASSUME_ITS_TRUE(after < before);
+    ASSUME_ITS_TRUE(after < 0.05);
+
+    fossil_jellyfish_graph_free(graph);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(graph_tests) {
+    ADD_TEST(test_graph_from_network);
+    ADD_TEST(test_graph_trains_network);
+    ADD_TEST(test_graph_branches);
+    ADD_TEST(test_graph_train_residual);
+}
@@ -0,0 +1,123 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+
+#define TEST_HASHED_FILE "test_hashed_network.dat"
+
+// Mean squared error of the network over 64 single-output samples
+static double mse(fossil_jellyfish_network_t* network, const double* inputs, const double* targets) {
+    double outputs[64];
+    fossil_jellyfish_forward_batch(network, inputs, 64, outputs);
+    return fossil_jellyfish_loss(LOSS_MSE, outputs, targets, 64, 1);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for the forward pass reading the virtual weight matrix
+FOSSIL_TEST(test_hashed_forward_matches_weights) {
+    int32_t neurons[] = {12, 20, 3};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_LINEAR, ACTIVATION_LINEAR};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_hash_layer(network, 1, 24, 7));
+    ASSUME_ITS_TRUE(network->layers[1]->kind == LAYER_HASHED);
+    ASSUME_ITS_TRUE(fossil_jellyfish_num_parameters(network) == 24 + 20 + 20 * 3 + 3);
+
+    double inputs[4 * 12], batch[4 * 3];
+    for (int32_t i = 0; i < 4 * 12; i++) {
+        inputs[i] = sin(0.37 * i + 0.5);
+    }
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_forward_batch(network, inputs, 4, batch));
+
+    for (int32_t s = 0; s < 4; s++) {
+        fossil_jellyfish_forward(network, &inputs[s * 12]);
+        for (int32_t j = 0; j < 20; j++) {
+            double sum = network->layers[1]->biases[j];
+            for (int32_t k = 0; k < 12; k++) {
+                sum += fossil_jellyfish_layer_weight(network, 1, j, k) * inputs[s * 12 + k];
+            }
+            ASSUME_ITS_TRUE(fabs(network->layers[1]->outputs[j] - sum) < 1e-12);
+        }
+        for (int32_t c = 0; c < 3; c++) {
+            ASSUME_ITS_TRUE(fabs(network->layers[2]->outputs[c] - batch[s * 3 + c]) < 1e-12);
+        }
+    }
+
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for training a hashed layer ten times smaller than its matrix
+FOSSIL_TEST(test_hashed_training) {
+    int32_t neurons[] = {8, 64, 1};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_LINEAR};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_hash_layer(network, 1, 51, 3));
+    fossil_jellyfish_init_layer(network, 1, INIT_AUTO, 11);
+
+    double inputs[64 * 8], targets[64];
+    for (int32_t i = 0; i < 64; i++) {
+        for (int32_t k = 0; k < 8; k++) {
+            inputs[i * 8 + k] = sin(0.9 * i + 1.7 * k);
+        }
+        targets[i] = 0.5 * inputs[i * 8] - 0.3 * inputs[i * 8 + 3] + 0.2 * inputs[i * 8 + 6];
+    }
+
+    double before = mse(network, inputs, targets);
+    fossil_jellyfish_train_with_loss(network, inputs, targets, 64, 200, 0.02, LOSS_MSE);
+    double after = mse(network, inputs, targets);
+    ASSUME_ITS_TRUE(after < before);
+    ASSUME_ITS_TRUE(after < 0.01);
+
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for saving and loading a network with a hashed layer
+FOSSIL_TEST(test_hashed_save_load) {
+    int32_t neurons[] = {6, 16, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_RELU, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_hash_layer(network, 1, 10, 42));
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_save(network, TEST_HASHED_FILE));
+
+    fossil_jellyfish_network_t* loaded = fossil_jellyfish_load(TEST_HASHED_FILE);
+    ASSUME_NOT_CNULL(loaded);
+    ASSUME_ITS_TRUE(loaded->layers[1]->kind == LAYER_HASHED);
+    ASSUME_ITS_TRUE(loaded->layers[1]->num_params == 10);
+    ASSUME_ITS_TRUE(loaded->layers[1]->hash_seed == 42);
+
+    double input[6] = {0.1, -0.4, 0.9, 0.3, -0.2, 0.7};
+    fossil_jellyfish_forward(network, input);
+    fossil_jellyfish_forward(loaded, input);
+    for (int32_t c = 0; c < 2; c++) {
+        ASSUME_ITS_TRUE(network->layers[2]->outputs[c] == loaded->layers[2]->outputs[c]);
+    }
+
+    remove(TEST_HASHED_FILE);
+    fossil_jellyfish_free_network(loaded);
+    fossil_jellyfish_free_network(network);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(hashed_tests) {
+    ADD_TEST(test_hashed_forward_matches_weights);
+    ADD_TEST(test_hashed_training);
+    ADD_TEST(test_hashed_save_load);
+}
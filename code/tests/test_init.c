@@ -0,0 +1,119 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for reproducibility across seeds and thread counts
+FOSSIL_TEST(test_init_reproducible) {
+    int32_t neurons[] = {300, 400};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_RELU, ACTIVATION_RELU};
+    fossil_jellyfish_network_t* a = fossil_jellyfish_create_network(2, neurons, activations);
+    fossil_jellyfish_network_t* b = fossil_jellyfish_create_network(2, neurons, activations);
+    size_t bytes = (size_t)(300 * 400) * sizeof(double);
+
+    fossil_jellyfish_set_num_threads(1);
+    fossil_jellyfish_init_network(a, INIT_HE_NORMAL, 42);
+    fossil_jellyfish_set_num_threads(4);
+    fossil_jellyfish_init_network(b, INIT_HE_NORMAL, 42);
+    ASSUME_ITS_TRUE(memcmp(a->layers[1]->weights, b->layers[1]->weights, bytes) == 0);
+
+    fossil_jellyfish_init_network(b, INIT_HE_NORMAL, 43);
+    ASSUME_ITS_TRUE(memcmp(a->layers[1]->weights, b->layers[1]->weights, bytes) != 0);
+    fossil_jellyfish_set_num_threads(0);
+
+    fossil_jellyfish_free_network(a);
+    fossil_jellyfish_free_network(b);
+}
+
+// Test case for the range and spread of the Xavier and He schemes
+FOSSIL_TEST(test_init_scale) {
+    int32_t neurons[] = {200, 100};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_TANH, ACTIVATION_TANH};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(2, neurons, activations);
+    fossil_jellyfish_layer_t* layer = network->layers[1];
+    int32_t count = 200 * 100;
+
+    // Default initialization is Xavier uniform for tanh layers
+    double limit = sqrt(6.0 / 300.0);
+    int32_t in_range = 1;
+    for (int32_t i = 0; i < count; i++) {
+        in_range &= fabs(layer->weights[i]) <= limit;
+    }
+    ASSUME_ITS_TRUE(in_range);
+    ASSUME_ITS_TRUE(layer->biases[0] == 0.0 && layer->biases[99] == 0.0);
+
+    fossil_jellyfish_init_network(network, INIT_HE_NORMAL, 7);
+    double sum_sq = 0;
+    for (int32_t i = 0; i < count; i++) {
+        sum_sq += layer->weights[i] * layer->weights[i];
+    }
+    ASSUME_ITS_TRUE(fabs(sum_sq / count - 2.0 / 200.0) < 0.1 * (2.0 / 200.0));
+
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for orthonormal rows and columns of the orthogonal scheme
+FOSSIL_TEST(test_init_orthogonal) {
+    int32_t neurons[] = {8, 5, 12};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_TANH, ACTIVATION_TANH, ACTIVATION_TANH};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    fossil_jellyfish_init_network(network, INIT_ORTHOGONAL, 3);
+
+    // Layer 1 is 5 x 8: rows are orthonormal
+    double* w = network->layers[1]->weights;
+    double worst = 0;
+    for (int32_t a = 0; a < 5; a++) {
+        for (int32_t b = 0; b < 5; b++) {
+            double dot = 0;
+            for (int32_t k = 0; k < 8; k++) {
+                dot += w[a * 8 + k] * w[b * 8 + k];
+            }
+            worst = fmax(worst, fabs(dot - (a == b ? 1.0 : 0.0)));
+        }
+    }
+    ASSUME_ITS_TRUE(worst < 1e-9);
+
+    // Layer 2 is 12 x 5: columns are orthonormal
+    w = network->layers[2]->weights;
+    worst = 0;
+    for (int32_t a = 0; a < 5; a++) {
+        for (int32_t b = 0; b < 5; b++) {
+            double dot = 0;
+            for (int32_t j = 0; j < 12; j++) {
+                dot += w[j * 5 + a] * w[j * 5 + b];
+            }
+            worst = fmax(worst, fabs(dot - (a == b ? 1.0 : 0.0)));
+        }
+    }
+    ASSUME_ITS_TRUE(worst < 1e-9);
+
+    fossil_jellyfish_free_network(network);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(init_tests) {
+    ADD_TEST(test_init_reproducible);
+    ADD_TEST(test_init_scale);
+    ADD_TEST(test_init_orthogonal);
+}
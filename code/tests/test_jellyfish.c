@@ -15,6 +15,7 @@
 #include <fossil/unittest/assume.h>
 
 #include "fossil/jellyfish/framework.h"
+#include <string.h>
 
 #define TEST_FILE "test_network.fish"
 #define NUM_LAYERS 2
@@ -28,11 +29,13 @@
 // Test case for creating a neural network
 FOSSIL_TEST(test_create_network) {
     fossil_jellyfish_network_t* network = (fossil_jellyfish_network_t*)malloc(sizeof(fossil_jellyfish_network_t));
+    fossil_jellyfish_network_init(network);
     network->num_layers = NUM_LAYERS;
     network->layers = (fossil_jellyfish_layer_t**)malloc(NUM_LAYERS * sizeof(fossil_jellyfish_layer_t*));
 
     // Create Layer 1
     network->layers[0] = (fossil_jellyfish_layer_t*)malloc(sizeof(fossil_jellyfish_layer_t));
+    fossil_jellyfish_layer_init(network->layers[0]);
     network->layers[0]->num_neurons = NUM_NEURONS_LAYER1;
     network->layers[0]->weights = (double*)malloc(NUM_NEURONS_LAYER1 * NUM_NEURONS_LAYER2 * sizeof(double));
     network->layers[0]->biases = (double*)malloc(NUM_NEURONS_LAYER1 * sizeof(double));
@@ -41,6 +44,7 @@ FOSSIL_TEST(test_create_network) {
 
     // Create Layer 2
     network->layers[1] = (fossil_jellyfish_layer_t*)malloc(sizeof(fossil_jellyfish_layer_t));
+    fossil_jellyfish_layer_init(network->layers[1]);
     network->layers[1]->num_neurons = NUM_NEURONS_LAYER2;
     network->layers[1]->weights = (double*)malloc(NUM_NEURONS_LAYER2 * NUM_NEURONS_LAYER1 * sizeof(double));
     network->layers[1]->biases = (double*)malloc(NUM_NEURONS_LAYER2 * sizeof(double));
@@ -57,11 +61,13 @@ FOSSIL_TEST(test_create_network) {
 // Test case for saving a neural network
 FOSSIL_TEST(test_save_network) {
     fossil_jellyfish_network_t* network = (fossil_jellyfish_network_t*)malloc(sizeof(fossil_jellyfish_network_t));
+    fossil_jellyfish_network_init(network);
     network->num_layers = NUM_LAYERS;
     network->layers = (fossil_jellyfish_layer_t**)malloc(NUM_LAYERS * sizeof(fossil_jellyfish_layer_t*));
 
     // Layer 1
     network->layers[0] = (fossil_jellyfish_layer_t*)malloc(sizeof(fossil_jellyfish_layer_t));
+    fossil_jellyfish_layer_init(network->layers[0]);
     network->layers[0]->num_neurons = NUM_NEURONS_LAYER1;
     network->layers[0]->weights = (double*)malloc(NUM_NEURONS_LAYER1 * NUM_NEURONS_LAYER2 * sizeof(double));
     network->layers[0]->biases = (double*)malloc(NUM_NEURONS_LAYER1 * sizeof(double));
@@ -70,6 +76,7 @@ FOSSIL_TEST(test_save_network) {
 
     // Layer 2
     network->layers[1] = (fossil_jellyfish_layer_t*)malloc(sizeof(fossil_jellyfish_layer_t));
+    fossil_jellyfish_layer_init(network->layers[1]);
     network->layers[1]->num_neurons = NUM_NEURONS_LAYER2;
     network->layers[1]->weights = (double*)malloc(NUM_NEURONS_LAYER2 * NUM_NEURONS_LAYER1 * sizeof(double));
     network->layers[1]->biases = (double*)malloc(NUM_NEURONS_LAYER2 * sizeof(double));
@@ -118,6 +125,143 @@ FOSSIL_TEST(test_load_network) {
     fossil_jellyfish_free_network(network);
 }
 
+// Test case for deep copies of a network
+FOSSIL_TEST(test_clone_network) {
+    int32_t neurons[] = {NUM_NEURONS_LAYER1, NUM_NEURONS_LAYER2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_RELU, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(NUM_LAYERS, neurons, activations);
+    fossil_jellyfish_network_t* clone = fossil_jellyfish_clone(network);
+    ASSUME_NOT_CNULL(clone);
+    ASSUME_ITS_EQUAL_I32(NUM_LAYERS, clone->num_layers);
+    ASSUME_ITS_TRUE(clone->layers[1]->weights != network->layers[1]->weights);
+    ASSUME_ITS_TRUE(clone->layers[1]->weights[0] == network->layers[1]->weights[0]);
+
+    clone->layers[1]->weights[0] += 1.0;
+    ASSUME_ITS_TRUE(clone->layers[1]->weights[0] != network->layers[1]->weights[0]);
+
+    fossil_jellyfish_free_network(network);
+    fossil_jellyfish_free_network(clone);
+}
+
+// Test case for copy-on-write snapshots
+FOSSIL_TEST(test_snapshot_network) {
+    int32_t neurons[] = {NUM_NEURONS_LAYER1, NUM_NEURONS_LAYER2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_RELU, ACTIVATION_SIGMOID};
+    double input[NUM_NEURONS_LAYER1] = {0.5, -0.25, 1.0};
+    double target[NUM_NEURONS_LAYER2] = {1.0, 0.0};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(NUM_LAYERS, neurons, activations);
+
+    fossil_jellyfish_network_t* snapshot = fossil_jellyfish_snapshot(network);
+    ASSUME_NOT_CNULL(snapshot);
+    ASSUME_ITS_TRUE(snapshot->layers[1]->weights == network->layers[1]->weights);
+
+    // Training the original detaches it and leaves the snapshot untouched
+    double before = snapshot->layers[1]->weights[0];
+    fossil_jellyfish_forward(network, input);
+    fossil_jellyfish_backpropagate(network, target, 0.5);
+    ASSUME_ITS_TRUE(snapshot->layers[1]->weights != network->layers[1]->weights);
+    ASSUME_ITS_TRUE(snapshot->layers[1]->weights[0] == before);
+    ASSUME_ITS_TRUE(network->layers[1]->weights[0] != before);
+
+    // Freeing the original first keeps the snapshot usable
+    fossil_jellyfish_free_network(network);
+    fossil_jellyfish_forward(snapshot, input);
+    ASSUME_ITS_TRUE(snapshot->layers[1]->outputs[0] > 0.0);
+    fossil_jellyfish_free_network(snapshot);
+}
+
+// Test case for every activation's backward pass against finite differences
+FOSSIL_TEST(test_activation_backward) {
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_RELU, ACTIVATION_SIGMOID, ACTIVATION_TANH, ACTIVATION_LEAKY_RELU,
+                                                   ACTIVATION_SOFTMAX, ACTIVATION_ELU, ACTIVATION_LINEAR};
+    double inputs[5] = {-1.3, -0.2, 0.4, 1.1, 2.5};
+    double weights[5] = {0.7, -0.5, 0.3, 1.2, -0.9};   // Loss = sum(weights * outputs)
+
+    for (int32_t a = 0; a < 7; a++) {
+        double outputs[5], gradients[5];
+        memcpy(outputs, inputs, sizeof(outputs));
+        memcpy(gradients, weights, sizeof(gradients));
+        fossil_jellyfish_activate_vector(outputs, 5, activations[a]);
+        fossil_jellyfish_activation_backward(outputs, gradients, 5, activations[a]);
+
+        for (int32_t i = 0; i < 5; i++) {
+            double up[5], down[5], numeric = 0;
+            memcpy(up, inputs, sizeof(up));
+            memcpy(down, inputs, sizeof(down));
+            up[i] += 1e-6;
+            down[i] -= 1e-6;
+            fossil_jellyfish_activate_vector(up, 5, activations[a]);
+            fossil_jellyfish_activate_vector(down, 5, activations[a]);
+            for (int32_t k = 0; k < 5; k++) {
+                numeric += weights[k] * (up[k] - down[k]) / 2e-6;
+            }
+            ASSUME_ITS_TRUE(fabs(numeric - gradients[i]) < 1e-6);
+        }
+    }
+}
+
+// Test case for training through softmax, leaky ReLU and ELU layers
+FOSSIL_TEST(test_train_softmax_classifier) {
+    int32_t neurons[] = {2, 12, 8, 3};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_LEAKY_RELU, ACTIVATION_ELU, ACTIVATION_SOFTMAX};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(4, neurons, activations);
+    double inputs[90 * 2], targets[90 * 3], outputs[90 * 3];
+
+    // Three clusters, one per class
+    for (int32_t i = 0; i < 90; i++) {
+        int32_t c = i % 3;
+        inputs[i * 2] = cos(2.1 * c) + 0.3 * sin(1.7 * i);
+        inputs[i * 2 + 1] = sin(2.1 * c) + 0.3 * cos(1.3 * i);
+        for (int32_t k = 0; k < 3; k++) {
+            targets[i * 3 + k] = k == c;
+        }
+    }
+
+    fossil_jellyfish_forward_batch(network, inputs, 90, outputs);
+    double before = fossil_jellyfish_loss(LOSS_CATEGORICAL_CROSS_ENTROPY, outputs, targets, 90, 3);
+    fossil_jellyfish_train_with_loss(network, inputs, targets, 90, 50, 0.05, LOSS_CATEGORICAL_CROSS_ENTROPY);
+    fossil_jellyfish_forward_batch(network, inputs, 90, outputs);
+    double after = fossil_jellyfish_loss(LOSS_CATEGORICAL_CROSS_ENTROPY, outputs, targets, 90, 3);
+
+    ASSUME_ITS_TRUE(fabs(outputs[0] + outputs[1] + outputs[2] - 1) < 1e-12);
+    ASSUME_ITS_TRUE(after < 0.5 * before);
+
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for forward passes reading inputs in place from larger records
+FOSSIL_TEST(test_forward_in_place) {
+    int32_t neurons[] = {3, 6, 4, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_RELU, ACTIVATION_SOFTMAX};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(4, neurons, activations);
+    fossil_jellyfish_hash_layer(network, 2, 10, 3);
+    double records[10 * 5], rows[10 * 3], expected[10 * 2], outputs[10 * 2];
+
+    // Each record holds an id, the three features and a label
+    for (int32_t r = 0; r < 10; r++) {
+        records[r * 5] = r;
+        for (int32_t k = 0; k < 3; k++) {
+            records[r * 5 + 1 + k] = rows[r * 3 + k] = sin(0.7 * (r * 3 + k));
+        }
+        records[r * 5 + 4] = r % 2;
+    }
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_forward_batch(network, rows, 10, expected));
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_forward_strided(network, records + 1, 5, 10, outputs));
+    ASSUME_ITS_TRUE(memcmp(outputs, expected, sizeof(expected)) == 0);
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_forward_strided(network, records + 1, 2, 10, outputs));
+
+    // The input layer's buffer is never written
+    double* input_buffer = network->layers[0]->outputs;
+    input_buffer[0] = input_buffer[1] = input_buffer[2] = -7;
+    for (int32_t r = 0; r < 10; r++) {
+        fossil_jellyfish_forward_into(network, records + r * 5 + 1, &outputs[r * 2]);
+    }
+    ASSUME_ITS_TRUE(memcmp(outputs, expected, sizeof(expected)) == 0);
+    ASSUME_ITS_TRUE(input_buffer[0] == -7 && input_buffer[1] == -7 && input_buffer[2] == -7);
+
+    fossil_jellyfish_free_network(network);
+}
+
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Pool
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -126,4 +270,9 @@ FOSSIL_TEST_GROUP(jellyfish_tests) {
     ADD_TEST(test_create_network);
     ADD_TEST(test_save_network);
     ADD_TEST(test_load_network);
+    ADD_TEST(test_clone_network);
+    ADD_TEST(test_snapshot_network);
+    ADD_TEST(test_activation_backward);
+    ADD_TEST(test_train_softmax_classifier);
+    ADD_TEST(test_forward_in_place);
 }
@@ -0,0 +1,126 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Odd widths leave half-filled register pairs; 11 neurons span several tiles
+static fossil_jellyfish_network_t* make_jit_network(void) {
+    int32_t neurons[] = {5, 11, 7, 9, 3};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_RELU, ACTIVATION_TANH, ACTIVATION_LINEAR, ACTIVATION_SOFTMAX};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(5, neurons, activations);
+    fossil_jellyfish_hash_layer(network, 3, 20, 7);
+    fossil_jellyfish_init_layer(network, 3, INIT_XAVIER_UNIFORM, 11);
+    return network;
+}
+
+static void make_inputs(double* inputs, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        inputs[i] = sin(0.37 * i) * 2;
+    }
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for the compiled forward pass matching the network bit for bit
+FOSSIL_TEST(test_jit_forward_matches_network) {
+    fossil_jellyfish_network_t* network = make_jit_network();
+    double means[5] = {0.1, -0.2, 0.3, 0, 0.5}, deviations[5] = {2, 0.5, 1, 3, 0};
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_set_normalization(network, means, deviations));
+    double inputs[20 * 5], expected[20 * 3], outputs[20 * 3];
+    make_inputs(inputs, 20 * 5);
+
+    fossil_jellyfish_jit_t* jit = fossil_jellyfish_jit_compile(network);
+    ASSUME_NOT_CNULL(jit);
+#if defined(__x86_64__) || defined(_M_X64)
+    ASSUME_NOT_CNULL(jit->code);
+#endif
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_forward_batch(network, inputs, 20, expected));
+    for (int32_t r = 0; r < 20; r++) {
+        ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_jit_forward(jit, &inputs[r * 5], &outputs[r * 3]));
+    }
+    ASSUME_ITS_TRUE(memcmp(outputs, expected, sizeof(expected)) == 0);
+
+    fossil_jellyfish_jit_free(jit);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for refreshing the JIT after training and rejecting a changed network
+FOSSIL_TEST(test_jit_refresh) {
+    fossil_jellyfish_network_t* network = make_jit_network();
+    double inputs[4 * 5], targets[4 * 3] = {1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0};
+    double before[3], after[3], expected[3];
+    make_inputs(inputs, 4 * 5);
+
+    fossil_jellyfish_jit_t* jit = fossil_jellyfish_jit_compile(network);
+    ASSUME_NOT_CNULL(jit);
+    fossil_jellyfish_jit_forward(jit, inputs, before);
+    fossil_jellyfish_train(network, inputs, targets, 4, 5, 0.1);
+
+    // The copied weights only change on refresh
+    fossil_jellyfish_jit_forward(jit, inputs, after);
+    ASSUME_ITS_TRUE(memcmp(before, after, sizeof(before)) == 0);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_jit_refresh(jit));
+    fossil_jellyfish_jit_forward(jit, inputs, after);
+    fossil_jellyfish_forward_batch(network, inputs, 1, expected);
+    ASSUME_ITS_TRUE(memcmp(before, after, sizeof(before)) != 0);
+    ASSUME_ITS_TRUE(memcmp(after, expected, sizeof(expected)) == 0);
+
+    // A changed activation keeps the data size but not the code
+    fossil_jellyfish_activation_t activation = network->layers[1]->activation;
+    network->layers[1]->activation = activation == ACTIVATION_TANH ? ACTIVATION_RELU : ACTIVATION_TANH;
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_jit_refresh(jit));
+    network->layers[1]->activation = activation;
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_jit_refresh(jit));
+
+    // Turning normalization on changes the code, not just the data
+    double means[5] = {0}, deviations[5] = {1, 1, 1, 1, 1};
+    fossil_jellyfish_set_normalization(network, means, deviations);
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_jit_refresh(jit));
+
+    fossil_jellyfish_jit_free(jit);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for networks without any computing layer
+FOSSIL_TEST(test_jit_input_only_network) {
+    int32_t neurons[] = {4};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(1, neurons, activations);
+    double input[4] = {1, -2, 3, -4}, output[4];
+
+    fossil_jellyfish_jit_t* jit = fossil_jellyfish_jit_compile(network);
+    ASSUME_NOT_CNULL(jit);
+    ASSUME_ITS_CNULL(jit->code);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_jit_forward(jit, input, output));
+    ASSUME_ITS_TRUE(memcmp(input, output, sizeof(input)) == 0);
+
+    fossil_jellyfish_jit_free(jit);
+    fossil_jellyfish_free_network(network);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(jit_tests) {
+    ADD_TEST(test_jit_forward_matches_network);
+    ADD_TEST(test_jit_refresh);
+    ADD_TEST(test_jit_input_only_network);
+}
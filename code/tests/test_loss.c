@@ -0,0 +1,88 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+
+#define LOSS_TOLERANCE 1e-9
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for the element-wise regression losses
+FOSSIL_TEST(test_loss_regression_values) {
+    double predicted[] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0};
+    double expected[]  = {1.5, 2.0, 0.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0};
+
+    // Differences are 0.5 and 3.0, everything else matches
+    ASSUME_ITS_TRUE(fabs(fossil_jellyfish_loss(LOSS_MSE, predicted, expected, 2, 5) - (0.25 + 9.0) / 10.0) < LOSS_TOLERANCE);
+    ASSUME_ITS_TRUE(fabs(fossil_jellyfish_loss(LOSS_MAE, predicted, expected, 2, 5) - (0.5 + 3.0) / 10.0) < LOSS_TOLERANCE);
+    ASSUME_ITS_TRUE(fabs(fossil_jellyfish_loss(LOSS_HUBER, predicted, expected, 2, 5) - (0.125 + 2.5) / 10.0) < LOSS_TOLERANCE);
+    ASSUME_ITS_TRUE(fabs(fossil_jellyfish_loss(LOSS_MSE, predicted, expected, 0, 5)) < LOSS_TOLERANCE);
+}
+
+// Test case for the cross-entropy losses
+FOSSIL_TEST(test_loss_cross_entropy_values) {
+    double predicted[] = {0.7, 0.2, 0.1, 0.1, 0.8, 0.1};
+    double expected[]  = {1.0, 0.0, 0.0, 0.0, 1.0, 0.0};
+
+    double categorical = fossil_jellyfish_loss(LOSS_CATEGORICAL_CROSS_ENTROPY, predicted, expected, 2, 3);
+    ASSUME_ITS_TRUE(fabs(categorical - (-(log(0.7) + log(0.8)) / 2.0)) < LOSS_TOLERANCE);
+
+    double p[] = {0.9, 0.2};
+    double t[] = {1.0, 0.0};
+    double binary = fossil_jellyfish_loss(LOSS_BINARY_CROSS_ENTROPY, p, t, 2, 1);
+    ASSUME_ITS_TRUE(fabs(binary - (-(log(0.9) + log(0.8)) / 2.0)) < LOSS_TOLERANCE);
+}
+
+// Test case comparing every gradient kernel against finite differences
+FOSSIL_TEST(test_loss_gradient_matches_finite_difference) {
+    fossil_jellyfish_loss_t losses[] = {LOSS_MAE, LOSS_HUBER, LOSS_BINARY_CROSS_ENTROPY, LOSS_CATEGORICAL_CROSS_ENTROPY};
+    double predicted[] = {0.3, 0.6, 0.1};
+    double expected[]  = {0.0, 1.0, 0.0};
+    double gradient[3];
+    const double h = 1e-6;
+
+    for (int32_t l = 0; l < 4; l++) {
+        fossil_jellyfish_loss_gradient(losses[l], predicted, expected, gradient, 1, 3);
+        for (int32_t i = 0; i < 3; i++) {
+            double saved = predicted[i];
+            predicted[i] = saved + h;
+            double up = fossil_jellyfish_loss(losses[l], predicted, expected, 1, 3);
+            predicted[i] = saved - h;
+            double down = fossil_jellyfish_loss(losses[l], predicted, expected, 1, 3);
+            predicted[i] = saved;
+
+            // Element-wise losses are averaged over the row, the gradient is not
+            double scale = losses[l] == LOSS_CATEGORICAL_CROSS_ENTROPY ? 1.0 : 3.0;
+            ASSUME_ITS_TRUE(fabs(scale * (up - down) / (2 * h) - gradient[i]) < 1e-4);
+        }
+    }
+
+    // MSE uses the 1/2-scaled convention of fossil_jellyfish_backpropagate
+    fossil_jellyfish_loss_gradient(LOSS_MSE, predicted, expected, gradient, 1, 3);
+    ASSUME_ITS_TRUE(fabs(gradient[1] - (0.6 - 1.0)) < LOSS_TOLERANCE);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(loss_tests) {
+    ADD_TEST(test_loss_regression_values);
+    ADD_TEST(test_loss_cross_entropy_values);
+    ADD_TEST(test_loss_gradient_matches_finite_difference);
+}
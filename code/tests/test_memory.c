@@ -0,0 +1,350 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_MEMORY_FILE "test_memory_network.dat"
+
+// 512 x 512 weights fill exactly one huge page
+static fossil_jellyfish_network_t* make_large_network(void) {
+    int32_t neurons[] = {512, 512, 4};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_RELU, ACTIVATION_LINEAR};
+    return fossil_jellyfish_create_network(3, neurons, activations);
+}
+
+static int32_t huge_page_aligned(const void* pointer) {
+    return ((uintptr_t)pointer & (FOSSIL_JELLYFISH_HUGE_PAGE_SIZE - 1)) == 0;
+}
+
+// Allocator hooks that count their calls
+typedef struct {
+    int64_t allocs;
+    int64_t frees;
+} counting_allocator_t;
+
+static void* counting_alloc(void* context, size_t size) {
+    ((counting_allocator_t*)context)->allocs++;
+    return malloc(size);
+}
+
+static void counting_free(void* context, void* pointer) {
+    ((counting_allocator_t*)context)->frees++;
+    free(pointer);
+}
+
+static fossil_jellyfish_allocator_t counting_hooks(counting_allocator_t* counter) {
+    fossil_jellyfish_allocator_t hooks = {counting_alloc, NULL, counting_free, counter};
+    return hooks;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for huge-page-aligned arenas and parameter arrays
+FOSSIL_TEST(test_memory_huge_page_allocation) {
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_get_huge_pages());
+    fossil_jellyfish_set_huge_pages(1);
+    ASSUME_ITS_EQUAL_I32(1, fossil_jellyfish_get_huge_pages());
+
+    double* arena = (double*)fossil_jellyfish_alloc_arena(FOSSIL_JELLYFISH_HUGE_PAGE_SIZE + 8);
+    ASSUME_NOT_CNULL(arena);
+    memset(arena, 0, FOSSIL_JELLYFISH_HUGE_PAGE_SIZE + 8);
+    fossil_jellyfish_free_arena(arena);
+
+    fossil_jellyfish_network_t* network = make_large_network();
+    fossil_jellyfish_network_t* clone = fossil_jellyfish_clone(network);
+    fossil_jellyfish_set_huge_pages(0);
+#ifndef _WIN32
+    ASSUME_ITS_TRUE(huge_page_aligned(network->layers[1]->weights));
+    ASSUME_ITS_TRUE(huge_page_aligned(clone->layers[1]->weights));
+#endif
+    ASSUME_ITS_TRUE(memcmp(network->layers[1]->weights, clone->layers[1]->weights, 512 * 512 * sizeof(double)) == 0);
+
+    fossil_jellyfish_free_network(clone);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for moving an existing network without changing its outputs
+FOSSIL_TEST(test_memory_use_huge_pages) {
+    fossil_jellyfish_network_t* network = make_large_network();
+    double* inputs = (double*)calloc(3 * 512, sizeof(double));
+    double before[3 * 4], after[3 * 4];
+    for (int32_t i = 0; i < 3 * 512; i++) {
+        inputs[i] = sin(0.1 * i);
+    }
+    fossil_jellyfish_forward_batch(network, inputs, 3, before);
+
+    // A no-op while huge pages are off
+    const double* original = network->layers[1]->weights;
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_use_huge_pages(network));
+    ASSUME_ITS_TRUE(network->layers[1]->weights == original);
+
+    fossil_jellyfish_set_huge_pages(1);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_pack_weights(network));
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_use_huge_pages(network));
+    fossil_jellyfish_set_huge_pages(0);
+#ifndef _WIN32
+    ASSUME_ITS_TRUE(huge_page_aligned(network->layers[1]->weights));
+    ASSUME_ITS_TRUE(huge_page_aligned(network->layers[1]->packed));
+#endif
+    fossil_jellyfish_forward_batch(network, inputs, 3, after);
+    ASSUME_ITS_TRUE(memcmp(before, after, sizeof(before)) == 0);
+
+    free(inputs);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for global and per-network allocators owning everything they allocate
+FOSSIL_TEST(test_memory_allocator_hooks) {
+    int32_t neurons[] = {3, 6, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    double inputs[3] = {0.5, -1.0, 0.25}, targets[2] = {1.0, 0.0};
+    counting_allocator_t own = {0, 0}, global = {0, 0};
+    fossil_jellyfish_allocator_t own_hooks = counting_hooks(&own);
+    fossil_jellyfish_allocator_t global_hooks = counting_hooks(&global);
+
+    // A per-network allocator follows the network into snapshots, clones and rewrites
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network_with_allocator(3, neurons, activations, &own_hooks);
+    ASSUME_NOT_CNULL(network);
+    fossil_jellyfish_network_t* snapshot = fossil_jellyfish_snapshot(network);
+    fossil_jellyfish_network_t* clone = fossil_jellyfish_clone(snapshot);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_fit_normalization(network, inputs, 1));
+    fossil_jellyfish_train(network, inputs, targets, 1, 2, 0.1);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_pack_weights(clone));
+    ASSUME_ITS_TRUE(clone->allocator.context == &own);
+    fossil_jellyfish_free_network(network);
+    fossil_jellyfish_free_network(snapshot);
+    fossil_jellyfish_free_network(clone);
+    ASSUME_ITS_TRUE(own.allocs > 0);
+    ASSUME_ITS_TRUE(own.allocs == own.frees);
+
+    // The global allocator is captured by networks created while it is installed
+    fossil_jellyfish_set_allocator(&global_hooks);
+    ASSUME_ITS_TRUE(fossil_jellyfish_get_allocator().context == &global);
+    network = fossil_jellyfish_create_network(3, neurons, activations);
+    fossil_jellyfish_set_allocator(NULL);
+    ASSUME_ITS_TRUE(fossil_jellyfish_get_allocator().alloc == NULL);
+    double* arena = (double*)fossil_jellyfish_alloc_arena(64);
+    fossil_jellyfish_free_arena(arena);
+    fossil_jellyfish_forward(network, inputs);
+    fossil_jellyfish_free_network(network);
+    ASSUME_ITS_TRUE(global.allocs > 0);
+    ASSUME_ITS_TRUE(global.allocs == global.frees);
+}
+
+// Test case for batch inference and evaluation staying off the allocator once warm
+FOSSIL_TEST(test_memory_scratch_steady_state) {
+    int32_t neurons[] = {4, 16, 3};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_RELU, ACTIVATION_SOFTMAX};
+    double inputs[64 * 4], targets[64 * 3], outputs[64 * 3];
+    for (int32_t i = 0; i < 64; i++) {
+        for (int32_t k = 0; k < 4; k++) {
+            inputs[i * 4 + k] = cos(0.3 * i + k);
+        }
+        for (int32_t c = 0; c < 3; c++) {
+            targets[i * 3 + c] = c == i % 3 ? 1.0 : 0.0;
+        }
+    }
+    fossil_jellyfish_dataset_t dataset = {inputs, targets, 64};
+    fossil_jellyfish_metrics_t metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.flags = METRIC_LOSS | METRIC_ACCURACY;
+    metrics.loss = LOSS_CATEGORICAL_CROSS_ENTROPY;
+
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    counting_allocator_t counter = {0, 0};
+    fossil_jellyfish_allocator_t hooks = counting_hooks(&counter);
+    fossil_jellyfish_scratch_release();
+    fossil_jellyfish_set_allocator(&hooks);
+
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_forward_batch(network, inputs, 64, outputs));
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_evaluate(network, &dataset, &metrics));
+    int64_t warm = counter.allocs;
+    ASSUME_ITS_TRUE(warm > 0);
+    for (int32_t repeat = 0; repeat < 10; repeat++) {
+        ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_forward_batch(network, inputs, 64, outputs));
+        ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_evaluate(network, &dataset, &metrics));
+    }
+    ASSUME_ITS_TRUE(warm == counter.allocs);
+
+    fossil_jellyfish_scratch_release();
+    fossil_jellyfish_set_allocator(NULL);
+    ASSUME_ITS_TRUE(counter.allocs == counter.frees);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_scratch_reserve((size_t)1 << 20));
+    fossil_jellyfish_scratch_release();
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for a network built in a static buffer of exactly its computed size
+FOSSIL_TEST(test_memory_static_network) {
+    static double buffer[4096];
+    int32_t neurons[] = {5, 12, 3};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_RELU, ACTIVATION_SIGMOID};
+    double input[5] = {0.2, -0.4, 1.0, 0.0, 0.7};
+    size_t size = fossil_jellyfish_network_size(3, neurons);
+    ASSUME_ITS_TRUE(size > 0 && size <= sizeof(buffer));
+    ASSUME_ITS_TRUE(fossil_jellyfish_network_size(0, neurons) == 0);
+
+    ASSUME_ITS_CNULL(fossil_jellyfish_create_network_in(buffer, size - FOSSIL_JELLYFISH_STATIC_ALIGNMENT, 3, neurons, activations));
+    ASSUME_ITS_CNULL(fossil_jellyfish_create_network_in((char*)buffer + 1, size, 3, neurons, activations));
+
+    // Neither construction nor inference reaches the global allocator
+    counting_allocator_t counter = {0, 0};
+    fossil_jellyfish_allocator_t hooks = counting_hooks(&counter);
+    fossil_jellyfish_set_allocator(&hooks);
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network_in(buffer, size, 3, neurons, activations);
+    ASSUME_NOT_CNULL(network);
+    fossil_jellyfish_forward(network, input);
+    fossil_jellyfish_set_allocator(NULL);
+    ASSUME_ITS_TRUE(counter.allocs == 0);
+    ASSUME_ITS_TRUE((char*)network->layers[2]->outputs < (char*)buffer + size);
+
+    // The buffer holds nothing more, so attaching packed weights fails cleanly
+    ASSUME_ITS_EQUAL_I32(-1, fossil_jellyfish_pack_weights(network));
+
+    fossil_jellyfish_network_t* reference = fossil_jellyfish_create_network(3, neurons, activations);
+    fossil_jellyfish_forward(reference, input);
+    ASSUME_ITS_TRUE(memcmp(network->layers[2]->outputs, reference->layers[2]->outputs, 3 * sizeof(double)) == 0);
+    fossil_jellyfish_free_network(reference);
+    fossil_jellyfish_free_network(network);
+}
+
+static void* failing_alloc(void* context, size_t size) {
+    ((counting_allocator_t*)context)->allocs++;
+    (void)size;
+    return NULL;
+}
+
+// Test case for building a layer large enough for parallel initialization in a buffer
+FOSSIL_TEST(test_memory_static_network_serial_init) {
+    int32_t neurons[] = {256, 256, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_RELU, ACTIVATION_LINEAR};
+    size_t size = fossil_jellyfish_network_size(3, neurons);
+    void* buffer = fossil_jellyfish_alloc_arena(size);
+    ASSUME_NOT_CNULL(buffer);
+
+    // Every allocation the construction attempted would fail and be counted
+    counting_allocator_t counter = {0, 0};
+    fossil_jellyfish_allocator_t hooks = {failing_alloc, NULL, counting_free, &counter};
+    fossil_jellyfish_set_num_threads(4);
+    fossil_jellyfish_set_allocator(&hooks);
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network_in(buffer, size, 3, neurons, activations);
+    fossil_jellyfish_set_allocator(NULL);
+    fossil_jellyfish_set_num_threads(0);
+    ASSUME_NOT_CNULL(network);
+    ASSUME_ITS_TRUE(counter.allocs == 0);
+
+    // Serial initialization draws the same weights as the parallel one
+    fossil_jellyfish_network_t* reference = fossil_jellyfish_create_network(3, neurons, activations);
+    ASSUME_ITS_TRUE(memcmp(network->layers[1]->weights, reference->layers[1]->weights, 256 * 256 * sizeof(double)) == 0);
+    fossil_jellyfish_free_network(reference);
+    fossil_jellyfish_free_network(network);
+    fossil_jellyfish_free_arena(buffer);
+}
+
+// Test case for loading a saved network into a buffer sized from the file
+FOSSIL_TEST(test_memory_static_load) {
+    int32_t neurons[] = {4, 9, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_LINEAR};
+    double inputs[2 * 4] = {1.0, 2.0, -1.0, 0.5, 3.0, -2.0, 0.0, 1.5};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_fit_normalization(network, inputs, 2));
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_pack_weights(network));
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_save(network, TEST_MEMORY_FILE));
+
+    size_t size = fossil_jellyfish_load_size(TEST_MEMORY_FILE);
+    ASSUME_ITS_TRUE(size > fossil_jellyfish_network_size(3, neurons));
+    double* buffer = (double*)malloc(size);
+    ASSUME_ITS_CNULL(fossil_jellyfish_load_into(TEST_MEMORY_FILE, buffer, size - FOSSIL_JELLYFISH_STATIC_ALIGNMENT));
+    fossil_jellyfish_network_t* loaded = fossil_jellyfish_load_into(TEST_MEMORY_FILE, buffer, size);
+    ASSUME_NOT_CNULL(loaded);
+    ASSUME_NOT_CNULL(loaded->input_mean);
+    ASSUME_NOT_CNULL(loaded->layers[1]->packed);
+
+    fossil_jellyfish_forward(network, inputs);
+    fossil_jellyfish_forward(loaded, inputs);
+    ASSUME_ITS_TRUE(memcmp(network->layers[2]->outputs, loaded->layers[2]->outputs, 2 * sizeof(double)) == 0);
+
+    fossil_jellyfish_free_network(loaded);
+    fossil_jellyfish_free_network(network);
+    free(buffer);
+    remove(TEST_MEMORY_FILE);
+    ASSUME_ITS_TRUE(fossil_jellyfish_load_size(TEST_MEMORY_FILE) == 0);
+}
+
+// Test case for loading a saved network from an unaligned byte range without stdio
+FOSSIL_TEST(test_memory_static_load_from_memory) {
+    int32_t neurons[] = {4, 9, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_LINEAR};
+    double inputs[4] = {1.0, 2.0, -1.0, 0.5};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_pack_weights(network));
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_save(network, TEST_MEMORY_FILE));
+
+    FILE* file = fopen(TEST_MEMORY_FILE, "rb");
+    ASSUME_NOT_CNULL(file);
+    fseek(file, 0, SEEK_END);
+    size_t image_size = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* bytes = (unsigned char*)malloc(image_size + 1);
+    ASSUME_ITS_TRUE(fread(bytes + 1, 1, image_size, file) == image_size);
+    fclose(file);
+    const unsigned char* image = bytes + 1;
+
+    size_t size = fossil_jellyfish_load_size_from_memory(image, image_size);
+    ASSUME_ITS_TRUE(size == fossil_jellyfish_load_size(TEST_MEMORY_FILE));
+    ASSUME_ITS_TRUE(fossil_jellyfish_load_size_from_memory(image, image_size - 1) == 0);
+    void* buffer = fossil_jellyfish_alloc_arena(size);
+    ASSUME_ITS_CNULL(fossil_jellyfish_load_into_from_memory(buffer, size, image, image_size / 2));
+
+    counting_allocator_t counter = {0, 0};
+    fossil_jellyfish_allocator_t hooks = {failing_alloc, NULL, counting_free, &counter};
+    fossil_jellyfish_set_allocator(&hooks);
+    fossil_jellyfish_network_t* loaded = fossil_jellyfish_load_into_from_memory(buffer, size, image, image_size);
+    fossil_jellyfish_set_allocator(NULL);
+    ASSUME_NOT_CNULL(loaded);
+    ASSUME_ITS_TRUE(counter.allocs == 0);
+    ASSUME_NOT_CNULL(loaded->layers[1]->packed);
+
+    fossil_jellyfish_forward(network, inputs);
+    fossil_jellyfish_forward(loaded, inputs);
+    ASSUME_ITS_TRUE(memcmp(network->layers[2]->outputs, loaded->layers[2]->outputs, 2 * sizeof(double)) == 0);
+
+    fossil_jellyfish_free_network(loaded);
+    fossil_jellyfish_free_network(network);
+    fossil_jellyfish_free_arena(buffer);
+    free(bytes);
+    remove(TEST_MEMORY_FILE);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(memory_tests) {
+    ADD_TEST(test_memory_huge_page_allocation);
+    ADD_TEST(test_memory_use_huge_pages);
+    ADD_TEST(test_memory_allocator_hooks);
+    ADD_TEST(test_memory_scratch_steady_state);
+    ADD_TEST(test_memory_static_network);
+    ADD_TEST(test_memory_static_network_serial_init);
+    ADD_TEST(test_memory_static_load);
+    ADD_TEST(test_memory_static_load_from_memory);
+}
@@ -0,0 +1,114 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_NORMALIZE_FILE "test_normalize_network.dat"
+
+// Raw features on very different scales
+static void make_raw_inputs(double* inputs, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        inputs[i * 3] = 1000 + 50 * sin(0.7 * i);
+        inputs[i * 3 + 1] = 0.001 * cos(1.3 * i);
+        inputs[i * 3 + 2] = -20 + 4 * sin(2.1 * i + 1);
+    }
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for the fused normalization matching a separate standardization pass
+FOSSIL_TEST(test_normalize_fused_forward) {
+    int32_t neurons[] = {3, 8, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    fossil_jellyfish_network_t* plain = fossil_jellyfish_clone(network);
+    double raw[40 * 3], standardized[40 * 3], fused[40 * 2], expected[40 * 2];
+    make_raw_inputs(raw, 40);
+
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_fit_normalization(network, raw, 40));
+    for (int32_t k = 0; k < 3; k++) {
+        double mean = 0, variance = 0;
+        for (int32_t i = 0; i < 40; i++) {
+            mean += raw[i * 3 + k] / 40;
+        }
+        for (int32_t i = 0; i < 40; i++) {
+            variance += (raw[i * 3 + k] - mean) * (raw[i * 3 + k] - mean) / 40;
+        }
+        ASSUME_ITS_TRUE(fabs(network->input_mean[k] - mean) < 1e-9 * fabs(mean));
+        ASSUME_ITS_TRUE(fabs(network->input_scale[k] * sqrt(variance) - 1) < 1e-9);
+        for (int32_t i = 0; i < 40; i++) {
+            standardized[i * 3 + k] = (raw[i * 3 + k] - network->input_mean[k]) * network->input_scale[k];
+        }
+    }
+
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_forward_batch(network, raw, 40, fused));
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_forward_batch(plain, standardized, 40, expected));
+    for (int32_t i = 0; i < 40; i++) {
+        fossil_jellyfish_forward(network, &raw[i * 3]);
+        for (int32_t c = 0; c < 2; c++) {
+            ASSUME_ITS_TRUE(fused[i * 2 + c] == expected[i * 2 + c]);
+            ASSUME_ITS_TRUE(network->layers[2]->outputs[c] == expected[i * 2 + c]);
+        }
+    }
+
+    // Chain graphs cannot standardize, so conversion waits for a fold
+    ASSUME_ITS_CNULL(fossil_jellyfish_graph_from_network(network));
+
+    fossil_jellyfish_free_network(plain);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for folding into the first layer and saving with the model
+FOSSIL_TEST(test_normalize_fold_and_save) {
+    int32_t neurons[] = {3, 8, 1};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_RELU, ACTIVATION_LINEAR};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    double raw[16 * 3], before[16], after[16];
+    make_raw_inputs(raw, 16);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_fit_normalization(network, raw, 16));
+    fossil_jellyfish_forward_batch(network, raw, 16, before);
+
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_save(network, TEST_NORMALIZE_FILE));
+    fossil_jellyfish_network_t* loaded = fossil_jellyfish_load(TEST_NORMALIZE_FILE);
+    ASSUME_NOT_CNULL(loaded);
+    ASSUME_NOT_CNULL(loaded->input_mean);
+    fossil_jellyfish_forward_batch(loaded, raw, 16, after);
+    ASSUME_ITS_TRUE(memcmp(before, after, sizeof(before)) == 0);
+
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_fold_normalization(network));
+    ASSUME_ITS_CNULL(network->input_mean);
+    fossil_jellyfish_forward_batch(network, raw, 16, after);
+    for (int32_t i = 0; i < 16; i++) {
+        ASSUME_ITS_TRUE(fabs(before[i] - after[i]) < 1e-9);
+    }
+
+    remove(TEST_NORMALIZE_FILE);
+    fossil_jellyfish_free_network(loaded);
+    fossil_jellyfish_free_network(network);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(normalize_tests) {
+    ADD_TEST(test_normalize_fused_forward);
+    ADD_TEST(test_normalize_fold_and_save);
+}
@@ -0,0 +1,111 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for learning a stream of samples one at a time
+FOSSIL_TEST(test_online_learns_stream) {
+    int32_t neurons[] = {2, 8, 1};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_RELU, ACTIVATION_TANH, ACTIVATION_LINEAR};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    fossil_jellyfish_online_config_t config = {4, 0.05, LOSS_MSE};
+    fossil_jellyfish_online_t* online = fossil_jellyfish_online_create(network, &config);
+    ASSUME_NOT_CNULL(online);
+
+    double* scratch = (double*)malloc(fossil_jellyfish_online_scratch_size(online) * sizeof(double));
+    double before = 0, after = 0, output;
+
+    // Target y = 0.5 * a - 0.3 * b
+    for (int32_t i = 0; i < 64; i++) {
+        double input[2] = {sin(0.7 * i), cos(1.3 * i)};
+        double target = 0.5 * input[0] - 0.3 * input[1];
+        fossil_jellyfish_online_predict(online, input, &output, scratch);
+        before += (output - target) * (output - target);
+    }
+    for (int32_t i = 0; i < 4000; i++) {
+        double input[2] = {sin(0.7 * i), cos(1.3 * i)};
+        double target = 0.5 * input[0] - 0.3 * input[1];
+        fossil_jellyfish_online_push(online, input, &target);
+    }
+    for (int32_t i = 0; i < 64; i++) {
+        double input[2] = {sin(0.7 * i), cos(1.3 * i)};
+        double target = 0.5 * input[0] - 0.3 * input[1];
+        fossil_jellyfish_online_predict(online, input, &output, scratch);
+        after += (output - target) * (output - target);
+    }
+
+    ASSUME_ITS_TRUE(fossil_jellyfish_online_version(online) == 1000);
+    ASSUME_ITS_TRUE(after < before);
+    ASSUME_ITS_TRUE(after / 64 < 1e-3);
+
+    free(scratch);
+    fossil_jellyfish_online_free(online);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for the published version lagging behind a held reader
+FOSSIL_TEST(test_online_versions) {
+    int32_t neurons[] = {3, 4, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_RELU, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    fossil_jellyfish_online_config_t config = {2, 0.5, LOSS_BINARY_CROSS_ENTROPY};
+    fossil_jellyfish_online_t* online = fossil_jellyfish_online_create(network, &config);
+    double inputs[] = {0.2, -0.1, 0.7, 0.9, 0.4, -0.6};
+    double targets[] = {1, 0, 0, 1};
+    double* scratch = (double*)malloc(fossil_jellyfish_online_scratch_size(online) * sizeof(double));
+    double output[2];
+
+    // Nothing is published until the cadence is reached
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_online_push(online, inputs, targets));
+    ASSUME_ITS_TRUE(fossil_jellyfish_online_version(online) == 0);
+    ASSUME_ITS_EQUAL_I32(1, fossil_jellyfish_online_push_batch(online, inputs + 3, targets + 2, 1));
+    ASSUME_ITS_TRUE(fossil_jellyfish_online_version(online) == 1);
+
+    // The published version matches the master weights
+    fossil_jellyfish_forward(network, inputs);
+    ASSUME_ITS_TRUE(fossil_jellyfish_online_predict(online, inputs, output, scratch) == 1);
+    ASSUME_ITS_TRUE(fabs(output[0] - network->layers[2]->outputs[0]) < 1e-12);
+    ASSUME_ITS_TRUE(fabs(output[1] - network->layers[2]->outputs[1]) < 1e-12);
+
+    // With both spare versions held by readers the writer keeps training and publishes later
+    for (int32_t v = 0; v < FOSSIL_JELLYFISH_ONLINE_VERSIONS; v++) {
+        online->readers[v] += v != online->published;
+    }
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_online_push_batch(online, inputs, targets, 2));
+    ASSUME_ITS_TRUE(fossil_jellyfish_online_version(online) == 1);
+    for (int32_t v = 0; v < FOSSIL_JELLYFISH_ONLINE_VERSIONS; v++) {
+        online->readers[v] = 0;
+    }
+    ASSUME_ITS_EQUAL_I32(1, fossil_jellyfish_online_push(online, inputs, targets));
+    ASSUME_ITS_TRUE(fossil_jellyfish_online_version(online) == 2);
+
+    free(scratch);
+    fossil_jellyfish_online_free(online);
+    fossil_jellyfish_free_network(network);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(online_tests) {
+    ADD_TEST(test_online_learns_stream);
+    ADD_TEST(test_online_versions);
+}
@@ -0,0 +1,288 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_PLAN_FILE "test_plan_network.dat"
+#define TEST_PLAN_TUNING "test_plan_tuning.txt"
+
+// One layer per kernel: packed dense, sparse, hashed and a narrow plain dense output
+static fossil_jellyfish_network_t* make_mixed_network(void) {
+    int32_t neurons[] = {5, 9, 12, 7, 3};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_RELU, ACTIVATION_ELU, ACTIVATION_SOFTMAX};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(5, neurons, activations);
+    fossil_jellyfish_layer_t* sparse = network->layers[2];
+    for (int32_t i = 0; i < 12 * 9; i++) {
+        if (i % 5 != 0) {
+            sparse->weights[i] = 0;
+        }
+    }
+    fossil_jellyfish_hash_layer(network, 3, 20, 7);
+    fossil_jellyfish_init_layer(network, 3, INIT_XAVIER_UNIFORM, 11);
+    return network;
+}
+
+// Allocator hooks that count their calls
+typedef struct {
+    int64_t allocs;
+    int64_t frees;
+} counting_allocator_t;
+
+static void* counting_alloc(void* context, size_t size) {
+    ((counting_allocator_t*)context)->allocs++;
+    return malloc(size);
+}
+
+static void counting_free(void* context, void* pointer) {
+    ((counting_allocator_t*)context)->frees++;
+    free(pointer);
+}
+
+static void make_inputs(double* inputs, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        inputs[i] = sin(0.37 * i) * 2;
+    }
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for kernel selection and the plan forward matching the network
+FOSSIL_TEST(test_plan_forward_matches_network) {
+    fossil_jellyfish_network_t* network = make_mixed_network();
+    double inputs[70 * 5], expected[70 * 3], outputs[70 * 3];
+    make_inputs(inputs, 70 * 5);
+    double means[5] = {0.1, -0.2, 0.3, 0, 0.5}, deviations[5] = {2, 0.5, 1, 3, 0};
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_set_normalization(network, means, deviations));
+
+    fossil_jellyfish_plan_t* plan = fossil_jellyfish_compile(network, NULL);
+    ASSUME_NOT_CNULL(plan);
+    ASSUME_ITS_EQUAL_I32(4, plan->num_steps);
+    ASSUME_ITS_EQUAL_I32(KERNEL_DENSE_PACKED, plan->steps[0].kind);
+    ASSUME_ITS_EQUAL_I32(KERNEL_SPARSE, plan->steps[1].kind);
+    ASSUME_ITS_EQUAL_I32(KERNEL_HASHED, plan->steps[2].kind);
+    ASSUME_ITS_EQUAL_I32(KERNEL_DENSE, plan->steps[3].kind);
+    ASSUME_ITS_TRUE(strcmp(plan->steps[3].activation_name, "softmax") == 0);
+
+    // 70 rows cover full and partial blocks
+    double* scratch = (double*)malloc(fossil_jellyfish_plan_scratch_size(plan) * sizeof(double));
+    fossil_jellyfish_plan_forward(plan, inputs, 70, outputs, scratch);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_forward_batch(network, inputs, 70, expected));
+    for (int32_t i = 0; i < 70 * 3; i++) {
+        ASSUME_ITS_TRUE(fabs(outputs[i] - expected[i]) < 1e-12);
+    }
+
+    // Without packing the wide layer falls back to the plain dense kernel
+    fossil_jellyfish_compile_options_t options = fossil_jellyfish_compile_defaults();
+    options.disable_packing = 1;
+    options.sparse_threshold = 0;
+    fossil_jellyfish_plan_t* plain = fossil_jellyfish_compile(network, &options);
+    ASSUME_ITS_EQUAL_I32(KERNEL_DENSE, plain->steps[0].kind);
+    ASSUME_ITS_EQUAL_I32(KERNEL_DENSE, plain->steps[1].kind);
+    fossil_jellyfish_plan_forward(plain, inputs, 70, outputs, scratch);
+    for (int32_t i = 0; i < 70 * 3; i++) {
+        ASSUME_ITS_TRUE(fabs(outputs[i] - expected[i]) < 1e-12);
+    }
+
+    free(scratch);
+    fossil_jellyfish_plan_free(plain);
+    fossil_jellyfish_plan_free(plan);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for plan gradients matching the network and surviving a refresh
+FOSSIL_TEST(test_plan_gradients_and_refresh) {
+    fossil_jellyfish_network_t* network = make_mixed_network();
+    fossil_jellyfish_plan_t* plan = fossil_jellyfish_compile(network, NULL);
+    int64_t count = fossil_jellyfish_num_parameters(network);
+    double* expected = (double*)calloc((size_t)count, sizeof(double));
+    double* gradients = (double*)calloc((size_t)count, sizeof(double));
+    double* scratch = (double*)malloc(fossil_jellyfish_plan_scratch_size(plan) * sizeof(double));
+    double inputs[4 * 5], targets[4 * 3] = {1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0};
+    make_inputs(inputs, 4 * 5);
+
+    for (int32_t i = 0; i < 4; i++) {
+        fossil_jellyfish_forward(network, &inputs[i * 5]);
+        fossil_jellyfish_accumulate_gradients(network, &targets[i * 3], LOSS_CATEGORICAL_CROSS_ENTROPY, expected);
+        fossil_jellyfish_plan_accumulate_gradients(plan, &inputs[i * 5], &targets[i * 3], LOSS_CATEGORICAL_CROSS_ENTROPY, gradients, scratch);
+    }
+    for (int64_t p = 0; p < count; p++) {
+        ASSUME_ITS_TRUE(fabs(gradients[p] - expected[p]) < 1e-12);
+    }
+
+    // New weights reach the packed copies only through a refresh
+    double before[4 * 3], after[4 * 3], reference[4 * 3];
+    fossil_jellyfish_plan_forward(plan, inputs, 4, before, scratch);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_apply_gradients(network, gradients, 0.5));
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_plan_refresh(plan));
+    fossil_jellyfish_plan_forward(plan, inputs, 4, after, scratch);
+    fossil_jellyfish_forward_batch(network, inputs, 4, reference);
+    ASSUME_ITS_TRUE(memcmp(before, after, sizeof(before)) != 0);
+    for (int32_t i = 0; i < 4 * 3; i++) {
+        ASSUME_ITS_TRUE(fabs(after[i] - reference[i]) < 1e-12);
+    }
+
+    free(expected);
+    free(gradients);
+    free(scratch);
+    fossil_jellyfish_plan_free(plan);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for packed weights kept with the network and saved with the model
+FOSSIL_TEST(test_plan_packed_weights) {
+    int32_t neurons[] = {6, 10, 8, 3};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_RELU, ACTIVATION_TANH, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(4, neurons, activations);
+    double inputs[9 * 6], expected[9 * 3], outputs[9 * 3];
+    make_inputs(inputs, 9 * 6);
+    fossil_jellyfish_forward_batch(network, inputs, 9, expected);
+
+    // Narrow layers stay row-major; the packed kernel sums in the same order
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_pack_weights(network));
+    ASSUME_NOT_CNULL(network->layers[1]->packed);
+    ASSUME_NOT_CNULL(network->layers[2]->packed);
+    ASSUME_ITS_CNULL(network->layers[3]->packed);
+    fossil_jellyfish_forward_batch(network, inputs, 9, outputs);
+    ASSUME_ITS_TRUE(memcmp(expected, outputs, sizeof(outputs)) == 0);
+    fossil_jellyfish_forward(network, inputs);
+    ASSUME_ITS_TRUE(memcmp(expected, network->layers[3]->outputs, 3 * sizeof(double)) == 0);
+
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_save(network, TEST_PLAN_FILE));
+    fossil_jellyfish_network_t* loaded = fossil_jellyfish_load(TEST_PLAN_FILE);
+    ASSUME_NOT_CNULL(loaded);
+    ASSUME_NOT_CNULL(loaded->layers[1]->packed);
+    ASSUME_ITS_TRUE(memcmp(loaded->layers[2]->packed, network->layers[2]->packed, 8 * 10 * sizeof(double)) == 0);
+    fossil_jellyfish_forward_batch(loaded, inputs, 9, outputs);
+    ASSUME_ITS_TRUE(memcmp(expected, outputs, sizeof(outputs)) == 0);
+
+    // Training writes the row-major weights, so the stale copies go away
+    double targets[3] = {1, 0, 1};
+    fossil_jellyfish_train(loaded, inputs, targets, 1, 1, 0.1);
+    ASSUME_ITS_CNULL(loaded->layers[1]->packed);
+    ASSUME_ITS_CNULL(loaded->layers[2]->packed);
+
+    remove(TEST_PLAN_FILE);
+    fossil_jellyfish_free_network(loaded);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for autotuning once per shape and reusing the cached winners
+FOSSIL_TEST(test_plan_autotune_cache) {
+    fossil_jellyfish_network_t* network = make_mixed_network();
+    double inputs[33 * 5], expected[33 * 3], outputs[33 * 3];
+    make_inputs(inputs, 33 * 5);
+    fossil_jellyfish_forward_batch(network, inputs, 33, expected);
+    remove(TEST_PLAN_TUNING);
+
+    fossil_jellyfish_compile_options_t options = fossil_jellyfish_compile_defaults();
+    fossil_jellyfish_plan_t* plan = fossil_jellyfish_compile(network, &options);
+    ASSUME_ITS_TRUE(strcmp(plan->steps[0].selection, "heuristic") == 0);
+    ASSUME_ITS_TRUE(strcmp(plan->steps[2].selection, "fixed") == 0);
+    fossil_jellyfish_plan_free(plan);
+
+    // The output layer is too narrow to pack and fully dense, so it has nothing to tune
+    options.autotune = 1;
+    options.tuning_cache = TEST_PLAN_TUNING;
+    plan = fossil_jellyfish_compile(network, &options);
+    ASSUME_NOT_CNULL(plan);
+    ASSUME_ITS_TRUE(strcmp(plan->steps[0].selection, "tuned") == 0);
+    ASSUME_ITS_TRUE(strcmp(plan->steps[1].selection, "tuned") == 0);
+    ASSUME_ITS_TRUE(strcmp(plan->steps[3].selection, "heuristic") == 0);
+    double* scratch = (double*)malloc(fossil_jellyfish_plan_scratch_size(plan) * sizeof(double));
+    fossil_jellyfish_plan_forward(plan, inputs, 33, outputs, scratch);
+    for (int32_t i = 0; i < 33 * 3; i++) {
+        ASSUME_ITS_TRUE(fabs(outputs[i] - expected[i]) < 1e-12);
+    }
+    fossil_jellyfish_plan_free(plan);
+
+    // Force the first layer's winner in the cache: later compiles must take it as is
+    char lines[4][512];
+    int32_t count = 0;
+    FILE* file = fopen(TEST_PLAN_TUNING, "r");
+    ASSUME_NOT_CNULL(file);
+    while (count < 4 && fgets(lines[count], sizeof(lines[count]), file)) {
+        count++;
+    }
+    fclose(file);
+    ASSUME_ITS_EQUAL_I32(3, count);
+    int32_t fan_in, fan_out, permille, candidates;
+    char kernel[32], rest[400];
+    ASSUME_ITS_EQUAL_I32(6, sscanf(lines[1], "%d %d %d %d %31s %399[^\n]", &fan_in, &fan_out, &permille, &candidates, kernel, rest));
+    ASSUME_ITS_EQUAL_I32(5, fan_in);
+    file = fopen(TEST_PLAN_TUNING, "w");
+    fprintf(file, "%s%d %d %d %d %s %s\n%s", lines[0], fan_in, fan_out, permille, candidates,
+            strcmp(kernel, "dense") == 0 ? "dense_packed" : "dense", rest, lines[2]);
+    fclose(file);
+
+    plan = fossil_jellyfish_compile(network, &options);
+    ASSUME_ITS_TRUE(strcmp(plan->steps[0].selection, "cached") == 0);
+    ASSUME_ITS_TRUE(strcmp(plan->steps[1].selection, "cached") == 0);
+    ASSUME_ITS_TRUE(strcmp(plan->steps[0].kernel_name, kernel) != 0);
+    fossil_jellyfish_plan_forward(plan, inputs, 33, outputs, scratch);
+    for (int32_t i = 0; i < 33 * 3; i++) {
+        ASSUME_ITS_TRUE(fabs(outputs[i] - expected[i]) < 1e-12);
+    }
+
+    free(scratch);
+    remove(TEST_PLAN_TUNING);
+    fossil_jellyfish_plan_free(plan);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for the packed and sparse step arrays coming from the network's allocator
+FOSSIL_TEST(test_plan_network_allocator) {
+    int32_t neurons[] = {6, 16, 12, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_RELU, ACTIVATION_TANH, ACTIVATION_LINEAR};
+    counting_allocator_t counter = {0, 0};
+    fossil_jellyfish_allocator_t hooks = {counting_alloc, NULL, counting_free, &counter};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network_with_allocator(4, neurons, activations, &hooks);
+    ASSUME_NOT_CNULL(network);
+    for (int32_t i = 0; i < 12 * 16; i++) {
+        if (i % 4 != 0) {
+            network->layers[2]->weights[i] = 0;
+        }
+    }
+
+    // One packed array for layer 1, values and indices for the sparse layer 2
+    int64_t allocs = counter.allocs, frees = counter.frees;
+    fossil_jellyfish_plan_t* plan = fossil_jellyfish_compile(network, NULL);
+    ASSUME_NOT_CNULL(plan);
+    ASSUME_ITS_EQUAL_I32(KERNEL_DENSE_PACKED, plan->steps[0].kind);
+    ASSUME_ITS_EQUAL_I32(KERNEL_SPARSE, plan->steps[1].kind);
+    ASSUME_ITS_TRUE(counter.allocs == allocs + 3);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_plan_refresh(plan));
+    fossil_jellyfish_plan_free(plan);
+    ASSUME_ITS_TRUE(counter.allocs - counter.frees == allocs - frees);
+
+    fossil_jellyfish_free_network(network);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(plan_tests) {
+    ADD_TEST(test_plan_forward_matches_network);
+    ADD_TEST(test_plan_gradients_and_refresh);
+    ADD_TEST(test_plan_packed_weights);
+    ADD_TEST(test_plan_autotune_cache);
+    ADD_TEST(test_plan_network_allocator);
+}
@@ -0,0 +1,145 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/unittest/framework.h>
+#include <fossil/unittest/assume.h>
+
+#include "fossil/jellyfish/framework.h"
+#include <string.h>
+
+// Three channels sampled at every step of a 40-step signal
+static void make_signal(double* signal, int32_t steps) {
+    for (int32_t t = 0; t < steps; t++) {
+        signal[t * 3] = sin(0.3 * t);
+        signal[t * 3 + 1] = cos(0.11 * t) * 2;
+        signal[t * 3 + 2] = t % 5 - 2;
+    }
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test case for streamed windows matching the forward pass on copied windows
+FOSSIL_TEST(test_stream_matches_windows) {
+    int32_t neurons[] = {12, 5, 4, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_RELU, ACTIVATION_SOFTMAX};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(4, neurons, activations);
+    double means[12], deviations[12], signal[40 * 3], output[2];
+    for (int32_t k = 0; k < 12; k++) {
+        means[k] = 0.1 * k;
+        deviations[k] = 1 + 0.2 * k;
+    }
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_set_normalization(network, means, deviations));
+    make_signal(signal, 40);
+
+    fossil_jellyfish_stream_t* stream = fossil_jellyfish_stream_create(network, 4);
+    ASSUME_NOT_CNULL(stream);
+    ASSUME_ITS_EQUAL_I32(3, stream->channels);
+    for (int32_t t = 0; t < 40; t++) {
+        int32_t ready = fossil_jellyfish_stream_push(stream, &signal[t * 3], output);
+        ASSUME_ITS_EQUAL_I32(t >= 3, ready);
+        if (ready) {
+            double window[12];
+            memcpy(window, &signal[(t - 3) * 3], sizeof(window));
+            fossil_jellyfish_forward(network, window);
+            ASSUME_ITS_TRUE(memcmp(output, network->layers[3]->outputs, sizeof(output)) == 0);
+        }
+    }
+
+    fossil_jellyfish_stream_free(stream);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for a hashed first layer as the only layer, a reset and invalid windows
+FOSSIL_TEST(test_stream_hashed_reset) {
+    int32_t neurons[] = {6, 4};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_SIGMOID};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(2, neurons, activations);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_hash_layer(network, 1, 9, 5));
+    ASSUME_ITS_CNULL(fossil_jellyfish_stream_create(network, 4));
+    double signal[40 * 3], output[4], expected[4];
+    make_signal(signal, 40);
+
+    fossil_jellyfish_stream_t* stream = fossil_jellyfish_stream_create(network, 2);
+    ASSUME_NOT_CNULL(stream);
+    for (int32_t t = 0; t < 10; t++) {
+        fossil_jellyfish_stream_push(stream, &signal[t * 3], output);
+    }
+
+    // After a reset the first window is the one starting at the next sample
+    fossil_jellyfish_stream_reset(stream);
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_stream_push(stream, &signal[20 * 3], output));
+    ASSUME_ITS_EQUAL_I32(1, fossil_jellyfish_stream_push(stream, &signal[21 * 3], output));
+    fossil_jellyfish_forward_batch(network, &signal[20 * 3], 1, expected);
+    ASSUME_ITS_TRUE(memcmp(output, expected, sizeof(expected)) == 0);
+
+    fossil_jellyfish_stream_free(stream);
+    fossil_jellyfish_free_network(network);
+}
+
+// Test case for the running-sum path of a first layer shared across positions
+FOSSIL_TEST(test_stream_tied_first_layer) {
+    int32_t neurons[] = {12, 5, 2};
+    fossil_jellyfish_activation_t activations[] = {ACTIVATION_LINEAR, ACTIVATION_TANH, ACTIVATION_LINEAR};
+    fossil_jellyfish_network_t* network = fossil_jellyfish_create_network(3, neurons, activations);
+    double means[12], deviations[12], signal[200 * 3], output[2];
+    for (int32_t k = 0; k < 12; k++) {
+        means[k] = 0.1 * (k % 3);
+        deviations[k] = 1 + 0.2 * (k % 3);
+    }
+    ASSUME_ITS_EQUAL_I32(0, fossil_jellyfish_set_normalization(network, means, deviations));
+    for (int32_t t = 0; t < 200; t++) {
+        signal[t * 3] = sin(0.3 * t);
+        signal[t * 3 + 1] = cos(0.11 * t) * 2;
+        signal[t * 3 + 2] = t % 5 - 2;
+    }
+
+    // Untied weights take the exact path
+    fossil_jellyfish_stream_t* stream = fossil_jellyfish_stream_create(network, 4);
+    ASSUME_ITS_EQUAL_I32(0, stream->tied);
+
+    // Every position reuses the weights of position 0
+    double* weights = network->layers[1]->weights;
+    for (int32_t j = 0; j < 5; j++) {
+        for (int32_t k = 3; k < 12; k++) {
+            weights[j * 12 + k] = weights[j * 12 + k % 3];
+        }
+    }
+    fossil_jellyfish_stream_reset(stream);
+    ASSUME_ITS_EQUAL_I32(1, stream->tied);
+    for (int32_t t = 0; t < 200; t++) {
+        int32_t ready = fossil_jellyfish_stream_push(stream, &signal[t * 3], output);
+        ASSUME_ITS_EQUAL_I32(t >= 3, ready);
+        if (ready) {
+            double window[12];
+            memcpy(window, &signal[(t - 3) * 3], sizeof(window));
+            fossil_jellyfish_forward(network, window);
+            ASSUME_ITS_TRUE(fabs(output[0] - network->layers[2]->outputs[0]) < 1e-12);
+            ASSUME_ITS_TRUE(fabs(output[1] - network->layers[2]->outputs[1]) < 1e-12);
+        }
+    }
+
+    fossil_jellyfish_stream_free(stream);
+    fossil_jellyfish_free_network(network);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(stream_tests) {
+    ADD_TEST(test_stream_matches_windows);
+    ADD_TEST(test_stream_hashed_reset);
+    ADD_TEST(test_stream_tied_first_layer);
+}
@@ -0,0 +1,408 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifdef __linux__
+#define _GNU_SOURCE
+#else
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "fossil/jellyfish/framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+typedef HANDLE score_thread_t;
+typedef CRITICAL_SECTION score_mutex_t;
+typedef CONDITION_VARIABLE score_cond_t;
+#define score_mutex_init(m) InitializeCriticalSection(m)
+#define score_mutex_destroy(m) DeleteCriticalSection(m)
+#define score_mutex_lock(m) EnterCriticalSection(m)
+#define score_mutex_unlock(m) LeaveCriticalSection(m)
+#define score_cond_init(c) InitializeConditionVariable(c)
+#define score_cond_destroy(c) ((void)(c))
+#define score_cond_wait(c, m) SleepConditionVariableCS((c), (m), INFINITE)
+#define score_cond_broadcast(c) WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+typedef pthread_t score_thread_t;
+typedef pthread_mutex_t score_mutex_t;
+typedef pthread_cond_t score_cond_t;
+#define score_mutex_init(m) pthread_mutex_init((m), NULL)
+#define score_mutex_destroy(m) pthread_mutex_destroy(m)
+#define score_mutex_lock(m) pthread_mutex_lock(m)
+#define score_mutex_unlock(m) pthread_mutex_unlock(m)
+#define score_cond_init(c) pthread_cond_init((c), NULL)
+#define score_cond_destroy(c) pthread_cond_destroy(c)
+#define score_cond_wait(c, m) pthread_cond_wait((c), (m))
+#define score_cond_broadcast(c) pthread_cond_broadcast(c)
+#endif
+
+// jellyfish-score: batch inference over a dataset file in three pipelined stages.
+// A reader thread maps or reads batches of records, the calling thread scores them
+// on the library thread pool, and a writer thread writes the predictions. Each stage
+// may run at most depth batches ahead of the next, so memory stays bounded.
+
+#define SCORE_DEFAULT_BATCH 4096
+#define SCORE_DEFAULT_DEPTH 4
+#define SCORE_PAGE_DOUBLES 512
+
+typedef struct {
+    const double* records;   // The batch's records, in the mapping or in buffer
+    double* buffer;          // Records read from a stream
+    double* outputs;
+    int64_t rows;
+} score_batch_t;
+
+typedef struct {
+    fossil_jellyfish_network_t* network;
+    const fossil_jellyfish_dataset_file_t* mapped;   // Set when the input is a mapped file
+    FILE* input;                                     // Set when the input is a stream
+    FILE* output;
+    int32_t input_width;
+    int32_t output_width;
+    int32_t record_width;
+    int64_t batch_rows;
+    int32_t depth;
+    score_batch_t* batches;       // Ring of depth batches
+
+    score_mutex_t mutex;
+    score_cond_t changed;
+    int64_t read;                 // Batches finished by each stage
+    int64_t scored;
+    int64_t written;
+    int32_t reading_done;
+    int32_t scoring_done;
+    int32_t failed;
+    int32_t truncated;            // The stream ended in the middle of a record
+    int64_t rows_written;
+} score_pipeline_t;
+
+static double now_seconds(void) {
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+// Marks a stage finished with a batch, or the whole pipeline failed
+static void score_advance(score_pipeline_t* pipeline, int64_t* counter, int64_t value, int32_t failed) {
+    score_mutex_lock(&pipeline->mutex);
+    *counter = value;
+    pipeline->failed |= failed;
+    score_cond_broadcast(&pipeline->changed);
+    score_mutex_unlock(&pipeline->mutex);
+}
+
+static void score_finish(score_pipeline_t* pipeline, int32_t* done) {
+    score_mutex_lock(&pipeline->mutex);
+    *done = 1;
+    score_cond_broadcast(&pipeline->changed);
+    score_mutex_unlock(&pipeline->mutex);
+}
+
+// Waits until batch is available from the previous stage; returns 0 once the stage ran dry
+static int32_t score_wait(score_pipeline_t* pipeline, const int64_t* counter, const int32_t* done, int64_t batch) {
+    score_mutex_lock(&pipeline->mutex);
+    while (*counter <= batch && !*done && !pipeline->failed) {
+        score_cond_wait(&pipeline->changed, &pipeline->mutex);
+    }
+    int32_t ready = *counter > batch && !pipeline->failed;
+    score_mutex_unlock(&pipeline->mutex);
+    return ready;
+}
+
+static void score_read(score_pipeline_t* pipeline) {
+    for (int64_t b = 0;; b++) {
+        // The slot is free once the writer is done with the batch depth places back
+        score_mutex_lock(&pipeline->mutex);
+        while (b - pipeline->written >= pipeline->depth && !pipeline->failed) {
+            score_cond_wait(&pipeline->changed, &pipeline->mutex);
+        }
+        int32_t failed = pipeline->failed;
+        score_mutex_unlock(&pipeline->mutex);
+        if (failed) {
+            break;
+        }
+
+        score_batch_t* batch = &pipeline->batches[b % pipeline->depth];
+        if (pipeline->mapped) {
+            int64_t begin = b * pipeline->batch_rows;
+            int64_t left = pipeline->mapped->num_records - begin;
+            if (left <= 0) {
+                break;
+            }
+            batch->rows = left < pipeline->batch_rows ? left : pipeline->batch_rows;
+            batch->records = pipeline->mapped->records + begin * pipeline->record_width;
+
+            // Fault the pages in here so the scoring threads do not stall on them
+            size_t count = (size_t)batch->rows * (size_t)pipeline->record_width;
+            volatile double sink = 0;
+            for (size_t i = 0; i < count; i += SCORE_PAGE_DOUBLES) {
+                sink += batch->records[i];
+            }
+            (void)sink;
+        } else {
+            // Read in bytes, so a stream that stops inside a record is noticed rather than dropped
+            size_t record_bytes = sizeof(double) * (size_t)pipeline->record_width;
+            size_t bytes = fread(batch->buffer, 1, record_bytes * (size_t)pipeline->batch_rows, pipeline->input);
+            pipeline->truncated = bytes % record_bytes != 0;
+            if (ferror(pipeline->input) || pipeline->truncated) {
+                score_advance(pipeline, &pipeline->read, b, 1);
+                break;
+            }
+            if (bytes == 0) {
+                break;
+            }
+            batch->rows = (int64_t)(bytes / record_bytes);
+            batch->records = batch->buffer;
+        }
+        score_advance(pipeline, &pipeline->read, b + 1, 0);
+    }
+    score_finish(pipeline, &pipeline->reading_done);
+}
+
+static void score_write(score_pipeline_t* pipeline) {
+    for (int64_t b = 0; score_wait(pipeline, &pipeline->scored, &pipeline->scoring_done, b); b++) {
+        const score_batch_t* batch = &pipeline->batches[b % pipeline->depth];
+        int32_t failed = fwrite(batch->outputs, sizeof(double) * (size_t)pipeline->output_width, (size_t)batch->rows, pipeline->output) != (size_t)batch->rows;
+        pipeline->rows_written += failed ? 0 : batch->rows;
+        score_advance(pipeline, &pipeline->written, b + 1, failed);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI score_read_entry(LPVOID context) {
+    score_read((score_pipeline_t*)context);
+    return 0;
+}
+
+static DWORD WINAPI score_write_entry(LPVOID context) {
+    score_write((score_pipeline_t*)context);
+    return 0;
+}
+
+static int32_t score_start(score_thread_t* thread, LPTHREAD_START_ROUTINE entry, score_pipeline_t* pipeline) {
+    *thread = CreateThread(NULL, 0, entry, pipeline, 0, NULL);
+    return *thread ? 0 : -1;
+}
+
+static void score_join(score_thread_t thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+static void* score_read_entry(void* context) {
+    score_read((score_pipeline_t*)context);
+    return NULL;
+}
+
+static void* score_write_entry(void* context) {
+    score_write((score_pipeline_t*)context);
+    return NULL;
+}
+
+static int32_t score_start(score_thread_t* thread, void* (*entry)(void*), score_pipeline_t* pipeline) {
+    return pthread_create(thread, NULL, entry, pipeline) == 0 ? 0 : -1;
+}
+
+static void score_join(score_thread_t thread) {
+    pthread_join(thread, NULL);
+}
+#endif
+
+// The calling thread is the scoring stage, since it drives the library thread pool
+static int32_t score_run(score_pipeline_t* pipeline) {
+    score_thread_t reader, writer;
+    int32_t status = -1;
+    score_mutex_init(&pipeline->mutex);
+    score_cond_init(&pipeline->changed);
+    if (score_start(&reader, score_read_entry, pipeline) == 0) {
+        if (score_start(&writer, score_write_entry, pipeline) == 0) {
+            for (int64_t b = 0; score_wait(pipeline, &pipeline->read, &pipeline->reading_done, b); b++) {
+                score_batch_t* batch = &pipeline->batches[b % pipeline->depth];
+                int32_t failed = fossil_jellyfish_forward_strided(pipeline->network, batch->records, pipeline->record_width, batch->rows, batch->outputs) != 0;
+                score_advance(pipeline, &pipeline->scored, b + 1, failed);
+            }
+            score_finish(pipeline, &pipeline->scoring_done);
+            score_join(writer);
+            status = 0;
+        } else {
+            // Stops the reader, which may be waiting for a slot
+            score_advance(pipeline, &pipeline->scored, 0, 1);
+        }
+        score_join(reader);
+    }
+
+    // Every way out tears the pipeline down the same way
+    score_cond_destroy(&pipeline->changed);
+    score_mutex_destroy(&pipeline->mutex);
+    return status == 0 && !pipeline->failed ? 0 : -1;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: jellyfish-score [-b rows] [-q depth] [-t threads] MODEL INPUT OUTPUT\n"
+            "  MODEL   a network saved with fossil_jellyfish_save\n"
+            "  INPUT   a dataset file, mapped into memory, or - for a dataset stream on stdin\n"
+            "  OUTPUT  receives a dataset of predictions without targets, or - for stdout\n"
+            "  -b      records per batch (default %d)\n"
+            "  -q      batches each stage may run ahead of the next (default %d)\n"
+            "  -t      threads of the inference pool, 0 for every core (default 0)\n",
+            SCORE_DEFAULT_BATCH, SCORE_DEFAULT_DEPTH);
+}
+
+static int32_t parse_count(const char* text, int64_t minimum, int64_t* value) {
+    char* end = NULL;
+    long long parsed = text ? strtoll(text, &end, 10) : 0;
+    if (!text || end == text || *end != '\0' || parsed < minimum) {
+        return -1;
+    }
+    *value = (int64_t)parsed;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int64_t batch_rows = SCORE_DEFAULT_BATCH, depth = SCORE_DEFAULT_DEPTH, threads = 0;
+    const char* paths[3];
+    int32_t num_paths = 0;
+
+    for (int32_t i = 1; i < argc; i++) {
+        int32_t ok = 1;
+        if (strcmp(argv[i], "-b") == 0) {
+            ok = parse_count(++i < argc ? argv[i] : NULL, 1, &batch_rows) == 0;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            ok = parse_count(++i < argc ? argv[i] : NULL, 1, &depth) == 0;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            ok = parse_count(++i < argc ? argv[i] : NULL, 0, &threads) == 0;
+        } else if (num_paths < 3) {
+            paths[num_paths++] = argv[i];
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            usage();
+            return 2;
+        }
+    }
+    if (num_paths != 3 || depth > 1024 || threads > 4096) {
+        usage();
+        return 2;
+    }
+    fossil_jellyfish_set_num_threads((int32_t)threads);
+
+    score_pipeline_t pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.batch_rows = batch_rows;
+    pipeline.depth = (int32_t)depth;
+    pipeline.network = fossil_jellyfish_load(paths[0]);
+    if (!pipeline.network) {
+        fprintf(stderr, "jellyfish-score: cannot load model %s\n", paths[0]);
+        return 1;
+    }
+    fossil_jellyfish_pack_weights(pipeline.network);
+    pipeline.input_width = pipeline.network->layers[0]->num_neurons;
+    pipeline.output_width = pipeline.network->layers[pipeline.network->num_layers - 1]->num_neurons;
+
+    // Open the input: a file is mapped, a stream is read a batch at a time
+    fossil_jellyfish_dataset_file_t* mapped = NULL;
+    fossil_jellyfish_dataset_header_t header;
+    int64_t num_records = -1;
+    int32_t target_width = -1;
+    if (strcmp(paths[1], "-") == 0) {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        pipeline.input = stdin;
+        if (fossil_jellyfish_dataset_read_header(stdin, &header) == 0 && header.input_width == pipeline.input_width) {
+            target_width = header.target_width;
+        }
+    } else {
+        mapped = fossil_jellyfish_dataset_open(paths[1]);
+        if (mapped && mapped->input_width == pipeline.input_width) {
+            pipeline.mapped = mapped;
+            target_width = mapped->target_width;
+            num_records = mapped->num_records;
+        }
+    }
+    if (target_width < 0) {
+        fprintf(stderr, "jellyfish-score: %s is not a dataset with %d inputs per record\n", paths[1], pipeline.input_width);
+        fossil_jellyfish_dataset_close(mapped);
+        fossil_jellyfish_free_network(pipeline.network);
+        return 1;
+    }
+    pipeline.record_width = pipeline.input_width + target_width;
+
+    int32_t to_stdout = strcmp(paths[2], "-") == 0;
+#ifdef _WIN32
+    if (to_stdout) {
+        _setmode(_fileno(stdout), _O_BINARY);
+    }
+#endif
+    pipeline.output = to_stdout ? stdout : fopen(paths[2], "wb");
+    int32_t status = pipeline.output ? fossil_jellyfish_dataset_write_header(pipeline.output, num_records, pipeline.output_width, 0) : -1;
+
+    pipeline.batches = (score_batch_t*)calloc((size_t)pipeline.depth, sizeof(score_batch_t));
+    status |= pipeline.batches ? 0 : -1;
+    for (int32_t b = 0; b < pipeline.depth && status == 0; b++) {
+        pipeline.batches[b].outputs = (double*)malloc((size_t)batch_rows * (size_t)pipeline.output_width * sizeof(double));
+        pipeline.batches[b].buffer = pipeline.input ? (double*)malloc((size_t)batch_rows * (size_t)pipeline.record_width * sizeof(double)) : NULL;
+        if (!pipeline.batches[b].outputs || (pipeline.input && !pipeline.batches[b].buffer)) {
+            status = -1;
+        }
+    }
+
+    double start = now_seconds();
+    if (status == 0) {
+        status = score_run(&pipeline);
+    }
+    double seconds = now_seconds() - start;
+
+    // A stream's length is known only now; patch it into a seekable output
+    if (status == 0 && num_records < 0 && !to_stdout && fseek(pipeline.output, 0, SEEK_SET) == 0) {
+        status = fossil_jellyfish_dataset_write_header(pipeline.output, pipeline.rows_written, pipeline.output_width, 0);
+    }
+    if (pipeline.output && (to_stdout ? fflush(pipeline.output) : fclose(pipeline.output)) != 0) {
+        status = -1;
+    }
+
+    if (status == 0) {
+        fprintf(stderr, "jellyfish-score: %lld rows in %.3f s, %.0f rows/s\n", (long long)pipeline.rows_written, seconds,
+                seconds > 0 ? (double)pipeline.rows_written / seconds : 0.0);
+    } else {
+        if (pipeline.truncated) {
+            fprintf(stderr, "jellyfish-score: %s ends in the middle of a record\n", paths[1]);
+        }
+        fprintf(stderr, "jellyfish-score: scoring %s into %s failed\n", paths[1], paths[2]);
+        if (pipeline.output && !to_stdout) {
+            remove(paths[2]);
+        }
+    }
+
+    for (int32_t b = 0; pipeline.batches && b < pipeline.depth; b++) {
+        free(pipeline.batches[b].outputs);
+        free(pipeline.batches[b].buffer);
+    }
+    free(pipeline.batches);
+    fossil_jellyfish_dataset_close(mapped);
+    fossil_jellyfish_free_network(pipeline.network);
+    return status == 0 ? 0 : 1;
+}
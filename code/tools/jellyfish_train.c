@@ -0,0 +1,593 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifdef __linux__
+#define _GNU_SOURCE
+#else
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "fossil/jellyfish/framework.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// jellyfish-train: trains a network described by a config file on a dataset file.
+// Mini-batches are streamed from the mapped file, or from stdin for a single epoch.
+// Their gradients are computed in parallel on the thread pool through a compiled plan
+// with packed weights, then applied by the configured optimizer.
+
+#define TRAIN_MAX_LAYERS 64
+#define TRAIN_MAX_LINE 1024
+#define TRAIN_ADAM_BETA1 0.9
+#define TRAIN_ADAM_BETA2 0.999
+#define TRAIN_ADAM_EPSILON 1e-8
+#define TRAIN_BATCH_GRAIN 16
+#define TRAIN_REDUCE_GRAIN 4096
+#define TRAIN_GRADIENT_BUDGET ((size_t)256 << 20)  // Bytes of per-thread gradient copies at most
+
+typedef enum {
+    OPTIMIZER_SGD,
+    OPTIMIZER_MOMENTUM,
+    OPTIMIZER_ADAM
+} train_optimizer_t;
+
+typedef struct {
+    int32_t num_layers;
+    int32_t neurons[TRAIN_MAX_LAYERS];
+    fossil_jellyfish_activation_t activations[TRAIN_MAX_LAYERS];
+    int32_t num_activations;
+    fossil_jellyfish_init_t init;
+    int32_t init_set;
+    uint64_t seed;
+    fossil_jellyfish_loss_t loss;
+    train_optimizer_t optimizer;
+    double learning_rate;
+    double momentum;
+    int64_t batch_size;
+    int64_t epochs;
+    int64_t threads;
+    int64_t checkpoint_every;     // Steps between checkpoints, 0 for none
+    char dataset[TRAIN_MAX_LINE];
+    char output[TRAIN_MAX_LINE];
+    char checkpoint[TRAIN_MAX_LINE];
+    char resume[TRAIN_MAX_LINE];  // Start from this saved network instead of the topology
+} train_config_t;
+
+// One mini-batch of gradients, split across the thread pool
+typedef struct {
+    const fossil_jellyfish_plan_t* plan;
+    const double* records;
+    int32_t record_width;
+    int32_t input_width;
+    fossil_jellyfish_loss_t loss;
+    double* gradients;        // One vector per copy
+    double* scratch;          // One plan scratch block per copy
+    int32_t copies;           // Threads that take part, each with its own vector
+    int64_t num_parameters;
+    size_t scratch_size;
+    double* mean;             // The reduced batch gradient
+    int64_t rows;
+} train_batch_t;
+
+static const char* activation_names[] = {"relu", "sigmoid", "tanh", "leaky_relu", "softmax", "elu", "linear"};
+static const char* init_names[] = {"auto", "xavier_uniform", "xavier_normal", "he_uniform", "he_normal", "orthogonal"};
+static const char* loss_names[] = {"mse", "mae", "huber", "binary_cross_entropy", "categorical_cross_entropy"};
+static const char* optimizer_names[] = {"sgd", "momentum", "adam"};
+
+static double now_seconds(void) {
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+static int32_t lookup_name(const char* name, const char* const* names, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int32_t parse_integer(const char* text, int64_t minimum, int64_t* value) {
+    char* end = NULL;
+    long long parsed = strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < minimum) {
+        return -1;
+    }
+    *value = (int64_t)parsed;
+    return 0;
+}
+
+static int32_t parse_real(const char* text, double* value) {
+    char* end = NULL;
+    *value = strtod(text, &end);
+    return end != text && *end == '\0' && *value >= 0 ? 0 : -1;
+}
+
+static int32_t copy_path(char* destination, const char* value) {
+    size_t length = strlen(value);
+    if (length == 0 || length >= TRAIN_MAX_LINE) {
+        return -1;
+    }
+    memcpy(destination, value, length + 1);
+    return 0;
+}
+
+static char* trim(char* text) {
+    while (isspace((unsigned char)*text)) {
+        text++;
+    }
+    char* end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) {
+        *--end = '\0';
+    }
+    return text;
+}
+
+// Splits a space-separated list in place; returns the number of items or -1 if there are too many
+static int32_t split_list(char* value, char** items) {
+    int32_t count = 0;
+    for (char* item = strtok(value, " \t"); item; item = strtok(NULL, " \t")) {
+        if (count == TRAIN_MAX_LAYERS) {
+            return -1;
+        }
+        items[count++] = item;
+    }
+    return count;
+}
+
+static int32_t apply_setting(train_config_t* config, const char* key, char* value) {
+    char* items[TRAIN_MAX_LAYERS];
+    int64_t integer;
+    int32_t index;
+
+    if (strcmp(key, "layers") == 0) {
+        int32_t count = split_list(value, items);
+        if (count < 2) {
+            return -1;
+        }
+        for (int32_t i = 0; i < count; i++) {
+            if (parse_integer(items[i], 1, &integer) != 0 || integer > INT32_MAX) {
+                return -1;
+            }
+            config->neurons[i] = (int32_t)integer;
+        }
+        config->num_layers = count;
+    } else if (strcmp(key, "activations") == 0) {
+        int32_t count = split_list(value, items);
+        if (count < 1) {
+            return -1;
+        }
+        for (int32_t i = 0; i < count; i++) {
+            if ((index = lookup_name(items[i], activation_names, 7)) < 0) {
+                return -1;
+            }
+            config->activations[i] = (fossil_jellyfish_activation_t)index;
+        }
+        config->num_activations = count;
+    } else if (strcmp(key, "init") == 0) {
+        if ((index = lookup_name(value, init_names, 6)) < 0) {
+            return -1;
+        }
+        config->init = (fossil_jellyfish_init_t)index;
+        config->init_set = 1;
+    } else if (strcmp(key, "seed") == 0) {
+        if (parse_integer(value, 0, &integer) != 0) {
+            return -1;
+        }
+        config->seed = (uint64_t)integer;
+    } else if (strcmp(key, "loss") == 0) {
+        if ((index = lookup_name(value, loss_names, 5)) < 0) {
+            return -1;
+        }
+        config->loss = (fossil_jellyfish_loss_t)index;
+    } else if (strcmp(key, "optimizer") == 0) {
+        if ((index = lookup_name(value, optimizer_names, 3)) < 0) {
+            return -1;
+        }
+        config->optimizer = (train_optimizer_t)index;
+    } else if (strcmp(key, "learning_rate") == 0) {
+        return parse_real(value, &config->learning_rate);
+    } else if (strcmp(key, "momentum") == 0) {
+        return parse_real(value, &config->momentum) == 0 && config->momentum < 1 ? 0 : -1;
+    } else if (strcmp(key, "batch_size") == 0) {
+        return parse_integer(value, 1, &config->batch_size);
+    } else if (strcmp(key, "epochs") == 0) {
+        return parse_integer(value, 1, &config->epochs);
+    } else if (strcmp(key, "threads") == 0) {
+        return parse_integer(value, 0, &config->threads) == 0 && config->threads <= 4096 ? 0 : -1;
+    } else if (strcmp(key, "checkpoint_every") == 0) {
+        return parse_integer(value, 0, &config->checkpoint_every);
+    } else if (strcmp(key, "dataset") == 0) {
+        return copy_path(config->dataset, value);
+    } else if (strcmp(key, "output") == 0) {
+        return copy_path(config->output, value);
+    } else if (strcmp(key, "checkpoint") == 0) {
+        return copy_path(config->checkpoint, value);
+    } else if (strcmp(key, "resume") == 0) {
+        return copy_path(config->resume, value);
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+// One activation per layer; the input layer's may be left out
+static int32_t spread_activations(train_config_t* config, int32_t num_layers) {
+    if (config->num_activations == num_layers - 1) {
+        memmove(&config->activations[1], &config->activations[0], (size_t)config->num_activations * sizeof(config->activations[0]));
+        config->activations[0] = ACTIVATION_LINEAR;
+        config->num_activations = num_layers;
+    }
+    return config->num_activations == num_layers ? 0 : -1;
+}
+
+// Resuming keeps the saved network as it is, so settings that would shape a new one must agree with it
+static int32_t check_resumed(train_config_t* config, const fossil_jellyfish_network_t* network) {
+    if (config->init_set) {
+        fprintf(stderr, "jellyfish-train: init does not apply to the resumed network %s\n", config->resume);
+        return -1;
+    }
+    int32_t matches = config->num_layers == 0 || config->num_layers == network->num_layers;
+    for (int32_t i = 0; matches && i < config->num_layers; i++) {
+        matches = config->neurons[i] == network->layers[i]->num_neurons;
+    }
+    if (matches && config->num_activations > 0) {
+        matches = spread_activations(config, network->num_layers) == 0;
+        // The input layer's activation is never applied
+        for (int32_t i = 1; matches && i < network->num_layers; i++) {
+            matches = config->activations[i] == network->layers[i]->activation;
+        }
+    }
+    if (!matches) {
+        fprintf(stderr, "jellyfish-train: layers or activations do not match the resumed network %s\n", config->resume);
+        return -1;
+    }
+    return 0;
+}
+
+// Reads "key = value" lines; '#' starts a comment
+static int32_t read_config(const char* path, train_config_t* config) {
+    FILE* file = fopen(path, "r");
+    char line[TRAIN_MAX_LINE];
+    int32_t number = 0;
+    if (!file) {
+        fprintf(stderr, "jellyfish-train: cannot open config %s\n", path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        char* comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        char* text = trim(line);
+        if (*text == '\0') {
+            continue;
+        }
+        char* equals = strchr(text, '=');
+        if (equals) {
+            *equals = '\0';
+        }
+        if (!equals || apply_setting(config, trim(text), trim(equals + 1)) != 0) {
+            fprintf(stderr, "jellyfish-train: %s:%d: invalid setting\n", path, number);
+            fclose(file);
+            return -1;
+        }
+    }
+    fclose(file);
+
+    // A resumed network brings its topology; any given must still match it, which main checks
+    if (!config->resume[0] || config->num_layers > 0) {
+        if (config->num_layers < 2 || (!config->resume[0] && config->num_activations == 0) ||
+            (config->num_activations > 0 && spread_activations(config, config->num_layers) != 0)) {
+            fprintf(stderr, "jellyfish-train: %s: layers and activations do not match\n", path);
+            return -1;
+        }
+    }
+    if (!config->output[0]) {
+        fprintf(stderr, "jellyfish-train: %s: no output path\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Sums the copies of each parameter in [begin, end) into the mean and clears them for the next batch
+static void train_reduce_task(void* context, int64_t begin, int64_t end, int32_t thread_index) {
+    train_batch_t* batch = (train_batch_t*)context;
+    (void)thread_index;
+    for (int64_t p = begin; p < end; p++) {
+        double sum = 0;
+        for (int32_t t = 0; t < batch->copies; t++) {
+            double* gradient = batch->gradients + (size_t)t * (size_t)batch->num_parameters + p;
+            sum += *gradient;
+            *gradient = 0;
+        }
+        batch->mean[p] = sum / (double)batch->rows;
+    }
+}
+
+static void train_batch_task(void* context, int64_t begin, int64_t end, int32_t thread_index) {
+    train_batch_t* batch = (train_batch_t*)context;
+    double* gradients = batch->gradients + (size_t)thread_index * (size_t)batch->num_parameters;
+    double* scratch = batch->scratch + (size_t)thread_index * batch->scratch_size;
+    for (int64_t r = begin; r < end; r++) {
+        const double* record = batch->records + r * batch->record_width;
+        fossil_jellyfish_plan_accumulate_gradients(batch->plan, record, record + batch->input_width, batch->loss, gradients, scratch);
+    }
+}
+
+// Writes to a temporary file first and replaces the old checkpoint in one step, so a
+// crash leaves either the previous checkpoint or the new one, never none or a torn one
+static int32_t save_atomically(fossil_jellyfish_network_t* network, const char* path) {
+    char temporary[TRAIN_MAX_LINE + 8];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    if (fossil_jellyfish_save(network, temporary) != 0) {
+        remove(temporary);
+        return -1;
+    }
+#ifdef _WIN32
+    // rename refuses to replace an existing file here
+    return MoveFileExA(temporary, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1;
+#else
+    return rename(temporary, path) == 0 ? 0 : -1;
+#endif
+}
+
+// Turns the summed gradients of a batch into the step handed to fossil_jellyfish_apply_gradients
+static void optimizer_step(const train_config_t* config, double* step, const double* gradients, double* first, double* second, int64_t count, int64_t iteration) {
+    if (config->optimizer == OPTIMIZER_SGD) {
+        memcpy(step, gradients, (size_t)count * sizeof(double));
+    } else if (config->optimizer == OPTIMIZER_MOMENTUM) {
+        for (int64_t p = 0; p < count; p++) {
+            first[p] = config->momentum * first[p] + gradients[p];
+            step[p] = first[p];
+        }
+    } else {
+        double correction1 = 1 - pow(TRAIN_ADAM_BETA1, (double)iteration);
+        double correction2 = 1 - pow(TRAIN_ADAM_BETA2, (double)iteration);
+        for (int64_t p = 0; p < count; p++) {
+            first[p] = TRAIN_ADAM_BETA1 * first[p] + (1 - TRAIN_ADAM_BETA1) * gradients[p];
+            second[p] = TRAIN_ADAM_BETA2 * second[p] + (1 - TRAIN_ADAM_BETA2) * gradients[p] * gradients[p];
+            step[p] = (first[p] / correction1) / (sqrt(second[p] / correction2) + TRAIN_ADAM_EPSILON);
+        }
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: jellyfish-train CONFIG [DATASET]\n"
+            "  CONFIG   key = value lines:\n"
+            "             layers = 8 64 3                 neurons per layer, input first\n"
+            "             activations = relu softmax      per layer; the input layer's may be left out\n"
+            "             init = auto | xavier_uniform | xavier_normal | he_uniform | he_normal | orthogonal\n"
+            "             seed = 1\n"
+            "             loss = mse | mae | huber | binary_cross_entropy | categorical_cross_entropy\n"
+            "             optimizer = sgd | momentum | adam\n"
+            "             learning_rate = 0.01            momentum = 0.9\n"
+            "             batch_size = 64                 epochs = 1\n"
+            "             threads = 0                     0 for every core\n"
+            "             dataset = train.dat             output = model.bin\n"
+            "             checkpoint = model.ckpt         checkpoint_every = 1000 (steps)\n"
+            "             resume = model.ckpt             start from a saved network; layers and\n"
+            "                                             activations, if given, must match it\n"
+            "           Checkpoints hold the network only: momentum and adam moments\n"
+            "           start again from zero on resume.\n"
+            "  DATASET  overrides the config's dataset; - streams one epoch from stdin\n");
+}
+
+int main(int argc, char** argv) {
+    train_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.seed = FOSSIL_JELLYFISH_DEFAULT_SEED;
+    config.loss = LOSS_MSE;
+    config.optimizer = OPTIMIZER_SGD;
+    config.learning_rate = 0.01;
+    config.momentum = 0.9;
+    config.batch_size = 64;
+    config.epochs = 1;
+
+    if (argc < 2 || argc > 3) {
+        usage();
+        return 2;
+    }
+    if (read_config(argv[1], &config) != 0 || (argc == 3 && copy_path(config.dataset, argv[2]) != 0)) {
+        return 2;
+    }
+    if (!config.dataset[0]) {
+        fprintf(stderr, "jellyfish-train: no dataset given\n");
+        return 2;
+    }
+    fossil_jellyfish_set_num_threads((int32_t)config.threads);
+
+    fossil_jellyfish_network_t* network = NULL;
+    if (config.resume[0]) {
+        network = fossil_jellyfish_load(config.resume);
+        if (network && check_resumed(&config, network) != 0) {
+            fossil_jellyfish_free_network(network);
+            return 2;
+        }
+    } else {
+        network = fossil_jellyfish_create_network(config.num_layers, config.neurons, config.activations);
+        if (network) {
+            fossil_jellyfish_init_network(network, config.init, config.seed);
+        }
+    }
+    if (!network) {
+        fprintf(stderr, "jellyfish-train: cannot build the network\n");
+        return 1;
+    }
+    int32_t input_width = network->layers[0]->num_neurons;
+    int32_t output_width = network->layers[network->num_layers - 1]->num_neurons;
+
+    // A mapped file can be replayed every epoch; a stream is read once
+    fossil_jellyfish_dataset_file_t* mapped = NULL;
+    fossil_jellyfish_dataset_header_t header;
+    FILE* stream = NULL;
+    int32_t target_width = -1;
+    if (strcmp(config.dataset, "-") == 0) {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        stream = stdin;
+        if (fossil_jellyfish_dataset_read_header(stdin, &header) == 0 && header.input_width == input_width) {
+            target_width = header.target_width;
+        }
+        config.epochs = 1;
+    } else {
+        mapped = fossil_jellyfish_dataset_open(config.dataset);
+        if (mapped && mapped->input_width == input_width) {
+            target_width = mapped->target_width;
+        }
+    }
+    if (target_width != output_width) {
+        fprintf(stderr, "jellyfish-train: %s is not a dataset of %d inputs and %d targets per record\n", config.dataset, input_width, output_width);
+        fossil_jellyfish_dataset_close(mapped);
+        fossil_jellyfish_free_network(network);
+        return 1;
+    }
+    int32_t record_width = input_width + target_width;
+
+    // Fast path: a compiled plan with packed weights, shared by every thread
+    fossil_jellyfish_plan_t* plan = fossil_jellyfish_compile(network, NULL);
+    int64_t count = fossil_jellyfish_num_parameters(network);
+    // No more gradient copies than a batch has chunks or the budget holds; other threads sit batches out
+    int64_t copies = fossil_jellyfish_get_num_threads();
+    int64_t chunks = (config.batch_size + TRAIN_BATCH_GRAIN - 1) / TRAIN_BATCH_GRAIN;
+    int64_t affordable = (int64_t)(TRAIN_GRADIENT_BUDGET / ((size_t)count * sizeof(double)));
+    copies = copies < chunks ? copies : chunks;
+    copies = copies < affordable ? copies : affordable;
+    train_batch_t batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.plan = plan;
+    batch.record_width = record_width;
+    batch.input_width = input_width;
+    batch.loss = config.loss;
+    batch.copies = copies > 1 ? (int32_t)copies : 1;
+    batch.num_parameters = count;
+    batch.scratch_size = plan ? fossil_jellyfish_plan_scratch_size(plan) : 0;
+    batch.gradients = (double*)calloc((size_t)batch.copies * (size_t)count, sizeof(double));
+    batch.scratch = (double*)malloc((size_t)batch.copies * batch.scratch_size * sizeof(double));
+    batch.mean = (double*)malloc((size_t)count * sizeof(double));
+    double* step = (double*)malloc((size_t)count * sizeof(double));
+    double* first = (double*)calloc((size_t)count, sizeof(double));
+    double* second = (double*)calloc((size_t)count, sizeof(double));
+    // Streamed batches alternate between two halves, so the last full one survives the read hitting the end
+    size_t batch_values = (size_t)config.batch_size * (size_t)record_width;
+    double* buffer = stream ? (double*)malloc(2 * batch_values * sizeof(double)) : NULL;
+    double* outputs = (double*)malloc((size_t)config.batch_size * (size_t)output_width * sizeof(double));
+    double* targets = (double*)malloc((size_t)config.batch_size * (size_t)output_width * sizeof(double));
+    int32_t status = plan && batch.gradients && batch.scratch && batch.mean && step && first && second && outputs && targets && (!stream || buffer) ? 0 : -1;
+
+    int64_t iteration = 0;
+    for (int64_t epoch = 0; epoch < config.epochs && status == 0; epoch++) {
+        double start = now_seconds();
+        int64_t samples = 0;
+        const double* last_records = NULL;
+        int64_t last_rows = 0;
+
+        for (int64_t offset = 0; status == 0; offset += config.batch_size) {
+            int64_t rows;
+            if (mapped) {
+                rows = mapped->num_records - offset < config.batch_size ? mapped->num_records - offset : config.batch_size;
+                batch.records = mapped->records + offset * record_width;
+            } else {
+                // Read in bytes, so a stream that stops inside a record is noticed rather than dropped
+                double* half = buffer + (size_t)(iteration % 2) * batch_values;
+                size_t record_bytes = sizeof(double) * (size_t)record_width;
+                size_t bytes = fread(half, 1, batch_values * sizeof(double), stream);
+                rows = (int64_t)(bytes / record_bytes);
+                batch.records = half;
+                status = ferror(stream) ? -1 : 0;
+                if (status == 0 && bytes % record_bytes != 0) {
+                    fprintf(stderr, "jellyfish-train: %s ends in the middle of a record\n", config.dataset);
+                    status = -1;
+                }
+            }
+            if (rows <= 0 || status != 0) {
+                break;
+            }
+
+            // Per-copy gradient sums, reduced over parameter ranges on the pool
+            batch.rows = rows;
+            fossil_jellyfish_parallel_for_bounded(rows, TRAIN_BATCH_GRAIN, batch.copies, train_batch_task, &batch);
+            fossil_jellyfish_parallel_for(count, TRAIN_REDUCE_GRAIN, train_reduce_task, &batch);
+            optimizer_step(&config, step, batch.mean, first, second, count, ++iteration);
+            if (fossil_jellyfish_apply_gradients(network, step, config.learning_rate) != 0 || fossil_jellyfish_plan_refresh(plan) != 0) {
+                status = -1;
+                break;
+            }
+            samples += rows;
+            last_records = batch.records;
+            last_rows = rows;
+
+            if (config.checkpoint[0] && config.checkpoint_every > 0 && iteration % config.checkpoint_every == 0 &&
+                save_atomically(network, config.checkpoint) != 0) {
+                fprintf(stderr, "jellyfish-train: cannot write checkpoint %s\n", config.checkpoint);
+                status = -1;
+            }
+        }
+
+        double seconds = now_seconds() - start;
+
+        // The loss of the updated network on the epoch's last batch, for the report
+        double last_loss = 0;
+        for (int64_t r = 0; r < last_rows && status == 0; r++) {
+            memcpy(targets + r * output_width, last_records + r * record_width + input_width, (size_t)output_width * sizeof(double));
+        }
+        if (last_rows > 0 && status == 0) {
+            fossil_jellyfish_forward_strided(network, last_records, record_width, last_rows, outputs);
+            last_loss = fossil_jellyfish_loss(config.loss, outputs, targets, last_rows, output_width);
+        }
+        if (status == 0) {
+            fprintf(stderr, "jellyfish-train: epoch %lld/%lld: %lld samples in %.3f s, %.0f samples/s, batch loss %.6g\n", (long long)(epoch + 1),
+                    (long long)config.epochs, (long long)samples, seconds, seconds > 0 ? (double)samples / seconds : 0.0, last_loss);
+        }
+    }
+
+    if (status == 0 && save_atomically(network, config.output) != 0) {
+        fprintf(stderr, "jellyfish-train: cannot write %s\n", config.output);
+        status = -1;
+    } else if (status != 0) {
+        fprintf(stderr, "jellyfish-train: training on %s failed\n", config.dataset);
+    }
+
+    free(batch.gradients);
+    free(batch.scratch);
+    free(batch.mean);
+    free(step);
+    free(first);
+    free(second);
+    free(buffer);
+    free(outputs);
+    free(targets);
+    fossil_jellyfish_plan_free(plan);
+    fossil_jellyfish_dataset_close(mapped);
+    fossil_jellyfish_free_network(network);
+    return status == 0 ? 0 : 1;
+}